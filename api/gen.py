@@ -287,10 +287,10 @@ mesh.add('getNode', doc, None, isize('nodeTag'), ovectordouble('coord'), ovector
 doc = '''Set the coordinates and the parametric coordinates (if any) of the node with tag `tag'. This function relies on an internal cache (a vector in case of dense node numbering, a map otherwise); for large meshes accessing nodes in bulk is often preferable.'''
 mesh.add('setNode', doc, None, isize('nodeTag'), ivectordouble('coord'), ivectordouble('parametricCoord'))
 
-doc = '''Rebuild the node cache.'''
+doc = '''Rebuild the node cache (in parallel). The cache is otherwise built on demand by the first function that accesses nodes by tag: rebuilding it beforehand allows such functions to be called concurrently without locking.'''
 mesh.add('rebuildNodeCache', doc, None, ibool('onlyIfNecessary', 'true', 'True'))
 
-doc = '''Rebuild the element cache.'''
+doc = '''Rebuild the element cache (in parallel). The cache is otherwise built on demand by the first function that accesses elements by tag: rebuilding it beforehand allows such functions to be called concurrently without locking.'''
 mesh.add('rebuildElementCache', doc, None, ibool('onlyIfNecessary', 'true', 'True'))
 
 doc = '''Get the nodes from all the elements belonging to the physical group of dimension `dim' and tag `tag'. `nodeTags' contains the node tags; `coord' is a vector of length 3 times the length of `nodeTags' that contains the x, y, z coordinates of the nodes, concatenated: [n1x, n1y, n1z, n2x, ...].'''
@@ -491,11 +491,11 @@ mesh.add('getEmbedded', doc, None, iint('dim'), iint('tag'), ovectorpair('dimTag
 doc = '''Reorder the elements of type `elementType' classified on the entity of tag `tag' according to `ordering'.'''
 mesh.add('reorderElements', doc, None, iint('elementType'), iint('tag'), ivectorsize('ordering'))
 
-doc = '''Renumber the node tags in a continuous sequence.'''
-mesh.add('renumberNodes', doc, None)
+doc = '''Renumber the node tags in a continuous sequence, using `method': "Sequential" (by entity), "RCMK" (reverse Cuthill-McKee, to reduce the bandwidth and the profile), "Hilbert" (along a Hilbert curve, for spatial locality) or "Partition" (by mesh partition). If `method' is empty, use the method given by the `Mesh.RenumberMethod' option.'''
+mesh.add('renumberNodes', doc, None, istring('method', '""'))
 
-doc = '''Renumber the element tags in a continuous sequence.'''
-mesh.add('renumberElements', doc, None)
+doc = '''Renumber the element tags in a continuous sequence, using `method' (see `renumberNodes'; "RCMK" orders the elements according to the current node numbering). The elements of curves are always kept in their original order.'''
+mesh.add('renumberElements', doc, None, istring('method', '""'))
 
 doc = '''Set the meshes of the entities of dimension `dim' and tag `tags' as periodic copies of the meshes of entities `tagsMaster', using the affine transformation specified in `affineTransformation' (16 entries of a 4x4 matrix, by row). If used after meshing, generate the periodic node correspondence information assuming the meshes of entities `tags' effectively match the meshes of entities `tagsMaster' (useful for structured and extruded meshes). Currently only available for @code{dim} == 1 and @code{dim} == 2.'''
 mesh.add('setPeriodic', doc, None, iint('dim'), ivectorint('tags'), ivectorint('tagsMaster'), ivectordouble('affineTransform'))
@@ -594,6 +594,9 @@ field.add('setAsBackgroundMesh', doc, None, iint('tag'))
 doc = '''Set the field `tag' as a boundary layer size field.'''
 field.add('setAsBoundaryLayer', doc, None, iint('tag'))
 
+doc = '''Evaluate the field `tag' at the points given by their coordinates `xyz' (concatenated: [p1x, p1y, p1z, p2x, ...]). Return the values in `values'. If `dim' and `entityTag' are given, evaluate the field as if the points were located on the corresponding model entity. The points are processed in chunks, in parallel if General.NumThreads > 1.'''
+field.add('evaluate', doc, None, iint('tag'), ivectordouble('xyz'), ovectordouble('values'), iint('dim', '-1'), iint('entityTag', '-1'))
+
 ################################################################################
 
 geo = model.add_module('geo', 'built-in CAD kernel functions')
@@ -987,6 +990,9 @@ view.add('combine', doc, None, istring('what'), istring('how'), ibool('remove',
 doc = '''Probe the view `tag' for its `value' at point (`x', `y', `z'). If no match is found, `value' is returned empty. Return only the value at step `step' is `step' is positive. Return only values with `numComp' if `numComp' is positive. Return the gradient of the `value' if `gradient' is set. If `distanceMax' is zero, only return a result if an exact match inside an element in the view is found; if `distanceMax' is positive and an exact match is not found, return the value at the closest node if it is closer than `distanceMax'; if `distanceMax' is negative and an exact match is not found, always return the value at the closest node. The distance to the match is returned in `distance'. Return the result from the element described by its coordinates if `xElementCoord', `yElementCoord' and `zElementCoord' are provided. If `dim' is >= 0, return only matches from elements of the specified dimension.'''
 view.add('probe', doc, None, iint('tag'), idouble('x'), idouble('y'), idouble('z'), ovectordouble('value'), odouble('distance'), iint('step', '-1'), iint('numComp', '-1'), ibool('gradient', 'false', 'False'), idouble('distanceMax', '0.'), ivectordouble('xElemCoord', 'std::vector<double>()', '[]', '[]'), ivectordouble('yElemCoord', 'std::vector<double>()', '[]', '[]'), ivectordouble('zElemCoord', 'std::vector<double>()', '[]', '[]'), iint('dim', '-1'))
 
+doc = '''Probe the view `tag' at the points given by their `coord' (x, y, z coordinates concatenated), in parallel. The values at all points are returned concatenated in `values', with the same number of values for each point (zero if no match is found for the point); the distance to the match of each point is returned in `distances' (-1 if no match is found). If `numComp' is not positive, the number of components is determined by the type of the data in the view (scalar, vector or tensor). `step', `gradient', `distanceMax' and `dim' have the same meaning as in `probe'.'''
+view.add('probeBatch', doc, None, iint('tag'), ivectordouble('coord'), ovectordouble('values'), ovectordouble('distances'), iint('step', '-1'), iint('numComp', '-1'), ibool('gradient', 'false', 'False'), idouble('distanceMax', '0.'), iint('dim', '-1'))
+
 doc = '''Write the view to a file `fileName'. The export format is determined by the file extension. Append to the file if `append' is set.'''
 view.add('write', doc, None, iint('tag'), istring('fileName'), ibool('append', 'false', 'False'))
 
@@ -1183,6 +1189,18 @@ logger.add('getCpuTime', doc, odouble)
 doc = '''Return last error message, if any.'''
 logger.add('getLastError', doc, None, ostring('error'))
 
+doc = '''Start profiling, clearing previously recorded data. The time spent in the main stages of mesh generation (for each model entity) is recorded for each thread, as well as counters such as the number of Delaunay point insertions, mesh size evaluations and octree queries.'''
+logger.add('startProfiling', doc, None)
+
+doc = '''Stop profiling. The recorded data is kept until the next call to `startProfiling'.'''
+logger.add('stopProfiling', doc, None)
+
+doc = '''Get the profiling data, as a flat list of nodes of the call tree of each thread. For each node `i', `names[i]' is the name of the region or counter, `parents[i]' the index of the parent node (-1 for top-level regions), `calls[i]' the number of calls (or the value of the counter), `inclusiveTimes[i]' and `exclusiveTimes[i]' the wall clock time spent in the region including and excluding its children (zero for counters), and `threads[i]' the index of the thread.'''
+logger.add('getProfile', doc, None, ovectorstring('names'), ovectorint('parents'), ovectorsize('calls'), ovectordouble('inclusiveTimes'), ovectordouble('exclusiveTimes'), ovectorint('threads'))
+
+doc = '''Write the recorded profiling regions in `fileName', in the Chrome trace (JSON) format.'''
+logger.add('writeProfile', doc, None, istring('fileName'))
+
 ################################################################################
 
 api.write_cpp()
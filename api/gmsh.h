@@ -765,12 +765,18 @@ namespace gmsh { // Top-level functions
 
       // gmsh::model::mesh::rebuildNodeCache
       //
-      // Rebuild the node cache.
+      // Rebuild the node cache (in parallel). The cache is otherwise built on
+      // demand by the first function that accesses nodes by tag: rebuilding it
+      // beforehand allows such functions to be called concurrently without
+      // locking.
       GMSH_API void rebuildNodeCache(const bool onlyIfNecessary = true);
 
       // gmsh::model::mesh::rebuildElementCache
       //
-      // Rebuild the element cache.
+      // Rebuild the element cache (in parallel). The cache is otherwise built on
+      // demand by the first function that accesses elements by tag: rebuilding it
+      // beforehand allows such functions to be called concurrently without
+      // locking.
       GMSH_API void rebuildElementCache(const bool onlyIfNecessary = true);
 
       // gmsh::model::mesh::getNodesForPhysicalGroup
@@ -1554,13 +1560,20 @@ namespace gmsh { // Top-level functions
 
       // gmsh::model::mesh::renumberNodes
       //
-      // Renumber the node tags in a continuous sequence.
-      GMSH_API void renumberNodes();
+      // Renumber the node tags in a continuous sequence, using `method':
+      // "Sequential" (by entity), "RCMK" (reverse Cuthill-McKee, to reduce the
+      // bandwidth and the profile), "Hilbert" (along a Hilbert curve, for spatial
+      // locality) or "Partition" (by mesh partition). If `method' is empty, use
+      // the method given by the `Mesh.RenumberMethod' option.
+      GMSH_API void renumberNodes(const std::string & method = "");
 
       // gmsh::model::mesh::renumberElements
       //
-      // Renumber the element tags in a continuous sequence.
-      GMSH_API void renumberElements();
+      // Renumber the element tags in a continuous sequence, using `method' (see
+      // `renumberNodes'; "RCMK" orders the elements according to the current node
+      // numbering). The elements of curves are always kept in their original
+      // order.
+      GMSH_API void renumberElements(const std::string & method = "");
 
       // gmsh::model::mesh::setPeriodic
       //
@@ -1824,6 +1837,19 @@ namespace gmsh { // Top-level functions
         // Set the field `tag' as a boundary layer size field.
         GMSH_API void setAsBoundaryLayer(const int tag);
 
+        // gmsh::model::mesh::field::evaluate
+        //
+        // Evaluate the field `tag' at the points given by their coordinates `xyz'
+        // (concatenated: [p1x, p1y, p1z, p2x, ...]). Return the values in
+        // `values'. If `dim' and `entityTag' are given, evaluate the field as if
+        // the points were located on the corresponding model entity. The points
+        // are processed in chunks, in parallel if General.NumThreads > 1.
+        GMSH_API void evaluate(const int tag,
+                               const std::vector<double> & xyz,
+                               std::vector<double> & values,
+                               const int dim = -1,
+                               const int entityTag = -1);
+
       } // namespace field
 
     } // namespace mesh
@@ -3459,6 +3485,26 @@ namespace gmsh { // Top-level functions
                         const std::vector<double> & zElemCoord = std::vector<double>(),
                         const int dim = -1);
 
+    // gmsh::view::probeBatch
+    //
+    // Probe the view `tag' at the points given by their `coord' (x, y, z
+    // coordinates concatenated), in parallel. The values at all points are
+    // returned concatenated in `values', with the same number of values for each
+    // point (zero if no match is found for the point); the distance to the match
+    // of each point is returned in `distances' (-1 if no match is found). If
+    // `numComp' is not positive, the number of components is determined by the
+    // type of the data in the view (scalar, vector or tensor). `step', `gradient',
+    // `distanceMax' and `dim' have the same meaning as in `probe'.
+    GMSH_API void probeBatch(const int tag,
+                             const std::vector<double> & coord,
+                             std::vector<double> & values,
+                             std::vector<double> & distances,
+                             const int step = -1,
+                             const int numComp = -1,
+                             const bool gradient = false,
+                             const double distanceMax = 0.,
+                             const int dim = -1);
+
     // gmsh::view::write
     //
     // Write the view to a file `fileName'. The export format is determined by the
@@ -3857,6 +3903,42 @@ namespace gmsh { // Top-level functions
     // Return last error message, if any.
     GMSH_API void getLastError(std::string & error);
 
+    // gmsh::logger::startProfiling
+    //
+    // Start profiling, clearing previously recorded data. The time spent in the
+    // main stages of mesh generation (for each model entity) is recorded for each
+    // thread, as well as counters such as the number of Delaunay point insertions,
+    // mesh size evaluations and octree queries.
+    GMSH_API void startProfiling();
+
+    // gmsh::logger::stopProfiling
+    //
+    // Stop profiling. The recorded data is kept until the next call to
+    // `startProfiling'.
+    GMSH_API void stopProfiling();
+
+    // gmsh::logger::getProfile
+    //
+    // Get the profiling data, as a flat list of nodes of the call tree of each
+    // thread. For each node `i', `names[i]' is the name of the region or counter,
+    // `parents[i]' the index of the parent node (-1 for top-level regions),
+    // `calls[i]' the number of calls (or the value of the counter),
+    // `inclusiveTimes[i]' and `exclusiveTimes[i]' the wall clock time spent in the
+    // region including and excluding its children (zero for counters), and
+    // `threads[i]' the index of the thread.
+    GMSH_API void getProfile(std::vector<std::string> & names,
+                             std::vector<int> & parents,
+                             std::vector<std::size_t> & calls,
+                             std::vector<double> & inclusiveTimes,
+                             std::vector<double> & exclusiveTimes,
+                             std::vector<int> & threads);
+
+    // gmsh::logger::writeProfile
+    //
+    // Write the recorded profiling regions in `fileName', in the Chrome trace
+    // (JSON) format.
+    GMSH_API void writeProfile(const std::string & fileName);
+
   } // namespace logger
 
 } // namespace gmsh
@@ -1596,7 +1596,9 @@ const set_node = setNode
 """
     gmsh.model.mesh.rebuildNodeCache(onlyIfNecessary = true)
 
-Rebuild the node cache.
+Rebuild the node cache (in parallel). The cache is otherwise built on demand by
+the first function that accesses nodes by tag: rebuilding it beforehand allows
+such functions to be called concurrently without locking.
 """
 function rebuildNodeCache(onlyIfNecessary = true)
     ierr = Ref{Cint}()
@@ -1611,7 +1613,9 @@ const rebuild_node_cache = rebuildNodeCache
 """
     gmsh.model.mesh.rebuildElementCache(onlyIfNecessary = true)
 
-Rebuild the element cache.
+Rebuild the element cache (in parallel). The cache is otherwise built on demand
+by the first function that accesses elements by tag: rebuilding it beforehand
+allows such functions to be called concurrently without locking.
 """
 function rebuildElementCache(onlyIfNecessary = true)
     ierr = Ref{Cint}()
@@ -3038,30 +3042,36 @@ end
 const reorder_elements = reorderElements
 
 """
-    gmsh.model.mesh.renumberNodes()
+    gmsh.model.mesh.renumberNodes(method = "")
 
-Renumber the node tags in a continuous sequence.
+Renumber the node tags in a continuous sequence, using `method`: "Sequential"
+(by entity), "RCMK" (reverse Cuthill-McKee, to reduce the bandwidth and the
+profile), "Hilbert" (along a Hilbert curve, for spatial locality) or "Partition"
+(by mesh partition). If `method` is empty, use the method given by the
+`Mesh.RenumberMethod` option.
 """
-function renumberNodes()
+function renumberNodes(method = "")
     ierr = Ref{Cint}()
     ccall((:gmshModelMeshRenumberNodes, gmsh.lib), Cvoid,
-          (Ptr{Cint},),
-          ierr)
+          (Ptr{Cchar}, Ptr{Cint}),
+          method, ierr)
     ierr[] != 0 && error(gmsh.logger.getLastError())
     return nothing
 end
 const renumber_nodes = renumberNodes
 
 """
-    gmsh.model.mesh.renumberElements()
+    gmsh.model.mesh.renumberElements(method = "")
 
-Renumber the element tags in a continuous sequence.
+Renumber the element tags in a continuous sequence, using `method` (see
+`renumberNodes`; "RCMK" orders the elements according to the current node
+numbering). The elements of curves are always kept in their original order.
 """
-function renumberElements()
+function renumberElements(method = "")
     ierr = Ref{Cint}()
     ccall((:gmshModelMeshRenumberElements, gmsh.lib), Cvoid,
-          (Ptr{Cint},),
-          ierr)
+          (Ptr{Cchar}, Ptr{Cint}),
+          method, ierr)
     ierr[] != 0 && error(gmsh.logger.getLastError())
     return nothing
 end
@@ -3682,6 +3692,29 @@ function setAsBoundaryLayer(tag)
 end
 const set_as_boundary_layer = setAsBoundaryLayer
 
+"""
+    gmsh.model.mesh.field.evaluate(tag, xyz, dim = -1, entityTag = -1)
+
+Evaluate the field `tag` at the points given by their coordinates `xyz`
+(concatenated: [p1x, p1y, p1z, p2x, ...]). Return the values in `values`. If
+`dim` and `entityTag` are given, evaluate the field as if the points were
+located on the corresponding model entity. The points are processed in chunks,
+in parallel if General.NumThreads > 1.
+
+Return `values`.
+"""
+function evaluate(tag, xyz, dim = -1, entityTag = -1)
+    api_values_ = Ref{Ptr{Cdouble}}()
+    api_values_n_ = Ref{Csize_t}()
+    ierr = Ref{Cint}()
+    ccall((:gmshModelMeshFieldEvaluate, gmsh.lib), Cvoid,
+          (Cint, Ptr{Cdouble}, Csize_t, Ptr{Ptr{Cdouble}}, Ptr{Csize_t}, Cint, Cint, Ptr{Cint}),
+          tag, convert(Vector{Cdouble}, xyz), length(xyz), api_values_, api_values_n_, dim, entityTag, ierr)
+    ierr[] != 0 && error(gmsh.logger.getLastError())
+    values = unsafe_wrap(Array, api_values_[], api_values_n_[], own = true)
+    return values
+end
+
 end # end of module field
 
 end # end of module mesh
@@ -6525,6 +6558,36 @@ function probe(tag, x, y, z, step = -1, numComp = -1, gradient = false, distance
     return value, api_distance_[]
 end
 
+"""
+    gmsh.view.probeBatch(tag, coord, step = -1, numComp = -1, gradient = false, distanceMax = 0., dim = -1)
+
+Probe the view `tag` at the points given by their `coord` (x, y, z coordinates
+concatenated), in parallel. The values at all points are returned concatenated
+in `values`, with the same number of values for each point (zero if no match is
+found for the point); the distance to the match of each point is returned in
+`distances` (-1 if no match is found). If `numComp` is not positive, the number
+of components is determined by the type of the data in the view (scalar, vector
+or tensor). `step`, `gradient`, `distanceMax` and `dim` have the same meaning as
+in `probe`.
+
+Return `values`, `distances`.
+"""
+function probeBatch(tag, coord, step = -1, numComp = -1, gradient = false, distanceMax = 0., dim = -1)
+    api_values_ = Ref{Ptr{Cdouble}}()
+    api_values_n_ = Ref{Csize_t}()
+    api_distances_ = Ref{Ptr{Cdouble}}()
+    api_distances_n_ = Ref{Csize_t}()
+    ierr = Ref{Cint}()
+    ccall((:gmshViewProbeBatch, gmsh.lib), Cvoid,
+          (Cint, Ptr{Cdouble}, Csize_t, Ptr{Ptr{Cdouble}}, Ptr{Csize_t}, Ptr{Ptr{Cdouble}}, Ptr{Csize_t}, Cint, Cint, Cint, Cdouble, Cint, Ptr{Cint}),
+          tag, convert(Vector{Cdouble}, coord), length(coord), api_values_, api_values_n_, api_distances_, api_distances_n_, step, numComp, gradient, distanceMax, dim, ierr)
+    ierr[] != 0 && error(gmsh.logger.getLastError())
+    values = unsafe_wrap(Array, api_values_[], api_values_n_[], own = true)
+    distances = unsafe_wrap(Array, api_distances_[], api_distances_n_[], own = true)
+    return values, distances
+end
+const probe_batch = probeBatch
+
 """
     gmsh.view.write(tag, fileName, append = false)
 
@@ -7541,6 +7604,98 @@ function getLastError()
 end
 const get_last_error = getLastError
 
+"""
+    gmsh.logger.startProfiling()
+
+Start profiling, clearing previously recorded data. The time spent in the main
+stages of mesh generation (for each model entity) is recorded for each thread,
+as well as counters such as the number of Delaunay point insertions, mesh size
+evaluations and octree queries.
+"""
+function startProfiling()
+    ierr = Ref{Cint}()
+    ccall((:gmshLoggerStartProfiling, gmsh.lib), Cvoid,
+          (Ptr{Cint},),
+          ierr)
+    ierr[] != 0 && error(gmsh.logger.getLastError())
+    return nothing
+end
+const start_profiling = startProfiling
+
+"""
+    gmsh.logger.stopProfiling()
+
+Stop profiling. The recorded data is kept until the next call to
+`startProfiling`.
+"""
+function stopProfiling()
+    ierr = Ref{Cint}()
+    ccall((:gmshLoggerStopProfiling, gmsh.lib), Cvoid,
+          (Ptr{Cint},),
+          ierr)
+    ierr[] != 0 && error(gmsh.logger.getLastError())
+    return nothing
+end
+const stop_profiling = stopProfiling
+
+"""
+    gmsh.logger.getProfile()
+
+Get the profiling data, as a flat list of nodes of the call tree of each thread.
+For each node `i`, `names[i]` is the name of the region or counter, `parents[i]`
+the index of the parent node (-1 for top-level regions), `calls[i]` the number
+of calls (or the value of the counter), `inclusiveTimes[i]` and
+`exclusiveTimes[i]` the wall clock time spent in the region including and
+excluding its children (zero for counters), and `threads[i]` the index of the
+thread.
+
+Return `names`, `parents`, `calls`, `inclusiveTimes`, `exclusiveTimes`, `threads`.
+"""
+function getProfile()
+    api_names_ = Ref{Ptr{Ptr{Cchar}}}()
+    api_names_n_ = Ref{Csize_t}()
+    api_parents_ = Ref{Ptr{Cint}}()
+    api_parents_n_ = Ref{Csize_t}()
+    api_calls_ = Ref{Ptr{Csize_t}}()
+    api_calls_n_ = Ref{Csize_t}()
+    api_inclusiveTimes_ = Ref{Ptr{Cdouble}}()
+    api_inclusiveTimes_n_ = Ref{Csize_t}()
+    api_exclusiveTimes_ = Ref{Ptr{Cdouble}}()
+    api_exclusiveTimes_n_ = Ref{Csize_t}()
+    api_threads_ = Ref{Ptr{Cint}}()
+    api_threads_n_ = Ref{Csize_t}()
+    ierr = Ref{Cint}()
+    ccall((:gmshLoggerGetProfile, gmsh.lib), Cvoid,
+          (Ptr{Ptr{Ptr{Cchar}}}, Ptr{Csize_t}, Ptr{Ptr{Cint}}, Ptr{Csize_t}, Ptr{Ptr{Csize_t}}, Ptr{Csize_t}, Ptr{Ptr{Cdouble}}, Ptr{Csize_t}, Ptr{Ptr{Cdouble}}, Ptr{Csize_t}, Ptr{Ptr{Cint}}, Ptr{Csize_t}, Ptr{Cint}),
+          api_names_, api_names_n_, api_parents_, api_parents_n_, api_calls_, api_calls_n_, api_inclusiveTimes_, api_inclusiveTimes_n_, api_exclusiveTimes_, api_exclusiveTimes_n_, api_threads_, api_threads_n_, ierr)
+    ierr[] != 0 && error(gmsh.logger.getLastError())
+    tmp_api_names_ = unsafe_wrap(Array, api_names_[], api_names_n_[], own = true)
+    names = [unsafe_string(tmp_api_names_[i]) for i in 1:length(tmp_api_names_) ]
+    parents = unsafe_wrap(Array, api_parents_[], api_parents_n_[], own = true)
+    calls = unsafe_wrap(Array, api_calls_[], api_calls_n_[], own = true)
+    inclusiveTimes = unsafe_wrap(Array, api_inclusiveTimes_[], api_inclusiveTimes_n_[], own = true)
+    exclusiveTimes = unsafe_wrap(Array, api_exclusiveTimes_[], api_exclusiveTimes_n_[], own = true)
+    threads = unsafe_wrap(Array, api_threads_[], api_threads_n_[], own = true)
+    return names, parents, calls, inclusiveTimes, exclusiveTimes, threads
+end
+const get_profile = getProfile
+
+"""
+    gmsh.logger.writeProfile(fileName)
+
+Write the recorded profiling regions in `fileName`, in the Chrome trace (JSON)
+format.
+"""
+function writeProfile(fileName)
+    ierr = Ref{Cint}()
+    ccall((:gmshLoggerWriteProfile, gmsh.lib), Cvoid,
+          (Ptr{Cchar}, Ptr{Cint}),
+          fileName, ierr)
+    ierr[] != 0 && error(gmsh.logger.getLastError())
+    return nothing
+end
+const write_profile = writeProfile
+
 end # end of module logger
 
 end # end of module gmsh
@@ -1927,7 +1927,9 @@ class model:
             """
             gmsh.model.mesh.rebuildNodeCache(onlyIfNecessary=True)
 
-            Rebuild the node cache.
+            Rebuild the node cache (in parallel). The cache is otherwise built on
+            demand by the first function that accesses nodes by tag: rebuilding it
+            beforehand allows such functions to be called concurrently without locking.
             """
             ierr = c_int()
             lib.gmshModelMeshRebuildNodeCache(
@@ -1942,7 +1944,9 @@ class model:
             """
             gmsh.model.mesh.rebuildElementCache(onlyIfNecessary=True)
 
-            Rebuild the element cache.
+            Rebuild the element cache (in parallel). The cache is otherwise built on
+            demand by the first function that accesses elements by tag: rebuilding it
+            beforehand allows such functions to be called concurrently without locking.
             """
             ierr = c_int()
             lib.gmshModelMeshRebuildElementCache(
@@ -3565,28 +3569,36 @@ class model:
         reorder_elements = reorderElements
 
         @staticmethod
-        def renumberNodes():
+        def renumberNodes(method=""):
             """
-            gmsh.model.mesh.renumberNodes()
+            gmsh.model.mesh.renumberNodes(method="")
 
-            Renumber the node tags in a continuous sequence.
+            Renumber the node tags in a continuous sequence, using `method':
+            "Sequential" (by entity), "RCMK" (reverse Cuthill-McKee, to reduce the
+            bandwidth and the profile), "Hilbert" (along a Hilbert curve, for spatial
+            locality) or "Partition" (by mesh partition). If `method' is empty, use the
+            method given by the `Mesh.RenumberMethod' option.
             """
             ierr = c_int()
             lib.gmshModelMeshRenumberNodes(
+                c_char_p(method.encode()),
                 byref(ierr))
             if ierr.value != 0:
                 raise Exception(logger.getLastError())
         renumber_nodes = renumberNodes
 
         @staticmethod
-        def renumberElements():
+        def renumberElements(method=""):
             """
-            gmsh.model.mesh.renumberElements()
+            gmsh.model.mesh.renumberElements(method="")
 
-            Renumber the element tags in a continuous sequence.
+            Renumber the element tags in a continuous sequence, using `method' (see
+            `renumberNodes'; "RCMK" orders the elements according to the current node
+            numbering). The elements of curves are always kept in their original order.
             """
             ierr = c_int()
             lib.gmshModelMeshRenumberElements(
+                c_char_p(method.encode()),
                 byref(ierr))
             if ierr.value != 0:
                 raise Exception(logger.getLastError())
@@ -4251,6 +4263,33 @@ class model:
                     raise Exception(logger.getLastError())
             set_as_boundary_layer = setAsBoundaryLayer
 
+            @staticmethod
+            def evaluate(tag, xyz, dim=-1, entityTag=-1):
+                """
+                gmsh.model.mesh.field.evaluate(tag, xyz, dim=-1, entityTag=-1)
+
+                Evaluate the field `tag' at the points given by their coordinates `xyz'
+                (concatenated: [p1x, p1y, p1z, p2x, ...]). Return the values in `values'.
+                If `dim' and `entityTag' are given, evaluate the field as if the points
+                were located on the corresponding model entity. The points are processed in
+                chunks, in parallel if General.NumThreads > 1.
+
+                Return `values'.
+                """
+                api_xyz_, api_xyz_n_ = _ivectordouble(xyz)
+                api_values_, api_values_n_ = POINTER(c_double)(), c_size_t()
+                ierr = c_int()
+                lib.gmshModelMeshFieldEvaluate(
+                    c_int(tag),
+                    api_xyz_, api_xyz_n_,
+                    byref(api_values_), byref(api_values_n_),
+                    c_int(dim),
+                    c_int(entityTag),
+                    byref(ierr))
+                if ierr.value != 0:
+                    raise Exception(logger.getLastError())
+                return _ovectordouble(api_values_, api_values_n_.value)
+
 
     class geo:
         """
@@ -7582,6 +7621,44 @@ class view:
             _ovectordouble(api_value_, api_value_n_.value),
             api_distance_.value)
 
+    @staticmethod
+    def probeBatch(tag, coord, step=-1, numComp=-1, gradient=False, distanceMax=0., dim=-1):
+        """
+        gmsh.view.probeBatch(tag, coord, step=-1, numComp=-1, gradient=False, distanceMax=0., dim=-1)
+
+        Probe the view `tag' at the points given by their `coord' (x, y, z
+        coordinates concatenated), in parallel. The values at all points are
+        returned concatenated in `values', with the same number of values for each
+        point (zero if no match is found for the point); the distance to the match
+        of each point is returned in `distances' (-1 if no match is found). If
+        `numComp' is not positive, the number of components is determined by the
+        type of the data in the view (scalar, vector or tensor). `step',
+        `gradient', `distanceMax' and `dim' have the same meaning as in `probe'.
+
+        Return `values', `distances'.
+        """
+        api_coord_, api_coord_n_ = _ivectordouble(coord)
+        api_values_, api_values_n_ = POINTER(c_double)(), c_size_t()
+        api_distances_, api_distances_n_ = POINTER(c_double)(), c_size_t()
+        ierr = c_int()
+        lib.gmshViewProbeBatch(
+            c_int(tag),
+            api_coord_, api_coord_n_,
+            byref(api_values_), byref(api_values_n_),
+            byref(api_distances_), byref(api_distances_n_),
+            c_int(step),
+            c_int(numComp),
+            c_int(bool(gradient)),
+            c_double(distanceMax),
+            c_int(dim),
+            byref(ierr))
+        if ierr.value != 0:
+            raise Exception(logger.getLastError())
+        return (
+            _ovectordouble(api_values_, api_values_n_.value),
+            _ovectordouble(api_distances_, api_distances_n_.value))
+    probe_batch = probeBatch
+
     @staticmethod
     def write(tag, fileName, append=False):
         """
@@ -8614,3 +8691,92 @@ class logger:
             raise Exception('Could not get last error')
         return _ostring(api_error_)
     get_last_error = getLastError
+
+    @staticmethod
+    def startProfiling():
+        """
+        gmsh.logger.startProfiling()
+
+        Start profiling, clearing previously recorded data. The time spent in the
+        main stages of mesh generation (for each model entity) is recorded for each
+        thread, as well as counters such as the number of Delaunay point
+        insertions, mesh size evaluations and octree queries.
+        """
+        ierr = c_int()
+        lib.gmshLoggerStartProfiling(
+            byref(ierr))
+        if ierr.value != 0:
+            raise Exception(logger.getLastError())
+    start_profiling = startProfiling
+
+    @staticmethod
+    def stopProfiling():
+        """
+        gmsh.logger.stopProfiling()
+
+        Stop profiling. The recorded data is kept until the next call to
+        `startProfiling'.
+        """
+        ierr = c_int()
+        lib.gmshLoggerStopProfiling(
+            byref(ierr))
+        if ierr.value != 0:
+            raise Exception(logger.getLastError())
+    stop_profiling = stopProfiling
+
+    @staticmethod
+    def getProfile():
+        """
+        gmsh.logger.getProfile()
+
+        Get the profiling data, as a flat list of nodes of the call tree of each
+        thread. For each node `i', `names[i]' is the name of the region or counter,
+        `parents[i]' the index of the parent node (-1 for top-level regions),
+        `calls[i]' the number of calls (or the value of the counter),
+        `inclusiveTimes[i]' and `exclusiveTimes[i]' the wall clock time spent in
+        the region including and excluding its children (zero for counters), and
+        `threads[i]' the index of the thread.
+
+        Return `names', `parents', `calls', `inclusiveTimes', `exclusiveTimes', `threads'.
+        """
+        api_names_, api_names_n_ = POINTER(POINTER(c_char))(), c_size_t()
+        api_parents_, api_parents_n_ = POINTER(c_int)(), c_size_t()
+        api_calls_, api_calls_n_ = POINTER(c_size_t)(), c_size_t()
+        api_inclusiveTimes_, api_inclusiveTimes_n_ = POINTER(c_double)(), c_size_t()
+        api_exclusiveTimes_, api_exclusiveTimes_n_ = POINTER(c_double)(), c_size_t()
+        api_threads_, api_threads_n_ = POINTER(c_int)(), c_size_t()
+        ierr = c_int()
+        lib.gmshLoggerGetProfile(
+            byref(api_names_), byref(api_names_n_),
+            byref(api_parents_), byref(api_parents_n_),
+            byref(api_calls_), byref(api_calls_n_),
+            byref(api_inclusiveTimes_), byref(api_inclusiveTimes_n_),
+            byref(api_exclusiveTimes_), byref(api_exclusiveTimes_n_),
+            byref(api_threads_), byref(api_threads_n_),
+            byref(ierr))
+        if ierr.value != 0:
+            raise Exception(logger.getLastError())
+        return (
+            _ovectorstring(api_names_, api_names_n_.value),
+            _ovectorint(api_parents_, api_parents_n_.value),
+            _ovectorsize(api_calls_, api_calls_n_.value),
+            _ovectordouble(api_inclusiveTimes_, api_inclusiveTimes_n_.value),
+            _ovectordouble(api_exclusiveTimes_, api_exclusiveTimes_n_.value),
+            _ovectorint(api_threads_, api_threads_n_.value))
+    get_profile = getProfile
+
+    @staticmethod
+    def writeProfile(fileName):
+        """
+        gmsh.logger.writeProfile(fileName)
+
+        Write the recorded profiling regions in `fileName', in the Chrome trace
+        (JSON) format.
+        """
+        ierr = c_int()
+        lib.gmshLoggerWriteProfile(
+            c_char_p(fileName.encode()),
+            byref(ierr))
+        if ierr.value != 0:
+            raise Exception(logger.getLastError())
+    write_profile = writeProfile
@@ -2025,22 +2025,22 @@ GMSH_API void gmshModelMeshReorderElements(const int elementType, const int tag,
   }
 }
 
-GMSH_API void gmshModelMeshRenumberNodes(int * ierr)
+GMSH_API void gmshModelMeshRenumberNodes(const char * method, int * ierr)
 {
   if(ierr) *ierr = 0;
   try {
-    gmsh::model::mesh::renumberNodes();
+    gmsh::model::mesh::renumberNodes(method);
   }
   catch(...){
     if(ierr) *ierr = 1;
   }
 }
 
-GMSH_API void gmshModelMeshRenumberElements(int * ierr)
+GMSH_API void gmshModelMeshRenumberElements(const char * method, int * ierr)
 {
   if(ierr) *ierr = 0;
   try {
-    gmsh::model::mesh::renumberElements();
+    gmsh::model::mesh::renumberElements(method);
   }
   catch(...){
     if(ierr) *ierr = 1;
@@ -2459,6 +2459,20 @@ GMSH_API void gmshModelMeshFieldSetAsBoundaryLayer(const int tag, int * ierr)
   }
 }
 
+GMSH_API void gmshModelMeshFieldEvaluate(const int tag, const double * xyz, const size_t xyz_n, double ** values, size_t * values_n, const int dim, const int entityTag, int * ierr)
+{
+  if(ierr) *ierr = 0;
+  try {
+    std::vector<double> api_xyz_(xyz, xyz + xyz_n);
+    std::vector<double> api_values_;
+    gmsh::model::mesh::field::evaluate(tag, api_xyz_, api_values_, dim, entityTag);
+    vector2ptr(api_values_, values, values_n);
+  }
+  catch(...){
+    if(ierr) *ierr = 1;
+  }
+}
+
 GMSH_API int gmshModelGeoAddPoint(const double x, const double y, const double z, const double meshSize, const int tag, int * ierr)
 {
   int result_api_ = 0;
@@ -4275,6 +4289,22 @@ GMSH_API void gmshViewProbe(const int tag, const double x, const double y, const
   }
 }
 
+GMSH_API void gmshViewProbeBatch(const int tag, const double * coord, const size_t coord_n, double ** values, size_t * values_n, double ** distances, size_t * distances_n, const int step, const int numComp, const int gradient, const double distanceMax, const int dim, int * ierr)
+{
+  if(ierr) *ierr = 0;
+  try {
+    std::vector<double> api_coord_(coord, coord + coord_n);
+    std::vector<double> api_values_;
+    std::vector<double> api_distances_;
+    gmsh::view::probeBatch(tag, api_coord_, api_values_, api_distances_, step, numComp, gradient, distanceMax, dim);
+    vector2ptr(api_values_, values, values_n);
+    vector2ptr(api_distances_, distances, distances_n);
+  }
+  catch(...){
+    if(ierr) *ierr = 1;
+  }
+}
+
 GMSH_API void gmshViewWrite(const int tag, const char * fileName, const int append, int * ierr)
 {
   if(ierr) *ierr = 0;
@@ -4937,3 +4967,59 @@ GMSH_API void gmshLoggerGetLastError(char ** error, int * ierr)
   }
 }
 
+GMSH_API void gmshLoggerStartProfiling(int * ierr)
+{
+  if(ierr) *ierr = 0;
+  try {
+    gmsh::logger::startProfiling();
+  }
+  catch(...){
+    if(ierr) *ierr = 1;
+  }
+}
+
+GMSH_API void gmshLoggerStopProfiling(int * ierr)
+{
+  if(ierr) *ierr = 0;
+  try {
+    gmsh::logger::stopProfiling();
+  }
+  catch(...){
+    if(ierr) *ierr = 1;
+  }
+}
+
+GMSH_API void gmshLoggerGetProfile(char *** names, size_t * names_n, int ** parents, size_t * parents_n, size_t ** calls, size_t * calls_n, double ** inclusiveTimes, size_t * inclusiveTimes_n, double ** exclusiveTimes, size_t * exclusiveTimes_n, int ** threads, size_t * threads_n, int * ierr)
+{
+  if(ierr) *ierr = 0;
+  try {
+    std::vector<std::string> api_names_;
+    std::vector<int> api_parents_;
+    std::vector<std::size_t> api_calls_;
+    std::vector<double> api_inclusiveTimes_;
+    std::vector<double> api_exclusiveTimes_;
+    std::vector<int> api_threads_;
+    gmsh::logger::getProfile(api_names_, api_parents_, api_calls_, api_inclusiveTimes_, api_exclusiveTimes_, api_threads_);
+    vectorstring2charptrptr(api_names_, names, names_n);
+    vector2ptr(api_parents_, parents, parents_n);
+    vector2ptr(api_calls_, calls, calls_n);
+    vector2ptr(api_inclusiveTimes_, inclusiveTimes, inclusiveTimes_n);
+    vector2ptr(api_exclusiveTimes_, exclusiveTimes, exclusiveTimes_n);
+    vector2ptr(api_threads_, threads, threads_n);
+  }
+  catch(...){
+    if(ierr) *ierr = 1;
+  }
+}
+
+GMSH_API void gmshLoggerWriteProfile(const char * fileName, int * ierr)
+{
+  if(ierr) *ierr = 0;
+  try {
+    gmsh::logger::writeProfile(fileName);
+  }
+  catch(...){
+    if(ierr) *ierr = 1;
+  }
+}
+
@@ -647,11 +647,15 @@ GMSH_API void gmshModelMeshSetNode(const size_t nodeTag,
                                    const double * parametricCoord, const size_t parametricCoord_n,
                                    int * ierr);
 
-/* Rebuild the node cache. */
+/* Rebuild the node cache (in parallel). The cache is otherwise built on
+ * demand by the first function that accesses nodes by tag: rebuilding it
+ * beforehand allows such functions to be called concurrently without locking. */
 GMSH_API void gmshModelMeshRebuildNodeCache(const int onlyIfNecessary,
                                             int * ierr);
 
-/* Rebuild the element cache. */
+/* Rebuild the element cache (in parallel). The cache is otherwise built on
+ * demand by the first function that accesses elements by tag: rebuilding it
+ * beforehand allows such functions to be called concurrently without locking. */
 GMSH_API void gmshModelMeshRebuildElementCache(const int onlyIfNecessary,
                                                int * ierr);
 
@@ -1363,11 +1367,19 @@ GMSH_API void gmshModelMeshReorderElements(const int elementType,
                                            const size_t * ordering, const size_t ordering_n,
                                            int * ierr);
 
-/* Renumber the node tags in a continuous sequence. */
-GMSH_API void gmshModelMeshRenumberNodes(int * ierr);
+/* Renumber the node tags in a continuous sequence, using `method':
+ * "Sequential" (by entity), "RCMK" (reverse Cuthill-McKee, to reduce the
+ * bandwidth and the profile), "Hilbert" (along a Hilbert curve, for spatial
+ * locality) or "Partition" (by mesh partition). If `method' is empty, use the
+ * method given by the `Mesh.RenumberMethod' option. */
+GMSH_API void gmshModelMeshRenumberNodes(const char * method,
+                                         int * ierr);
 
-/* Renumber the element tags in a continuous sequence. */
-GMSH_API void gmshModelMeshRenumberElements(int * ierr);
+/* Renumber the element tags in a continuous sequence, using `method' (see
+ * `renumberNodes'; "RCMK" orders the elements according to the current node
+ * numbering). The elements of curves are always kept in their original order. */
+GMSH_API void gmshModelMeshRenumberElements(const char * method,
+                                            int * ierr);
 
 /* Set the meshes of the entities of dimension `dim' and tag `tags' as
  * periodic copies of the meshes of entities `tagsMaster', using the affine
@@ -1596,6 +1608,18 @@ GMSH_API void gmshModelMeshFieldSetAsBackgroundMesh(const int tag,
 GMSH_API void gmshModelMeshFieldSetAsBoundaryLayer(const int tag,
                                                    int * ierr);
 
+/* Evaluate the field `tag' at the points given by their coordinates `xyz'
+ * (concatenated: [p1x, p1y, p1z, p2x, ...]). Return the values in `values'.
+ * If `dim' and `entityTag' are given, evaluate the field as if the points
+ * were located on the corresponding model entity. The points are processed in
+ * chunks, in parallel if General.NumThreads > 1. */
+GMSH_API void gmshModelMeshFieldEvaluate(const int tag,
+                                         const double * xyz, const size_t xyz_n,
+                                         double ** values, size_t * values_n,
+                                         const int dim,
+                                         const int entityTag,
+                                         int * ierr);
+
 /* Add a geometrical point in the built-in CAD representation, at coordinates
  * (`x', `y', `z'). If `meshSize' is > 0, add a meshing constraint at that
  * point. If `tag' is positive, set the tag explicitly; otherwise a new tag is
@@ -3071,6 +3095,25 @@ GMSH_API void gmshViewProbe(const int tag,
                             const int dim,
                             int * ierr);
 
+/* Probe the view `tag' at the points given by their `coord' (x, y, z
+ * coordinates concatenated), in parallel. The values at all points are
+ * returned concatenated in `values', with the same number of values for each
+ * point (zero if no match is found for the point); the distance to the match
+ * of each point is returned in `distances' (-1 if no match is found). If
+ * `numComp' is not positive, the number of components is determined by the
+ * type of the data in the view (scalar, vector or tensor). `step',
+ * `gradient', `distanceMax' and `dim' have the same meaning as in `probe'. */
+GMSH_API void gmshViewProbeBatch(const int tag,
+                                 const double * coord, const size_t coord_n,
+                                 double ** values, size_t * values_n,
+                                 double ** distances, size_t * distances_n,
+                                 const int step,
+                                 const int numComp,
+                                 const int gradient,
+                                 const double distanceMax,
+                                 const int dim,
+                                 int * ierr);
+
 /* Write the view to a file `fileName'. The export format is determined by the
  * file extension. Append to the file if `append' is set. */
 GMSH_API void gmshViewWrite(const int tag,
@@ -3372,4 +3415,34 @@ GMSH_API double gmshLoggerGetCpuTime(int * ierr);
 GMSH_API void gmshLoggerGetLastError(char ** error,
                                      int * ierr);
 
+/* Start profiling, clearing previously recorded data. The time spent in the
+ * main stages of mesh generation (for each model entity) is recorded for each
+ * thread, as well as counters such as the number of Delaunay point
+ * insertions, mesh size evaluations and octree queries. */
+GMSH_API void gmshLoggerStartProfiling(int * ierr);
+
+/* Stop profiling. The recorded data is kept until the next call to
+ * `startProfiling'. */
+GMSH_API void gmshLoggerStopProfiling(int * ierr);
+
+/* Get the profiling data, as a flat list of nodes of the call tree of each
+ * thread. For each node `i', `names[i]' is the name of the region or counter,
+ * `parents[i]' the index of the parent node (-1 for top-level regions),
+ * `calls[i]' the number of calls (or the value of the counter),
+ * `inclusiveTimes[i]' and `exclusiveTimes[i]' the wall clock time spent in
+ * the region including and excluding its children (zero for counters), and
+ * `threads[i]' the index of the thread. */
+GMSH_API void gmshLoggerGetProfile(char *** names, size_t * names_n,
+                                   int ** parents, size_t * parents_n,
+                                   size_t ** calls, size_t * calls_n,
+                                   double ** inclusiveTimes, size_t * inclusiveTimes_n,
+                                   double ** exclusiveTimes, size_t * exclusiveTimes_n,
+                                   int ** threads, size_t * threads_n,
+                                   int * ierr);
+
+/* Write the recorded profiling regions in `fileName', in the Chrome trace
+ * (JSON) format. */
+GMSH_API void gmshLoggerWriteProfile(const char * fileName,
+                                     int * ierr);
+
 #endif
@@ -1362,7 +1362,9 @@ c
             integer(c_int)::ierr
           end subroutine gmshModelMeshSetNode
 
-!  Rebuild the node cache.
+!  Rebuild the node cache (in parallel). The cache is otherwise built on
+!  demand by the first function that accesses nodes by tag: rebuilding it
+!  beforehand allows such functions to be called concurrently without locking.
         subroutine gmshModelMeshRebuildNodeCache(
      &      onlyIfNecessary,
      &      ierr)
@@ -1372,7 +1374,9 @@ c
             integer(c_int)::ierr
           end subroutine gmshModelMeshRebuildNodeCache
 
-!  Rebuild the element cache.
+!  Rebuild the element cache (in parallel). The cache is otherwise built on
+!  demand by the first function that accesses elements by tag: rebuilding it
+!  beforehand allows such functions to be called concurrently without locking.
         subroutine gmshModelMeshRebuildElementCache(
      &      onlyIfNecessary,
      &      ierr)
@@ -2830,19 +2834,29 @@ c
             integer(c_int)::ierr
           end subroutine gmshModelMeshReorderElements
 
-!  Renumber the node tags in a continuous sequence.
+!  Renumber the node tags in a continuous sequence, using `method':
+!  "Sequential" (by entity), "RCMK" (reverse Cuthill-McKee, to reduce the
+!  bandwidth and the profile), "Hilbert" (along a Hilbert curve, for spatial
+!  locality) or "Partition" (by mesh partition). If `method' is empty, use the
+!  method given by the `Mesh.RenumberMethod' option.
         subroutine gmshModelMeshRenumberNodes(
+     &      method,
      &      ierr)
      &    bind(C, name = "gmshModelMeshRenumberNodes")
           use, intrinsic :: iso_c_binding
+            character(len = 1, kind = c_char)::method(*)
             integer(c_int)::ierr
           end subroutine gmshModelMeshRenumberNodes
 
-!  Renumber the element tags in a continuous sequence.
+!  Renumber the element tags in a continuous sequence, using `method' (see
+!  `renumberNodes'; "RCMK" orders the elements according to the current node
+!  numbering). The elements of curves are always kept in their original order.
         subroutine gmshModelMeshRenumberElements(
+     &      method,
      &      ierr)
      &    bind(C, name = "gmshModelMeshRenumberElements")
           use, intrinsic :: iso_c_binding
+            character(len = 1, kind = c_char)::method(*)
             integer(c_int)::ierr
           end subroutine gmshModelMeshRenumberElements
 
@@ -3370,6 +3384,32 @@ c
             integer(c_int)::ierr
           end subroutine gmshModelMeshFieldSetAsBoundaryLayer
 
+!  Evaluate the field `tag' at the points given by their coordinates `xyz'
+!  (concatenated: [p1x, p1y, p1z, p2x, ...]). Return the values in `values'.
+!  If `dim' and `entityTag' are given, evaluate the field as if the points
+!  were located on the corresponding model entity. The points are processed in
+!  chunks, in parallel if General.NumThreads > 1.
+        subroutine gmshModelMeshFieldEvaluate(
+     &      tag,
+     &      xyz,
+     &      xyz_n,
+     &      values,
+     &      values_n,
+     &      dim,
+     &      entityTag,
+     &      ierr)
+     &    bind(C, name = "gmshModelMeshFieldEvaluate")
+          use, intrinsic :: iso_c_binding
+            integer(c_int), value::tag
+            real(c_double)::xyz(*)
+            integer(c_size_t), value :: xyz_n
+            type(c_ptr), intent(out)::values
+            integer(c_size_t) :: values_n
+            integer(c_int), value::dim
+            integer(c_int), value::entityTag
+            integer(c_int)::ierr
+          end subroutine gmshModelMeshFieldEvaluate
+
 !  Add a geometrical point in the built-in CAD representation, at coordinates
 !  (`x', `y', `z'). If `meshSize' is > 0, add a meshing constraint at that
 !  point. If `tag' is positive, set the tag explicitly; otherwise a new tag is
@@ -6457,6 +6497,45 @@ c
             integer(c_int)::ierr
           end subroutine gmshViewProbe
 
+!  Probe the view `tag' at the points given by their `coord' (x, y, z
+!  coordinates concatenated), in parallel. The values at all points are
+!  returned concatenated in `values', with the same number of values for each
+!  point (zero if no match is found for the point); the distance to the match
+!  of each point is returned in `distances' (-1 if no match is found). If
+!  `numComp' is not positive, the number of components is determined by the
+!  type of the data in the view (scalar, vector or tensor). `step',
+!  `gradient', `distanceMax' and `dim' have the same meaning as in `probe'.
+        subroutine gmshViewProbeBatch(
+     &      tag,
+     &      coord,
+     &      coord_n,
+     &      values,
+     &      values_n,
+     &      distances,
+     &      distances_n,
+     &      step,
+     &      numComp,
+     &      gradient,
+     &      distanceMax,
+     &      dim,
+     &      ierr)
+     &    bind(C, name = "gmshViewProbeBatch")
+          use, intrinsic :: iso_c_binding
+            integer(c_int), value::tag
+            real(c_double)::coord(*)
+            integer(c_size_t), value :: coord_n
+            type(c_ptr), intent(out)::values
+            integer(c_size_t) :: values_n
+            type(c_ptr), intent(out)::distances
+            integer(c_size_t) :: distances_n
+            integer(c_int), value::step
+            integer(c_int), value::numComp
+            integer(c_int), value::gradient
+            real(c_double), value::distanceMax
+            integer(c_int), value::dim
+            integer(c_int)::ierr
+          end subroutine gmshViewProbeBatch
+
 !  Write the view to a file `fileName'. The export format is determined by the
 !  file extension. Append to the file if `append' is set.
         subroutine gmshViewWrite(
@@ -7165,6 +7244,75 @@ c
             integer(c_int)::ierr
           end subroutine gmshLoggerGetLastError
 
+!  Start profiling, clearing previously recorded data. The time spent in the
+!  main stages of mesh generation (for each model entity) is recorded for each
+!  thread, as well as counters such as the number of Delaunay point
+!  insertions, mesh size evaluations and octree queries.
+        subroutine gmshLoggerStartProfiling(
+     &      ierr)
+     &    bind(C, name = "gmshLoggerStartProfiling")
+          use, intrinsic :: iso_c_binding
+            integer(c_int)::ierr
+          end subroutine gmshLoggerStartProfiling
+
+!  Stop profiling. The recorded data is kept until the next call to
+!  `startProfiling'.
+        subroutine gmshLoggerStopProfiling(
+     &      ierr)
+     &    bind(C, name = "gmshLoggerStopProfiling")
+          use, intrinsic :: iso_c_binding
+            integer(c_int)::ierr
+          end subroutine gmshLoggerStopProfiling
+
+!  Get the profiling data, as a flat list of nodes of the call tree of each
+!  thread. For each node `i', `names[i]' is the name of the region or counter,
+!  `parents[i]' the index of the parent node (-1 for top-level regions),
+!  `calls[i]' the number of calls (or the value of the counter),
+!  `inclusiveTimes[i]' and `exclusiveTimes[i]' the wall clock time spent in
+!  the region including and excluding its children (zero for counters), and
+!  `threads[i]' the index of the thread.
+        subroutine gmshLoggerGetProfile(
+     &      names,
+     &      names_n,
+     &      parents,
+     &      parents_n,
+     &      calls,
+     &      calls_n,
+     &      inclusiveTimes,
+     &      inclusiveTimes_n,
+     &      exclusiveTimes,
+     &      exclusiveTimes_n,
+     &      threads,
+     &      threads_n,
+     &      ierr)
+     &    bind(C, name = "gmshLoggerGetProfile")
+          use, intrinsic :: iso_c_binding
+            type(c_ptr), intent(out)::names
+            integer(c_size_t) :: names_n
+            type(c_ptr), intent(out)::parents
+            integer(c_size_t) :: parents_n
+            type(c_ptr), intent(out)::calls
+            integer(c_size_t) :: calls_n
+            type(c_ptr), intent(out)::inclusiveTimes
+            integer(c_size_t) :: inclusiveTimes_n
+            type(c_ptr), intent(out)::exclusiveTimes
+            integer(c_size_t) :: exclusiveTimes_n
+            type(c_ptr), intent(out)::threads
+            integer(c_size_t) :: threads_n
+            integer(c_int)::ierr
+          end subroutine gmshLoggerGetProfile
+
+!  Write the recorded profiling regions in `fileName', in the Chrome trace
+!  (JSON) format.
+        subroutine gmshLoggerWriteProfile(
+     &      fileName,
+     &      ierr)
+     &    bind(C, name = "gmshLoggerWriteProfile")
+          use, intrinsic :: iso_c_binding
+            character(len = 1, kind = c_char)::fileName(*)
+            integer(c_int)::ierr
+          end subroutine gmshLoggerWriteProfile
+
         end interface
       end module gmsh_fortran
 
@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+
+# Gmsh - Copyright (C) 1997-2022 C. Geuzaine, J.-F. Remacle
+#
+# See the LICENSE.txt file in the Gmsh root directory for license information.
+# Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+# Mesh generation benchmark runner: meshes all the .geo files of the given
+# suites (subdirectories of benchmarks/) with a fixed random seed and for each
+# requested number of threads, collects the timings, peak memory usage, element
+# counts and quality statistics reported by "gmsh -benchreport" into a JSON
+# file, and optionally compares them with a baseline.
+#
+# python3 benchmark.py --gmsh path/to/gmsh --threads 1,4 --output new.json 2d 3d
+# python3 benchmark.py --gmsh path/to/gmsh --baseline ref.json 2d 3d
+
+import argparse
+import glob
+import json
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+# quantities compared with the baseline: (name, getter, higher is better);
+# quality statistics are given as [min, avg, max]
+CHECKS = [
+    ('wall 1d', lambda r: r['wall']['1d'], False),
+    ('wall 2d', lambda r: r['wall']['2d'], False),
+    ('wall 3d', lambda r: r['wall']['3d'], False),
+    ('wall optimize', lambda r: r['wall']['optimize'], False),
+    ('wall io', lambda r: r['wall']['io'], False),
+    ('peak rss', lambda r: r['peak_rss'], False),
+    ('min sicn', lambda r: r['quality']['sicn'][0], True),
+    ('avg sicn', lambda r: r['quality']['sicn'][1], True),
+]
+
+# timings below this value (in seconds) are too noisy to be compared
+MIN_TIME = 0.1
+
+
+def dimension(suite):
+    name = os.path.basename(os.path.normpath(suite))
+    if name.startswith('1d'):
+        return 1
+    if name.startswith('2d'):
+        return 2
+    return 3
+
+
+def run(gmsh, path, dim, threads, seed, timeout):
+    fd, report = tempfile.mkstemp(suffix='.json')
+    os.close(fd)
+    fd, out = tempfile.mkstemp(suffix='.msh')
+    os.close(fd)
+    cmd = [gmsh, os.path.basename(path), '-' + str(dim), '-nt', str(threads),
+           '-setnumber', 'Mesh.RandomSeed', str(seed), '-nopopup', '-v', '1',
+           '-o', out, '-benchreport', report]
+    result = {'file': path, 'dim': dim, 'threads': threads, 'seed': seed}
+    t = time.time()
+    try:
+        p = subprocess.run(cmd, cwd=os.path.dirname(path) or '.',
+                           stdout=subprocess.DEVNULL,
+                           stderr=subprocess.DEVNULL, timeout=timeout)
+        result['status'] = 'ok' if p.returncode == 0 else 'error'
+    except subprocess.TimeoutExpired:
+        result['status'] = 'timeout'
+    result['total_wall'] = time.time() - t
+    with open(report) as f:
+        lines = f.read().splitlines()
+    if lines:
+        data = json.loads(lines[-1])
+        data.pop('file', None)
+        data.pop('threads', None)
+        result.update(data)
+    elif result['status'] == 'ok':
+        result['status'] = 'error'
+    os.remove(report)
+    if os.path.exists(out):
+        os.remove(out)
+    return result
+
+
+def key(r):
+    return '{} -{} -nt {}'.format(r['file'], r['dim'], r['threads'])
+
+
+def compare(results, baseline, tol):
+    ref = {key(r): r for r in baseline['results']}
+    regressions = 0
+    for r in results:
+        b = ref.get(key(r))
+        if not b:
+            continue
+        if b['status'] == 'ok' and r['status'] != 'ok':
+            print('{}: {} (was ok)'.format(key(r), r['status']))
+            regressions += 1
+            continue
+        if r['status'] != 'ok' or b['status'] != 'ok':
+            continue
+        for name, get, higher in CHECKS:
+            v, v0 = get(r), get(b)
+            if name.startswith('wall') and max(v, v0) < MIN_TIME:
+                continue
+            t = tol * abs(v0)
+            if (higher and v < v0 - t) or (not higher and v > v0 + t):
+                print('{}: {} {:g} -> {:g}'.format(key(r), name, v0, v))
+                regressions += 1
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Gmsh mesh generation '
+                                     'benchmarks')
+    parser.add_argument('suites', nargs='+', help='benchmark subdirectories '
+                        '(e.g. 2d 3d occ_large) or .geo files')
+    parser.add_argument('--gmsh', default='gmsh', help='gmsh executable')
+    parser.add_argument('--threads', default='1',
+                        help='comma-separated numbers of threads')
+    parser.add_argument('--seed', type=int, default=1,
+                        help='random seed (Mesh.RandomSeed)')
+    parser.add_argument('--timeout', type=float, default=3600.,
+                        help='timeout for each run (in seconds)')
+    parser.add_argument('--output', default='benchmark.json',
+                        help='output JSON file')
+    parser.add_argument('--csv', help='also write the results in CSV format')
+    parser.add_argument('--baseline', help='baseline JSON file to compare '
+                        'with')
+    parser.add_argument('--tolerance', type=float, default=0.2,
+                        help='relative tolerance for the comparison')
+    args = parser.parse_args()
+
+    gmsh = os.path.abspath(args.gmsh) if os.path.exists(args.gmsh) \
+        else args.gmsh
+    here = os.path.dirname(os.path.abspath(__file__))
+    files = []
+    for s in args.suites:
+        if s.endswith('.geo'):
+            files.append((s, dimension(os.path.dirname(s))))
+            continue
+        d = s if os.path.isdir(s) else os.path.join(here, s)
+        for f in sorted(glob.glob(os.path.join(d, '*.geo'))):
+            files.append((f, dimension(d)))
+
+    results = []
+    for f, dim in files:
+        for nt in [int(n) for n in args.threads.split(',')]:
+            r = run(gmsh, os.path.abspath(f), dim, nt, args.seed, args.timeout)
+            r['file'] = os.path.relpath(r['file'], here)
+            print('{}: {} ({:.3g}s)'.format(key(r), r['status'],
+                                            r['total_wall']))
+            sys.stdout.flush()
+            results.append(r)
+
+    with open(args.output, 'w') as f:
+        json.dump({'gmsh': args.gmsh, 'results': results}, f, indent=1)
+
+    if args.csv:
+        cols = ['file', 'dim', 'threads', 'status', 'total_wall', 'peak_rss',
+                'nodes']
+        with open(args.csv, 'w') as f:
+            f.write(','.join(cols + ['wall ' + p for p in
+                                     ['1d', '2d', '3d', 'optimize', 'io']] +
+                             ['cpu ' + p for p in
+                              ['1d', '2d', '3d', 'optimize', 'io']] +
+                             ['elements', 'min sicn', 'avg sicn']) + '\n')
+            for r in results:
+                row = [str(r.get(c, '')) for c in cols]
+                for t in ['wall', 'cpu']:
+                    row += [str(r[t][p]) if t in r else '' for p in
+                            ['1d', '2d', '3d', 'optimize', 'io']]
+                row.append(str(sum(r['elements'].values())) if 'elements' in r
+                           else '')
+                row += [str(r['quality']['sicn'][i]) if 'quality' in r else ''
+                        for i in [0, 1]]
+                f.write(','.join(row) + '\n')
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        n = compare(results, baseline, args.tolerance)
+        if n:
+            print('{} regression(s) with respect to {}'.format(n,
+                                                               args.baseline))
+            sys.exit(1)
+        print('No regression with respect to {}'.format(args.baseline))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,77 @@
+// Micro-benchmark for the nearest neighbor queries performed by the background
+// mesh (mesh size and cross field lookups): measures the query rate of the
+// nanoflann kd-tree as a function of the number of threads, with lock-free
+// concurrent queries and with queries serialized in a critical section (as
+// was required with ANN).
+//
+// g++ -O2 -fopenmp -I../../src/geo -I../../src/numeric kdtree_query_perf.cpp
+// ./a.out [number of points] [number of queries]
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <omp.h>
+#include "SPoint3KDTree.h"
+
+static double rand01() { return (double)rand() / RAND_MAX; }
+
+static double query(SPoint3KDTree &tree, const std::vector<SPoint3> &q,
+                    int nthreads, bool serialize, double &checksum)
+{
+  double sum = 0.;
+  double t0 = omp_get_wtime();
+#pragma omp parallel for num_threads(nthreads) reduction(+ : sum)
+  for(std::size_t i = 0; i < q.size(); i++) {
+    double pt[3] = {q[i].x(), q[i].y(), q[i].z()};
+    std::size_t index[2];
+    double dist[2];
+    nanoflann::KNNResultSet<double> res(2);
+    res.init(index, dist);
+    if(serialize) {
+#pragma omp critical
+      tree.findNeighbors(res, &pt[0], nanoflann::SearchParams(10));
+    }
+    else {
+      tree.findNeighbors(res, &pt[0], nanoflann::SearchParams(10));
+    }
+    sum += dist[0] + dist[1];
+  }
+  checksum = sum;
+  return omp_get_wtime() - t0;
+}
+
+int main(int argc, char **argv)
+{
+  std::size_t np = (argc > 1) ? atol(argv[1]) : 100000;
+  std::size_t nq = (argc > 2) ? atol(argv[2]) : 4000000;
+
+  // boundary nodes of a parametric domain: points on a closed curve
+  SPoint3Cloud cloud;
+  for(std::size_t i = 0; i < np; i++) {
+    double t = 2 * M_PI * i / np;
+    cloud.pts.push_back(SPoint3((1 + 0.3 * cos(5 * t)) * cos(t),
+                                (1 + 0.3 * cos(5 * t)) * sin(t), 0.));
+  }
+  SPoint3CloudAdaptor<SPoint3Cloud> adaptor(cloud);
+  SPoint3KDTree tree(3, adaptor, nanoflann::KDTreeSingleIndexAdaptorParams(10));
+  tree.buildIndex();
+
+  std::vector<SPoint3> q(nq);
+  for(std::size_t i = 0; i < nq; i++)
+    q[i] = SPoint3(2.6 * rand01() - 1.3, 2.6 * rand01() - 1.3, 0.);
+
+  printf("%lu points, %lu queries\n", (unsigned long)np, (unsigned long)nq);
+  printf("%8s %16s %16s %10s\n", "threads", "lock-free (q/s)", "locked (q/s)",
+         "speedup");
+  double ref = 0.;
+  for(int n = 1; n <= omp_get_max_threads(); n *= 2) {
+    double c1, c2;
+    double t1 = query(tree, q, n, false, c1);
+    double t2 = query(tree, q, n, true, c2);
+    if(n == 1) ref = t1;
+    if(std::abs(c1 - c2) > 1e-8 * std::abs(c1))
+      printf("checksum mismatch: %g != %g\n", c1, c2);
+    printf("%8d %16.4g %16.4g %10.2f\n", n, nq / t1, nq / t2, ref / t1);
+  }
+  return 0;
+}
@@ -16,6 +16,10 @@
 #include "OS.h"
 #include "cross3D.h"
 
+#if defined(HAVE_ANN)
+#include "ANN/ANN.h"
+#endif
+
 #if defined(HAVE_SOLVER)
 #include "linearSystemCSR.h"
 #include "linearSystemPETSc.h"
@@ -19,6 +19,7 @@
 #include "GModel.h"
 #include "CreateFile.h"
 #include "OS.h"
+#include "Profiler.h"
 #include "GmshGlobal.h"
 #include "StringUtils.h"
 
@@ -208,6 +209,10 @@ std::vector<std::pair<std::string, std::string> > GetUsage()
                  "then exit"));
   s.push_back(mp("-nt int", "Set number of threads (General.NumThreads)"));
   s.push_back(mp("-cpu", "Report CPU times for all operations"));
+  s.push_back(mp("-benchreport file", "Append timings, memory usage and mesh "
+                 "statistics to file (in JSON Lines format)"));
+  s.push_back(mp("-profile file", "Profile the main stages of mesh generation "
+                 "and write a trace to file (in Chrome trace format)"));
   s.push_back(mp("-version", "Show version number"));
   s.push_back(mp("-info", "Show detailed version information"));
   s.push_back(mp("-help", "Show command line usage"));
@@ -936,6 +941,26 @@ static bool GetMeshOption(const std::vector<std::string> &argv,
       if(exitOnError) Msg::Exit(1);
     }
   }
+  else if(argv[i] == "-benchreport") {
+    i++;
+    if(i < argv.size())
+      CTX::instance()->benchReportFileName = argv[i++];
+    else {
+      Msg::Error("Missing argument");
+      if(exitOnError) Msg::Exit(1);
+    }
+  }
+  else if(argv[i] == "-profile") {
+    i++;
+    if(i < argv.size()) {
+      CTX::instance()->profileFileName = argv[i++];
+      Profiler::start();
+    }
+    else {
+      Msg::Error("Missing argument");
+      if(exitOnError) Msg::Exit(1);
+    }
+  }
   else if(argv[i] == "-append_statreport") {
     i++;
     CTX::instance()->createAppendMeshStatReport = 2;
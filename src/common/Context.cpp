@@ -59,7 +59,7 @@ void CTX::init()
   cg[0] = cg[1] = cg[2] = 0.;
   polygonOffset = 0;
   printing = 0;
-  meshTimer[0] = meshTimer[1] = meshTimer[2] = 0.;
+  for(int i = 0; i < 5; i++) meshTimer[i] = meshCpuTimer[i] = 0.;
   drawRotationCenter = 0;
   pickElements = 0;
   geom.draw = 1;
@@ -43,9 +43,10 @@ struct contextMeshOptions {
   double hoMaxRho, hoMaxAngle, hoMaxInnerAngle;
   int NewtonConvergenceTestXYZ, maxIterDelaunay3D;
   int ignorePeriodicityMsh2, ignoreParametrizationMsh4, boundaryLayerFanElements;
-  int maxNumThreads1D, maxNumThreads2D, maxNumThreads3D;
+  int maxNumThreads1D, maxNumThreads2D, maxNumThreads3D, maxNumSubdomains2D;
+  int compactNodeStorage;
   double angleToleranceFacetOverlap, toleranceReferenceElement;
-  int renumber, compoundClassify, reparamMaxTriangles;
+  int renumber, renumberMethod, compoundClassify, reparamMaxTriangles;
   double compoundLcFactor;
   unsigned int randomSeed;
   int nLayersPerGap;
@@ -140,7 +141,7 @@ public:
   std::vector<std::string> files;
   std::string bgmFileName, outputFileName, defaultFileName, tmpFileName;
   std::string sessionFileName, optionsFileName, errorFileName;
-  std::string meshStatReportFileName;
+  std::string meshStatReportFileName, benchReportFileName, profileFileName;
   // filename of the executable, with full path
   std::string exeFileName;
   // the home directory
@@ -286,8 +287,9 @@ public:
   // vector display type and options (for normals, etc.)
   int vectorType;
   double arrowRelHeadRadius, arrowRelStemRadius, arrowRelStemLength;
-  // records cpu times for 1-D, 2-D and 3-D mesh generation
-  double meshTimer[3];
+  // records wall and cpu times for 1-D, 2-D and 3-D mesh generation, mesh
+  // optimization and output file creation
+  double meshTimer[5], meshCpuTimer[5];
   // dynamic variable tracking if the bbox is currently imposed
   int forcedBBox;
   // enable selection/hover/picking using the mouse
@@ -318,7 +320,7 @@ public:
     int combineTime, combineRemoveOrig, combineCopyOptions;
     int fileFormat, plugins, forceNodeData, forceElementData;
     int saveMesh, saveInterpolationMatrices;
-    double animDelay;
+    double animDelay, stepMemoryBudget;
     std::string doubleClickedGraphPointCommand;
     double doubleClickedGraphPointX, doubleClickedGraphPointY;
     int doubleClickedView;
@@ -13,6 +13,7 @@
 #include "OpenFile.h"
 #include "CreateFile.h"
 #include "OS.h"
+#include "Profiler.h"
 
 #if defined(HAVE_OPENGL)
 #include "drawContext.h"
@@ -298,6 +299,8 @@ void CreateOutputFile(const std::string &fileName, int format,
 
   if(status)
     Msg::StatusBar(true, "Writing '%s'...", name.c_str());
+  double t1 = Cpu(), w1 = TimeOfDay();
+  ProfilerScope scope("CreateOutputFile");
 
   switch (format) {
 
@@ -826,6 +829,8 @@ void CreateOutputFile(const std::string &fileName, int format,
 
   CTX::instance()->print.fileFormat = oldFormat;
   CTX::instance()->printing = 0;
+  CTX::instance()->meshTimer[4] = TimeOfDay() - w1;
+  CTX::instance()->meshCpuTimer[4] = Cpu() - t1;
 
   if(status && !error)
     Msg::StatusBar(true, "Done writing '%s'", name.c_str());
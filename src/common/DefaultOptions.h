@@ -1125,6 +1125,9 @@ StringXNumber MeshOptions_Number[] = {
   { F|O, "ColorCarousel" , opt_mesh_color_carousel , 1. ,
     "Mesh coloring (0: by element type, 1: by elementary entity, 2: by physical "
     "group, 3: by mesh partition)" },
+  { F|O, "CompactNodeStorage" , opt_mesh_compact_node_storage , 0. ,
+    "Construct the nodes created in bulk (e.g. when reading mesh files) in "
+    "contiguous blocks of memory instead of allocating them one by one" },
   { F|O, "CompoundClassify" , opt_mesh_compound_classify , 1. ,
     "How are surface mesh elements classified on compounds? (0: on the new discrete "
     "surface, 1: on the original geometrical surfaces - incompatible with e.g. high-order "
@@ -1240,6 +1243,10 @@ StringXNumber MeshOptions_Number[] = {
   { F|O, "MaxIterDelaunay3D" , opt_mesh_max_iter_delaunay_3d, 0,
     "Maximum number of point insertion iterations in 3D Delaunay mesher "
     "(0: unlimited)" },
+  { F|O, "MaxNumSubdomains2D" , opt_mesh_max_num_subdomains_2d , 0. ,
+    "Maximum number of subdomains in which large surfaces are split, to be "
+    "meshed with several threads by the Delaunay and Frontal-Delaunay "
+    "algorithms (0: no splitting)" },
   { F|O, "MaxNumThreads1D" , opt_mesh_max_num_threads_1d , 0. ,
     "Maximum number of threads for 1D meshing (0: use General.NumThreads)" },
   { F|O, "MaxNumThreads2D" , opt_mesh_max_num_threads_2d , 0. ,
@@ -1480,6 +1487,10 @@ StringXNumber MeshOptions_Number[] = {
     "Number of refinement steps in the MeshAdapt-based 2D algorithms" },
   { F|O, "Renumber" , opt_mesh_renumber , 1 ,
     "Renumber nodes and elements in a continuous sequence after mesh generation" },
+  { F|O, "RenumberMethod" , opt_mesh_renumber_method , 0 ,
+    "Method used to renumber nodes and elements (0: sequential by entity, "
+    "1: reverse Cuthill-McKee, 2: Hilbert curve, 3: by partition); methods 1 "
+    "and 2 also group the nodes and elements by partition" },
   { F|O, "ReparamMaxTriangles" , opt_mesh_reparam_max_triangles , 250000 ,
     "Maximum number of triangles in a single parametrization patch" },
 
@@ -1684,6 +1695,10 @@ StringXNumber PostProcessingOptions_Number[] = {
     "Save the mesh when exporting model-based data" },
   { F|O, "Smoothing" , opt_post_smooth , 0. ,
     "Apply (non-reversible) smoothing to post-processing view when merged" },
+  { F|O, "StepMemoryBudget" , opt_post_step_memory_budget , 0. ,
+    "Memory budget (in Mb) for the time steps of model-based views read from "
+    "MSH files: if positive, time steps are only read when first accessed, and "
+    "the least recently used ones are evicted when the budget is exceeded" },
 
   { 0, nullptr , nullptr , 0. }
 } ;
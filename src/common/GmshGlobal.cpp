@@ -22,6 +22,7 @@ typedef unsigned long intptr_t;
 #include "Options.h"
 #include "CommandLine.h"
 #include "OS.h"
+#include "Profiler.h"
 #include "Context.h"
 #include "robustPredicates.h"
 #include "BasisFactory.h"
@@ -46,6 +47,7 @@ typedef unsigned long intptr_t;
 #include "meshPartition.h"
 #include "gmshCrossFields.h"
 #include "automaticMeshSizeField.h"
+#include "Generator.h"
 #endif
 
 #if defined(HAVE_PLUGINS)
@@ -376,6 +378,16 @@ int GmshBatch()
     CreateOutputFile(name, CTX::instance()->mesh.fileFormat);
   }
 
+#if defined(HAVE_MESH)
+  if(!CTX::instance()->benchReportFileName.empty())
+    AppendBenchReport(CTX::instance()->benchReportFileName);
+#endif
+
+  if(!CTX::instance()->profileFileName.empty()) {
+    Profiler::stop();
+    Profiler::writeTrace(CTX::instance()->profileFileName);
+  }
+
   // launch solver (if requested)
 #if defined(HAVE_ONELAB)
   onelabUtils::runClient();
@@ -7,6 +7,7 @@
 #include <stdio.h>
 #include <vector>
 #include "Octree.h"
+#include "Profiler.h"
 
 Octree *Octree_Create(int maxElements, double origin[3], double size[3],
                       void (*BB)(void *, double *, double *),
@@ -81,6 +82,8 @@ void Octree_Arrange(Octree *myOctree)
 void *Octree_Search(double *pt, Octree *myOctree)
 {
   if(!myOctree) return nullptr;
+  static const int counter = Profiler::counter("Octree queries");
+  Profiler::count(counter);
   return searchElement(myOctree->root, pt, myOctree->info,
                        myOctree->function_BB, myOctree->function_inElement);
 }
@@ -88,6 +91,8 @@ void *Octree_Search(double *pt, Octree *myOctree)
 void Octree_SearchAll(double *pt, Octree *myOctree, std::vector<void *> *output)
 {
   if(!myOctree) return;
+  static const int counter = Profiler::counter("Octree queries");
+  Profiler::count(counter);
   searchAllElements(myOctree->root, pt, myOctree->info, myOctree->function_BB,
                     myOctree->function_inElement, output);
 }
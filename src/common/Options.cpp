@@ -4902,6 +4902,16 @@ double opt_mesh_renumber(OPT_ARGS_NUM)
   return CTX::instance()->mesh.renumber;
 }
 
+double opt_mesh_renumber_method(OPT_ARGS_NUM)
+{
+  if(action & GMSH_SET) {
+    int method = (int)val;
+    if(method < 0 || method > 3) method = 0;
+    CTX::instance()->mesh.renumberMethod = method;
+  }
+  return CTX::instance()->mesh.renumberMethod;
+}
+
 double opt_mesh_normals(OPT_ARGS_NUM)
 {
   if(action & GMSH_SET) { CTX::instance()->mesh.normals = val; }
@@ -6438,6 +6448,12 @@ double opt_mesh_compound_classify(OPT_ARGS_NUM)
   return CTX::instance()->mesh.compoundClassify;
 }
 
+double opt_mesh_compact_node_storage(OPT_ARGS_NUM)
+{
+  if(action & GMSH_SET) CTX::instance()->mesh.compactNodeStorage = (int)val;
+  return CTX::instance()->mesh.compactNodeStorage;
+}
+
 double opt_mesh_compound_lc_factor(OPT_ARGS_NUM)
 {
   if(action & GMSH_SET) CTX::instance()->mesh.compoundLcFactor = val;
@@ -6631,6 +6647,13 @@ double opt_mesh_max_num_threads_3d(OPT_ARGS_NUM)
   return CTX::instance()->mesh.maxNumThreads3D;
 }
 
+double opt_mesh_max_num_subdomains_2d(OPT_ARGS_NUM)
+{
+  if(action & GMSH_SET)
+    CTX::instance()->mesh.maxNumSubdomains2D = std::max(0, (int)val);
+  return CTX::instance()->mesh.maxNumSubdomains2D;
+}
+
 double opt_mesh_angle_tolerance_facet_overlap(OPT_ARGS_NUM)
 {
   if(action & GMSH_SET) {
@@ -6926,6 +6949,12 @@ double opt_post_save_interpolation_matrices(OPT_ARGS_NUM)
   return CTX::instance()->post.saveInterpolationMatrices;
 }
 
+double opt_post_step_memory_budget(OPT_ARGS_NUM)
+{
+  if(action & GMSH_SET) CTX::instance()->post.stepMemoryBudget = val;
+  return CTX::instance()->post.stepMemoryBudget;
+}
+
 double opt_post_double_clicked_graph_point_x(OPT_ARGS_NUM)
 {
   if(action & GMSH_SET) CTX::instance()->post.doubleClickedGraphPointX = val;
@@ -589,6 +589,7 @@ double opt_mesh_read_groups_of_elements(OPT_ARGS_NUM);
 double opt_mesh_save_groups_of_elements(OPT_ARGS_NUM);
 double opt_mesh_save_groups_of_nodes(OPT_ARGS_NUM);
 double opt_mesh_color_carousel(OPT_ARGS_NUM);
+double opt_mesh_compact_node_storage(OPT_ARGS_NUM);
 double opt_mesh_compound_classify(OPT_ARGS_NUM);
 double opt_mesh_compound_lc_factor(OPT_ARGS_NUM);
 double opt_mesh_random_seed(OPT_ARGS_NUM);
@@ -610,9 +611,11 @@ double opt_mesh_max_iter_delaunay_3d(OPT_ARGS_NUM);
 double opt_mesh_max_num_threads_1d(OPT_ARGS_NUM);
 double opt_mesh_max_num_threads_2d(OPT_ARGS_NUM);
 double opt_mesh_max_num_threads_3d(OPT_ARGS_NUM);
+double opt_mesh_max_num_subdomains_2d(OPT_ARGS_NUM);
 double opt_mesh_angle_tolerance_facet_overlap(OPT_ARGS_NUM);
 double opt_mesh_tolerance_reference_element(OPT_ARGS_NUM);
 double opt_mesh_renumber(OPT_ARGS_NUM);
+double opt_mesh_renumber_method(OPT_ARGS_NUM);
 double opt_mesh_unv_strict_format(OPT_ARGS_NUM);
 double opt_mesh_reparam_max_triangles(OPT_ARGS_NUM);
 double opt_mesh_ignore_parametrization(OPT_ARGS_NUM);
@@ -649,6 +652,7 @@ double opt_post_force_node_data(OPT_ARGS_NUM);
 double opt_post_force_element_data(OPT_ARGS_NUM);
 double opt_post_save_mesh(OPT_ARGS_NUM);
 double opt_post_save_interpolation_matrices(OPT_ARGS_NUM);
+double opt_post_step_memory_budget(OPT_ARGS_NUM);
 double opt_post_double_clicked_graph_point_x(OPT_ARGS_NUM);
 double opt_post_double_clicked_graph_point_y(OPT_ARGS_NUM);
 double opt_post_double_clicked_view(OPT_ARGS_NUM);
@@ -0,0 +1,217 @@
+// Gmsh - Copyright (C) 1997-2022 C. Geuzaine, J.-F. Remacle
+//
+// See the LICENSE.txt file in the Gmsh root directory for license information.
+// Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+#include <stdio.h>
+#include "GmshMessage.h"
+#include "Profiler.h"
+#include "OS.h"
+#include "StringUtils.h"
+
+// maximum number of trace events recorded per thread
+static const std::size_t maxEvents = 1 << 20;
+
+struct ProfilerNode {
+  std::string name;
+  int parent;
+  std::vector<int> children;
+  // child node of each counter id (-1 if not created yet)
+  std::vector<int> counters;
+  std::size_t calls;
+  double inclusive, childrenTime;
+  ProfilerNode(const std::string &n, int p)
+    : name(n), parent(p), calls(0), inclusive(0.), childrenTime(0.)
+  {
+  }
+};
+
+struct ProfilerEvent {
+  int node;
+  double start, end;
+};
+
+class ProfilerThread {
+public:
+  int id;
+  // call tree (node 0 is the root), open regions (node and start time) and
+  // recorded events
+  std::vector<ProfilerNode> nodes;
+  std::vector<std::pair<int, double> > stack;
+  std::vector<ProfilerEvent> events;
+  std::size_t droppedEvents;
+  ProfilerThread(int i) : id(i), droppedEvents(0)
+  {
+    nodes.push_back(ProfilerNode("", -1));
+  }
+  int child(int parent, const std::string &name)
+  {
+    for(auto c : nodes[parent].children)
+      if(nodes[c].name == name) return c;
+    int c = nodes.size();
+    nodes.push_back(ProfilerNode(name, parent));
+    nodes[parent].children.push_back(c);
+    return c;
+  }
+  int current() const { return stack.empty() ? 0 : stack.back().first; }
+};
+
+std::atomic<bool> Profiler::_enabled(false);
+
+// registered counter names; never cleared, so that the ids stored at the call
+// sites remain valid across profiling runs
+static std::vector<std::string> _counterNames;
+
+// data of all the threads, for the current profiling run (_generation)
+static std::vector<ProfilerThread *> _threads;
+static std::atomic<int> _generation(0);
+static double _startTime = 0.;
+
+static thread_local ProfilerThread *_localThread = nullptr;
+static thread_local int _localGeneration = -1;
+
+ProfilerThread *Profiler::_thread()
+{
+  if(_localGeneration != _generation || !_localThread) {
+#pragma omp critical(Profiler)
+    {
+      _localThread = new ProfilerThread(_threads.size());
+      _threads.push_back(_localThread);
+    }
+    _localGeneration = _generation;
+  }
+  return _localThread;
+}
+
+void Profiler::start()
+{
+  _enabled = false;
+  for(auto t : _threads) delete t;
+  _threads.clear();
+  _generation++;
+  _startTime = TimeOfDay();
+  _enabled = true;
+}
+
+void Profiler::stop() { _enabled = false; }
+
+void Profiler::begin(const std::string &name)
+{
+  if(!isEnabled()) return;
+  ProfilerThread *t = _thread();
+  int n = t->child(t->current(), name);
+  t->stack.push_back(std::make_pair(n, TimeOfDay()));
+}
+
+void Profiler::end()
+{
+  ProfilerThread *t = _thread();
+  if(t->stack.empty()) return;
+  double now = TimeOfDay();
+  int n = t->stack.back().first;
+  double start = t->stack.back().second;
+  t->stack.pop_back();
+  ProfilerNode &node = t->nodes[n];
+  node.calls++;
+  node.inclusive += now - start;
+  if(node.parent > 0) t->nodes[node.parent].childrenTime += now - start;
+  if(t->events.size() < maxEvents) {
+    ProfilerEvent e = {n, start, now};
+    t->events.push_back(e);
+  }
+  else
+    t->droppedEvents++;
+}
+
+int Profiler::counter(const char *name)
+{
+  int id = -1;
+#pragma omp critical(Profiler)
+  {
+    for(std::size_t i = 0; i < _counterNames.size(); i++) {
+      if(_counterNames[i] == name) {
+        id = i;
+        break;
+      }
+    }
+    if(id < 0) {
+      id = _counterNames.size();
+      _counterNames.push_back(name);
+    }
+  }
+  return id;
+}
+
+void Profiler::_count(int id, std::size_t n)
+{
+  if(id < 0) return;
+  ProfilerThread *t = _thread();
+  int parent = t->current();
+  std::vector<int> &counters = t->nodes[parent].counters;
+  if((int)counters.size() <= id) counters.resize(id + 1, -1);
+  if(counters[id] < 0) {
+    std::string name;
+#pragma omp critical(Profiler)
+    name = _counterNames[id];
+    int c = t->child(parent, name);
+    // child() can reallocate the nodes
+    t->nodes[parent].counters[id] = c;
+  }
+  t->nodes[t->nodes[parent].counters[id]].calls += n;
+}
+
+void Profiler::get(std::vector<std::string> &names, std::vector<int> &parents,
+                   std::vector<std::size_t> &calls,
+                   std::vector<double> &inclusiveTimes,
+                   std::vector<double> &exclusiveTimes,
+                   std::vector<int> &threads)
+{
+  names.clear();
+  parents.clear();
+  calls.clear();
+  inclusiveTimes.clear();
+  exclusiveTimes.clear();
+  threads.clear();
+  for(auto t : _threads) {
+    int offset = names.size() - 1; // the root node is skipped
+    for(std::size_t i = 1; i < t->nodes.size(); i++) {
+      const ProfilerNode &node = t->nodes[i];
+      names.push_back(node.name);
+      parents.push_back(node.parent > 0 ? offset + node.parent : -1);
+      calls.push_back(node.calls);
+      inclusiveTimes.push_back(node.inclusive);
+      exclusiveTimes.push_back(node.inclusive - node.childrenTime);
+      threads.push_back(t->id);
+    }
+  }
+}
+
+bool Profiler::writeTrace(const std::string &fileName)
+{
+  FILE *fp = Fopen(fileName.c_str(), "w");
+  if(!fp) {
+    Msg::Error("Unable to open file '%s'", fileName.c_str());
+    return false;
+  }
+  fprintf(fp, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+  bool first = true;
+  std::size_t dropped = 0;
+  for(auto t : _threads) {
+    for(auto &e : t->events) {
+      // complete events, with timestamps and durations in microseconds
+      fprintf(fp, "%s{\"name\": %s, \"ph\": \"X\", \"pid\": 0, \"tid\": %d, "
+                  "\"ts\": %.3f, \"dur\": %.3f}",
+              first ? "" : ",\n", JsonString(t->nodes[e.node].name).c_str(),
+              t->id, 1.e6 * (e.start - _startTime), 1.e6 * (e.end - e.start));
+      first = false;
+    }
+    dropped += t->droppedEvents;
+  }
+  fprintf(fp, "\n]}\n");
+  fclose(fp);
+  if(dropped)
+    Msg::Warning("%lu profiler events were not recorded in trace",
+                 (unsigned long)dropped);
+  Msg::Info("Wrote profiler trace '%s'", fileName.c_str());
+  return true;
+}
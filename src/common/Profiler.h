@@ -0,0 +1,83 @@
+// Gmsh - Copyright (C) 1997-2022 C. Geuzaine, J.-F. Remacle
+//
+// See the LICENSE.txt file in the Gmsh root directory for license information.
+// Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+
+class ProfilerThread;
+
+// A lightweight hierarchical profiler. Named regions (opened and closed on the
+// same thread, usually with a ProfilerScope) are accumulated in a call tree
+// for each thread, and are also recorded as events that can be exported in
+// the Chrome trace format (for chrome://tracing or https://ui.perfetto.dev).
+// Counters (e.g. the number of point insertions) are leaves of the tree
+// without time; their names are registered once, and the returned id is
+// usually stored in a static variable at the call site:
+//
+//   static const int c = Profiler::counter("Octree queries");
+//   Profiler::count(c);
+//
+// Nothing is recorded when the profiler is not started.
+class Profiler {
+private:
+  static std::atomic<bool> _enabled;
+  static ProfilerThread *_thread();
+  static void _count(int id, std::size_t n);
+
+public:
+  // start profiling, clearing previous data; start() and stop() should not be
+  // called while regions are open in other threads
+  static void start();
+  // stop profiling; the data is kept until the next start()
+  static void stop();
+  static bool isEnabled() { return _enabled.load(std::memory_order_relaxed); }
+  // open and close a region on the calling thread
+  static void begin(const std::string &name);
+  static void end();
+  // get the id of the counter with the given name, registering it if needed
+  static int counter(const char *name);
+  // add n to the counter with the given id in the current region
+  static void count(int id, std::size_t n = 1)
+  {
+    if(isEnabled()) _count(id, n);
+  }
+  // get the call trees as a flat list of nodes: parents[i] is the index of
+  // the parent of node i (-1 for the top-level regions of each thread), times
+  // are in seconds and are zero for counters
+  static void get(std::vector<std::string> &names, std::vector<int> &parents,
+                  std::vector<std::size_t> &calls,
+                  std::vector<double> &inclusiveTimes,
+                  std::vector<double> &exclusiveTimes,
+                  std::vector<int> &threads);
+  // write the recorded regions in the Chrome trace (JSON) format
+  static bool writeTrace(const std::string &fileName);
+};
+
+// Open a region for the lifetime of the object; the name of regions attached
+// to a model entity is only built if the profiler is running
+class ProfilerScope {
+private:
+  bool _active;
+
+public:
+  ProfilerScope(const char *name) : _active(Profiler::isEnabled())
+  {
+    if(_active) Profiler::begin(name);
+  }
+  ProfilerScope(const char *name, int tag) : _active(Profiler::isEnabled())
+  {
+    if(_active) Profiler::begin(std::string(name) + " " + std::to_string(tag));
+  }
+  ~ProfilerScope()
+  {
+    if(_active) Profiler::end();
+  }
+};
+
+#endif
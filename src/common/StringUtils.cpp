@@ -184,6 +184,28 @@ std::string RemoveWhiteSpace(const std::string &s)
   return std::regex_replace(s, r, "");
 }
 
+std::string JsonString(const std::string &s)
+{
+  // quoted JSON string, with quotes, backslashes and control characters
+  // escaped
+  std::string str = "\"";
+  for(std::size_t i = 0; i < s.size(); i++) {
+    unsigned char c = s[i];
+    if(c == '"' || c == '\\') {
+      str += '\\';
+      str += c;
+    }
+    else if(c < 0x20) {
+      char tmp[8];
+      sprintf(tmp, "\\u%04x", c);
+      str += tmp;
+    }
+    else
+      str += c;
+  }
+  return str + "\"";
+}
+
 static std::string getNextTokenInString(const std::string &msg,
                                         std::string::size_type &first,
                                         char separator)
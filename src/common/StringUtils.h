@@ -29,6 +29,7 @@ bool SplitOptionName(const std::string &fullName, std::string &category,
 std::vector<std::string> SplitString(const std::string &msg, char separator,
                                      bool removeWhiteSpace = false);
 std::string RemoveWhiteSpace(const std::string &s);
+std::string JsonString(const std::string &s);
 bool IsOnelabName(const std::string &name, std::string &cleanName);
 
 #endif
@@ -0,0 +1,126 @@
+// Gmsh - Copyright (C) 1997-2022 C. Geuzaine, J.-F. Remacle
+//
+// See the LICENSE.txt file in the Gmsh root directory for license information.
+// Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+#ifndef TAG_HASH_TABLE_H
+#define TAG_HASH_TABLE_H
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <stdint.h>
+
+// Open-addressing (linear probing) hash table mapping non-zero tags to values,
+// used for the mesh node and element caches when the numbering is not dense.
+// Lookups only read the table, and can thus be performed concurrently. Slots
+// are claimed with an atomic compare-and-swap on their key, so insertions can
+// also be performed concurrently, provided that reserve() has been called
+// with the final number of keys beforehand (insertions that would exceed the
+// load factor rehash the table, which is not thread-safe).
+template <class T> class TagHashTable {
+private:
+  std::unique_ptr<std::atomic<std::size_t>[]> _keys; // 0 for empty slots
+  std::vector<T> _values;
+  std::size_t _capacity; // 0 or a power of 2
+  int _bits;
+  std::atomic<std::size_t> _size;
+
+  std::size_t _slot(std::size_t key) const
+  {
+    // Fibonacci hashing: spreads consecutive tags over the table
+    return (std::size_t)(((uint64_t)key * 0x9E3779B97F4A7C15ULL) >>
+                         (64 - _bits));
+  }
+  void _allocate(std::size_t capacity)
+  {
+    _capacity = 16;
+    _bits = 4;
+    while(_capacity < capacity) {
+      _capacity *= 2;
+      _bits++;
+    }
+    _keys.reset(new std::atomic<std::size_t>[_capacity]);
+    for(std::size_t i = 0; i < _capacity; i++) _keys[i] = 0;
+    _values.assign(_capacity, T());
+    _size = 0;
+  }
+  void _rehash(std::size_t capacity)
+  {
+    std::unique_ptr<std::atomic<std::size_t>[]> keys(std::move(_keys));
+    std::vector<T> values;
+    values.swap(_values);
+    std::size_t old = _capacity;
+    _allocate(capacity);
+    for(std::size_t i = 0; i < old; i++)
+      if(keys[i]) insert(keys[i], values[i]);
+  }
+
+public:
+  TagHashTable() : _capacity(0), _bits(0), _size(0) {}
+  std::size_t size() const { return _size; }
+  bool empty() const { return !_size; }
+  // remove all the entries and free the memory
+  void clear()
+  {
+    _keys.reset();
+    std::vector<T>().swap(_values);
+    _capacity = 0;
+    _bits = 0;
+    _size = 0;
+  }
+  // remove all the entries and allocate room for n keys
+  void reserve(std::size_t n) { _allocate(2 * n); }
+  // insert the value for the given key (which should not be 0); return false
+  // (and keep the existing value) if the key is already present
+  bool insert(std::size_t key, const T &value)
+  {
+    if(!key) return false;
+    if(2 * (_size + 1) > _capacity) _rehash(2 * _capacity);
+    std::size_t mask = _capacity - 1;
+    for(std::size_t i = _slot(key);; i = (i + 1) & mask) {
+      std::size_t k = _keys[i].load(std::memory_order_acquire);
+      if(!k && _keys[i].compare_exchange_strong(k, key,
+                                                std::memory_order_acq_rel)) {
+        _values[i] = value;
+        _size++;
+        return true;
+      }
+      if(k == key) return false;
+    }
+  }
+  // insert or replace the value for the given key
+  void set(std::size_t key, const T &value)
+  {
+    T *v = find(key);
+    if(v)
+      *v = value;
+    else
+      insert(key, value);
+  }
+  // return a pointer to the value for the given key, or nullptr
+  const T *find(std::size_t key) const
+  {
+    if(!key || !_capacity) return nullptr;
+    std::size_t mask = _capacity - 1;
+    for(std::size_t i = _slot(key);; i = (i + 1) & mask) {
+      std::size_t k = _keys[i].load(std::memory_order_acquire);
+      if(k == key) return &_values[i];
+      if(!k) return nullptr;
+    }
+  }
+  T *find(std::size_t key)
+  {
+    return const_cast<T *>(static_cast<const TagHashTable *>(this)->find(key));
+  }
+  // call f(key, value) for all the entries, in no particular order
+  template <class F> void forEach(F f)
+  {
+    for(std::size_t i = 0; i < _capacity; i++) {
+      std::size_t k = _keys[i].load(std::memory_order_relaxed);
+      if(k) f(k, _values[i]);
+    }
+  }
+};
+
+#endif
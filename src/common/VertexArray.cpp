@@ -11,9 +11,6 @@
 #include "Numeric.h"
 #include "OS.h"
 
-template<int N> float ElementDataLessThan<N>::tolerance = 0.0F;
-float BarycenterLessThan::tolerance = 0.0F;
-
 VertexArray::VertexArray(int numVerticesPerElement, int numElements)
   : _numVerticesPerElement(numVerticesPerElement)
 {
@@ -104,7 +101,6 @@ void VertexArray::add(double *x, double *y, double *z, SVector3 *n, unsigned cha
 
   if(boundary && npe == 3){
     ElementData<3> e(x, y, z, n, r, g, b, a, ele);
-    ElementDataLessThan<3>::tolerance = (float)(CTX::instance()->lc * 1.e-12);
     auto it = _data3.find(e);
     if(it == _data3.end())
       _data3.insert(e);
@@ -120,7 +116,6 @@ void VertexArray::add(double *x, double *y, double *z, SVector3 *n, unsigned cha
     Barycenter pc(0.0F, 0.0F, 0.0F);
     for(int i = 0; i < npe; i++)
       pc += Barycenter(x[i], y[i], z[i]);
-    BarycenterLessThan::tolerance = (float)(CTX::instance()->lc * 1.e-12);
     if(_barycenters.find(pc) != _barycenters.end())
       return;
     _barycenters.insert(pc);
@@ -342,6 +337,13 @@ void VertexArray::fromChar(int length, const char *bytes, int swap)
 
 void VertexArray::merge(VertexArray* va)
 {
+  for(auto it = va->_data3.begin(); it != va->_data3.end(); it++) {
+    auto it2 = _data3.find(*it);
+    if(it2 == _data3.end())
+      _data3.insert(*it);
+    else
+      _data3.erase(it2);
+  }
   if(va->getNumVertices() != 0) {
     _vertices.insert(_vertices.end(), va->firstVertex(), va->lastVertex());
     _normals.insert(_normals.end(), va->firstNormal(), va->lastNormal());
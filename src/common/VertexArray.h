@@ -7,7 +7,9 @@
 #define VERTEX_ARRAY_H
 
 #include <vector>
-#include <set>
+#include <algorithm>
+#include <functional>
+#include "robin_hood.h"
 #include "SVector3.h"
 #include "SBoundingBox3d.h"
 
@@ -65,11 +67,18 @@ public:
   inline MElement *ele() const { return _ele; }
   SPoint3 barycenter() const
   {
-    SPoint3 p(0., 0., 0.);
+    // sum the coordinates in increasing order, so that the result does not
+    // depend on the ordering of the nodes
+    float c[3][N];
     for(int i = 0; i < N; i++) {
-      p[0] += _x[i];
-      p[1] += _y[i];
-      p[2] += _z[i];
+      c[0][i] = _x[i];
+      c[1][i] = _y[i];
+      c[2][i] = _z[i];
+    }
+    SPoint3 p(0., 0., 0.);
+    for(int j = 0; j < 3; j++) {
+      std::sort(c[j], c[j] + N);
+      for(int i = 0; i < N; i++) p[j] += c[j][i];
     }
     p[0] /= (double)N;
     p[1] /= (double)N;
@@ -78,19 +87,33 @@ public:
   }
 };
 
-template <int N> class ElementDataLessThan {
+// hash the coordinates of a point (such that equal points, including +0 and -0
+// coordinates, give the same hash)
+inline std::size_t hashPoint(double x, double y, double z)
+{
+  std::size_t h = std::hash<double>()(x);
+  h = robin_hood::hash_int(h ^ std::hash<double>()(y));
+  return robin_hood::hash_int(h ^ std::hash<double>()(z));
+}
+
+// elements with the same barycenter (as the copies of a face shared by two
+// volume elements) are considered equal
+template <int N> class ElementDataHash {
+public:
+  std::size_t operator()(const ElementData<N> &e) const
+  {
+    SPoint3 p = e.barycenter();
+    return hashPoint(p.x(), p.y(), p.z());
+  }
+};
+
+template <int N> class ElementDataEqual {
 public:
-  static float tolerance;
   bool operator()(const ElementData<N> &e1, const ElementData<N> &e2) const
   {
     SPoint3 p1 = e1.barycenter();
     SPoint3 p2 = e2.barycenter();
-    if(p1.x() - p2.x() > tolerance) return true;
-    if(p1.x() - p2.x() < -tolerance) return false;
-    if(p1.y() - p2.y() > tolerance) return true;
-    if(p1.y() - p2.y() < -tolerance) return false;
-    if(p1.z() - p2.z() > tolerance) return true;
-    return false;
+    return p1.x() == p2.x() && p1.y() == p2.y() && p1.z() == p2.z();
   }
 };
 
@@ -114,25 +137,11 @@ public:
   }
 };
 
-class BarycenterLessThan {
-public:
-  static float tolerance;
-  bool operator()(const Barycenter &p1, const Barycenter &p2) const
-  {
-    if(p1.x() - p2.x() > tolerance) return true;
-    if(p1.x() - p2.x() < -tolerance) return false;
-    if(p1.y() - p2.y() > tolerance) return true;
-    if(p1.y() - p2.y() < -tolerance) return false;
-    if(p1.z() - p2.z() > tolerance) return true;
-    return false;
-  }
-};
-
 class BarycenterHash {
 public:
   std::size_t operator()(const Barycenter &b) const
   {
-    return (std::size_t)(b.x() + b.y() + b.z());
+    return hashPoint(b.x(), b.y(), b.z());
   }
 };
 
@@ -140,14 +149,10 @@ class BarycenterEqual {
 public:
   bool operator()(const Barycenter &a, const Barycenter &b) const
   {
-    return (fabs(a.x() - b.x()) < BarycenterLessThan::tolerance &&
-            fabs(a.y() - b.y()) < BarycenterLessThan::tolerance &&
-            fabs(a.z() - b.z()) < BarycenterLessThan::tolerance);
+    return a.x() == b.x() && a.y() == b.y() && a.z() == b.z();
   }
 };
 
-//#include <tr1/unordered_set>
-
 class VertexArray {
 private:
   int _numVerticesPerElement;
@@ -155,10 +160,11 @@ private:
   std::vector<normal_type> _normals;
   std::vector<unsigned char> _colors;
   std::vector<MElement *> _elements;
-  std::set<ElementData<3>, ElementDataLessThan<3> > _data3;
-  std::set<Barycenter, BarycenterLessThan> _barycenters;
-  // std::tr1::unordered_set<Barycenter, BarycenterHash, BarycenterEqual>
-  // _barycenters;
+  robin_hood::unordered_set<ElementData<3>, ElementDataHash<3>,
+                            ElementDataEqual<3> >
+    _data3;
+  robin_hood::unordered_set<Barycenter, BarycenterHash, BarycenterEqual>
+    _barycenters;
 
   // add stuff in the arrays
   void _addVertex(float x, float y, float z);
@@ -229,7 +235,8 @@ public:
                           double &max, int &numSteps, double &time,
                           double &xmin, double &ymin, double &zmin,
                           double &xmax, double &ymax, double &zmax);
-  // merge another vertex array into this one
+  // merge another vertex array into this one (before finalize(), the boundary
+  // elements of both arrays are merged as if added to this one)
   void merge(VertexArray *va);
 };
 
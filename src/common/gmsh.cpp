@@ -46,6 +46,7 @@
 #include "pyramidalBasis.h"
 #include "Numeric.h"
 #include "OS.h"
+#include "Profiler.h"
 #include "OpenFile.h"
 #include "HierarchicalBasisH1Quad.h"
 #include "HierarchicalBasisH1Tria.h"
@@ -1681,6 +1682,54 @@ GMSH_API void gmsh::model::mesh::getNodes(std::vector<std::size_t> &nodeTags,
   else {
     GModel::current()->getEntities(entities, dim);
   }
+  if(!includeBoundary) {
+    // split the nodes of the entities in chunks, with their offset in the
+    // (exactly sized) outputs, and fill the chunks concurrently
+    struct chunk {
+      const std::vector<MVertex *> *nodes;
+      std::size_t first, last, offset;
+    };
+    std::vector<chunk> chunks;
+    const std::size_t chunkSize = 10000;
+    std::size_t numNodes = 0;
+    for(std::size_t i = 0; i < entities.size(); i++) {
+      const std::vector<MVertex *> &mv = entities[i]->mesh_vertices;
+      for(std::size_t j = 0; j < mv.size(); j += chunkSize) {
+        chunk c = {&mv, j, std::min(j + chunkSize, mv.size()), numNodes + j};
+        chunks.push_back(c);
+      }
+      numNodes += mv.size();
+    }
+    nodeTags.resize(numNodes);
+    coord.resize(3 * numNodes);
+    int nthreads = CTX::instance()->numThreads;
+    if(!nthreads) nthreads = Msg::GetMaxThreads();
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+    for(std::size_t c = 0; c < chunks.size(); c++) {
+      const chunk &ch = chunks[c];
+      for(std::size_t j = ch.first; j < ch.last; j++) {
+        MVertex *v = (*ch.nodes)[j];
+        std::size_t k = ch.offset + j - ch.first;
+        nodeTags[k] = v->getNum();
+        coord[3 * k] = v->x();
+        coord[3 * k + 1] = v->y();
+        coord[3 * k + 2] = v->z();
+      }
+    }
+    // the number of parametric coordinates can differ between nodes
+    if(dim > 0 && returnParametricCoord) {
+      parametricCoord.reserve(dim * numNodes);
+      for(std::size_t i = 0; i < entities.size(); i++) {
+        for(auto v : entities[i]->mesh_vertices) {
+          double par;
+          for(int k = 0; k < dim; k++) {
+            if(v->getParameter(k, par)) parametricCoord.push_back(par);
+          }
+        }
+      }
+    }
+    return;
+  }
   for(std::size_t i = 0; i < entities.size(); i++) {
     GEntity *ge = entities[i];
     for(std::size_t j = 0; j < ge->mesh_vertices.size(); j++) {
@@ -1874,23 +1923,34 @@ GMSH_API void gmsh::model::mesh::addNodes(
     }
     param = true;
   }
+  // construct the nodes in a single block of memory if
+  // Mesh.CompactNodeStorage is set
+  std::size_t size = sizeof(MVertex);
+  if(param && dim == 1) size = sizeof(MEdgeVertex);
+  else if(param && dim == 2) size = sizeof(MFaceVertex);
+  char *block = MVertexBlock::allocate(size, numNodes);
+  ge->mesh_vertices.reserve(ge->mesh_vertices.size() + numNodes);
   for(int i = 0; i < numNodes; i++) {
     std::size_t tag = (numNodeTags ? nodeTags[i] : 0); // 0 = automatic tag
     double x = coord[3 * i];
     double y = coord[3 * i + 1];
     double z = coord[3 * i + 2];
+    void *p = block ? block + i * size : nullptr;
     MVertex *vv = nullptr;
     if(param && dim == 1) {
       double u = parametricCoord[i];
-      vv = new MEdgeVertex(x, y, z, ge, u, tag);
+      vv = p ? ::new(p) MEdgeVertex(x, y, z, ge, u, tag) :
+               new MEdgeVertex(x, y, z, ge, u, tag);
     }
     else if(param && dim == 2) {
       double u = parametricCoord[2 * i];
       double v = parametricCoord[2 * i + 1];
-      vv = new MFaceVertex(x, y, z, ge, u, v, tag);
+      vv = p ? ::new(p) MFaceVertex(x, y, z, ge, u, v, tag) :
+               new MFaceVertex(x, y, z, ge, u, v, tag);
     }
     else
-      vv = new MVertex(x, y, z, ge, tag);
+      vv = p ? ::new(p) MVertex(x, y, z, ge, tag) :
+               new MVertex(x, y, z, ge, tag);
     ge->mesh_vertices.push_back(vv);
   }
   GModel::current()->destroyMeshCaches();
@@ -1988,21 +2048,50 @@ GMSH_API void gmsh::model::mesh::getElements(
   nodeTags.clear();
   std::map<int, std::vector<GEntity *> > typeEnt;
   _getEntitiesForElementTypes(dim, tag, typeEnt);
-  for(auto it = typeEnt.begin(); it != typeEnt.end(); it++) {
-    elementTypes.push_back(it->first);
-    elementTags.push_back(std::vector<std::size_t>());
-    nodeTags.push_back(std::vector<std::size_t>());
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+  elementTypes.reserve(typeEnt.size());
+  elementTags.resize(typeEnt.size());
+  nodeTags.resize(typeEnt.size());
+  std::size_t t = 0;
+  for(auto it = typeEnt.begin(); it != typeEnt.end(); it++, t++) {
     int elementType = it->first;
-    for(std::size_t i = 0; i < it->second.size(); i++) {
-      GEntity *ge = it->second[i];
+    elementTypes.push_back(elementType);
+    const std::vector<GEntity *> &entities = it->second;
+    // count the elements of the given type in each entity first, then fill
+    // the (exactly sized) outputs concurrently
+    std::vector<std::size_t> offsets(entities.size() + 1, 0);
+    std::vector<std::size_t> nodeOffsets(entities.size() + 1, 0);
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+    for(std::size_t i = 0; i < entities.size(); i++) {
+      GEntity *ge = entities[i];
+      std::size_t num = 0, numNodes = 0;
       for(std::size_t j = 0; j < ge->getNumMeshElements(); j++) {
         MElement *e = ge->getMeshElement(j);
-        if(e->getTypeForMSH() == elementType) {
-          elementTags.back().push_back(e->getNum());
-          for(std::size_t k = 0; k < e->getNumVertices(); k++) {
-            nodeTags.back().push_back(e->getVertex(k)->getNum());
-          }
-        }
+        if(e->getTypeForMSH() != elementType) continue;
+        num++;
+        numNodes += e->getNumVertices(); // not constant for polygons
+      }
+      offsets[i + 1] = num;
+      nodeOffsets[i + 1] = numNodes;
+    }
+    for(std::size_t i = 0; i < entities.size(); i++) {
+      offsets[i + 1] += offsets[i];
+      nodeOffsets[i + 1] += nodeOffsets[i];
+    }
+    elementTags[t].resize(offsets.back());
+    nodeTags[t].resize(nodeOffsets.back());
+    std::size_t *etags = elementTags[t].data(), *ntags = nodeTags[t].data();
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+    for(std::size_t i = 0; i < entities.size(); i++) {
+      GEntity *ge = entities[i];
+      std::size_t index = offsets[i], nodeIndex = nodeOffsets[i];
+      for(std::size_t j = 0; j < ge->getNumMeshElements(); j++) {
+        MElement *e = ge->getMeshElement(j);
+        if(e->getTypeForMSH() != elementType) continue;
+        etags[index++] = e->getNum();
+        for(std::size_t k = 0; k < e->getNumVertices(); k++)
+          ntags[nodeIndex++] = e->getVertex(k)->getNum();
       }
     }
   }
@@ -5279,16 +5368,31 @@ gmsh::model::mesh::reorderElements(const int elementType, const int tag,
   }
 }
 
-GMSH_API void gmsh::model::mesh::renumberNodes()
+static int _getRenumberMethod(const std::string &method)
+{
+  if(method.empty()) return -1;
+  if(method == "Sequential") return 0;
+  if(method == "RCMK") return 1;
+  if(method == "Hilbert") return 2;
+  if(method == "Partition") return 3;
+  Msg::Error("Unknown renumbering method '%s'", method.c_str());
+  return -2;
+}
+
+GMSH_API void gmsh::model::mesh::renumberNodes(const std::string &method)
 {
   if(!_checkInit()) return;
-  GModel::current()->renumberMeshVertices();
+  int m = _getRenumberMethod(method);
+  if(m < -1) return;
+  GModel::current()->renumberMeshVertices(m);
 }
 
-GMSH_API void gmsh::model::mesh::renumberElements()
+GMSH_API void gmsh::model::mesh::renumberElements(const std::string &method)
 {
   if(!_checkInit()) return;
-  GModel::current()->renumberMeshElements();
+  int m = _getRenumberMethod(method);
+  if(m < -1) return;
+  GModel::current()->renumberMeshElements(m);
 }
 
 GMSH_API void
@@ -5889,6 +5993,52 @@ GMSH_API void gmsh::model::mesh::field::setAsBoundaryLayer(const int tag)
 #endif
 }
 
+GMSH_API void gmsh::model::mesh::field::evaluate(const int tag,
+                                                 const std::vector<double> &xyz,
+                                                 std::vector<double> &values,
+                                                 const int dim,
+                                                 const int entityTag)
+{
+  if(!_checkInit()) return;
+  values.clear();
+#if defined(HAVE_MESH)
+  Field *field = GModel::current()->getFields()->get(tag);
+  if(!field) {
+    Msg::Error("Unknown field %i", tag);
+    return;
+  }
+  if(xyz.size() % 3) {
+    Msg::Error("Number of coordinates should be a multiple of 3");
+    return;
+  }
+  GEntity *ge = nullptr;
+  if(dim >= 0 && entityTag >= 0) {
+    ge = GModel::current()->getEntityByTag(dim, entityTag);
+    if(!ge) {
+      Msg::Error("%s does not exist", _getEntityName(dim, entityTag).c_str());
+      return;
+    }
+  }
+  GModel::current()->getFields()->initialize();
+  std::size_t n = xyz.size() / 3;
+  values.resize(n);
+  if(!n) return;
+  // fields are evaluated concurrently by chunks of points
+  const std::size_t chunk = 4096;
+  std::size_t nchunks = (n + chunk - 1) / chunk;
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t i = 0; i < nchunks; i++) {
+    std::size_t start = i * chunk;
+    std::size_t num = std::min(chunk, n - start);
+    field->evaluate(&xyz[3 * start], num, &values[start], ge);
+  }
+#else
+  Msg::Error("Fields require the mesh module");
+#endif
+}
+
 // gmsh::model::geo
 
 GMSH_API int gmsh::model::geo::addPoint(const double x, const double y,
@@ -7927,6 +8077,56 @@ GMSH_API void gmsh::view::probe(const int tag, const double x, const double y,
 #endif
 }
 
+GMSH_API void gmsh::view::probeBatch(const int tag,
+                                     const std::vector<double> &coord,
+                                     std::vector<double> &values,
+                                     std::vector<double> &distances,
+                                     const int step, const int numComp,
+                                     const bool gradient,
+                                     const double distanceMax, const int dim)
+{
+  if(!_checkInit()) return;
+#if defined(HAVE_POST)
+  PView *view = PView::getViewByTag(tag);
+  if(!view) {
+    Msg::Error("Unknown view with tag %d", tag);
+    return;
+  }
+  PViewData *data = view->getData();
+  if(!data) {
+    Msg::Error("No data in view %d", tag);
+    return;
+  }
+  values.clear();
+  distances.clear();
+  if(coord.size() % 3) {
+    Msg::Error("Wrong number of coordinates");
+    return;
+  }
+  int nc = numComp;
+  if(nc != 1 && nc != 3 && nc != 9) {
+    if(data->getNumScalars())
+      nc = 1;
+    else if(data->getNumVectors())
+      nc = 3;
+    else if(data->getNumTensors())
+      nc = 9;
+    else
+      nc = 1;
+  }
+  std::size_t n = coord.size() / 3;
+  if(!n) return;
+  int numSteps = (step < 0) ? data->getNumTimeSteps() : 1;
+  int mult = gradient ? 3 : 1;
+  values.resize(n * numSteps * mult * nc);
+  distances.resize(n);
+  data->searchClosest(nc, n, &coord[0], &values[0], &distances[0],
+                      distanceMax, step, gradient, dim);
+#else
+  Msg::Error("Views require the post-processing module");
+#endif
+}
+
 GMSH_API void gmsh::view::write(const int tag, const std::string &fileName,
                                 const bool append)
 {
@@ -8797,3 +8997,33 @@ GMSH_API void gmsh::logger::getLastError(std::string &error)
   if(!_checkInit()) return;
   error = Msg::GetLastError();
 }
+
+GMSH_API void gmsh::logger::startProfiling()
+{
+  if(!_checkInit()) return;
+  Profiler::start();
+}
+
+GMSH_API void gmsh::logger::stopProfiling()
+{
+  if(!_checkInit()) return;
+  Profiler::stop();
+}
+
+GMSH_API void gmsh::logger::getProfile(std::vector<std::string> &names,
+                                       std::vector<int> &parents,
+                                       std::vector<std::size_t> &calls,
+                                       std::vector<double> &inclusiveTimes,
+                                       std::vector<double> &exclusiveTimes,
+                                       std::vector<int> &threads)
+{
+  if(!_checkInit()) return;
+  Profiler::get(names, parents, calls, inclusiveTimes, exclusiveTimes,
+                threads);
+}
+
+GMSH_API void gmsh::logger::writeProfile(const std::string &fileName)
+{
+  if(!_checkInit()) return;
+  Profiler::writeTrace(fileName);
+}
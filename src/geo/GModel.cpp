@@ -7,6 +7,7 @@
 #include <stdlib.h>
 #include <sstream>
 #include <stack>
+#include <algorithm>
 #include "GmshConfig.h"
 #include "GmshMessage.h"
 #include "GModel.h"
@@ -42,6 +43,7 @@
 #include "CreateFile.h"
 #include "Options.h"
 #include "GModelParametrize.h"
+#include "HilbertCurve.h"
 
 #if defined(HAVE_MESH)
 #include "meshGEdge.h"
@@ -70,7 +72,8 @@ std::vector<GModel *> GModel::list;
 int GModel::_current = -1;
 
 GModel::GModel(const std::string &name)
-  : _name(name), _visible(1), _elementOctree(nullptr),
+  : _name(name), _visible(1), _vertexCacheBuilt(false),
+    _elementCacheBuilt(false), _elementOctree(nullptr),
     _geo_internals(nullptr), _occ_internals(nullptr), _acis_internals(nullptr),
     _parasolid_internals(nullptr), _fields(nullptr),
     _currentMeshEntity(nullptr), _numPartitions(0), normals(nullptr),
@@ -219,11 +222,11 @@ void GModel::destroyMeshCaches()
     _vertexVectorCache.clear();
     std::vector<MVertex *>().swap(_vertexVectorCache);
     _vertexMapCache.clear();
-    std::map<int, MVertex *>().swap(_vertexMapCache);
+    _vertexCacheBuilt = false;
     _elementVectorCache.clear();
     std::vector<std::pair<MElement *, int> >().swap(_elementVectorCache);
     _elementMapCache.clear();
-    std::map<int, std::pair<MElement *, int> >().swap(_elementMapCache);
+    _elementCacheBuilt = false;
     _elementIndexCache.clear();
     std::map<int, int>().swap(_elementIndexCache);
     if(_elementOctree) {
@@ -1620,7 +1623,307 @@ static void getDependentViewData(GModel *m, PViewDataGModel::DataType type,
 }
 #endif
 
-void GModel::renumberMeshVertices()
+// partition of a mesh element (0 if the mesh is not partitioned)
+static int getElementPartition(GEntity *ge, MElement *e)
+{
+  if(e->getPartition() > 0) return e->getPartition();
+  const std::vector<int> *p = nullptr;
+  switch(ge->geomType()) {
+  case GEntity::PartitionPoint:
+    p = &static_cast<partitionVertex *>(ge)->getPartitions();
+    break;
+  case GEntity::PartitionCurve:
+    p = &static_cast<partitionEdge *>(ge)->getPartitions();
+    break;
+  case GEntity::PartitionSurface:
+    p = &static_cast<partitionFace *>(ge)->getPartitions();
+    break;
+  case GEntity::PartitionVolume:
+    p = &static_cast<partitionRegion *>(ge)->getPartitions();
+    break;
+  default: break;
+  }
+  return (p && p->size()) ? *std::min_element(p->begin(), p->end()) : 0;
+}
+
+// bandwidth (largest difference between the tags of the nodes of an element)
+// and profile (sum over all nodes of the difference between the tag of the
+// node and the smallest tag of its neighbors) of the dense node numbering
+// first, ..., first + num - 1
+static void getNodeNumberingStatistics(std::vector<GEntity *> &entities,
+                                       std::size_t first, std::size_t num,
+                                       std::size_t &bandwidth,
+                                       std::size_t &profile)
+{
+  std::vector<std::size_t> minNeighbor(num);
+  for(std::size_t i = 0; i < num; i++) minNeighbor[i] = i;
+  bandwidth = 0;
+  for(std::size_t i = 0; i < entities.size(); i++) {
+    for(std::size_t j = 0; j < entities[i]->getNumMeshElements(); j++) {
+      MElement *e = entities[i]->getMeshElement(j);
+      std::size_t nmin = num, nmax = 0;
+      for(std::size_t k = 0; k < e->getNumVertices(); k++) {
+        std::size_t n = e->getVertex(k)->getNum() - first;
+        nmin = std::min(nmin, n);
+        nmax = std::max(nmax, n);
+      }
+      if(nmax >= num) continue; // node not classified on any entity
+      bandwidth = std::max(bandwidth, nmax - nmin);
+      for(std::size_t k = 0; k < e->getNumVertices(); k++) {
+        std::size_t n = e->getVertex(k)->getNum() - first;
+        minNeighbor[n] = std::min(minNeighbor[n], nmin);
+      }
+    }
+  }
+  profile = 0;
+  for(std::size_t i = 0; i < num; i++) profile += i - minNeighbor[i];
+}
+
+// reverse Cuthill-McKee ordering of the nodes 0, ..., n - 1 of the graph given
+// in compressed row storage (ptr, adj), nodes in different groups being
+// considered as disconnected: the groups are ordered one after the other, by
+// increasing group number
+static void getReverseCuthillMcKeeOrdering(const std::vector<std::size_t> &ptr,
+                                           const std::vector<std::size_t> &adj,
+                                           const std::vector<std::size_t> &group,
+                                           std::vector<std::size_t> &ordering)
+{
+  std::size_t n = group.size();
+  std::vector<std::size_t> degree(n, 0);
+  for(std::size_t i = 0; i < n; i++)
+    for(std::size_t k = ptr[i]; k < ptr[i + 1]; k++)
+      if(group[adj[k]] == group[i]) degree[i]++;
+  std::vector<std::size_t> nodes(n);
+  for(std::size_t i = 0; i < n; i++) nodes[i] = i;
+  std::stable_sort(nodes.begin(), nodes.end(),
+                   [&group](std::size_t a, std::size_t b) {
+                     return group[a] < group[b];
+                   });
+  // breadth-first search from root in the part of its connected component that
+  // is not ordered yet, visiting the neighbors by increasing degree; return
+  // the number of levels and the start of the last level in visit
+  std::vector<std::size_t> mark(n, 0);
+  std::vector<char> done(n, 0);
+  std::size_t stamp = 0;
+  auto bfs = [&](std::size_t root, std::vector<std::size_t> &visit,
+                 std::size_t &lastLevel) {
+    stamp++;
+    visit.assign(1, root);
+    mark[root] = stamp;
+    std::size_t levels = 0;
+    for(std::size_t l = 0; l < visit.size(); levels++) {
+      lastLevel = l;
+      for(std::size_t end = visit.size(); l < end; l++) {
+        std::size_t i = visit[l], start = visit.size();
+        for(std::size_t k = ptr[i]; k < ptr[i + 1]; k++) {
+          std::size_t j = adj[k];
+          if(mark[j] != stamp && !done[j] && group[j] == group[i]) {
+            mark[j] = stamp;
+            visit.push_back(j);
+          }
+        }
+        std::sort(visit.begin() + start, visit.end(),
+                  [&degree](std::size_t a, std::size_t b) {
+                    return degree[a] < degree[b] ||
+                           (degree[a] == degree[b] && a < b);
+                  });
+      }
+    }
+    return levels;
+  };
+  ordering.clear();
+  ordering.reserve(n);
+  std::vector<std::size_t> visit;
+  std::size_t start = 0;
+  for(std::size_t g = 0; g < n; g++) {
+    std::size_t root = nodes[g], lastLevel;
+    if(!done[root]) {
+      // start from a pseudo-peripheral node: move the root to a node of
+      // minimal degree in the last level while the number of levels grows
+      std::size_t levels = bfs(root, visit, lastLevel);
+      for(int it = 0; it < 10; it++) {
+        std::size_t next = visit[lastLevel];
+        for(std::size_t l = lastLevel; l < visit.size(); l++)
+          if(degree[visit[l]] < degree[next]) next = visit[l];
+        std::size_t nextLevels = bfs(next, visit, lastLevel);
+        if(nextLevels <= levels) break;
+        root = next;
+        levels = nextLevels;
+      }
+      bfs(root, visit, lastLevel);
+      for(std::size_t l = 0; l < visit.size(); l++) {
+        done[visit[l]] = 1;
+        ordering.push_back(visit[l]);
+      }
+    }
+    if(g + 1 == n || group[nodes[g + 1]] != group[nodes[g]]) {
+      std::reverse(ordering.begin() + start, ordering.end());
+      start = ordering.size();
+    }
+  }
+}
+
+// renumber the nodes, densely numbered first, ..., first + num - 1, with the
+// given method; the first numSaved nodes are kept before the others
+static void reorderMeshVertices(std::vector<GEntity *> &entities, int method,
+                                std::size_t first, std::size_t num,
+                                std::size_t numSaved, int numPartitions)
+{
+  std::vector<MVertex *> nodes(num, nullptr);
+  for(std::size_t i = 0; i < entities.size(); i++)
+    for(std::size_t j = 0; j < entities[i]->getNumMeshVertices(); j++) {
+      MVertex *v = entities[i]->getMeshVertex(j);
+      nodes[v->getNum() - first] = v;
+    }
+
+  // group the nodes by partition (the smallest partition of the elements they
+  // belong to), after the saved/not saved split
+  std::vector<std::size_t> group(num, 0);
+  if(numPartitions > 0 || method == 3) {
+    const std::size_t none = std::numeric_limits<std::size_t>::max();
+    std::vector<std::size_t> part(num, none);
+    for(std::size_t i = 0; i < entities.size(); i++) {
+      for(std::size_t j = 0; j < entities[i]->getNumMeshElements(); j++) {
+        MElement *e = entities[i]->getMeshElement(j);
+        std::size_t p = getElementPartition(entities[i], e);
+        for(std::size_t k = 0; k < e->getNumVertices(); k++) {
+          std::size_t n = e->getVertex(k)->getNum() - first;
+          if(n < num) part[n] = std::min(part[n], p);
+        }
+      }
+    }
+    for(std::size_t i = 0; i < num; i++)
+      group[i] = (part[i] == none) ? 0 : part[i];
+  }
+  std::size_t offset = 0;
+  for(std::size_t i = 0; i < num; i++) offset = std::max(offset, group[i] + 1);
+  for(std::size_t i = numSaved; i < num; i++) group[i] += offset;
+
+  std::vector<std::size_t> ordering;
+  if(method == 1) {
+    // node graph in compressed row storage, from the element connectivity
+    std::vector<std::size_t> ptr(num + 1, 0), adj;
+    for(int pass = 0; pass < 2; pass++) {
+      for(std::size_t i = 0; i < entities.size(); i++) {
+        for(std::size_t j = 0; j < entities[i]->getNumMeshElements(); j++) {
+          MElement *e = entities[i]->getMeshElement(j);
+          std::size_t nv = e->getNumVertices();
+          for(std::size_t k = 0; k < nv; k++) {
+            std::size_t a = e->getVertex(k)->getNum() - first;
+            if(a >= num) continue;
+            for(std::size_t l = 0; l < nv; l++) {
+              std::size_t b = e->getVertex(l)->getNum() - first;
+              if(b >= num || a == b) continue;
+              if(pass == 0)
+                ptr[a + 1]++;
+              else
+                adj[ptr[a]++] = b;
+            }
+          }
+        }
+      }
+      if(pass == 0) {
+        for(std::size_t i = 0; i < num; i++) ptr[i + 1] += ptr[i];
+        adj.resize(ptr[num]);
+      }
+      else {
+        for(std::size_t i = num; i > 0; i--) ptr[i] = ptr[i - 1];
+        ptr[0] = 0;
+      }
+    }
+    // remove duplicate edges
+    std::size_t m = 0;
+    for(std::size_t i = 0; i < num; i++) {
+      std::size_t start = m;
+      std::sort(adj.begin() + ptr[i], adj.begin() + ptr[i + 1]);
+      for(std::size_t k = ptr[i]; k < ptr[i + 1]; k++)
+        if(m == start || adj[m - 1] != adj[k]) adj[m++] = adj[k];
+      ptr[i] = start;
+    }
+    ptr[num] = m;
+    adj.resize(m);
+    getReverseCuthillMcKeeOrdering(ptr, adj, group, ordering);
+  }
+  else {
+    ordering.resize(num);
+    for(std::size_t i = 0; i < num; i++) ordering[i] = i;
+    std::stable_sort(ordering.begin(), ordering.end(),
+                     [&group](std::size_t a, std::size_t b) {
+                       return group[a] < group[b];
+                     });
+    if(method == 2) {
+      // sort each group along a Hilbert curve
+      for(std::size_t start = 0, end = 0; start < num; start = end) {
+        while(end < num && group[ordering[end]] == group[ordering[start]])
+          end++;
+        std::vector<SPoint3> points(end - start);
+        for(std::size_t i = start; i < end; i++)
+          points[i - start] = nodes[ordering[i]]->point();
+        std::vector<std::size_t> hilbert;
+        SortHilbert(points, hilbert);
+        std::vector<std::size_t> tmp(ordering.begin() + start,
+                                     ordering.begin() + end);
+        for(std::size_t i = 0; i < hilbert.size(); i++)
+          ordering[start + i] = tmp[hilbert[i]];
+      }
+    }
+  }
+
+  for(std::size_t i = 0; i < num; i++) {
+    MVertex *v = nodes[ordering[i]];
+    if(v) v->forceNum(first + i);
+  }
+}
+
+// reorder the elements of each mesh entity of dimension 2 or 3 with the given
+// method, before they are numbered sequentially; the elements of curves are
+// kept in parametric order
+static void reorderMeshElements(std::vector<GEntity *> &entities, int method)
+{
+  for(std::size_t i = 0; i < entities.size(); i++) {
+    GEntity *ge = entities[i];
+    if(ge->dim() < 2) continue;
+    std::vector<int> types;
+    ge->getElementTypes(types);
+    for(std::size_t t = 0; t < types.size(); t++) {
+      std::size_t num = ge->getNumMeshElementsByType(types[t]);
+      if(num < 2) continue;
+      // sort key: partition, then smallest node tag (method 1, following the
+      // node numbering) or position along a Hilbert curve (method 2)
+      std::vector<std::pair<std::size_t, std::size_t> > key(num);
+      std::vector<SPoint3> points;
+      for(std::size_t j = 0; j < num; j++) {
+        MElement *e = ge->getMeshElementByType(types[t], j);
+        std::size_t minNum = 0;
+        if(method == 1) {
+          minNum = e->getVertex(0)->getNum();
+          for(std::size_t k = 1; k < e->getNumVertices(); k++)
+            minNum = std::min(minNum, e->getVertex(k)->getNum());
+        }
+        else if(method == 2)
+          points.push_back(e->barycenter());
+        key[j] = std::make_pair(getElementPartition(ge, e), minNum);
+      }
+      if(method == 2) {
+        std::vector<std::size_t> hilbert;
+        SortHilbert(points, hilbert);
+        for(std::size_t j = 0; j < num; j++) key[hilbert[j]].second = j;
+      }
+      std::vector<std::size_t> ordering(num);
+      for(std::size_t j = 0; j < num; j++) ordering[j] = j;
+      std::stable_sort(ordering.begin(), ordering.end(),
+                       [&key](std::size_t a, std::size_t b) {
+                         return key[a] < key[b];
+                       });
+      int type = ge->getMeshElementByType(types[t], 0)->getTypeForMSH();
+      if(!ge->reorder(type, ordering))
+        Msg::Debug("Could not reorder elements of type %d in entity %d",
+                   type, ge->tag());
+    }
+  }
+}
+
+void GModel::renumberMeshVertices(int method)
 {
   destroyMeshCaches();
   setMaxVertexNumber(CTX::instance()->mesh.firstNodeTag - 1);
@@ -1657,6 +1960,7 @@ void GModel::renumberMeshVertices()
   }
 
   std::size_t n = CTX::instance()->mesh.firstNodeTag - 1;
+  std::size_t numSaved = 0;
   if(potentiallySaveSubset) {
     Msg::Debug("Renumbering for potentially partial mesh save");
     // if we potentially only save a subset of elements, make sure to first
@@ -1691,6 +1995,7 @@ void GModel::renumberMeshVertices()
         if(v->getNum() == 0) v->forceNum(++n);
       }
     }
+    numSaved = n - (CTX::instance()->mesh.firstNodeTag - 1);
     for(std::size_t i = 0; i < entities.size(); i++) {
       GEntity *ge = entities[i];
       for(std::size_t j = 0; j < ge->getNumMeshVertices(); j++) {
@@ -1707,6 +2012,23 @@ void GModel::renumberMeshVertices()
         ge->getMeshVertex(j)->forceNum(++n);
       }
     }
+    numSaved = n - (CTX::instance()->mesh.firstNodeTag - 1);
+  }
+
+  if(method < 0) method = CTX::instance()->mesh.renumberMethod;
+  if(method > 0) {
+    // reorder the sequential numbering for better locality
+    std::size_t first = CTX::instance()->mesh.firstNodeTag;
+    std::size_t num = n - (first - 1), bw[2], profile[2];
+    getNodeNumberingStatistics(entities, first, num, bw[0], profile[0]);
+    reorderMeshVertices(entities, method, first, num, numSaved,
+                        getNumPartitions());
+    getNodeNumberingStatistics(entities, first, num, bw[1], profile[1]);
+    Msg::Info("Renumbered nodes (%s): bandwidth %lu -> %lu, profile %lu -> %lu",
+              method == 1 ? "reverse Cuthill-McKee" :
+              method == 2 ? "Hilbert curve" : "by partition",
+              (unsigned long)bw[0], (unsigned long)bw[1],
+              (unsigned long)profile[0], (unsigned long)profile[1]);
   }
 
 #if defined(HAVE_POST)
@@ -1727,7 +2049,7 @@ void GModel::renumberMeshVertices()
 #endif
 }
 
-void GModel::renumberMeshElements()
+void GModel::renumberMeshElements(int method)
 {
   destroyMeshCaches();
   setMaxElementNumber(CTX::instance()->mesh.firstElementTag - 1);
@@ -1764,6 +2086,9 @@ void GModel::renumberMeshElements()
     }
   }
 
+  if(method < 0) method = CTX::instance()->mesh.renumberMethod;
+  if(method > 0) reorderMeshElements(entities, method);
+
   std::size_t n = CTX::instance()->mesh.firstElementTag - 1;
   if(potentiallySaveSubset) {
     for(std::size_t i = 0; i < entities.size(); i++) {
@@ -1833,18 +2158,32 @@ std::size_t GModel::getNumMeshElements(unsigned c[6])
   return 0;
 }
 
-MElement *GModel::getMeshElementByCoord(SPoint3 &p, SPoint3 &param, int dim,
-                                        bool strict)
+MElementOctree *GModel::_getElementOctree()
 {
-  if(!_elementOctree) {
-#pragma omp barrier
-#pragma omp single
-    {
+  // build the octree once, and only publish it when complete, so that
+  // concurrent searches do not need to synchronize
+  MElementOctree *octree;
+#pragma omp atomic read
+  octree = _elementOctree;
+  if(octree) return octree;
+#pragma omp critical(GModelElementOctree)
+  {
+    if(!_elementOctree) {
       Msg::Debug("Rebuilding mesh element octree");
-      _elementOctree = new MElementOctree(this);
+      MElementOctree *o = new MElementOctree(this);
+#pragma omp flush
+#pragma omp atomic write
+      _elementOctree = o;
     }
+    octree = _elementOctree;
   }
-  MElement *e = _elementOctree->find(p.x(), p.y(), p.z(), dim, strict);
+  return octree;
+}
+
+MElement *GModel::getMeshElementByCoord(SPoint3 &p, SPoint3 &param, int dim,
+                                        bool strict)
+{
+  MElement *e = _getElementOctree()->find(p.x(), p.y(), p.z(), dim, strict);
   if(e) {
     double xyz[3] = {p.x(), p.y(), p.z()}, uvw[3];
     e->xyz2uvw(xyz, uvw);
@@ -1859,15 +2198,55 @@ MElement *GModel::getMeshElementByCoord(SPoint3 &p, SPoint3 &param, int dim,
 std::vector<MElement *> GModel::getMeshElementsByCoord(SPoint3 &p, int dim,
                                                        bool strict)
 {
-  if(!_elementOctree) {
-#pragma omp barrier
-#pragma omp single
-    {
-      Msg::Debug("Rebuilding mesh element octree");
-      _elementOctree = new MElementOctree(this);
+  return _getElementOctree()->findAll(p.x(), p.y(), p.z(), dim, strict);
+}
+
+// split the mesh vertices or elements of the entities in chunks (entity, start,
+// end) of reasonable size, to fill the caches in parallel
+static void getCacheChunks(std::vector<GEntity *> &entities, bool elements,
+                           std::vector<std::size_t> &chunks)
+{
+  const std::size_t size = 10000;
+  for(std::size_t i = 0; i < entities.size(); i++) {
+    std::size_t n = elements ? entities[i]->getNumMeshElements() :
+                               entities[i]->getNumMeshVertices();
+    for(std::size_t j = 0; j < n; j += size) {
+      chunks.push_back(i);
+      chunks.push_back(j);
+      chunks.push_back(std::min(j + size, n));
+    }
+  }
+}
+
+// tag of the j-th node or element of an entity
+static std::size_t getCacheTag(GEntity *ge, bool elements, std::size_t j)
+{
+  return elements ? ge->getMeshElement(j)->getNum() :
+                    ge->mesh_vertices[j]->getNum();
+}
+
+// check if some tags (at most maxTag) appear more than once, with a bitmap
+// filled concurrently
+static bool hasDuplicateTags(std::vector<GEntity *> &entities, bool elements,
+                             std::vector<std::size_t> &chunks,
+                             std::size_t maxTag, int nthreads)
+{
+  std::size_t n = maxTag / 64 + 1;
+  std::unique_ptr<std::atomic<uint64_t>[]> bits(new std::atomic<uint64_t>[n]);
+  for(std::size_t i = 0; i < n; i++) bits[i] = 0;
+  bool duplicates = false;
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads) \
+  reduction(|| : duplicates)
+  for(std::size_t c = 0; c < chunks.size() / 3; c++) {
+    GEntity *ge = entities[chunks[3 * c]];
+    for(std::size_t j = chunks[3 * c + 1]; j < chunks[3 * c + 2]; j++) {
+      std::size_t tag = getCacheTag(ge, elements, j);
+      if(tag > maxTag) continue;
+      uint64_t mask = (uint64_t)1 << (tag % 64);
+      if(bits[tag / 64].fetch_or(mask) & mask) duplicates = true;
     }
   }
-  return _elementOctree->findAll(p.x(), p.y(), p.z(), dim, strict);
+  return duplicates;
 }
 
 void GModel::rebuildMeshVertexCache(bool onlyIfNecessary)
@@ -1877,32 +2256,70 @@ void GModel::rebuildMeshVertexCache(bool onlyIfNecessary)
     _vertexVectorCache.clear();
     _vertexMapCache.clear();
     bool dense = false;
-    if(_maxVertexNum == getNumMeshVertices()) {
+    std::size_t numVertices = getNumMeshVertices();
+    if(_maxVertexNum == numVertices) {
       Msg::Debug("We have a dense node numbering in the cache");
       dense = true;
     }
-    else if(_maxVertexNum < 10 * getNumMeshVertices()) {
+    else if(_maxVertexNum < 10 * numVertices) {
       Msg::Debug(
         "We have a fairly dense node numbering - still using cache vector");
       dense = true;
     }
     std::vector<GEntity *> entities;
     getEntities(entities);
-    if(dense) {
-      // numbering starts at 1
+    std::vector<std::size_t> chunks;
+    getCacheChunks(entities, false, chunks);
+    int nthreads = CTX::instance()->numThreads;
+    if(!nthreads) nthreads = Msg::GetMaxThreads();
+    // with duplicate tags the cache is filled serially, so that the last node
+    // in entity order is kept (as when filling it sequentially)
+    bool duplicates = false;
+    if(dense) { // numbering starts at 1
       _vertexVectorCache.resize(_maxVertexNum + 1, (MVertex *)nullptr);
-      for(std::size_t i = 0; i < entities.size(); i++)
-        for(std::size_t j = 0; j < entities[i]->mesh_vertices.size(); j++)
-          _vertexVectorCache[entities[i]->mesh_vertices[j]->getNum()] =
-            entities[i]->mesh_vertices[j];
+      duplicates =
+        hasDuplicateTags(entities, false, chunks, _maxVertexNum, nthreads);
+      if(!duplicates) {
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+        for(std::size_t c = 0; c < chunks.size() / 3; c++) {
+          GEntity *ge = entities[chunks[3 * c]];
+          for(std::size_t j = chunks[3 * c + 1]; j < chunks[3 * c + 2]; j++) {
+            MVertex *v = ge->mesh_vertices[j];
+            _vertexVectorCache[v->getNum()] = v;
+          }
+        }
+      }
     }
     else {
-      for(std::size_t i = 0; i < entities.size(); i++)
-        for(std::size_t j = 0; j < entities[i]->mesh_vertices.size(); j++)
-          _vertexMapCache[entities[i]->mesh_vertices[j]->getNum()] =
-            entities[i]->mesh_vertices[j];
+      // no rehashing, so that insertions can be done concurrently; a tag that
+      // is already present is not inserted again
+      _vertexMapCache.reserve(numVertices);
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads) \
+  reduction(|| : duplicates)
+      for(std::size_t c = 0; c < chunks.size() / 3; c++) {
+        GEntity *ge = entities[chunks[3 * c]];
+        for(std::size_t j = chunks[3 * c + 1]; j < chunks[3 * c + 2]; j++) {
+          MVertex *v = ge->mesh_vertices[j];
+          if(!_vertexMapCache.insert(v->getNum(), v)) duplicates = true;
+        }
+      }
+      if(duplicates) _vertexMapCache.reserve(numVertices);
+    }
+    if(duplicates) {
+      Msg::Debug("Duplicate node tags in cache");
+      for(auto ge : entities) {
+        for(auto v : ge->mesh_vertices) {
+          if(dense)
+            _vertexVectorCache[v->getNum()] = v;
+          else
+            _vertexMapCache.set(v->getNum(), v);
+        }
+      }
     }
   }
+#pragma omp flush
+#pragma omp atomic write
+  _vertexCacheBuilt = true;
 }
 
 void GModel::rebuildMeshElementCache(bool onlyIfNecessary)
@@ -1913,60 +2330,124 @@ void GModel::rebuildMeshElementCache(bool onlyIfNecessary)
     _elementVectorCache.clear();
     _elementMapCache.clear();
     bool dense = false;
-    if(_maxElementNum == getNumMeshElements()) {
+    std::size_t numElements = getNumMeshElements();
+    if(_maxElementNum == numElements) {
       Msg::Debug("We have a dense element numbering in the cache");
       dense = true;
     }
-    else if(_maxElementNum < 10 * getNumMeshElements()) {
+    else if(_maxElementNum < 10 * numElements) {
       Msg::Debug(
         "We have a fairly dense element numbering - still using cache vector");
       dense = true;
     }
     std::vector<GEntity *> entities;
     getEntities(entities);
-    if(dense) {
-      // numbering starts at 1
+    std::vector<std::size_t> chunks;
+    getCacheChunks(entities, true, chunks);
+    int nthreads = CTX::instance()->numThreads;
+    if(!nthreads) nthreads = Msg::GetMaxThreads();
+    // with duplicate tags the cache is filled serially, so that the last
+    // element in entity order is kept
+    bool duplicates = false;
+    if(dense) { // numbering starts at 1
       _elementVectorCache.resize(_maxElementNum + 1, std::make_pair(nullptr, 0));
-      for(std::size_t i = 0; i < entities.size(); i++)
-        for(std::size_t j = 0; j < entities[i]->getNumMeshElements(); j++) {
-          MElement *e = entities[i]->getMeshElement(j);
-          _elementVectorCache[e->getNum()] =
-            std::make_pair(e, entities[i]->tag());
+      duplicates =
+        hasDuplicateTags(entities, true, chunks, _maxElementNum, nthreads);
+      if(!duplicates) {
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+        for(std::size_t c = 0; c < chunks.size() / 3; c++) {
+          GEntity *ge = entities[chunks[3 * c]];
+          for(std::size_t j = chunks[3 * c + 1]; j < chunks[3 * c + 2]; j++) {
+            MElement *e = ge->getMeshElement(j);
+            _elementVectorCache[e->getNum()] = std::make_pair(e, ge->tag());
+          }
         }
+      }
     }
     else {
-      for(std::size_t i = 0; i < entities.size(); i++)
-        for(std::size_t j = 0; j < entities[i]->getNumMeshElements(); j++) {
-          MElement *e = entities[i]->getMeshElement(j);
-          _elementMapCache[e->getNum()] = std::make_pair(e, entities[i]->tag());
+      // no rehashing, so that insertions can be done concurrently
+      _elementMapCache.reserve(numElements);
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads) \
+  reduction(|| : duplicates)
+      for(std::size_t c = 0; c < chunks.size() / 3; c++) {
+        GEntity *ge = entities[chunks[3 * c]];
+        for(std::size_t j = chunks[3 * c + 1]; j < chunks[3 * c + 2]; j++) {
+          MElement *e = ge->getMeshElement(j);
+          if(!_elementMapCache.insert(e->getNum(),
+                                      std::make_pair(e, ge->tag())))
+            duplicates = true;
+        }
+      }
+      if(duplicates) _elementMapCache.reserve(numElements);
+    }
+    if(duplicates) {
+      Msg::Debug("Duplicate element tags in cache");
+      for(auto ge : entities) {
+        for(std::size_t j = 0; j < ge->getNumMeshElements(); j++) {
+          MElement *e = ge->getMeshElement(j);
+          if(dense)
+            _elementVectorCache[e->getNum()] = std::make_pair(e, ge->tag());
+          else
+            _elementMapCache.set(e->getNum(), std::make_pair(e, ge->tag()));
         }
+      }
     }
   }
+#pragma omp flush
+#pragma omp atomic write
+  _elementCacheBuilt = true;
 }
 
-MVertex *GModel::getMeshVertexByTag(int n)
+void GModel::_checkMeshVertexCache()
 {
-  if(_vertexVectorCache.empty() && _vertexMapCache.empty()) {
-#pragma omp barrier
-#pragma omp single
-    {
+  // the cache is built by the first thread that needs it; the other threads
+  // wait in the critical section
+  bool built;
+#pragma omp atomic read
+  built = _vertexCacheBuilt;
+  if(built) return;
+#pragma omp critical(GModelVertexCache)
+  {
+#pragma omp atomic read
+    built = _vertexCacheBuilt;
+    if(!built) {
       Msg::Debug("Rebuilding mesh node cache");
-      rebuildMeshVertexCache();
+      // keep the cache if it has been filled directly by a mesh reader
+      rebuildMeshVertexCache(true);
     }
   }
+}
 
-  if(n < (int)_vertexVectorCache.size())
-    return _vertexVectorCache[n];
-  else
-    return _vertexMapCache[n];
+void GModel::_checkMeshElementCache()
+{
+  bool built;
+#pragma omp atomic read
+  built = _elementCacheBuilt;
+  if(built) return;
+#pragma omp critical(GModelElementCache)
+  {
+#pragma omp atomic read
+    built = _elementCacheBuilt;
+    if(!built) rebuildMeshElementCache(true);
+  }
+}
+
+MVertex *GModel::getMeshVertexByTag(std::size_t n)
+{
+  _checkMeshVertexCache();
+  return getMeshVertexByTagInCache(n);
+}
+
+MVertex *GModel::getMeshVertexByTagInCache(std::size_t n) const
+{
+  if(n < _vertexVectorCache.size()) return _vertexVectorCache[n];
+  MVertex *const *v = _vertexMapCache.find(n);
+  return v ? *v : nullptr;
 }
 
 void GModel::addMVertexToVertexCache(MVertex* v)
 {
-  if(_vertexVectorCache.empty() && _vertexMapCache.empty()) {
-    Msg::Debug("Rebuilding mesh node cache");
-    rebuildMeshVertexCache();
-  }
+  _checkMeshVertexCache();
   if (_vertexVectorCache.size() > 0) {
 #pragma omp critical
     if (v->getNum() >= _vertexVectorCache.size()) {
@@ -1974,7 +2455,7 @@ void GModel::addMVertexToVertexCache(MVertex* v)
     }
     _vertexVectorCache[v->getNum()] = v;
   } else {
-    _vertexMapCache[v->getNum()] = v;
+    _vertexMapCache.set(v->getNum(), v);
   }
 }
 
@@ -1998,24 +2479,16 @@ void GModel::getMeshVerticesForPhysicalGroup(int dim, int num,
   v.insert(v.begin(), sv.begin(), sv.end());
 }
 
-MElement *GModel::getMeshElementByTag(int n, int &entityTag)
+MElement *GModel::getMeshElementByTag(std::size_t n, int &entityTag)
 {
-  if(_elementVectorCache.empty() && _elementMapCache.empty()) {
-#pragma omp barrier
-#pragma omp single
-    {
-      Msg::Debug("Rebuilding mesh element cache");
-      rebuildMeshElementCache();
-    }
+  _checkMeshElementCache();
+  if(n < _elementVectorCache.size()) {
+    entityTag = _elementVectorCache[n].second;
+    return _elementVectorCache[n].first;
   }
-
-  std::pair<MElement*, int> ret;
-  if(n < (int)_elementVectorCache.size())
-    ret = _elementVectorCache[n];
-  else
-    ret = _elementMapCache[n];
-  entityTag = ret.second;
-  return ret.first;
+  const std::pair<MElement *, int> *e = _elementMapCache.find(n);
+  entityTag = e ? e->second : 0;
+  return e ? e->first : nullptr;
 }
 
 int GModel::getMeshElementIndex(MElement *e)
@@ -2502,6 +2975,28 @@ void GModel::_storeVerticesInEntities(std::map<int, MVertex *> &vertices)
   }
 }
 
+void GModel::_storeVerticesInEntities(TagHashTable<MVertex *> &vertices)
+{
+  // store the vertices in the order of their tags, as with a map
+  std::vector<std::pair<std::size_t, MVertex **> > sorted;
+  sorted.reserve(vertices.size());
+  vertices.forEach([&sorted](std::size_t num, MVertex *&v) {
+    sorted.push_back(std::make_pair(num, &v));
+  });
+  std::sort(sorted.begin(), sorted.end());
+  for(std::size_t i = 0; i < sorted.size(); i++) {
+    MVertex *v = *sorted[i].second;
+    if(!v) continue;
+    GEntity *ge = v->onWhat();
+    if(ge)
+      ge->mesh_vertices.push_back(v);
+    else {
+      delete v; // we delete all unused vertices
+      *sorted[i].second = nullptr;
+    }
+  }
+}
+
 void GModel::_storeVerticesInEntities(std::vector<MVertex *> &vertices)
 {
   for(std::size_t i = 0; i < vertices.size(); i++) {
@@ -2675,6 +3170,41 @@ void GModel::checkMeshCoherence(double tolerance)
   Msg::StatusBar(true, "Done checking mesh coherence");
 }
 
+// sort v in parallel: chunks are sorted independently and then merged pairwise
+template <class T> static void parallelSort(std::vector<T> &v, int nthreads)
+{
+  std::size_t numChunks = 1;
+  while((int)numChunks < nthreads && 10000 * numChunks < v.size())
+    numChunks *= 2;
+  std::vector<std::size_t> bounds(numChunks + 1);
+  for(std::size_t c = 0; c <= numChunks; c++)
+    bounds[c] = v.size() * c / numChunks;
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t c = 0; c < numChunks; c++)
+    std::sort(v.begin() + bounds[c], v.begin() + bounds[c + 1]);
+  for(std::size_t step = 1; step < numChunks; step *= 2) {
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+    for(std::size_t c = 0; c < numChunks; c += 2 * step)
+      std::inplace_merge(v.begin() + bounds[c], v.begin() + bounds[c + step],
+                         v.begin() + bounds[std::min(c + 2 * step, numChunks)]);
+  }
+}
+
+// interleave the bits of 3 integers of (at most) 21 bits
+static uint64_t mortonKey(uint64_t i, uint64_t j, uint64_t k)
+{
+  auto spread = [](uint64_t x) {
+    x &= 0x1fffff;
+    x = (x | x << 32) & 0x1f00000000ffffULL;
+    x = (x | x << 16) & 0x1f0000ff0000ffULL;
+    x = (x | x << 8) & 0x100f00f00f00f00fULL;
+    x = (x | x << 4) & 0x10c30c30c30c30c3ULL;
+    x = (x | x << 2) & 0x1249249249249249ULL;
+    return x;
+  };
+  return spread(i) | (spread(j) << 1) | (spread(k) << 2);
+}
+
 int GModel::removeDuplicateMeshVertices(double tolerance,
                                         const std::vector<GEntity*> &ents)
 {
@@ -2692,84 +3222,183 @@ int GModel::removeDuplicateMeshVertices(double tolerance,
   // re-index all vertices (don't use MVertex::getNum(), as we want to be able
   // to remove duplicate vertices from "incorrect" meshes, where vertices with
   // the same number are duplicated)
-  int n = 0;
+  std::vector<MVertex *> all;
   for(std::size_t i = 0; i < entities.size(); i++) {
     GEntity *ge = entities[i];
     for(std::size_t j = 0; j < ge->mesh_vertices.size(); j++) {
       MVertex *v = ge->mesh_vertices[j];
-      v->setIndex(++n);
+      all.push_back(v);
+      v->setIndex(all.size());
     }
   }
+  std::size_t n = all.size();
+  if(!n) {
+    Msg::Info("No duplicate nodes found");
+    return 0;
+  }
 
-  MVertexRTree pos(eps);
-  std::map<int, MVertex *> vertices;
-  std::map<MVertex *, MVertex *> duplicates;
-  for(std::size_t i = 0; i < entities.size(); i++) {
-    GEntity *ge = entities[i];
-    for(std::size_t j = 0; j < ge->mesh_vertices.size(); j++) {
-      MVertex *v = ge->mesh_vertices[j];
-      MVertex *v2 = pos.insert(v);
-      if(v2)
-        duplicates[v] = v2; // v should be removed
-      else
-        vertices[v->getIndex()] = v;
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+
+  // a node is a duplicate of a previous node if their bounding boxes of size
+  // eps overlap, i.e. if their coordinates differ by at most 2 * eps (as with
+  // an MVertexRTree): sort the nodes in cells of size h >= 2 * eps, with at
+  // most 2^20 cells in each direction of the bounding box of the nodes (so
+  // that the cell indices and their neighbors fit in the 21 bits of the
+  // Morton keys), along a Morton curve
+  SBoundingBox3d box;
+  for(std::size_t i = 0; i < n; i++) box += all[i]->point();
+  SPoint3 pmin = box.min(), pmax = box.max();
+  double size = std::max(std::max(pmax.x() - pmin.x(), pmax.y() - pmin.y()),
+                         pmax.z() - pmin.z());
+  double dist = 2 * eps, h = std::max(dist, size / (1 << 20));
+  if(h <= 0.) h = 1.; // all the nodes coincide
+  const uint64_t maxCell = (1 << 20);
+  auto cell = [&pmin, h, maxCell](const SPoint3 &p, int d) -> uint64_t {
+    double c = std::floor((p[d] - pmin[d]) / h);
+    return c <= 0. ? 0 : std::min((uint64_t)c, maxCell);
+  };
+  std::vector<std::pair<uint64_t, std::size_t> > sorted(n);
+#pragma omp parallel for schedule(dynamic, 10000) num_threads(nthreads)
+  for(std::size_t i = 0; i < n; i++) {
+    SPoint3 p = all[i]->point();
+    sorted[i] = std::make_pair(mortonKey(cell(p, 0), cell(p, 1), cell(p, 2)),
+                               i);
+  }
+  parallelSort(sorted, nthreads);
+  std::vector<std::size_t> cellStart;
+  for(std::size_t i = 0; i < n; i++)
+    if(!i || sorted[i].first != sorted[i - 1].first) cellStart.push_back(i);
+  cellStart.push_back(n);
+
+  // earlier neighbors of each node (nodes with a smaller index within the
+  // tolerance), in compressed row storage, by increasing index
+  std::vector<std::size_t> ptr(n + 1, 0), adj;
+  for(int pass = 0; pass < 2; pass++) {
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+    for(std::size_t c = 0; c < cellStart.size() - 1; c++) {
+      uint64_t key = sorted[cellStart[c]].first;
+      for(std::size_t s = cellStart[c]; s < cellStart[c + 1]; s++) {
+        std::size_t i = sorted[s].second;
+        SPoint3 p = all[i]->point();
+        // neighboring cells that can contain a node within the tolerance
+        int range[3][2];
+        uint64_t ci[3];
+        for(int d = 0; d < 3; d++) {
+          ci[d] = cell(p, d);
+          double x = p[d] - pmin[d] - ci[d] * h;
+          range[d][0] = (ci[d] > 0 && x <= 1.01 * dist) ? -1 : 0;
+          range[d][1] = (ci[d] < maxCell && h - x <= 1.01 * dist) ? 1 : 0;
+        }
+        std::size_t num = 0;
+        for(int dx = range[0][0]; dx <= range[0][1]; dx++) {
+          for(int dy = range[1][0]; dy <= range[1][1]; dy++) {
+            for(int dz = range[2][0]; dz <= range[2][1]; dz++) {
+              std::size_t start = cellStart[c], end = cellStart[c + 1];
+              if(dx || dy || dz) {
+                uint64_t k = mortonKey(ci[0] + dx, ci[1] + dy, ci[2] + dz);
+                if(k == key) continue;
+                auto it = std::lower_bound(sorted.begin(), sorted.end(),
+                                           std::make_pair(k, (std::size_t)0));
+                if(it == sorted.end() || it->first != k) continue;
+                start = it - sorted.begin();
+                auto ce = std::upper_bound(cellStart.begin(), cellStart.end(),
+                                           start);
+                end = *ce;
+              }
+              for(std::size_t t = start; t < end; t++) {
+                std::size_t j = sorted[t].second;
+                if(j >= i) continue;
+                SPoint3 q = all[j]->point();
+                if(std::abs(p.x() - q.x()) <= dist &&
+                   std::abs(p.y() - q.y()) <= dist &&
+                   std::abs(p.z() - q.z()) <= dist) {
+                  if(pass == 1) adj[ptr[i] + num] = j;
+                  num++;
+                }
+              }
+            }
+          }
+        }
+        if(pass == 0)
+          ptr[i + 1] = num;
+        else
+          std::sort(adj.begin() + ptr[i], adj.begin() + ptr[i] + num);
+      }
+    }
+    if(pass == 0) {
+      for(std::size_t i = 0; i < n; i++) ptr[i + 1] += ptr[i];
+      adj.resize(ptr[n]);
     }
   }
 
-  int num = (int)duplicates.size();
-  Msg::Info("Found %d duplicate nodes ", num);
+  // a node is kept if none of its earlier neighbors is kept, and is otherwise
+  // replaced by its first kept neighbor; this only requires a sequential pass
+  // over the nodes that have earlier neighbors
+  std::vector<MVertex *> replace(n, nullptr);
+  std::size_t num = 0;
+  for(std::size_t i = 0; i < n; i++) {
+    for(std::size_t k = ptr[i]; k < ptr[i + 1]; k++) {
+      if(!replace[adj[k]]) {
+        replace[i] = all[adj[k]];
+        num++;
+        break;
+      }
+    }
+  }
+  Msg::Info("Found %lu duplicate nodes ", (unsigned long)num);
 
   if(!num) {
     Msg::Info("No duplicate nodes found");
     return 0;
   }
 
+  // node replacing v (or nullptr), for nodes that might not belong to the
+  // entities
+  auto duplicate = [&all, &replace, n](MVertex *v) -> MVertex * {
+    std::size_t i = v->getIndex() - 1;
+    if(v->getIndex() > 0 && i < n && all[i] == v) return replace[i];
+    return nullptr;
+  };
+
   for(std::size_t i = 0; i < entities.size(); i++) {
     GEntity *ge = entities[i];
     // clear list of vertices owned by entity
     ge->mesh_vertices.clear();
     // replace vertices in element
+#pragma omp parallel for schedule(dynamic, 1000) num_threads(nthreads)
     for(std::size_t j = 0; j < ge->getNumMeshElements(); j++) {
       MElement *e = ge->getMeshElement(j);
       for(std::size_t k = 0; k < e->getNumVertices(); k++) {
-        auto it = duplicates.find(e->getVertex(k));
-        if(it != duplicates.end()) e->setVertex(k, it->second);
+        MVertex *v = duplicate(e->getVertex(k));
+        if(v) e->setVertex(k, v);
       }
     }
     // replace vertices in periodic copies
-    std::map<MVertex *, MVertex *, MVertexPtrLessThan> &corrVtcs = ge->correspondingVertices;
+    std::map<MVertex *, MVertex *, MVertexPtrLessThan> &corrVtcs =
+      ge->correspondingVertices;
     if(corrVtcs.size()) {
-      std::map<MVertex *, MVertex *>::iterator cIter;
-      for(cIter = duplicates.begin(); cIter != duplicates.end(); ++cIter) {
-        MVertex *oldTgt = cIter->first;
-        MVertex *newTgt = cIter->second;
-        auto cvIter = corrVtcs.find(oldTgt);
-        if(cvIter != corrVtcs.end()) {
-          MVertex *src = cvIter->second;
-          corrVtcs.erase(cvIter);
-          corrVtcs[newTgt] = src;
-        }
-      }
-      for(cIter = corrVtcs.begin(); cIter != corrVtcs.end(); ++cIter) {
-        MVertex *oldSrc = cIter->second;
-        auto nIter = duplicates.find(oldSrc);
-        if(nIter != duplicates.end()) {
-          MVertex *tgt = cIter->first;
-          MVertex *newSrc = nIter->second;
-          corrVtcs[tgt] = newSrc;
-        }
+      std::map<MVertex *, MVertex *, MVertexPtrLessThan> newCorrVtcs;
+      for(auto it = corrVtcs.begin(); it != corrVtcs.end(); ++it) {
+        MVertex *tgt = duplicate(it->first), *src = duplicate(it->second);
+        newCorrVtcs[tgt ? tgt : it->first] = src ? src : it->second;
       }
+      corrVtcs.swap(newCorrVtcs);
     }
   }
 
   destroyMeshCaches();
   _associateEntityWithMeshVertices();
+  std::vector<MVertex *> vertices(n), to_delete;
+  for(std::size_t i = 0; i < n; i++) {
+    if(replace[i])
+      to_delete.push_back(all[i]);
+    else
+      vertices[i] = all[i];
+  }
   _storeVerticesInEntities(vertices);
 
   // delete duplicates
-  std::vector<MVertex *> to_delete;
-  for(auto it = duplicates.begin(); it != duplicates.end(); it++)
-    to_delete.push_back(it->first);
   for(std::size_t i = 0; i < to_delete.size(); i++) delete to_delete[i];
 
   if(CTX::instance()->mesh.renumber) {
@@ -2777,7 +3406,8 @@ int GModel::removeDuplicateMeshVertices(double tolerance,
   }
 
   if(num)
-    Msg::Info("Removed %d duplicate mesh node%s", num, num > 1 ? "s" : "");
+    Msg::Info("Removed %lu duplicate mesh node%s", (unsigned long)num,
+              num > 1 ? "s" : "");
 
   Msg::StatusBar(true, "Done removing duplicate mesh nodes");
   return num;
@@ -2787,24 +3417,63 @@ int GModel::removeDuplicateMeshElements(const std::vector<GEntity*> &ents)
 {
   Msg::StatusBar(true, "Removing duplicate mesh elements...");
 
-  // this removes elements that have the same nodes (in the same entity)
+  // this removes elements that have the same nodes (in the same entity): the
+  // elements are sorted by a hash of their sorted nodes, and the elements with
+  // the same hash are compared; the first of a set of duplicates is kept
   std::vector<GEntity*> entities(ents);
   if(entities.empty()) getEntities(entities);
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
   int num = 0;
   for(auto &e : entities) {
     std::vector<int> types;
     e->getElementTypes(types);
     for(auto t : types) {
-      std::set<MElement*, MElementPtrLessThanVertices> uniq;
-      for(std::size_t i = 0; i < e->getNumMeshElementsByType(t); i++) {
-        MElement *ele = e->getMeshElementByType(t, i);
-        uniq.insert(ele);
+      std::size_t n = e->getNumMeshElementsByType(t);
+      if(n < 2) continue;
+      std::vector<std::pair<uint64_t, std::size_t> > sorted(n);
+#pragma omp parallel num_threads(nthreads)
+      {
+        std::vector<MVertex *> v;
+#pragma omp for schedule(dynamic, 1000)
+        for(std::size_t i = 0; i < n; i++) {
+          e->getMeshElementByType(t, i)->getVertices(v);
+          std::sort(v.begin(), v.end());
+          uint64_t hash = 14695981039346656037ULL;
+          for(auto p : v)
+            hash = (hash ^ (uint64_t)(uintptr_t)p) * 1099511628211;
+          sorted[i] = std::make_pair(hash, i);
+        }
+      }
+      parallelSort(sorted, nthreads);
+      std::vector<char> duplicate(n, 0);
+      int diff = 0;
+      for(std::size_t s = 0, end = 0; s < n; s = end) {
+        end = s + 1;
+        while(end < n && sorted[end].first == sorted[s].first) end++;
+        // elements in a run are sorted by index: compare each with the
+        // previous ones that are not duplicates
+        MElementPtrLessThanVertices less;
+        for(std::size_t i = s + 1; i < end; i++) {
+          MElement *ei = e->getMeshElementByType(t, sorted[i].second);
+          for(std::size_t j = s; j < i; j++) {
+            if(duplicate[sorted[j].second]) continue;
+            MElement *ej = e->getMeshElementByType(t, sorted[j].second);
+            if(!less(ei, ej) && !less(ej, ei)) {
+              duplicate[sorted[i].second] = 1;
+              diff++;
+              break;
+            }
+          }
+        }
       }
-      int diff = e->getNumMeshElementsByType(t) - uniq.size();
       if(diff > 0) {
         num += diff;
         Msg::Info("Removed %d duplicate element%s in entity %d of dimension %d",
                   diff, diff > 1 ? "s" : "", e->tag(), e->dim());
+        std::vector<MElement *> uniq;
+        for(std::size_t i = 0; i < n; i++)
+          if(!duplicate[i]) uniq.push_back(e->getMeshElementByType(t, i));
         e->removeElements(t);
         for(auto ele : uniq) e->addElement(t, ele);
       }
@@ -21,6 +21,7 @@
 #include "SBoundingBox3d.h"
 #include "MFaceHash.h"
 #include "MEdgeHash.h"
+#include "TagHashTable.h"
 
 #define hashmapMFace                                                           \
   std::unordered_map<MFace, std::size_t, MFaceHash, MFaceEqual>
@@ -96,11 +97,17 @@ protected:
   char _visible;
 
   // vertex and element caches to speed-up direct access by tag (mostly
-  // used for post-processing I/O)
+  // used for post-processing I/O): vectors indexed by tag if the numbering is
+  // dense enough, hash tables otherwise
   std::vector<MVertex *> _vertexVectorCache;
-  std::map<int, MVertex *> _vertexMapCache;
+  TagHashTable<MVertex *> _vertexMapCache;
   std::vector<std::pair<MElement *, int> > _elementVectorCache;
-  std::map<int, std::pair<MElement *, int> > _elementMapCache;
+  TagHashTable<std::pair<MElement *, int> > _elementMapCache;
+  // set once the caches are complete, so that they can be built on demand by
+  // concurrent lookups
+  bool _vertexCacheBuilt, _elementCacheBuilt;
+  void _checkMeshVertexCache();
+  void _checkMeshElementCache();
   std::map<int, int> _elementIndexCache;
 
   // ghost cell information (stores partitions for each element acting
@@ -110,6 +117,7 @@ protected:
 
   // an octree for fast mesh element lookup
   MElementOctree *_elementOctree;
+  MElementOctree *_getElementOctree();
 
   // global cache storage of discrete curvatures
   std::map<MVertex *, std::pair<SVector3, SVector3> > _curvatures;
@@ -167,6 +175,7 @@ protected:
   // store the vertices in the geometrical entity they are associated
   // with, and delete those that are not associated with any entity
   void _storeVerticesInEntities(std::map<int, MVertex *> &vertices);
+  void _storeVerticesInEntities(TagHashTable<MVertex *> &vertices);
   void _storeVerticesInEntities(std::vector<MVertex *> &vertices);
 
   // store the physical tags in the geometrical entities
@@ -284,9 +293,10 @@ public:
   hashmapMFace::const_iterator lastMFace() { return _mapFaceNum.end(); }
 
   // renumber mesh vertices and elements in a continuous sequence (this
-  // invalidates the mesh caches)
-  void renumberMeshVertices();
-  void renumberMeshElements();
+  // invalidates the mesh caches), using the given method (see the
+  // Mesh.RenumberMethod option; -1 to use the value of the option)
+  void renumberMeshVertices(int method = -1);
+  void renumberMeshElements(int method = -1);
 
   // delete all the mesh-related caches (this must be called when the
   // mesh is changed)
@@ -530,13 +540,14 @@ public:
   std::vector<MElement *> getMeshElementsByCoord(SPoint3 &p, int dim = -1,
                                                  bool strict = true);
 
-  // access a mesh element by tag, using the element cache
-  MElement *getMeshElementByTag(int n)
+  // access a mesh element by tag, using the element cache (which is built if
+  // necessary); can be called concurrently
+  MElement *getMeshElementByTag(std::size_t n)
   {
     int tag;
     return getMeshElementByTag(n, tag);
   }
-  MElement *getMeshElementByTag(int n, int &entityTag);
+  MElement *getMeshElementByTag(std::size_t n, int &entityTag);
 
   // access temporary mesh element index
   int getMeshElementIndex(MElement *e);
@@ -546,15 +557,21 @@ public:
   std::size_t getNumMeshVertices(int dim = -1) const;
 
   // recompute _vertexVectorCache if there is a dense vertex numbering or
-  // _vertexMapCache if not.
+  // _vertexMapCache if not (in parallel); call this before a parallel section
+  // to avoid building the cache on demand in the first lookup
   void rebuildMeshVertexCache(bool onlyIfNecessary = false);
 
   // recompute _elementVectorCache if there is a dense element numbering or
-  // _elementMapCache if not.
+  // _elementMapCache if not (in parallel)
   void rebuildMeshElementCache(bool onlyIfNecessary = false);
 
-  // access a mesh vertex by tag, using the vertex cache
-  MVertex *getMeshVertexByTag(int n);
+  // access a mesh vertex by tag, using the vertex cache (which is built if
+  // necessary); can be called concurrently
+  MVertex *getMeshVertexByTag(std::size_t n);
+
+  // same as getMeshVertexByTag, but never modifies the cache (which should thus
+  // be up-to-date); can be called concurrently
+  MVertex *getMeshVertexByTagInCache(std::size_t n) const;
 
   // add a mesh vertex to the global mesh vertex cache
   void addMVertexToVertexCache(MVertex* v);
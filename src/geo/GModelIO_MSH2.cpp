@@ -611,8 +611,11 @@ int GModel::_readMSH2(const std::string &name)
       // cache the vertex indexing data
       if(vertexVector.size())
         _vertexVectorCache = vertexVector;
-      else
-        _vertexMapCache = vertexMap;
+      else {
+        _vertexMapCache.reserve(vertexMap.size());
+        for(auto it = vertexMap.begin(); it != vertexMap.end(); ++it)
+          _vertexMapCache.insert(it->first, it->second);
+      }
       postpro = true;
       break;
     }
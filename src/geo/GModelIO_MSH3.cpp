@@ -407,9 +407,9 @@ int GModel::_readMSH3(const std::string &name)
         }
         minVertex = std::min(minVertex, num);
         maxVertex = std::max(maxVertex, num);
-        if(_vertexMapCache.count(num))
+        if(_vertexMapCache.find(num))
           Msg::Warning("Skipping duplicate node %d", num);
-        _vertexMapCache[num] = vertex;
+        _vertexMapCache.set(num, vertex);
         if(numVertices > 100000)
           Msg::ProgressMeter(i + 1, true, "Reading nodes");
       }
@@ -425,8 +425,9 @@ int GModel::_readMSH3(const std::string &name)
           _vertexVectorCache[0] = nullptr;
         else
           _vertexVectorCache[numVertices] = nullptr;
-        for(auto it = _vertexMapCache.begin(); it != _vertexMapCache.end(); ++it)
-          _vertexVectorCache[it->first] = it->second;
+        _vertexMapCache.forEach([this](std::size_t num, MVertex *v) {
+          _vertexVectorCache[num] = v;
+        });
         _vertexMapCache.clear();
       }
     }
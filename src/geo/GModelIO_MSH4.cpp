@@ -16,6 +16,8 @@
 #include <cstdlib>
 #include <limits>
 #include <stdexcept>
+#include <memory>
+#include <cstring>
 
 #include "GmshDefines.h"
 #include "OS.h"
@@ -41,6 +43,13 @@
 #include "MTrihedron.h"
 #include "StringUtils.h"
 
+#if !defined(WIN32) || defined(__CYGWIN__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 static bool readMSH4Physicals(GModel *const model, FILE *fp,
                               GEntity *const entity, bool binary, char *str,
                               bool swap)
@@ -459,6 +468,69 @@ static bool readMSH4Entities(GModel *const model, FILE *fp, bool partition,
   return true;
 }
 
+static GEntity *getOrCreateMSH4Entity(GModel *const model, int entityDim,
+                                      int entityTag)
+{
+  GEntity *entity = model->getEntityByTag(entityDim, entityTag);
+  if(entity) return entity;
+  switch(entityDim) {
+  case 0: {
+    Msg::Info("Creating discrete point %d", entityTag);
+    GVertex *gv = new discreteVertex(model, entityTag);
+    GModel::current()->add(gv);
+    return gv;
+  }
+  case 1: {
+    Msg::Info("Creating discrete curve %d", entityTag);
+    GEdge *ge = new discreteEdge(model, entityTag, nullptr, nullptr);
+    GModel::current()->add(ge);
+    return ge;
+  }
+  case 2: {
+    Msg::Info("Creating discrete surface %d", entityTag);
+    GFace *gf = new discreteFace(model, entityTag);
+    GModel::current()->add(gf);
+    return gf;
+  }
+  case 3: {
+    Msg::Info("Creating discrete volume %d", entityTag);
+    GRegion *gr = new discreteRegion(model, entityTag);
+    GModel::current()->add(gr);
+    return gr;
+  }
+  default:
+    Msg::Error("Invalid dimension %d to create discrete entity", entityDim);
+    return nullptr;
+  }
+}
+
+static std::size_t getMSH4NodeSize(std::size_t n)
+{
+  if(n == 5) return sizeof(MFaceVertex);
+  if(n == 4) return sizeof(MEdgeVertex);
+  return sizeof(MVertex);
+}
+
+// create the j-th node of a block of nodes with n coordinates (3 cartesian +
+// parametric ones): in place if memory was allocated for the block (see
+// MVertexBlock), on the heap otherwise
+static MVertex *createMSH4Node(char *block, std::size_t j, const double *c,
+                               std::size_t n, GEntity *entity, std::size_t tag)
+{
+  void *p = block ? block + j * getMSH4NodeSize(n) : nullptr;
+  if(n == 5) {
+    if(p)
+      return ::new(p) MFaceVertex(c[0], c[1], c[2], entity, c[3], c[4], tag);
+    return new MFaceVertex(c[0], c[1], c[2], entity, c[3], c[4], tag);
+  }
+  else if(n == 4) {
+    if(p) return ::new(p) MEdgeVertex(c[0], c[1], c[2], entity, c[3], tag);
+    return new MEdgeVertex(c[0], c[1], c[2], entity, c[3], tag);
+  }
+  if(p) return ::new(p) MVertex(c[0], c[1], c[2], entity, tag);
+  return new MVertex(c[0], c[1], c[2], entity, tag);
+}
+
 static std::pair<std::size_t, MVertex *> *
 readMSH4Nodes(GModel *const model, FILE *fp, bool binary, bool &dense,
               std::size_t &totalNumNodes, std::size_t &maxNodeNum, bool swap,
@@ -539,43 +611,10 @@ readMSH4Nodes(GModel *const model, FILE *fp, bool binary, bool &dense,
       }
     }
 
-    GEntity *entity = model->getEntityByTag(entityDim, entityTag);
+    GEntity *entity = getOrCreateMSH4Entity(model, entityDim, entityTag);
     if(!entity) {
-      switch(entityDim) {
-      case 0: {
-        Msg::Info("Creating discrete point %d", entityTag);
-        GVertex *gv = new discreteVertex(model, entityTag);
-        GModel::current()->add(gv);
-        entity = gv;
-        break;
-      }
-      case 1: {
-        Msg::Info("Creating discrete curve %d", entityTag);
-        GEdge *ge = new discreteEdge(model, entityTag, nullptr, nullptr);
-        GModel::current()->add(ge);
-        entity = ge;
-        break;
-      }
-      case 2: {
-        Msg::Info("Creating discrete surface %d", entityTag);
-        GFace *gf = new discreteFace(model, entityTag);
-        GModel::current()->add(gf);
-        entity = gf;
-        break;
-      }
-      case 3: {
-        Msg::Info("Creating discrete volume %d", entityTag);
-        GRegion *gr = new discreteRegion(model, entityTag);
-        GModel::current()->add(gr);
-        entity = gr;
-        break;
-      }
-      default: {
-        Msg::Error("Invalid dimension %d to create discrete entity", entityDim);
-        delete[] vertexCache;
-        return nullptr;
-      }
-      }
+      delete[] vertexCache;
+      return nullptr;
     }
 
     std::size_t n = 3;
@@ -594,22 +633,11 @@ readMSH4Nodes(GModel *const model, FILE *fp, bool binary, bool &dense,
         return nullptr;
       }
       if(swap) SwapBytes((char *)&coord[0], sizeof(double), n * numNodes);
+      char *block = MVertexBlock::allocate(getMSH4NodeSize(n), numNodes);
       std::size_t k = 0;
       for(std::size_t j = 0; j < numNodes; j++) {
-        MVertex *mv = nullptr;
         std::size_t tagNode = tags[j];
-        if(n == 5) {
-          mv = new MFaceVertex(coord[k], coord[k + 1], coord[k + 2], entity,
-                               coord[k + 3], coord[k + 4], tagNode);
-        }
-        else if(n == 4) {
-          mv = new MEdgeVertex(coord[k], coord[k + 1], coord[k + 2], entity,
-                               coord[k + 3], tagNode);
-        }
-        else {
-          mv =
-            new MVertex(coord[k], coord[k + 1], coord[k + 2], entity, tagNode);
-        }
+        MVertex *mv = createMSH4Node(block, j, &coord[k], n, entity, tagNode);
         k += n;
         entity->addMeshVertex(mv);
         mv->setEntity(entity);
@@ -938,6 +966,377 @@ readMSH4Elements(GModel *const model, FILE *fp, bool binary, bool &dense,
   return elementCache;
 }
 
+// Read-only memory mapping of a mesh file: large binary node and element
+// blocks are decoded concurrently, directly from the mapped data
+class MSH4MappedFile {
+private:
+  const char *_data;
+  std::size_t _size;
+
+public:
+  MSH4MappedFile(const std::string &name) : _data(nullptr), _size(0)
+  {
+#if !defined(WIN32) || defined(__CYGWIN__)
+    int fd = open(name.c_str(), O_RDONLY);
+    if(fd < 0) return;
+    struct stat st;
+    if(!fstat(fd, &st) && st.st_size > 0) {
+      void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if(p != MAP_FAILED) {
+        _data = (const char *)p;
+        _size = st.st_size;
+      }
+    }
+    close(fd);
+#endif
+  }
+  ~MSH4MappedFile()
+  {
+#if !defined(WIN32) || defined(__CYGWIN__)
+    if(_data) munmap((void *)_data, _size);
+#endif
+  }
+  bool valid() const { return _data != nullptr; }
+  std::size_t size() const { return _size; }
+  // copy num items of the given size, starting at offset
+  bool read(std::size_t offset, void *dst, std::size_t size,
+            std::size_t num) const
+  {
+    if(offset + size * num > _size) return false;
+    memcpy(dst, _data + offset, size * num);
+    return true;
+  }
+};
+
+// number of threads used to decode or encode binary node and element blocks
+static int getNumIOThreads()
+{
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+  return nthreads;
+}
+
+// a contiguous range of nodes or elements of a block, decoded by one thread
+struct MSH4Chunk {
+  std::size_t block, first, num, index;
+};
+
+static void makeMSH4Chunks(const std::vector<std::size_t> &blockSizes,
+                           std::vector<MSH4Chunk> &chunks)
+{
+  const std::size_t chunkSize = 65536;
+  std::size_t index = 0;
+  for(std::size_t i = 0; i < blockSizes.size(); i++) {
+    for(std::size_t first = 0; first < blockSizes[i]; first += chunkSize) {
+      MSH4Chunk c;
+      c.block = i;
+      c.first = first;
+      c.num = std::min(chunkSize, blockSizes[i] - first);
+      c.index = index + first;
+      chunks.push_back(c);
+    }
+    index += blockSizes[i];
+  }
+}
+
+static bool isDenseNumbering(std::size_t minNum, std::size_t maxNum,
+                             std::size_t num)
+{
+  // if the numbering is (fairly) dense, we fill the vector cache, otherwise we
+  // fill the map cache
+  return (minNum == 1 && maxNum == num) || maxNum < 10 * num;
+}
+
+static std::pair<std::size_t, MVertex *> *
+readMSH4NodesParallel(GModel *const model, FILE *fp, const MSH4MappedFile &mf,
+                      bool &dense, std::size_t &totalNumNodes,
+                      std::size_t &maxNodeNum, bool swap, int nthreads)
+{
+  double t1 = TimeOfDay();
+  long start = ftell(fp);
+  std::size_t numBlock = 0, minTag = 0, maxTag = 0;
+  totalNumNodes = 0;
+  maxNodeNum = 0;
+
+  std::size_t data[4];
+  if(fread(data, sizeof(std::size_t), 4, fp) != 4) { return nullptr; }
+  if(swap) SwapBytes((char *)data, sizeof(std::size_t), 4);
+  numBlock = data[0];
+  totalNumNodes = data[1];
+  minTag = data[2];
+  maxTag = data[3];
+
+  // first pass: index the blocks (and create the missing entities) without
+  // reading the nodes
+  std::vector<GEntity *> entities(numBlock);
+  std::vector<std::size_t> numCoord(numBlock), offsets(numBlock);
+  std::vector<std::size_t> blockSizes(numBlock);
+  std::vector<char *> blocks(numBlock, nullptr);
+  for(std::size_t i = 0; i < numBlock; i++) {
+    int data[3];
+    std::size_t numNodes = 0;
+    if(fread(data, sizeof(int), 3, fp) != 3) return nullptr;
+    if(swap) SwapBytes((char *)data, sizeof(int), 3);
+    if(fread(&numNodes, sizeof(std::size_t), 1, fp) != 1) return nullptr;
+    if(swap) SwapBytes((char *)&numNodes, sizeof(std::size_t), 1);
+    entities[i] = getOrCreateMSH4Entity(model, data[0], data[1]);
+    if(!entities[i]) return nullptr;
+    numCoord[i] = 3 + (data[2] ? data[0] : 0);
+    offsets[i] = ftell(fp);
+    blockSizes[i] = numNodes;
+    std::size_t size = numNodes * (sizeof(std::size_t) +
+                                   numCoord[i] * sizeof(double));
+    if(offsets[i] + size > mf.size() || fseek(fp, size, SEEK_CUR))
+      return nullptr;
+  }
+  std::size_t end = ftell(fp);
+
+  std::vector<MSH4Chunk> chunks;
+  makeMSH4Chunks(blockSizes, chunks);
+  for(std::size_t i = 0; i < numBlock; i++)
+    blocks[i] = MVertexBlock::allocate(getMSH4NodeSize(numCoord[i]),
+                                       blockSizes[i]);
+  std::size_t numNodes = 0;
+  for(std::size_t i = 0; i < numBlock; i++) numNodes += blockSizes[i];
+  if(numNodes != totalNumNodes) {
+    Msg::Error("Number of nodes in blocks (%lu) does not match section header "
+               "(%lu)", numNodes, totalNumNodes);
+    for(std::size_t i = 0; i < numBlock; i++)
+      if(blocks[i]) MVertexBlock::release(blocks[i], blockSizes[i]);
+    return nullptr;
+  }
+
+  std::pair<std::size_t, MVertex *> *vertexCache =
+    new std::pair<std::size_t, MVertex *>[totalNumNodes];
+  Msg::Info("%lu node%s", totalNumNodes, totalNumNodes > 1 ? "s" : "");
+
+  // second pass: decode the chunks concurrently
+  std::vector<std::size_t> minNum(chunks.size(), 0), maxNum(chunks.size(), 0);
+  std::vector<bool> ok(chunks.size(), false);
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t c = 0; c < chunks.size(); c++) {
+    const MSH4Chunk &ch = chunks[c];
+    GEntity *entity = entities[ch.block];
+    std::size_t n = numCoord[ch.block];
+    std::vector<std::size_t> tags(ch.num);
+    std::vector<double> coord(n * ch.num);
+    std::size_t tagOffset = offsets[ch.block] + ch.first * sizeof(std::size_t);
+    std::size_t coordOffset = offsets[ch.block] +
+                              blockSizes[ch.block] * sizeof(std::size_t) +
+                              ch.first * n * sizeof(double);
+    char *block = blocks[ch.block];
+    if(!mf.read(tagOffset, &tags[0], sizeof(std::size_t), ch.num) ||
+       !mf.read(coordOffset, &coord[0], sizeof(double), n * ch.num)) {
+      if(block)
+        MVertexBlock::release(block + ch.first * getMSH4NodeSize(n), ch.num);
+      continue;
+    }
+    if(swap) {
+      SwapBytes((char *)&tags[0], sizeof(std::size_t), ch.num);
+      SwapBytes((char *)&coord[0], sizeof(double), n * ch.num);
+    }
+    std::size_t tmin = std::numeric_limits<std::size_t>::max(), tmax = 0;
+    for(std::size_t j = 0, k = 0; j < ch.num; j++, k += n) {
+      std::size_t tagNode = tags[j];
+      MVertex *mv = createMSH4Node(block, ch.first + j, &coord[k], n, entity,
+                                   tagNode);
+      tmin = std::min(tmin, tagNode);
+      tmax = std::max(tmax, tagNode);
+      vertexCache[ch.index + j] = std::make_pair(tagNode, mv);
+    }
+    minNum[c] = tmin;
+    maxNum[c] = tmax;
+    ok[c] = true;
+  }
+
+  std::size_t minNodeNum = std::numeric_limits<std::size_t>::max();
+  bool success = true;
+  for(std::size_t c = 0; c < chunks.size(); c++) {
+    success &= ok[c];
+    minNodeNum = std::min(minNodeNum, minNum[c]);
+    maxNodeNum = std::max(maxNodeNum, maxNum[c]);
+  }
+  if(!success) {
+    for(std::size_t i = 0; i < totalNumNodes; i++)
+      if(vertexCache[i].second) delete vertexCache[i].second;
+    delete[] vertexCache;
+    return nullptr;
+  }
+
+  // add the nodes to the entities, in the order of the file
+  for(std::size_t i = 0, index = 0; i < numBlock; i++) {
+    for(std::size_t j = 0; j < blockSizes[i]; j++)
+      entities[i]->addMeshVertex(vertexCache[index++].second);
+  }
+  // concurrent updates of the max node number are not guaranteed to be
+  // ordered
+  model->setMaxVertexNumber(maxNodeNum);
+
+  if(minTag != minNodeNum || maxTag != maxNodeNum)
+    Msg::Warning("Min/Max node tags reported in section header are wrong: "
+                 "(%d/%d) != (%d/%d)",
+                 minTag, maxTag, minNodeNum, maxNodeNum);
+  dense = isDenseNumbering(minNodeNum, maxNodeNum, totalNumNodes);
+
+  double t2 = TimeOfDay();
+  double mb = (end - start) / 1024. / 1024.;
+  Msg::Info("Read %g Mb of nodes in %g seconds (%g Mb/s, %d threads)", mb,
+            t2 - t1, (t2 > t1) ? mb / (t2 - t1) : 0., nthreads);
+  return vertexCache;
+}
+
+static std::pair<std::size_t, std::pair<MElement *, int> > *
+readMSH4ElementsParallel(GModel *const model, FILE *fp,
+                         const MSH4MappedFile &mf, bool &dense,
+                         std::size_t &totalNumElements,
+                         std::size_t &maxElementNum, bool swap, int nthreads)
+{
+  double t1 = TimeOfDay();
+  long start = ftell(fp);
+  std::size_t numBlock = 0;
+  totalNumElements = 0;
+  maxElementNum = 0;
+
+  std::size_t data[4];
+  if(fread(data, sizeof(std::size_t), 4, fp) != 4) { return nullptr; }
+  if(swap) SwapBytes((char *)data, sizeof(std::size_t), 4);
+  numBlock = data[0];
+  totalNumElements = data[1];
+
+  // first pass: index the blocks without reading the elements
+  std::vector<GEntity *> entities(numBlock);
+  std::vector<int> types(numBlock), numVert(numBlock);
+  std::vector<std::size_t> offsets(numBlock), blockSizes(numBlock);
+  for(std::size_t i = 0; i < numBlock; i++) {
+    int data[3];
+    std::size_t numElements = 0;
+    if(fread(data, sizeof(int), 3, fp) != 3) return nullptr;
+    if(swap) SwapBytes((char *)data, sizeof(int), 3);
+    if(fread(&numElements, sizeof(std::size_t), 1, fp) != 1) return nullptr;
+    if(swap) SwapBytes((char *)&numElements, sizeof(std::size_t), 1);
+    GEntity *entity = model->getEntityByTag(data[0], data[1]);
+    if(!entity) {
+      Msg::Error("Unknown entity %d of dimension %d", data[1], data[0]);
+      return nullptr;
+    }
+    if(entity->geomType() == GEntity::GhostCurve) {
+      static_cast<ghostEdge *>(entity)->haveMesh(true);
+    }
+    else if(entity->geomType() == GEntity::GhostSurface) {
+      static_cast<ghostFace *>(entity)->haveMesh(true);
+    }
+    else if(entity->geomType() == GEntity::GhostVolume) {
+      static_cast<ghostRegion *>(entity)->haveMesh(true);
+    }
+    entities[i] = entity;
+    types[i] = data[2];
+    numVert[i] = MElement::getInfoMSH(data[2]);
+    offsets[i] = ftell(fp);
+    blockSizes[i] = numElements;
+    std::size_t size = numElements * (1 + numVert[i]) * sizeof(std::size_t);
+    if(offsets[i] + size > mf.size() || fseek(fp, size, SEEK_CUR))
+      return nullptr;
+  }
+  std::size_t end = ftell(fp);
+
+  std::vector<MSH4Chunk> chunks;
+  makeMSH4Chunks(blockSizes, chunks);
+  std::size_t numElements = 0;
+  for(std::size_t i = 0; i < numBlock; i++) numElements += blockSizes[i];
+  if(numElements != totalNumElements) {
+    Msg::Error("Number of elements in blocks (%lu) does not match section "
+               "header (%lu)", numElements, totalNumElements);
+    return nullptr;
+  }
+
+  std::pair<std::size_t, std::pair<MElement *, int> > *elementCache =
+    new std::pair<std::size_t, std::pair<MElement *, int> >[totalNumElements];
+  Msg::Info("%lu element%s", totalNumElements, totalNumElements > 1 ? "s" : "");
+
+  // second pass: decode the chunks concurrently; the node cache is up-to-date
+  // and is only read
+  std::vector<std::size_t> minNum(chunks.size(), 0), maxNum(chunks.size(), 0);
+  std::vector<bool> ok(chunks.size(), false);
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t c = 0; c < chunks.size(); c++) {
+    const MSH4Chunk &ch = chunks[c];
+    const int elmType = types[ch.block];
+    const int numVertPerElm = numVert[ch.block];
+    const int entityTag = entities[ch.block]->tag();
+    std::size_t n = 1 + numVertPerElm;
+    std::vector<std::size_t> data(ch.num * n);
+    if(!mf.read(offsets[ch.block] + ch.first * n * sizeof(std::size_t),
+                &data[0], sizeof(std::size_t), ch.num * n))
+      continue;
+    if(swap) SwapBytes((char *)&data[0], sizeof(std::size_t), ch.num * n);
+    std::size_t tmin = std::numeric_limits<std::size_t>::max(), tmax = 0;
+    std::vector<MVertex *> vertices(numVertPerElm, (MVertex *)nullptr);
+    bool valid = true;
+    for(std::size_t j = 0; j < ch.num && valid; j++) {
+      std::size_t *d = &data[j * n];
+      for(int k = 0; k < numVertPerElm; k++) {
+        vertices[k] = model->getMeshVertexByTagInCache(d[k + 1]);
+        if(!vertices[k]) {
+          Msg::Error("Unknown node %lu in element %lu", d[k + 1], d[0]);
+          valid = false;
+          break;
+        }
+      }
+      if(!valid) break;
+      MElementFactory elementFactory;
+      MElement *element = elementFactory.create(
+        elmType, vertices, d[0], 0, false, 0, nullptr, nullptr, nullptr);
+      if(!element) {
+        Msg::Error("Could not create element %lu of type %d", d[0], elmType);
+        valid = false;
+        break;
+      }
+      tmin = std::min(tmin, d[0]);
+      tmax = std::max(tmax, d[0]);
+      elementCache[ch.index + j] =
+        std::make_pair(d[0], std::make_pair(element, entityTag));
+    }
+    minNum[c] = tmin;
+    maxNum[c] = tmax;
+    ok[c] = valid;
+  }
+
+  std::size_t minElementNum = std::numeric_limits<std::size_t>::max();
+  bool success = true;
+  for(std::size_t c = 0; c < chunks.size(); c++) {
+    success &= ok[c];
+    minElementNum = std::min(minElementNum, minNum[c]);
+    maxElementNum = std::max(maxElementNum, maxNum[c]);
+  }
+  if(!success) {
+    for(std::size_t i = 0; i < totalNumElements; i++)
+      if(elementCache[i].second.first) delete elementCache[i].second.first;
+    delete[] elementCache;
+    return nullptr;
+  }
+
+  // add the elements to the entities, in the order of the file
+  for(std::size_t i = 0, index = 0; i < numBlock; i++) {
+    GEntity *entity = entities[i];
+    bool ghost = (entity->geomType() == GEntity::GhostCurve ||
+                  entity->geomType() == GEntity::GhostSurface ||
+                  entity->geomType() == GEntity::GhostVolume);
+    for(std::size_t j = 0; j < blockSizes[i]; j++, index++) {
+      MElement *element = elementCache[index].second.first;
+      if(!ghost) entity->addElement(element->getType(), element);
+    }
+  }
+  model->setMaxElementNumber(maxElementNum);
+
+  dense = isDenseNumbering(minElementNum, maxElementNum, totalNumElements);
+
+  double t2 = TimeOfDay();
+  double mb = (end - start) / 1024. / 1024.;
+  Msg::Info("Read %g Mb of elements in %g seconds (%g Mb/s, %d threads)", mb,
+            t2 - t1, (t2 > t1) ? mb / (t2 - t1) : 0., nthreads);
+  return elementCache;
+}
+
 static bool readMSH4PeriodicNodes(GModel *const model, FILE *fp, bool binary,
                                   bool swap, double version)
 {
@@ -1361,8 +1760,15 @@ int GModel::_readMSH4(const std::string &name)
       _vertexMapCache.clear();
       bool dense = false;
       std::size_t totalNumNodes = 0, maxNodeNum;
-      std::pair<std::size_t, MVertex *> *vertexCache = readMSH4Nodes(
-        this, fp, binary, dense, totalNumNodes, maxNodeNum, swap, version);
+      int nthreads = binary ? getNumIOThreads() : 1;
+      std::unique_ptr<MSH4MappedFile> mf;
+      if(nthreads > 1) mf.reset(new MSH4MappedFile(name));
+      std::pair<std::size_t, MVertex *> *vertexCache =
+        (mf && mf->valid()) ?
+          readMSH4NodesParallel(this, fp, *mf, dense, totalNumNodes,
+                                maxNodeNum, swap, nthreads) :
+          readMSH4Nodes(this, fp, binary, dense, totalNumNodes, maxNodeNum,
+                        swap, version);
       Msg::StopProgressMeter();
       if(!vertexCache) {
         Msg::Error("Could not read nodes");
@@ -1381,11 +1787,10 @@ int GModel::_readMSH4(const std::string &name)
         }
       }
       else {
+        _vertexMapCache.reserve(totalNumNodes);
         for(std::size_t i = 0; i < totalNumNodes; i++) {
-          if(_vertexMapCache.count(vertexCache[i].first) == 0) {
-            _vertexMapCache[vertexCache[i].first] = vertexCache[i].second;
-          }
-          else {
+          if(!_vertexMapCache.insert(vertexCache[i].first,
+                                     vertexCache[i].second)) {
             Msg::Info("Skipping duplicate node %d", vertexCache[i].first);
           }
         }
@@ -1395,9 +1800,15 @@ int GModel::_readMSH4(const std::string &name)
     else if(!strncmp(&str[1], "Elements", 8)) {
       bool dense = false;
       std::size_t totalNumElements = 0, maxElementNum = 0;
+      int nthreads = binary ? getNumIOThreads() : 1;
+      std::unique_ptr<MSH4MappedFile> mf;
+      if(nthreads > 1) mf.reset(new MSH4MappedFile(name));
       std::pair<std::size_t, std::pair<MElement *, int> > *elementCache =
-        readMSH4Elements(this, fp, binary, dense, totalNumElements,
-                         maxElementNum, swap, version);
+        (mf && mf->valid()) ?
+          readMSH4ElementsParallel(this, fp, *mf, dense, totalNumElements,
+                                   maxElementNum, swap, nthreads) :
+          readMSH4Elements(this, fp, binary, dense, totalNumElements,
+                           maxElementNum, swap, version);
       Msg::StopProgressMeter();
       if(!elementCache) {
         Msg::Error("Could not read elements");
@@ -1416,11 +1827,10 @@ int GModel::_readMSH4(const std::string &name)
         }
       }
       else {
+        _elementMapCache.reserve(totalNumElements);
         for(std::size_t i = 0; i < totalNumElements; i++) {
-          if(_elementMapCache.count(elementCache[i].first) == 0) {
-            _elementMapCache[elementCache[i].first] = elementCache[i].second;
-          }
-          else {
+          if(!_elementMapCache.insert(elementCache[i].first,
+                                      elementCache[i].second)) {
             Msg::Info("Skipping duplicate element %d", elementCache[i].first);
           }
         }
@@ -2258,9 +2668,204 @@ getEntitiesToSave(GModel *const model, bool partitioned,
   }
 }
 
+// Write size bytes at the given offset of the file, without moving the file
+// position: several threads can write disjoint parts of the same file
+static bool writeMSH4At(FILE *fp, const void *data, std::size_t size,
+                        std::size_t offset)
+{
+#if !defined(WIN32) || defined(__CYGWIN__)
+  int fd = fileno(fp);
+  const char *p = (const char *)data;
+  while(size) {
+    ssize_t n = pwrite(fd, p, size, offset);
+    if(n <= 0) return false;
+    p += n;
+    size -= n;
+    offset += n;
+  }
+  return true;
+#else
+  return false;
+#endif
+}
+
+// Concurrent encoding of the binary node blocks of the given entities (in
+// order): each thread encodes chunks of nodes and writes them directly at
+// their final offset in the file. The file is identical to the one written
+// sequentially by writeMSH4EntityNodes(). If a write fails the file position
+// is restored, and false is returned so that the caller can write the nodes
+// sequentially instead.
+static bool writeMSH4NodesParallel(const std::vector<GEntity *> &entities,
+                                   FILE *fp, int saveParametric,
+                                   double scalingFactor, int nthreads)
+{
+  double t1 = TimeOfDay();
+  fflush(fp);
+  std::size_t start = ftell(fp);
+  const std::size_t header = 3 * sizeof(int) + sizeof(std::size_t);
+
+  std::vector<std::size_t> blockSizes(entities.size());
+  std::vector<std::size_t> numCoord(entities.size());
+  std::vector<std::size_t> offsets(entities.size());
+  std::size_t offset = start;
+  for(std::size_t i = 0; i < entities.size(); i++) {
+    GEntity *ge = entities[i];
+    int parametric = saveParametric;
+    if(ge->dim() != 1 && ge->dim() != 2) parametric = 0;
+    blockSizes[i] = ge->getNumMeshVertices();
+    numCoord[i] = 3 + (parametric ? ge->dim() : 0);
+    offsets[i] = offset;
+    offset += header + blockSizes[i] * (sizeof(std::size_t) +
+                                        numCoord[i] * sizeof(double));
+  }
+  std::size_t end = offset;
+
+  std::vector<MSH4Chunk> chunks;
+  makeMSH4Chunks(blockSizes, chunks);
+  bool success = true;
+  for(std::size_t i = 0; i < entities.size(); i++) {
+    // empty blocks have no chunk: write their header here
+    if(blockSizes[i]) continue;
+    int data[3] = {entities[i]->dim(), entities[i]->tag(),
+                   numCoord[i] > 3 ? 1 : 0};
+    char buf[header];
+    std::size_t zero = 0;
+    memcpy(buf, data, sizeof(data));
+    memcpy(buf + sizeof(data), &zero, sizeof(std::size_t));
+    success &= writeMSH4At(fp, buf, header, offsets[i]);
+  }
+
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t c = 0; c < chunks.size(); c++) {
+    if(!success) continue;
+    const MSH4Chunk &ch = chunks[c];
+    GEntity *ge = entities[ch.block];
+    std::size_t N = blockSizes[ch.block], n = numCoord[ch.block];
+    bool ok = true;
+    if(!ch.first) {
+      int data[3] = {ge->dim(), ge->tag(), n > 3 ? 1 : 0};
+      char buf[header];
+      memcpy(buf, data, sizeof(data));
+      memcpy(buf + sizeof(data), &N, sizeof(std::size_t));
+      ok &= writeMSH4At(fp, buf, header, offsets[ch.block]);
+    }
+    std::vector<std::size_t> tags(ch.num);
+    std::vector<double> coord(n * ch.num);
+    std::size_t j = 0;
+    for(std::size_t i = 0; i < ch.num; i++) {
+      MVertex *mv = ge->getMeshVertex(ch.first + i);
+      tags[i] = mv->getNum();
+      coord[j++] = mv->x() * scalingFactor;
+      coord[j++] = mv->y() * scalingFactor;
+      coord[j++] = mv->z() * scalingFactor;
+      if(n >= 4) mv->getParameter(0, coord[j++]);
+      if(n == 5) mv->getParameter(1, coord[j++]);
+    }
+    std::size_t tagOffset =
+      offsets[ch.block] + header + ch.first * sizeof(std::size_t);
+    std::size_t coordOffset = offsets[ch.block] + header +
+                              N * sizeof(std::size_t) +
+                              ch.first * n * sizeof(double);
+    ok &= writeMSH4At(fp, &tags[0], ch.num * sizeof(std::size_t), tagOffset);
+    ok &= writeMSH4At(fp, &coord[0], n * ch.num * sizeof(double),
+                      coordOffset);
+    if(!ok) success = false;
+  }
+
+  if(!success) {
+    fseek(fp, start, SEEK_SET);
+    Msg::Warning("Could not write nodes concurrently: writing them "
+                 "sequentially");
+    return false;
+  }
+  fseek(fp, end, SEEK_SET);
+  double t2 = TimeOfDay();
+  double mb = (end - start) / 1024. / 1024.;
+  Msg::Debug("Wrote %g Mb of nodes in %g seconds (%g Mb/s, %d threads)", mb,
+             t2 - t1, (t2 > t1) ? mb / (t2 - t1) : 0., nthreads);
+  return true;
+}
+
+// Concurrent encoding of binary element blocks, with the same layout as in
+// writeMSH4Elements(); return false (with the file position restored) if a
+// write fails
+struct MSH4ElementBlock {
+  int dim, entityTag, elmType;
+  const std::vector<MElement *> *elements;
+};
+
+static bool
+writeMSH4ElementsParallel(const std::vector<MSH4ElementBlock> &blocks,
+                          FILE *fp, int nthreads)
+{
+  double t1 = TimeOfDay();
+  fflush(fp);
+  std::size_t start = ftell(fp);
+  const std::size_t header = 3 * sizeof(int) + sizeof(std::size_t);
+
+  std::vector<std::size_t> blockSizes(blocks.size()), numVert(blocks.size());
+  std::vector<std::size_t> offsets(blocks.size());
+  std::size_t offset = start;
+  for(std::size_t i = 0; i < blocks.size(); i++) {
+    blockSizes[i] = blocks[i].elements->size();
+    numVert[i] = MElement::getInfoMSH(blocks[i].elmType);
+    offsets[i] = offset;
+    offset += header + blockSizes[i] * (1 + numVert[i]) * sizeof(std::size_t);
+  }
+  std::size_t end = offset;
+
+  std::vector<MSH4Chunk> chunks;
+  makeMSH4Chunks(blockSizes, chunks);
+  bool success = true;
+
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t c = 0; c < chunks.size(); c++) {
+    if(!success) continue;
+    const MSH4Chunk &ch = chunks[c];
+    const MSH4ElementBlock &b = blocks[ch.block];
+    std::size_t n = 1 + numVert[ch.block];
+    bool ok = true;
+    if(!ch.first) {
+      int data[3] = {b.dim, b.entityTag, b.elmType};
+      std::size_t N = blockSizes[ch.block];
+      char buf[header];
+      memcpy(buf, data, sizeof(data));
+      memcpy(buf + sizeof(data), &N, sizeof(std::size_t));
+      ok &= writeMSH4At(fp, buf, header, offsets[ch.block]);
+    }
+    std::vector<std::size_t> tags(ch.num * n);
+    std::size_t k = 0;
+    for(std::size_t i = 0; i < ch.num; i++) {
+      MElement *e = (*b.elements)[ch.first + i];
+      tags[k] = e->getNum();
+      for(std::size_t j = 0; j < n - 1; j++)
+        tags[k + 1 + j] = e->getVertex(j)->getNum();
+      k += n;
+    }
+    ok &= writeMSH4At(fp, &tags[0], ch.num * n * sizeof(std::size_t),
+                      offsets[ch.block] + header +
+                        ch.first * n * sizeof(std::size_t));
+    if(!ok) success = false;
+  }
+
+  if(!success) {
+    fseek(fp, start, SEEK_SET);
+    Msg::Warning("Could not write elements concurrently: writing them "
+                 "sequentially");
+    return false;
+  }
+  fseek(fp, end, SEEK_SET);
+  double t2 = TimeOfDay();
+  double mb = (end - start) / 1024. / 1024.;
+  Msg::Debug("Wrote %g Mb of elements in %g seconds (%g Mb/s, %d threads)", mb,
+             t2 - t1, (t2 > t1) ? mb / (t2 - t1) : 0., nthreads);
+  return true;
+}
+
 static void writeMSH4Nodes(GModel *const model, FILE *fp, bool partitioned,
                            int partitionToSave, bool binary, int saveParametric,
-                           double scalingFactor, bool saveAll, double version)
+                           double scalingFactor, bool saveAll, double version,
+                           int nthreads)
 {
   std::set<GRegion *, GEntityPtrLessThan> regions;
   std::set<GFace *, GEntityPtrLessThan> faces;
@@ -2324,21 +2929,33 @@ static void writeMSH4Nodes(GModel *const model, FILE *fp, bool partitioned,
     }
   }
 
-  for(auto it = vertices.begin(); it != vertices.end(); ++it) {
-    writeMSH4EntityNodes(*it, fp, binary, saveParametric, scalingFactor,
-                         version);
-  }
-  for(auto it = edges.begin(); it != edges.end(); ++it) {
-    writeMSH4EntityNodes(*it, fp, binary, saveParametric, scalingFactor,
-                         version);
-  }
-  for(auto it = faces.begin(); it != faces.end(); ++it) {
-    writeMSH4EntityNodes(*it, fp, binary, saveParametric, scalingFactor,
-                         version);
-  }
-  for(auto it = regions.begin(); it != regions.end(); ++it) {
-    writeMSH4EntityNodes(*it, fp, binary, saveParametric, scalingFactor,
-                         version);
+  bool done = false;
+  if(binary && nthreads > 1) {
+    std::vector<GEntity *> entities;
+    entities.insert(entities.end(), vertices.begin(), vertices.end());
+    entities.insert(entities.end(), edges.begin(), edges.end());
+    entities.insert(entities.end(), faces.begin(), faces.end());
+    entities.insert(entities.end(), regions.begin(), regions.end());
+    done = writeMSH4NodesParallel(entities, fp, saveParametric, scalingFactor,
+                                  nthreads);
+  }
+  if(!done) {
+    for(auto it = vertices.begin(); it != vertices.end(); ++it) {
+      writeMSH4EntityNodes(*it, fp, binary, saveParametric, scalingFactor,
+                           version);
+    }
+    for(auto it = edges.begin(); it != edges.end(); ++it) {
+      writeMSH4EntityNodes(*it, fp, binary, saveParametric, scalingFactor,
+                           version);
+    }
+    for(auto it = faces.begin(); it != faces.end(); ++it) {
+      writeMSH4EntityNodes(*it, fp, binary, saveParametric, scalingFactor,
+                           version);
+    }
+    for(auto it = regions.begin(); it != regions.end(); ++it) {
+      writeMSH4EntityNodes(*it, fp, binary, saveParametric, scalingFactor,
+                           version);
+    }
   }
 
   if(binary) fprintf(fp, "\n");
@@ -2348,7 +2965,7 @@ static void writeMSH4Nodes(GModel *const model, FILE *fp, bool partitioned,
 
 static void writeMSH4Elements(GModel *const model, FILE *fp, bool partitioned,
                               int partitionToSave, bool binary, bool saveAll,
-                              double version)
+                              double version, int nthreads)
 {
   std::set<GRegion *, GEntityPtrLessThan> regions;
   std::set<GFace *, GEntityPtrLessThan> faces;
@@ -2464,47 +3081,62 @@ static void writeMSH4Elements(GModel *const model, FILE *fp, bool partitioned,
       fprintf(fp, "%lu %lu\n", numSection, numElements);
   }
 
-  for(int dim = 0; dim <= 3; dim++) {
-    for(auto it = elementsByType[dim].begin(); it != elementsByType[dim].end();
-        ++it) {
-      int entityTag = it->first.first;
-      int elmType = it->first.second;
-      std::size_t numElm = it->second.size();
-      if(binary) {
-        fwrite(&dim, sizeof(int), 1, fp);
-        fwrite(&entityTag, sizeof(int), 1, fp);
-        fwrite(&elmType, sizeof(int), 1, fp);
-        fwrite(&numElm, sizeof(std::size_t), 1, fp);
-      }
-      else {
-        fprintf(fp, "%d %d %d %lu\n", (version >= 4.1) ? dim : entityTag,
-                (version >= 4.1) ? entityTag : dim, elmType, numElm);
-      }
-
-      std::size_t N = it->second.size();
-      if(binary) {
-        const int numVertPerElm = MElement::getInfoMSH(elmType);
-        std::size_t n = 1 + numVertPerElm;
-        std::vector<std::size_t> tags(N * n);
-        std::size_t k = 0;
-        for(std::size_t i = 0; i < N; i++) {
-          MElement *e = it->second[i];
-          tags[k] = e->getNum();
-          for(int j = 0; j < numVertPerElm; j++) {
-            tags[k + 1 + j] = e->getVertex(j)->getNum();
+  bool done = false;
+  if(binary && nthreads > 1) {
+    std::vector<MSH4ElementBlock> blocks;
+    for(int dim = 0; dim <= 3; dim++) {
+      for(auto it = elementsByType[dim].begin();
+          it != elementsByType[dim].end(); ++it) {
+        MSH4ElementBlock b = {dim, it->first.first, it->first.second,
+                              &it->second};
+        blocks.push_back(b);
+      }
+    }
+    done = writeMSH4ElementsParallel(blocks, fp, nthreads);
+  }
+  if(!done) {
+    for(int dim = 0; dim <= 3; dim++) {
+      for(auto it = elementsByType[dim].begin();
+          it != elementsByType[dim].end(); ++it) {
+        int entityTag = it->first.first;
+        int elmType = it->first.second;
+        std::size_t numElm = it->second.size();
+        if(binary) {
+          fwrite(&dim, sizeof(int), 1, fp);
+          fwrite(&entityTag, sizeof(int), 1, fp);
+          fwrite(&elmType, sizeof(int), 1, fp);
+          fwrite(&numElm, sizeof(std::size_t), 1, fp);
+        }
+        else {
+          fprintf(fp, "%d %d %d %lu\n", (version >= 4.1) ? dim : entityTag,
+                  (version >= 4.1) ? entityTag : dim, elmType, numElm);
+        }
+
+        std::size_t N = it->second.size();
+        if(binary) {
+          const int numVertPerElm = MElement::getInfoMSH(elmType);
+          std::size_t n = 1 + numVertPerElm;
+          std::vector<std::size_t> tags(N * n);
+          std::size_t k = 0;
+          for(std::size_t i = 0; i < N; i++) {
+            MElement *e = it->second[i];
+            tags[k] = e->getNum();
+            for(int j = 0; j < numVertPerElm; j++) {
+              tags[k + 1 + j] = e->getVertex(j)->getNum();
+            }
+            k += n;
           }
-          k += n;
+          fwrite(&tags[0], sizeof(std::size_t), N * n, fp);
         }
-        fwrite(&tags[0], sizeof(std::size_t), N * n, fp);
-      }
-      else {
-        for(std::size_t i = 0; i < N; i++) {
-          MElement *e = it->second[i];
-          fprintf(fp, "%lu ", e->getNum());
-          for(std::size_t i = 0; i < e->getNumVertices(); i++) {
-            fprintf(fp, "%lu ", e->getVertex(i)->getNum());
+        else {
+          for(std::size_t i = 0; i < N; i++) {
+            MElement *e = it->second[i];
+            fprintf(fp, "%lu ", e->getNum());
+            for(std::size_t i = 0; i < e->getNumVertices(); i++) {
+              fprintf(fp, "%lu ", e->getVertex(i)->getNum());
+            }
+            fprintf(fp, "\n");
           }
-          fprintf(fp, "\n");
         }
       }
     }
@@ -2820,13 +3452,21 @@ int GModel::_writeMSH4(const std::string &name, double version, bool binary,
   if(partitioned)
     writeMSH4Entities(this, fp, true, binary, scalingFactor, version);
 
+  // binary node and element blocks are encoded concurrently and written at
+  // their offset in the file (which is not possible in append mode)
+  int nthreads = (binary && !append) ? getNumIOThreads() : 1;
+#if defined(WIN32) && !defined(__CYGWIN__)
+  nthreads = 1;
+#endif
+
   // nodes
   writeMSH4Nodes(this, fp, partitioned, partitionToSave, binary,
-                 saveParametric ? 1 : 0, scalingFactor, saveAll, version);
+                 saveParametric ? 1 : 0, scalingFactor, saveAll, version,
+                 nthreads);
 
   // elements
   writeMSH4Elements(this, fp, partitioned, partitionToSave, binary, saveAll,
-                    version);
+                    version, nthreads);
 
   // periodic
   writeMSH4PeriodicNodes(this, fp, binary, version);
@@ -68,7 +68,7 @@ int GModel::readUNV(const std::string &name, bool readGroupsOfElements)
           for(std::size_t i = 0; i < strlen(buffer); i++)
             if(buffer[i] == 'D') buffer[i] = 'E';
           if(sscanf(buffer, "%lf %lf %lf", &x, &y, &z) != 3) break;
-          _vertexMapCache[num] = new MVertex(x, y, z, nullptr, num);
+          _vertexMapCache.set(num, new MVertex(x, y, z, nullptr, num));
         }
       }
       else if(record == 2412) { // elements
@@ -12,6 +12,11 @@ class Octree;
 class GModel;
 class MElement;
 
+// bounding box (1% thicker) of a mesh element, and inclusion test of a point
+// in a mesh element, as used by the octree
+void MElementBB(void *a, double *min, double *max);
+int MElementInEle(void *a, double *x);
+
 class MElementOctree {
 private:
   Octree *_octree;
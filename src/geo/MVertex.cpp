@@ -5,6 +5,8 @@
 
 #include <string.h>
 #include <cmath>
+#include <atomic>
+#include <algorithm>
 #include "MVertex.h"
 #include "GModel.h"
 #include "GVertex.h"
@@ -12,6 +14,7 @@
 #include "GFace.h"
 #include "GmshMessage.h"
 #include "StringUtils.h"
+#include "Context.h"
 
 double angle3Vertices(const MVertex *p1, const MVertex *p2, const MVertex *p3)
 {
@@ -38,6 +41,68 @@ MVertex::MVertex(double x, double y, double z, GEntity *ge, std::size_t num)
   _index = (long int)num;
 }
 
+// blocks of nodes, sorted by address; the number of blocks is checked first
+// so that deleting nodes does not lock when there are no blocks
+struct MVertexBlockInfo {
+  const char *begin, *end;
+  std::size_t numSlots;
+};
+static std::vector<MVertexBlockInfo> vertexBlocks;
+static std::atomic<std::size_t> numVertexBlocks(0);
+
+static bool blockLessThan(const MVertexBlockInfo &a, const MVertexBlockInfo &b)
+{
+  return a.begin < b.begin;
+}
+
+char *MVertexBlock::allocate(std::size_t size, std::size_t num)
+{
+  if(!CTX::instance()->mesh.compactNodeStorage || !num) return nullptr;
+  char *data = (char *)::operator new(size * num);
+  MVertexBlockInfo info = {data, data + size * num, num};
+#pragma omp critical(MVertexBlock)
+  {
+    vertexBlocks.insert(std::upper_bound(vertexBlocks.begin(),
+                                         vertexBlocks.end(), info,
+                                         blockLessThan),
+                        info);
+    numVertexBlocks++;
+  }
+  return data;
+}
+
+bool MVertexBlock::release(const void *p, std::size_t num)
+{
+  if(!numVertexBlocks.load(std::memory_order_acquire)) return false;
+  bool found = false;
+  const char *freeBlock = nullptr;
+#pragma omp critical(MVertexBlock)
+  {
+    MVertexBlockInfo key = {(const char *)p, nullptr, 0};
+    auto it = std::upper_bound(vertexBlocks.begin(), vertexBlocks.end(), key,
+                               blockLessThan);
+    if(it != vertexBlocks.begin() && key.begin < (--it)->end) {
+      found = true;
+      it->numSlots -= std::min(num, it->numSlots);
+      if(!it->numSlots) {
+        // the last slots of the block have been released
+        freeBlock = it->begin;
+        vertexBlocks.erase(it);
+        numVertexBlocks--;
+      }
+    }
+  }
+  if(freeBlock) ::operator delete((void *)freeBlock);
+  return found;
+}
+
+void *MVertex::operator new(std::size_t size) { return ::operator new(size); }
+
+void MVertex::operator delete(void *p)
+{
+  if(!MVertexBlock::release(p)) ::operator delete(p);
+}
+
 void MVertex::deleteLast()
 {
   GModel *m = GModel::current();
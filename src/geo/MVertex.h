@@ -48,6 +48,11 @@ public:
   virtual ~MVertex() {}
   void deleteLast();
 
+  // nodes can be constructed in place in a MVertexBlock: deleting them then
+  // only releases their slot in the block
+  static void *operator new(std::size_t size);
+  static void operator delete(void *p);
+
   // get/set the visibility flag
   virtual char getVisibility() { return _visible; }
   virtual void setVisibility(char val) { _visible = val; }
@@ -206,6 +211,21 @@ public:
   }
 };
 
+// Contiguous blocks of memory in which the nodes created in bulk (e.g. when
+// reading a mesh file) are constructed in place with ::new, instead of being
+// allocated one by one. This removes the per-node allocation overhead and keeps
+// the nodes of an entity contiguous in memory. A block is freed when all its
+// slots have been released, i.e. when all its nodes have been deleted.
+class MVertexBlock {
+public:
+  // allocate a block for num nodes of the given size (e.g. sizeof(MVertex)),
+  // or return nullptr if Mesh.CompactNodeStorage is not set
+  static char *allocate(std::size_t size, std::size_t num);
+  // release num slots starting at p (e.g. slots in which no node will be
+  // constructed); return false if p is not in a block
+  static bool release(const void *p, std::size_t num = 1);
+};
+
 class MVertexPtrLessThanLexicographic {
   static double tolerance;
 
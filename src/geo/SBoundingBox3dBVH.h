@@ -0,0 +1,195 @@
+// Gmsh - Copyright (C) 1997-2022 C. Geuzaine, J.-F. Remacle
+//
+// See the LICENSE.txt file in the Gmsh root directory for license information.
+// Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
+
+#ifndef SBOUNDING_BOX_3D_BVH_H
+#define SBOUNDING_BOX_3D_BVH_H
+
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include "SBoundingBox3d.h"
+
+// Bounding volume hierarchy over a set of primitives (e.g. mesh elements)
+// given by their axis-aligned bounding boxes. The tree is stored in flat
+// arrays and is never modified after build(): queries only read it, and can
+// thus be performed concurrently by several threads.
+class SBoundingBox3dBVH {
+private:
+  struct Node {
+    double min[3], max[3];
+    // leaf: primitives _prims[start, start + num[; internal node: children
+    // are _nodes[start] and _nodes[start + 1]
+    std::size_t start, num;
+    bool leaf;
+  };
+  std::vector<Node> _nodes;
+  std::vector<std::size_t> _prims;
+  std::vector<double> _boxes; // xmin, ymin, zmin, xmax, ymax, zmax
+  std::size_t _leafSize;
+  // the median split halves the number of primitives at each level, so that
+  // the tree depth (and the number of pending nodes during a depth-first
+  // traversal) is bounded by the number of bits of std::size_t
+  static const int _maxStack = 2 * std::numeric_limits<std::size_t>::digits;
+
+  double _center(std::size_t p, int dim) const
+  {
+    return 0.5 * (_boxes[6 * p + dim] + _boxes[6 * p + 3 + dim]);
+  }
+  void _build(std::size_t n, std::size_t start, std::size_t num)
+  {
+    Node &node = _nodes[n];
+    for(int d = 0; d < 3; d++) {
+      node.min[d] = std::numeric_limits<double>::max();
+      node.max[d] = -std::numeric_limits<double>::max();
+    }
+    double cmin[3] = {node.min[0], node.min[1], node.min[2]};
+    double cmax[3] = {node.max[0], node.max[1], node.max[2]};
+    for(std::size_t i = start; i < start + num; i++) {
+      std::size_t p = _prims[i];
+      for(int d = 0; d < 3; d++) {
+        node.min[d] = std::min(node.min[d], _boxes[6 * p + d]);
+        node.max[d] = std::max(node.max[d], _boxes[6 * p + 3 + d]);
+        cmin[d] = std::min(cmin[d], _center(p, d));
+        cmax[d] = std::max(cmax[d], _center(p, d));
+      }
+    }
+    if(num <= _leafSize) {
+      node.leaf = true;
+      node.start = start;
+      node.num = num;
+      return;
+    }
+    // split at the median of the box centers along the largest extent
+    int dim = 0;
+    for(int d = 1; d < 3; d++)
+      if(cmax[d] - cmin[d] > cmax[dim] - cmin[dim]) dim = d;
+    std::size_t half = num / 2;
+    std::nth_element(_prims.begin() + start, _prims.begin() + start + half,
+                     _prims.begin() + start + num,
+                     [this, dim](std::size_t a, std::size_t b) {
+                       return _center(a, dim) < _center(b, dim);
+                     });
+    std::size_t child = _nodes.size();
+    node.leaf = false;
+    node.start = child;
+    node.num = 0;
+    _nodes.resize(child + 2); // invalidates node
+    _build(child, start, half);
+    _build(child + 1, start + half, num - half);
+  }
+  double _distanceSquared(const Node &node, const double p[3]) const
+  {
+    double d2 = 0.;
+    for(int d = 0; d < 3; d++) {
+      double e = std::max(std::max(node.min[d] - p[d], p[d] - node.max[d]), 0.);
+      d2 += e * e;
+    }
+    return d2;
+  }
+  bool _contains(const Node &node, const double p[3], double tol) const
+  {
+    for(int d = 0; d < 3; d++)
+      if(p[d] < node.min[d] - tol || p[d] > node.max[d] + tol) return false;
+    return true;
+  }
+
+public:
+  SBoundingBox3dBVH(std::size_t leafSize = 4) : _leafSize(leafSize) {}
+  std::size_t size() const { return _boxes.size() / 6; }
+  bool empty() const { return _boxes.empty(); }
+  void clear()
+  {
+    _nodes.clear();
+    _prims.clear();
+    _boxes.clear();
+  }
+  // build the tree for the primitives 0, ..., boxes.size() - 1
+  void build(const std::vector<SBoundingBox3d> &boxes)
+  {
+    clear();
+    _boxes.resize(6 * boxes.size());
+    _prims.resize(boxes.size());
+    for(std::size_t i = 0; i < boxes.size(); i++) {
+      SPoint3 bmin = boxes[i].min(), bmax = boxes[i].max();
+      for(int d = 0; d < 3; d++) {
+        _boxes[6 * i + d] = bmin[d];
+        _boxes[6 * i + 3 + d] = bmax[d];
+      }
+      _prims[i] = i;
+    }
+    if(boxes.empty()) return;
+    _nodes.reserve(2 * (boxes.size() / _leafSize + 1));
+    _nodes.resize(1);
+    _build(0, 0, boxes.size());
+  }
+  // find the primitive closest to p, given a function returning the squared
+  // distance between p and a primitive; return false if the tree is empty
+  template <class Distance2>
+  bool closest(const double p[3], Distance2 distance2, std::size_t &index,
+               double &dist2) const
+  {
+    dist2 = std::numeric_limits<double>::max();
+    if(_nodes.empty()) return false;
+    std::size_t stack[_maxStack], top = 0;
+    stack[top++] = 0;
+    while(top) {
+      const Node &node = _nodes[stack[--top]];
+      if(_distanceSquared(node, p) >= dist2) continue;
+      if(node.leaf) {
+        for(std::size_t i = node.start; i < node.start + node.num; i++) {
+          double d2 = distance2(_prims[i]);
+          if(d2 < dist2) {
+            dist2 = d2;
+            index = _prims[i];
+          }
+        }
+      }
+      else {
+        // visit the closest child first (it is pushed last)
+        double d0 = _distanceSquared(_nodes[node.start], p);
+        double d1 = _distanceSquared(_nodes[node.start + 1], p);
+        if(d0 < d1) {
+          stack[top++] = node.start + 1;
+          stack[top++] = node.start;
+        }
+        else {
+          stack[top++] = node.start;
+          stack[top++] = node.start + 1;
+        }
+      }
+    }
+    return true;
+  }
+  // call visit(i) for each primitive i whose bounding box (enlarged by tol)
+  // contains p, until visit returns true; return true if it did
+  template <class Visit>
+  bool containing(const double p[3], Visit visit, double tol = 0.) const
+  {
+    if(_nodes.empty()) return false;
+    std::size_t stack[_maxStack], top = 0;
+    stack[top++] = 0;
+    while(top) {
+      const Node &node = _nodes[stack[--top]];
+      if(!_contains(node, p, tol)) continue;
+      if(node.leaf) {
+        for(std::size_t i = node.start; i < node.start + node.num; i++) {
+          std::size_t q = _prims[i];
+          bool in = true;
+          for(int d = 0; d < 3 && in; d++)
+            in = (p[d] >= _boxes[6 * q + d] - tol &&
+                  p[d] <= _boxes[6 * q + 3 + d] + tol);
+          if(in && visit(q)) return true;
+        }
+      }
+      else {
+        stack[top++] = node.start;
+        stack[top++] = node.start + 1;
+      }
+    }
+    return false;
+  }
+};
+
+#endif
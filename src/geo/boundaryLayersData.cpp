@@ -431,7 +431,9 @@ bool buildAdditionalPoints2D(GFace *gf)
     if(bl_field == nullptr) continue;
     BoundaryLayerField *blf = dynamic_cast<BoundaryLayerField *>(bl_field);
 
-    if(!blf->setupFor2d(gf->tag())) continue;
+    // only set up the field (which modifies it) if the surface is concerned,
+    // so that other surfaces can be meshed concurrently
+    if(!blf->isFaceBL(gf->tag()) || !blf->setupFor2d(gf->tag())) continue;
 
     std::set<MVertex *> _vertices;
     std::set<MEdge, MEdgeLessThan> allEdges;
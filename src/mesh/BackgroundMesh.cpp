@@ -28,9 +28,7 @@
 #include "linearSystemPETSc.h"
 #endif
 
-#if defined(HAVE_ANN)
-static const int NBANN = 2;
-#endif
+static const int NBNEIGHBORS = 2;
 
 static const int MAX_THREADS = 256;
 
@@ -73,10 +71,8 @@ backgroundMesh *backgroundMesh::current()
 }
 
 backgroundMesh::backgroundMesh(GFace *_gf, bool cfd)
-#if defined(HAVE_ANN)
-  : _octree(nullptr), uv_kdtree(nullptr), nodes(nullptr), angle_nodes(nullptr),
-    angle_kdtree(nullptr)
-#endif
+  : _octree(nullptr), _nodesAdaptor(_nodes), _angleNodesAdaptor(_angleNodes),
+    _uvKdtree(nullptr), _angleKdtree(nullptr)
 {
   if(cfd) {
     Msg::Debug("Building cross field using closest distance");
@@ -113,22 +109,12 @@ backgroundMesh::backgroundMesh(GFace *_gf, bool cfd)
     _triangles.push_back(T2D);
   }
 
-#if defined(HAVE_ANN)
-  index = new ANNidx[2];
-  dist = new ANNdist[2];
-  nodes = annAllocPts(myBCNodes.size(), 3);
-  auto itp = myBCNodes.begin();
-  int ind = 0;
-  while(itp != myBCNodes.end()) {
-    SPoint2 pt = *itp;
-    nodes[ind][0] = pt.x();
-    nodes[ind][1] = pt.y();
-    nodes[ind][2] = 0.0;
-    itp++;
-    ind++;
-  }
-  uv_kdtree = new ANNkd_tree(nodes, myBCNodes.size(), 3);
-#endif
+  _nodes.pts.reserve(myBCNodes.size());
+  for(auto itp = myBCNodes.begin(); itp != myBCNodes.end(); ++itp)
+    _nodes.pts.push_back(SPoint3(itp->x(), itp->y(), 0.0));
+  _uvKdtree = new SPoint3KDTree(3, _nodesAdaptor,
+                                nanoflann::KDTreeSingleIndexAdaptorParams(10));
+  _uvKdtree->buildIndex();
 
   // build a search structure
   _octree = new MElementOctree(_triangles);
@@ -156,14 +142,8 @@ backgroundMesh::~backgroundMesh()
   for(std::size_t i = 0; i < _vertices.size(); i++) delete _vertices[i];
   for(std::size_t i = 0; i < _triangles.size(); i++) delete _triangles[i];
   if(_octree) delete _octree;
-#if defined(HAVE_ANN)
-  if(uv_kdtree) delete uv_kdtree;
-  if(angle_kdtree) delete angle_kdtree;
-  if(nodes) annDeallocPts(nodes);
-  if(angle_nodes) annDeallocPts(angle_nodes);
-  delete[] index;
-  delete[] dist;
-#endif
+  if(_uvKdtree) delete _uvKdtree;
+  if(_angleKdtree) delete _angleKdtree;
 }
 
 static void propagateValuesOnFace(GFace *_gf,
@@ -330,29 +310,20 @@ void backgroundMesh::propagateCrossFieldByDistance(GFace *_gf)
     }
   }
 
-#if defined(HAVE_ANN)
-  index = new ANNidx[NBANN];
-  dist = new ANNdist[NBANN];
-  angle_nodes = annAllocPts(_cosines4.size(), 3);
-  auto itp = _cosines4.begin();
-  int ind = 0;
+  _angleNodes.pts.clear();
   _sin.clear();
   _cos.clear();
-  while(itp != _cosines4.end()) {
+  for(auto itp = _cosines4.begin(); itp != _cosines4.end(); ++itp) {
     MVertex *v = itp->first;
-    double c = itp->second;
     SPoint2 pt = _param[v];
-    double s = _sines4[v];
-    angle_nodes[ind][0] = pt.x();
-    angle_nodes[ind][1] = pt.y();
-    angle_nodes[ind][2] = 0.0;
-    _cos.push_back(c);
-    _sin.push_back(s);
-    itp++;
-    ind++;
-  }
-  angle_kdtree = new ANNkd_tree(angle_nodes, _cosines4.size(), 3);
-#endif
+    _angleNodes.pts.push_back(SPoint3(pt.x(), pt.y(), 0.0));
+    _cos.push_back(itp->second);
+    _sin.push_back(_sines4[v]);
+  }
+  if(_angleKdtree) delete _angleKdtree;
+  _angleKdtree = new SPoint3KDTree(3, _angleNodesAdaptor,
+                                   nanoflann::KDTreeSingleIndexAdaptorParams(10));
+  _angleKdtree->buildIndex();
 }
 
 inline double myAngle(const SVector3 &a, const SVector3 &b, const SVector3 &d)
@@ -559,6 +530,24 @@ void backgroundMesh::updateSizes(GFace *_gf)
   }
 }
 
+// element containing the projection of (u, v) on the segment joining the two
+// closest boundary nodes; used for points slightly outside of the domain
+MElement *backgroundMesh::_findNearBoundary(double u, double v) const
+{
+  if(!_uvKdtree || _nodes.pts.size() < 2) return nullptr;
+  double pt[3] = {u, v, 0.0};
+  std::size_t index[2];
+  double dist[2];
+  nanoflann::KNNResultSet<double> res(2);
+  res.init(index, dist);
+  _uvKdtree->findNeighbors(res, &pt[0], nanoflann::SearchParams(10));
+  SPoint3 pnew;
+  double d;
+  signedDistancePointLine(_nodes.pts[index[0]], _nodes.pts[index[1]],
+                          SPoint3(u, v, 0.), d, pnew);
+  return _octree->find(pnew.x(), pnew.y(), 0.0, 2, true);
+}
+
 bool backgroundMesh::inDomain(double u, double v, double w) const
 {
   if(!_octree) return false;
@@ -575,18 +564,8 @@ double backgroundMesh::operator()(double u, double v, double w) const
   double uv2[3];
   MElement *e = _octree->find(u, v, w, 2, true);
   if(!e) {
-#if defined(HAVE_ANN)
-    if(uv_kdtree->nPoints() < 2) return -1000.;
-    double pt[3] = {u, v, 0.0};
-#pragma omp critical // just to avoid crash (still incorrect) - should use nanoflann
-    uv_kdtree->annkSearch(pt, 2, index, dist);
-    SPoint3 p1(nodes[index[0]][0], nodes[index[0]][1], nodes[index[0]][2]);
-    SPoint3 p2(nodes[index[1]][0], nodes[index[1]][1], nodes[index[1]][2]);
-    SPoint3 pnew;
-    double d;
-    signedDistancePointLine(p1, p2, SPoint3(u, v, 0.), d, pnew);
-    e = _octree->find(pnew.x(), pnew.y(), 0.0, 2, true);
-#endif
+    if(_nodes.pts.size() < 2) return -1000.;
+    e = _findNearBoundary(u, v);
     if(!e) {
       Msg::Error("BGM octree: cannot find UVW=%g %g %g", u, v, w);
       return -1000.0; // 0.4;
@@ -605,14 +584,16 @@ double backgroundMesh::getAngle(double u, double v, double w) const
   // use closest point for computing cross field angles: this allows NOT to
   // generate a spurious mesh and solve a PDE
   if(!_octree) {
-#if defined(HAVE_ANN)
     double angle = 0.;
-    if(angle_kdtree->nPoints() >= NBANN) {
+    if(_angleKdtree && _angleNodes.pts.size() >= (std::size_t)NBNEIGHBORS) {
       double pt[3] = {u, v, 0.0};
-#pragma omp critical // just to avoid crash (still incorrect) - should use nanoflann
-      angle_kdtree->annkSearch(pt, NBANN, index, dist);
+      std::size_t index[NBNEIGHBORS];
+      double dist[NBNEIGHBORS];
+      nanoflann::KNNResultSet<double> res(NBNEIGHBORS);
+      res.init(index, dist);
+      _angleKdtree->findNeighbors(res, &pt[0], nanoflann::SearchParams(10));
       double SINE = 0.0, COSINE = 0.0;
-      for(int i = 0; i < NBANN; i++) {
+      for(int i = 0; i < NBNEIGHBORS; i++) {
         SINE += _sin[index[i]];
         COSINE += _cos[index[i]];
       }
@@ -620,7 +601,6 @@ double backgroundMesh::getAngle(double u, double v, double w) const
     }
     crossField2d::normalizeAngle(angle);
     return angle;
-#endif
   }
 
   // HACK FOR LEWIS
@@ -637,18 +617,8 @@ double backgroundMesh::getAngle(double u, double v, double w) const
   double uv2[3];
   MElement *e = _octree->find(u, v, w, 2, true);
   if(!e) {
-#if defined(HAVE_ANN)
-    if(uv_kdtree->nPoints() < 2) return -1000.0;
-    double pt[3] = {u, v, 0.0};
-#pragma omp critical // just to avoid crash (still incorrect) - should use nanoflann
-    uv_kdtree->annkSearch(pt, 2, index, dist);
-    SPoint3 p1(nodes[index[0]][0], nodes[index[0]][1], nodes[index[0]][2]);
-    SPoint3 p2(nodes[index[1]][0], nodes[index[1]][1], nodes[index[1]][2]);
-    SPoint3 pnew;
-    double d;
-    signedDistancePointLine(p1, p2, SPoint3(u, v, 0.), d, pnew);
-    e = _octree->find(pnew.x(), pnew.y(), 0., 2, true);
-#endif
+    if(_nodes.pts.size() < 2) return -1000.0;
+    e = _findNearBoundary(u, v);
     if(!e) {
       Msg::Error("BGM octree angle: cannot find UVW=%g %g %g", u, v, w);
       return -1000.0;
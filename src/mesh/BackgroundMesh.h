@@ -15,11 +15,7 @@
 #include "BackgroundMeshTools.h"
 #include "MLine.h"
 #include "MTriangle.h"
-
-#if defined(HAVE_ANN)
-#include "ANN/ANN.h"
-class ANNkd_tree;
-#endif
+#include "SPoint3KDTree.h"
 
 class GEntity;
 class GModel;
@@ -55,15 +51,14 @@ class backgroundMesh : public simpleFunction<double> {
   static std::vector<backgroundMesh *> _current;
   backgroundMesh(GFace *, bool dist = false);
   ~backgroundMesh();
-#if defined(HAVE_ANN)
-  mutable ANNkd_tree *uv_kdtree;
-  mutable ANNpointArray nodes;
-  ANNidxArray index;
-  ANNdistArray dist;
-  mutable ANNpointArray angle_nodes;
-  mutable ANNkd_tree *angle_kdtree;
+  // kd-trees on the boundary nodes and on the nodes carrying cross field
+  // angles (in the parametric plane); they are built once and only read
+  // afterwards, so that queries can be performed concurrently
+  SPoint3Cloud _nodes, _angleNodes;
+  SPoint3CloudAdaptor<SPoint3Cloud> _nodesAdaptor, _angleNodesAdaptor;
+  SPoint3KDTree *_uvKdtree, *_angleKdtree;
   std::vector<double> _cos, _sin;
-#endif
+  MElement *_findNearBoundary(double u, double v) const;
 public:
   static void set(GFace *);
   static void setCrossFieldsByDistance(GFace *);
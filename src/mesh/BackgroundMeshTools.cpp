@@ -9,6 +9,7 @@
 #include "GEdge.h"
 #include "GEntity.h"
 #include "Context.h"
+#include "Profiler.h"
 #include "Field.h"
 #include "GModel.h"
 
@@ -256,6 +257,8 @@ double BGM_MeshSize(GEntity *ge, double U, double V, double X, double Y,
                     double Z)
 {
   if(!ge) Msg::Warning("No entity in background mesh size evaluation");
+  static const int counter = Profiler::counter("Mesh size evaluations");
+  Profiler::count(counter);
 
   // default size to size of model
   double lc = CTX::instance()->lc;
@@ -284,6 +287,9 @@ double BGM_MeshSize(GEntity *ge, double U, double V, double X, double Y,
 SMetric3 BGM_MeshMetric(GEntity *ge, double U, double V, double X, double Y,
                         double Z)
 {
+  static const int counter = Profiler::counter("Mesh size evaluations");
+  Profiler::count(counter);
+
   // default size to size of model
   double lc = CTX::instance()->lc;
 
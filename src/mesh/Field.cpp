@@ -16,6 +16,9 @@
 #include <string.h>
 #include <sstream>
 #include <algorithm>
+#include <map>
+#include <memory>
+#include <atomic>
 #include "GmshConfig.h"
 #include "Context.h"
 #include "Field.h"
@@ -30,7 +33,11 @@
 #include "automaticMeshSizeField.h"
 #include "fullMatrix.h"
 #include "SPoint3KDTree.h"
+#include "SBoundingBox3dBVH.h"
 #include "MVertex.h"
+#include "MLine.h"
+#include "MTriangle.h"
+#include "MQuadrangle.h"
 
 #if defined(HAVE_POST)
 #include "PView.h"
@@ -44,10 +51,6 @@
 #include <unistd.h>
 #endif
 
-#if defined(HAVE_ANN)
-#include "ANN/ANN.h"
-#endif
-
 Field::~Field()
 {
   for(auto it = options.begin(); it != options.end(); ++it) delete it->second;
@@ -55,6 +58,13 @@ Field::~Field()
     delete it->second;
 }
 
+void Field::evaluate(const double *xyz, std::size_t n, double *values,
+                     GEntity *ge)
+{
+  for(std::size_t i = 0; i < n; i++)
+    values[i] = (*this)(xyz[3 * i], xyz[3 * i + 1], xyz[3 * i + 2], ge);
+}
+
 FieldOption *Field::getOption(const std::string &optionName)
 {
   auto it = options.find(optionName);
@@ -182,8 +192,7 @@ public:
   {
     if(_data) delete[] _data;
   }
-  using Field::operator();
-  double operator()(double x, double y, double z, GEntity *ge = nullptr)
+  void update()
   {
     if(updateNeeded) {
       _errorStatus = false;
@@ -195,7 +204,9 @@ public:
           input.open(_fileName.c_str(), std::ios::binary);
         if(!input.is_open()) {
           Msg::Error("Could not open file '%s'", _fileName.c_str());
-          return MAX_LC;
+          _errorStatus = true;
+          updateNeeded = false;
+          return;
         }
         input.exceptions(std::ifstream::eofbit | std::ifstream::failbit |
                          std::ifstream::badbit);
@@ -207,7 +218,9 @@ public:
           if(nt <= 0) {
             Msg::Error("Field %i: invalid number of data points %d x %d x %d",
                        this->id, _n[0], _n[1], _n[2]);
-            return MAX_LC;
+            _errorStatus = true;
+            updateNeeded = false;
+            return;
           }
           if(_data) delete[] _data;
           _data = new double[nt];
@@ -220,7 +233,9 @@ public:
           if(nt <= 0) {
             Msg::Error("Field %i: invalid number of data points %d x %d x %d",
                        this->id, _n[0], _n[1], _n[2]);
-            return MAX_LC;
+            _errorStatus = true;
+            updateNeeded = false;
+            return;
           }
           if(_data) delete[] _data;
           _data = new double[nt];
@@ -238,10 +253,15 @@ public:
       }
       if(!_d[0] || !_d[1] || !_d[2]) {
         Msg::Error("Field %i: Dx, Dy and Dz should be non zero", this->id);
-        return MAX_LC;
+        _errorStatus = true;
       }
       updateNeeded = false;
     }
+  }
+  using Field::operator();
+  double operator()(double x, double y, double z, GEntity *ge = nullptr)
+  {
+    updateIfNeeded();
     if(_errorStatus) return MAX_LC;
     // tri-linear
     int id[2][3];
@@ -686,7 +706,23 @@ public:
       Msg::Warning("Unknown Field %i", _inField);
       return MAX_LC;
     }
-    double d = (*field)(x, y, z);
+    return threshold((*field)(x, y, z));
+  }
+  void evaluate(const double *xyz, std::size_t n, double *values,
+                GEntity *ge = nullptr)
+  {
+    Field *field = (_inField == id) ? nullptr :
+      GModel::current()->getFields()->get(_inField);
+    if(!field) {
+      if(_inField != id) Msg::Warning("Unknown Field %i", _inField);
+      std::fill(values, values + n, MAX_LC);
+      return;
+    }
+    field->evaluate(xyz, n, values);
+    for(std::size_t i = 0; i < n; i++) values[i] = threshold(values[i]);
+  }
+  double threshold(double d) const
+  {
     if(_stopAtDistMax && d >= _dMax) return MAX_LC;
     double r = (d - _dMin) / (_dMax - _dMin);
     r = std::max(std::min(r, 1.), 0.);
@@ -972,17 +1008,87 @@ public:
   }
 };
 
-class MathEvalExpression {
+// mathEvaluator is not re-entrant: each thread parses its own copy of the
+// expressions, the first time it evaluates them
+class threadMathEvaluator {
 private:
-  mathEvaluator *_f;
-  std::set<int> _fields;
+  std::vector<std::string> _expressions, _variables;
+  // index of the evaluator in the per-thread caches (reused once the evaluator
+  // is destroyed), and generation of the expressions: 0 if they are not set,
+  // unique across all the evaluators otherwise
+  std::size_t _index, _generation;
+  static std::vector<std::size_t> &_freeIndices()
+  {
+    static std::vector<std::size_t> indices;
+    return indices;
+  }
+  static std::size_t _newIndex()
+  {
+    static std::size_t numIndices = 0;
+    std::size_t index;
+#pragma omp critical(threadMathEvaluator)
+    {
+      if(_freeIndices().empty())
+        index = numIndices++;
+      else {
+        index = _freeIndices().back();
+        _freeIndices().pop_back();
+      }
+    }
+    return index;
+  }
+  struct Slot {
+    std::size_t generation;
+    std::unique_ptr<mathEvaluator> evaluator;
+    Slot() : generation(0) {}
+  };
 
 public:
-  MathEvalExpression() : _f(nullptr) {}
-  ~MathEvalExpression()
+  threadMathEvaluator() : _index(_newIndex()), _generation(0) {}
+  threadMathEvaluator(const threadMathEvaluator &) = delete;
+  threadMathEvaluator &operator=(const threadMathEvaluator &) = delete;
+  ~threadMathEvaluator()
+  {
+#pragma omp critical(threadMathEvaluator)
+    _freeIndices().push_back(_index);
+  }
+  bool empty() const { return !_generation; }
+  bool set(const std::vector<std::string> &expressions,
+           const std::vector<std::string> &variables)
+  {
+    static std::atomic<std::size_t> numGenerations(0);
+    _generation = 0;
+    std::vector<std::string> expr(expressions);
+    mathEvaluator e(expr, variables);
+    if(expr.empty()) return false;
+    _expressions = expressions;
+    _variables = variables;
+    _generation = ++numGenerations;
+    return true;
+  }
+  bool eval(const std::vector<double> &values, std::vector<double> &res) const
   {
-    if(_f) delete _f;
+    if(!_generation) return false;
+    // one evaluator per thread, rebuilt when the expressions change
+    thread_local std::vector<Slot> slots;
+    if(slots.size() <= _index) slots.resize(_index + 1);
+    Slot &slot = slots[_index];
+    if(slot.generation != _generation) {
+      std::vector<std::string> expr(_expressions);
+      slot.evaluator.reset(new mathEvaluator(expr, _variables));
+      slot.generation = _generation;
+    }
+    return slot.evaluator->eval(values, res);
   }
+};
+
+class MathEvalExpression {
+private:
+  threadMathEvaluator _f;
+  std::set<int> _fields;
+
+public:
+  MathEvalExpression() {}
   bool set_function(const std::string &f)
   {
     // get id numbers of fields appearing in the function
@@ -1014,18 +1120,11 @@ public:
       sstream << "F" << *it;
       variables[i++] = sstream.str();
     }
-    if(_f) delete _f;
-    _f = new mathEvaluator(expressions, variables);
-    if(expressions.empty()) {
-      delete _f;
-      _f = nullptr;
-      return false;
-    }
-    return true;
+    return _f.set(expressions, variables);
   }
   double evaluate(double x, double y, double z)
   {
-    if(!_f) return MAX_LC;
+    if(_f.empty()) return MAX_LC;
     std::vector<double> values(3 + _fields.size()), res(1);
     values[0] = x;
     values[1] = y;
@@ -1041,28 +1140,47 @@ public:
         values[i++] = MAX_LC;
       }
     }
-    if(_f->eval(values, res))
+    if(_f.eval(values, res))
       return res[0];
     else
       return MAX_LC;
   }
+  void evaluate(const double *xyz, std::size_t n, double *out)
+  {
+    if(_f.empty()) {
+      std::fill(out, out + n, MAX_LC);
+      return;
+    }
+    // evaluate the fields used in the expression on all the points first
+    std::vector<std::vector<double> > fieldValues(_fields.size());
+    int i = 0;
+    for(auto it = _fields.begin(); it != _fields.end(); it++, i++) {
+      Field *field = GModel::current()->getFields()->get(*it);
+      fieldValues[i].resize(n, MAX_LC);
+      if(field)
+        field->evaluate(xyz, n, &fieldValues[i][0]);
+      else
+        Msg::Warning("Unknown Field %i in MathEval", *it);
+    }
+    std::vector<double> values(3 + _fields.size()), res(1);
+    for(std::size_t p = 0; p < n; p++) {
+      values[0] = xyz[3 * p];
+      values[1] = xyz[3 * p + 1];
+      values[2] = xyz[3 * p + 2];
+      for(std::size_t j = 0; j < fieldValues.size(); j++)
+        values[3 + j] = fieldValues[j][p];
+      out[p] = _f.eval(values, res) ? res[0] : MAX_LC;
+    }
+  }
 };
 
 class MathEvalExpressionAniso {
 private:
-  mathEvaluator *_f[6];
+  threadMathEvaluator _f[6];
   std::set<int> _fields[6];
 
 public:
-  MathEvalExpressionAniso()
-  {
-    for(int i = 0; i < 6; i++) _f[i] = nullptr;
-  }
-  ~MathEvalExpressionAniso()
-  {
-    for(int i = 0; i < 6; i++)
-      if(_f[i]) delete _f[i];
-  }
+  MathEvalExpressionAniso() {}
   bool set_function(int iFunction, const std::string &f)
   {
     // get id numbers of fields appearing in the function
@@ -1094,20 +1212,13 @@ public:
       sstream << "F" << *it;
       variables[i++] = sstream.str();
     }
-    if(_f[iFunction]) delete _f[iFunction];
-    _f[iFunction] = new mathEvaluator(expressions, variables);
-    if(expressions.empty()) {
-      delete _f[iFunction];
-      _f[iFunction] = nullptr;
-      return false;
-    }
-    return true;
+    return _f[iFunction].set(expressions, variables);
   }
   void evaluate(double x, double y, double z, SMetric3 &metr)
   {
     const int index[6][2] = {{0, 0}, {1, 1}, {2, 2}, {0, 1}, {0, 2}, {1, 2}};
     for(int iFunction = 0; iFunction < 6; iFunction++) {
-      if(!_f[iFunction])
+      if(_f[iFunction].empty())
         metr(index[iFunction][0], index[iFunction][1]) = MAX_LC;
       else {
         std::vector<double> values(3 + _fields[iFunction].size()), res(1);
@@ -1126,7 +1237,7 @@ public:
             values[i++] = MAX_LC;
           }
         }
-        if(_f[iFunction]->eval(values, res))
+        if(_f[iFunction].eval(values, res))
           metr(index[iFunction][0], index[iFunction][1]) = res[0];
         else
           metr(index[iFunction][0], index[iFunction][1]) = MAX_LC;
@@ -1147,21 +1258,26 @@ public:
     options["F"] = new FieldOptionString(
       _f, "Mathematical function to evaluate.", &updateNeeded);
   }
+  void update()
+  {
+    if(updateNeeded) {
+      if(!_expr.set_function(_f))
+        Msg::Error("Field %i: invalid matheval expression \"%s\"", this->id,
+                   _f.c_str());
+      updateNeeded = false;
+    }
+  }
   using Field::operator();
   double operator()(double x, double y, double z, GEntity *ge = nullptr)
   {
-    double ret = 0;
-#pragma omp critical
-    {
-      if(updateNeeded) {
-        if(!_expr.set_function(_f))
-          Msg::Error("Field %i: invalid matheval expression \"%s\"", this->id,
-                     _f.c_str());
-        updateNeeded = false;
-      }
-      ret = _expr.evaluate(x, y, z);
-    }
-    return ret;
+    updateIfNeeded();
+    return _expr.evaluate(x, y, z);
+  }
+  void evaluate(const double *xyz, std::size_t n, double *values,
+                GEntity *ge = nullptr)
+  {
+    updateIfNeeded();
+    _expr.evaluate(xyz, n, values);
   }
   const char *getName() { return "MathEval"; }
   std::string getDescription()
@@ -1215,37 +1331,27 @@ public:
     options["m23"] =
       new FieldOptionString(_f[5], "[Deprecated]", &updateNeeded, true);
   }
-  void operator()(double x, double y, double z, SMetric3 &metr,
-                  GEntity *ge = nullptr)
+  void update()
   {
-#pragma omp critical
-    {
-      if(updateNeeded) {
-        for(int i = 0; i < 6; i++) {
-          if(!_expr.set_function(i, _f[i]))
-            Msg::Error("Field %i: invalid matheval expression \"%s\"", this->id,
-                       _f[i].c_str());
-        }
-        updateNeeded = false;
+    if(updateNeeded) {
+      for(int i = 0; i < 6; i++) {
+        if(!_expr.set_function(i, _f[i]))
+          Msg::Error("Field %i: invalid matheval expression \"%s\"", this->id,
+                     _f[i].c_str());
       }
-      _expr.evaluate(x, y, z, metr);
+      updateNeeded = false;
     }
   }
+  void operator()(double x, double y, double z, SMetric3 &metr,
+                  GEntity *ge = nullptr)
+  {
+    updateIfNeeded();
+    _expr.evaluate(x, y, z, metr);
+  }
   double operator()(double x, double y, double z, GEntity *ge = nullptr)
   {
     SMetric3 metr;
-#pragma omp critical
-    {
-      if(updateNeeded) {
-        for(int i = 0; i < 6; i++) {
-          if(!_expr.set_function(i, _f[i]))
-            Msg::Error("Field %i: invalid matheval expression \"%s\"", this->id,
-                       _f[i].c_str());
-        }
-        updateNeeded = false;
-      }
-      _expr.evaluate(x, y, z, metr);
-    }
+    (*this)(x, y, z, metr, ge);
     return metr(0, 0);
   }
   const char *getName() { return "MathEvalAniso"; }
@@ -1407,19 +1513,27 @@ public:
       new FieldOptionString(_cmdLine, "Command line to launch", &updateNeeded);
   }
   ~ExternalProcessField() { closePipes(); }
-  using Field::operator();
-  double operator()(double x, double y, double z, GEntity *ge = nullptr)
+  void update()
   {
-    double xyz[3] = {x, y, z};
-    double f;
     if(updateNeeded) {
       closePipes();
       _pipes.start(_cmdLine.c_str());
       updateNeeded = false;
     }
-    if(!_pipes.write((void *)xyz, 3 * sizeof(double)) ||
-       !_pipes.read((void *)&f, sizeof(double))) {
-      f = 1e22; // std::numeric_limits<double>::max();
+  }
+  using Field::operator();
+  double operator()(double x, double y, double z, GEntity *ge = nullptr)
+  {
+    double xyz[3] = {x, y, z};
+    double f;
+    // the external process answers one request at a time
+#pragma omp critical
+    {
+      update();
+      if(!_pipes.write((void *)xyz, 3 * sizeof(double)) ||
+         !_pipes.read((void *)&f, sizeof(double))) {
+        f = 1e22; // std::numeric_limits<double>::max();
+      }
     }
     return f;
   }
@@ -1524,8 +1638,7 @@ public:
            "See the MathEval Field help to get a description of valid FX, FY "
            "and FZ expressions.";
   }
-  using Field::operator();
-  double operator()(double x, double y, double z, GEntity *ge = nullptr)
+  void update()
   {
     if(updateNeeded) {
       for(int i = 0; i < 3; i++) {
@@ -1535,6 +1648,11 @@ public:
       }
       updateNeeded = false;
     }
+  }
+  using Field::operator();
+  double operator()(double x, double y, double z, GEntity *ge = nullptr)
+  {
+    updateIfNeeded();
     if(_inField == id) return MAX_LC;
     Field *field = GModel::current()->getFields()->get(_inField);
     if(!field) {
@@ -1851,21 +1969,22 @@ public:
   {
     return "Take the minimum value of a list of fields.";
   }
-  using Field::operator();
-  double operator()(double x, double y, double z, GEntity *ge = nullptr)
+  void update()
   {
-#pragma omp critical
-    {
-      if(updateNeeded) {
-        _fields.clear();
-        for(auto it = _fieldIds.begin(); it != _fieldIds.end(); it++) {
-          Field *f = (GModel::current()->getFields()->get(*it));
-          if(!f) Msg::Warning("Unknown Field %i", *it);
-          if(f && *it != id) _fields.push_back(f);
-        }
-        updateNeeded = false;
+    if(updateNeeded) {
+      _fields.clear();
+      for(auto it = _fieldIds.begin(); it != _fieldIds.end(); it++) {
+        Field *f = (GModel::current()->getFields()->get(*it));
+        if(!f) Msg::Warning("Unknown Field %i", *it);
+        if(f && *it != id) _fields.push_back(f);
       }
+      updateNeeded = false;
     }
+  }
+  using Field::operator();
+  double operator()(double x, double y, double z, GEntity *ge = nullptr)
+  {
+    updateIfNeeded();
 
     double v = MAX_LC;
     for(auto f : _fields) {
@@ -1882,6 +2001,35 @@ public:
     }
     return v;
   }
+  void evaluate(const double *xyz, std::size_t n, double *values,
+                GEntity *ge = nullptr)
+  {
+    updateIfNeeded();
+    std::fill(values, values + n, MAX_LC);
+    for(auto f : _fields) {
+      if(f->isotropic()) {
+        // evaluate by chunks in a stack buffer: no allocation, and safe for
+        // nested Min/Max fields
+        double tmp[256];
+        for(std::size_t j = 0; j < n; j += 256) {
+          std::size_t m = std::min(n - j, (std::size_t)256);
+          f->evaluate(&xyz[3 * j], m, tmp, ge);
+          for(std::size_t i = 0; i < m; i++)
+            values[j + i] = std::min(values[j + i], tmp[i]);
+        }
+      }
+      else {
+        for(std::size_t i = 0; i < n; i++) {
+          SMetric3 ff;
+          (*f)(xyz[3 * i], xyz[3 * i + 1], xyz[3 * i + 2], ff, ge);
+          fullMatrix<double> V(3, 3);
+          fullVector<double> S(3);
+          ff.eig(V, S, 1);
+          values[i] = std::min(values[i], sqrt(1. / S(2)));
+        }
+      }
+    }
+  }
   const char *getName() { return "Min"; }
 };
 
@@ -1900,21 +2048,22 @@ public:
   {
     return "Take the maximum value of a list of fields.";
   }
-  using Field::operator();
-  double operator()(double x, double y, double z, GEntity *ge = nullptr)
+  void update()
   {
-#pragma omp critical
-    {
-      if(updateNeeded) {
-        _fields.clear();
-        for(auto it = _fieldIds.begin(); it != _fieldIds.end(); it++) {
-          Field *f = (GModel::current()->getFields()->get(*it));
-          if(!f) Msg::Warning("Unknown Field %i", *it);
-          if(f && *it != id) _fields.push_back(f);
-        }
-        updateNeeded = false;
+    if(updateNeeded) {
+      _fields.clear();
+      for(auto it = _fieldIds.begin(); it != _fieldIds.end(); it++) {
+        Field *f = (GModel::current()->getFields()->get(*it));
+        if(!f) Msg::Warning("Unknown Field %i", *it);
+        if(f && *it != id) _fields.push_back(f);
       }
+      updateNeeded = false;
     }
+  }
+  using Field::operator();
+  double operator()(double x, double y, double z, GEntity *ge = nullptr)
+  {
+    updateIfNeeded();
 
     double v = -MAX_LC;
     for(auto f : _fields) {
@@ -1931,6 +2080,35 @@ public:
     }
     return v;
   }
+  void evaluate(const double *xyz, std::size_t n, double *values,
+                GEntity *ge = nullptr)
+  {
+    updateIfNeeded();
+    std::fill(values, values + n, -MAX_LC);
+    for(auto f : _fields) {
+      if(f->isotropic()) {
+        // evaluate by chunks in a stack buffer: no allocation, and safe for
+        // nested Min/Max fields
+        double tmp[256];
+        for(std::size_t j = 0; j < n; j += 256) {
+          std::size_t m = std::min(n - j, (std::size_t)256);
+          f->evaluate(&xyz[3 * j], m, tmp, ge);
+          for(std::size_t i = 0; i < m; i++)
+            values[j + i] = std::max(values[j + i], tmp[i]);
+        }
+      }
+      else {
+        for(std::size_t i = 0; i < n; i++) {
+          SMetric3 ff;
+          (*f)(xyz[3 * i], xyz[3 * i + 1], xyz[3 * i + 2], ff, ge);
+          fullMatrix<double> V(3, 3);
+          fullVector<double> S(3);
+          ff.eig(V, S, 1);
+          values[i] = std::max(values[i], sqrt(1. / S(0)));
+        }
+      }
+    }
+  }
   const char *getName() { return "Max"; }
 };
 
@@ -2083,6 +2261,12 @@ public:
     }
     return _vOut;
   }
+  void evaluate(const double *xyz, std::size_t n, double *values,
+                GEntity *ge = nullptr)
+  {
+    // the value only depends on the entity
+    if(n) std::fill(values, values + n, ConstantField::operator()(0, 0, 0, ge));
+  }
   const char *getName() { return "Constant"; }
 };
 
@@ -2095,24 +2279,19 @@ struct AttractorInfo {
   double u, v;
 };
 
-#if defined(HAVE_ANN)
-
 class AttractorAnisoCurveField : public Field {
 private:
-  ANNkd_tree *_kdTree;
-  ANNpointArray _zeroNodes;
-  ANNidxArray _index;
-  ANNdistArray _dist;
+  SPoint3Cloud _zeroNodes;
+  SPoint3CloudAdaptor<SPoint3Cloud> _pc2kdtree;
+  SPoint3KDTree *_kdTree;
   std::list<int> _curveTags;
   double _dMin, _dMax, _lMinTangent, _lMaxTangent, _lMinNormal, _lMaxNormal;
   int _sampling;
   std::vector<SVector3> _tg;
 
 public:
-  AttractorAnisoCurveField() : _kdTree(nullptr), _zeroNodes(nullptr)
+  AttractorAnisoCurveField() : _pc2kdtree(_zeroNodes), _kdTree(nullptr)
   {
-    _index = new ANNidx[1];
-    _dist = new ANNdist[1];
     _sampling = 20;
     updateNeeded = true;
     _dMin = 0.1;
@@ -2173,9 +2352,6 @@ public:
   ~AttractorAnisoCurveField()
   {
     if(_kdTree) delete _kdTree;
-    if(_zeroNodes) annDeallocPts(_zeroNodes);
-    delete[] _index;
-    delete[] _dist;
   }
   const char *getName() { return "AttractorAnisoCurve"; }
   std::string getDescription()
@@ -2187,14 +2363,11 @@ public:
   }
   void update()
   {
-    if(_zeroNodes) {
-      annDeallocPts(_zeroNodes);
-      delete _kdTree;
-    }
-    int totpoints = _sampling * _curveTags.size();
-    if(totpoints) { _zeroNodes = annAllocPts(totpoints, 3); }
-    _tg.resize(totpoints);
-    int k = 0;
+    if(!updateNeeded) return;
+    if(_kdTree) delete _kdTree;
+    _kdTree = nullptr;
+    _zeroNodes.pts.clear();
+    _tg.clear();
     for(auto it = _curveTags.begin(); it != _curveTags.end(); ++it) {
       GEdge *e = GModel::current()->getEdgeByTag(*it);
       if(e) {
@@ -2204,29 +2377,45 @@ public:
           double t = b.low() + u * (b.high() - b.low());
           GPoint gp = e->point(t);
           SVector3 d = e->firstDer(t);
-          _zeroNodes[k][0] = gp.x();
-          _zeroNodes[k][1] = gp.y();
-          _zeroNodes[k][2] = gp.z();
-          _tg[k] = d;
-          _tg[k].normalize();
-          k++;
+          d.normalize();
+          _zeroNodes.pts.push_back(SPoint3(gp.x(), gp.y(), gp.z()));
+          _tg.push_back(d);
         }
       }
       else {
         Msg::Warning("Unknown curve %d", *it);
       }
     }
-    _kdTree = new ANNkd_tree(_zeroNodes, totpoints, 3);
+    if(_zeroNodes.pts.size()) {
+      _kdTree = new SPoint3KDTree(3, _pc2kdtree,
+                                  nanoflann::KDTreeSingleIndexAdaptorParams(10));
+      _kdTree->buildIndex();
+    }
     updateNeeded = false;
   }
+  // nearest sampling point: the search only reads the tree, so it can be
+  // performed concurrently once the tree has been built
+  bool nearest(double x, double y, double z, std::size_t &index, double &d)
+  {
+    updateIfNeeded();
+    if(!_kdTree) return false;
+    double pt[3] = {x, y, z};
+    nanoflann::KNNResultSet<double> res(1);
+    double dist2 = 0.;
+    res.init(&index, &dist2);
+    _kdTree->findNeighbors(res, &pt[0], nanoflann::SearchParams(10));
+    d = sqrt(dist2);
+    return true;
+  }
   void operator()(double x, double y, double z, SMetric3 &metr,
                   GEntity *ge = nullptr)
   {
-    if(updateNeeded) update();
-    double xyz[3] = {x, y, z};
-#pragma omp critical // avoid crash (still incorrect) - use Distance instead
-    _kdTree->annkSearch(xyz, 1, _index, _dist);
-    double d = sqrt(_dist[0]);
+    std::size_t index = 0;
+    double d = 0.;
+    if(!nearest(x, y, z, index, d)) {
+      metr = SMetric3(1 / (MAX_LC * MAX_LC));
+      return;
+    }
     double lTg = d < _dMin ? _lMinTangent :
                  d > _dMax ? _lMaxTangent :
                              _lMinTangent + (_lMaxTangent - _lMinTangent) *
@@ -2235,7 +2424,7 @@ public:
                 d > _dMax ? _lMaxNormal :
                             _lMinNormal + (_lMaxNormal - _lMinNormal) *
                                             (d - _dMin) / (_dMax - _dMin);
-    SVector3 t = _tg[_index[0]];
+    SVector3 t = _tg[index];
     SVector3 n0 = crossprod(t, fabs(t(0)) > fabs(t(1)) ? SVector3(0, 1, 0) :
                                                          SVector3(1, 0, 0));
     SVector3 n1 = crossprod(t, n0);
@@ -2243,17 +2432,13 @@ public:
   }
   virtual double operator()(double X, double Y, double Z, GEntity *ge = nullptr)
   {
-    if(updateNeeded) update();
-    double xyz[3] = {X, Y, Z};
-#pragma omp critical // avoid crash (still incorrect) - use Distance instead
-    _kdTree->annkSearch(xyz, 1, _index, _dist);
-    double d = sqrt(_dist[0]);
+    std::size_t index = 0;
+    double d = 0.;
+    if(!nearest(X, Y, Z, index, d)) return MAX_LC;
     return std::max(d, 0.05);
   }
 };
 
-#endif // ANN
-
 class OctreeField : public Field {
 private:
   // octree field
@@ -2406,6 +2591,13 @@ private:
   }
   virtual double operator()(double X, double Y, double Z, GEntity *ge = nullptr)
   {
+    if(updateNeeded || !_root) {
+      // the octree is built by evaluating the input field, which could itself
+      // need to lock: use a named critical section
+#pragma omp critical(OctreeFieldUpdate)
+      update();
+      if(!_root) return MAX_LC;
+    }
     SPoint3 xmin = bounds.min();
     SVector3 d = bounds.max() - xmin;
     return _root->evaluate((X - xmin.x()) / _l0, (Y - xmin.y()) / _l0,
@@ -2453,10 +2645,138 @@ class DistanceField : public Field {
   SPoint3Cloud _pc;
   SPoint3CloudAdaptor<SPoint3Cloud> _pc2kdtree;
   SPoint3KDTree *_kdtree;
-  std::size_t _outIndex;
+  // exact mode: distance to the points, mesh lines and mesh triangles of the
+  // entities (or to the sampling points of the entities that are not meshed)
+  struct Primitive {
+    SPoint3 p[3];
+    int num;
+    AttractorInfo info;
+  };
+  bool _exact;
+  std::size_t _numElements;
+  std::vector<Primitive> _prims;
+  SBoundingBox3dBVH _bvh;
+  // closest point (or primitive in exact mode) found by the last evaluation
+  // of the calling thread
+  struct LastQuery {
+    const DistanceField *field;
+    std::size_t index;
+    SPoint3 point;
+  };
+  static LastQuery &lastQuery()
+  {
+    static thread_local LastQuery q = {nullptr, 0, SPoint3()};
+    return q;
+  }
+  void setLastQuery(std::size_t index) const
+  {
+    LastQuery &q = lastQuery();
+    q.field = this;
+    q.index = index;
+  }
+
+  static double distance2(const Primitive &q, const SPoint3 &p, SPoint3 &c)
+  {
+    double d = 0.;
+    if(q.num == 1)
+      c = q.p[0];
+    else if(q.num == 2)
+      signedDistancePointLine(q.p[0], q.p[1], p, d, c);
+    else
+      signedDistancePointTriangle(q.p[0], q.p[1], q.p[2], p, d, c);
+    double d2 = p.distance(c);
+    return d2 * d2;
+  }
+  void addPrimitive(const SPoint3 &p0, const SPoint3 &p1, const SPoint3 &p2,
+                    int num, const AttractorInfo &info)
+  {
+    // degenerate segments and triangles are replaced by points and segments
+    if(num == 3 && norm(crossprod(p1 - p0, p2 - p0)) == 0.) {
+      addPrimitive(p0, p1, p1, 2, info);
+      addPrimitive(p1, p2, p2, 2, info);
+      addPrimitive(p0, p2, p2, 2, info);
+      return;
+    }
+    if(num == 2 && p0.distance(p1) == 0.) num = 1;
+    Primitive q;
+    q.p[0] = p0;
+    q.p[1] = p1;
+    q.p[2] = p2;
+    q.num = num;
+    q.info = info;
+    _prims.push_back(q);
+  }
+  std::size_t countElements() const
+  {
+    std::size_t n = 0;
+    for(auto t : _curveTags) {
+      GEdge *e = GModel::current()->getEdgeByTag(t);
+      if(e) n += e->lines.size();
+    }
+    for(auto t : _surfaceTags) {
+      GFace *f = GModel::current()->getFaceByTag(t);
+      if(f) n += f->triangles.size() + f->quadrangles.size();
+    }
+    return n;
+  }
+  void buildExact()
+  {
+    _prims.clear();
+    std::set<std::pair<int, int> > meshed;
+    for(auto t : _curveTags) {
+      GEdge *e = GModel::current()->getEdgeByTag(t);
+      if(!e || e->lines.empty()) continue;
+      meshed.insert(std::make_pair(1, t));
+      for(auto l : e->lines) {
+        SPoint3 p0 = l->getVertex(0)->point(), p1 = l->getVertex(1)->point();
+        addPrimitive(p0, p1, p1, 2, AttractorInfo(t, 1, 0, 0));
+      }
+    }
+    for(auto t : _surfaceTags) {
+      GFace *f = GModel::current()->getFaceByTag(t);
+      if(!f || (f->triangles.empty() && f->quadrangles.empty())) continue;
+      meshed.insert(std::make_pair(2, t));
+      for(auto tri : f->triangles) {
+        addPrimitive(tri->getVertex(0)->point(), tri->getVertex(1)->point(),
+                     tri->getVertex(2)->point(), 3, AttractorInfo(t, 2, 0, 0));
+      }
+      for(auto q : f->quadrangles) {
+        SPoint3 p[4];
+        for(int i = 0; i < 4; i++) p[i] = q->getVertex(i)->point();
+        addPrimitive(p[0], p[1], p[2], 3, AttractorInfo(t, 2, 0, 0));
+        addPrimitive(p[0], p[2], p[3], 3, AttractorInfo(t, 2, 0, 0));
+      }
+    }
+    // sampling points of the points and of the entities that are not meshed
+    for(std::size_t i = 0; i < _pc.pts.size(); i++) {
+      if(meshed.count(std::make_pair(_infos[i].dim, _infos[i].ent))) continue;
+      addPrimitive(_pc.pts[i], _pc.pts[i], _pc.pts[i], 1, _infos[i]);
+    }
+    std::vector<SBoundingBox3d> boxes(_prims.size());
+    for(std::size_t i = 0; i < _prims.size(); i++) {
+      for(int j = 0; j < _prims[i].num; j++) boxes[i] += _prims[i].p[j];
+    }
+    _bvh.build(boxes);
+    _numElements = countElements();
+    Msg::Debug("Field %i: exact distance to %lu primitives", id,
+               _prims.size());
+  }
+  double exactDistance(double x, double y, double z)
+  {
+    double pt[3] = {x, y, z};
+    SPoint3 p(x, y, z), c;
+    std::size_t index = 0;
+    double dist2;
+    auto d2 = [&](std::size_t i) { return distance2(_prims[i], p, c); };
+    if(!_bvh.closest(pt, d2, index, dist2)) return MAX_LC;
+    setLastQuery(index);
+    distance2(_prims[index], p, lastQuery().point);
+    return sqrt(dist2);
+  }
 
 public:
-  DistanceField() : _pc2kdtree(_pc), _kdtree(nullptr), _outIndex(0)
+  DistanceField()
+    : _pc2kdtree(_pc), _kdtree(nullptr), _exact(false), _numElements(0)
   {
     _sampling = 20;
 
@@ -2471,6 +2791,11 @@ public:
     options["Sampling"] = new FieldOptionInt(
       _sampling, "Linear (i.e. per dimension) number of sampling points to "
       "discretize each curve and surface", &updateNeeded);
+    options["Exact"] = new FieldOptionBool(
+      _exact, "Compute the exact distance to the mesh elements (lines and "
+      "triangles) of the curves and surfaces, using a bounding volume "
+      "hierarchy; entities that are not meshed yet are sampled",
+      &updateNeeded);
 
     // deprecated names
     options["NodesList"] =
@@ -2491,7 +2816,8 @@ public:
       new FieldOptionInt(_sampling, "[Deprecated]", &updateNeeded, true);
   }
   DistanceField(int dim, int tag, int nbe)
-    : _sampling(nbe), _pc2kdtree(_pc), _kdtree(nullptr), _outIndex(0)
+    : _sampling(nbe), _pc2kdtree(_pc), _kdtree(nullptr), _exact(false),
+      _numElements(0)
   {
     if(dim == 0)
       _pointTags.push_back(tag);
@@ -2512,20 +2838,30 @@ public:
     return "Compute the distance to the given points, curves or surfaces. "
            "For efficiency, curves and surfaces are replaced by a set "
            "of points (sampled according to Sampling), to which the distance "
-           "is actually computed.";
+           "is actually computed. If Exact is set, the distance to the mesh "
+           "elements of the curves and surfaces is computed instead.";
   }
   std::pair<AttractorInfo, SPoint3> getAttractorInfo() const
   {
-    if(_outIndex < _infos.size() && _outIndex < _pc.pts.size())
-      return std::make_pair(_infos[_outIndex], _pc.pts[_outIndex]);
+    const LastQuery &q = lastQuery();
+    if(q.field == this) {
+      std::size_t i = q.index;
+      if(_exact && i < _prims.size())
+        return std::make_pair(_prims[i].info, q.point);
+      if(!_exact && i < _infos.size() && i < _pc.pts.size())
+        return std::make_pair(_infos[i], _pc.pts[i]);
+    }
     return std::make_pair(AttractorInfo(), SPoint3());
   }
   void update()
   {
+    // in exact mode, the elements have changed if the boundary was (re)meshed
+    if(_exact && _numElements != countElements()) updateNeeded = true;
     if(updateNeeded) {
       _infos.clear();
       _pc.pts.clear();
       if(_kdtree) delete _kdtree;
+      _kdtree = nullptr;
 
       for(auto it = _pointTags.begin(); it != _pointTags.end(); ++it) {
         GVertex *gv = GModel::current()->getVertexByTag(*it);
@@ -2581,24 +2917,52 @@ public:
         }
       }
 
-      // construct a kd-tree index:
-      _kdtree = new SPoint3KDTree(3, _pc2kdtree,
-                                  nanoflann::KDTreeSingleIndexAdaptorParams(10));
-      _kdtree->buildIndex();
+      if(_exact) { buildExact(); }
+      else {
+        // construct a kd-tree index:
+        _kdtree = new SPoint3KDTree(
+          3, _pc2kdtree, nanoflann::KDTreeSingleIndexAdaptorParams(10));
+        _kdtree->buildIndex();
+      }
       updateNeeded = false;
     }
   }
   using Field::operator();
   virtual double operator()(double X, double Y, double Z, GEntity *ge = nullptr)
   {
+    if(_exact) return exactDistance(X, Y, Z);
     if(!_kdtree) return MAX_LC;
     double pt[3] = {X, Y, Z};
     nanoflann::KNNResultSet<double> res(1);
+    std::size_t outIndex = 0;
     double outDistSqr;
-    res.init(&_outIndex, &outDistSqr);
+    res.init(&outIndex, &outDistSqr);
     _kdtree->findNeighbors(res, &pt[0], nanoflann::SearchParams(10));
+    setLastQuery(outIndex);
     return sqrt(outDistSqr);
   }
+  void evaluate(const double *xyz, std::size_t n, double *values,
+                GEntity *ge = nullptr)
+  {
+    if(_exact) {
+      for(std::size_t i = 0; i < n; i++)
+        values[i] = exactDistance(xyz[3 * i], xyz[3 * i + 1], xyz[3 * i + 2]);
+      return;
+    }
+    if(!_kdtree) {
+      std::fill(values, values + n, MAX_LC);
+      return;
+    }
+    std::size_t outIndex = 0;
+    for(std::size_t i = 0; i < n; i++) {
+      nanoflann::KNNResultSet<double> res(1);
+      double outDistSqr;
+      res.init(&outIndex, &outDistSqr);
+      _kdtree->findNeighbors(res, &xyz[3 * i], nanoflann::SearchParams(10));
+      values[i] = sqrt(outDistSqr);
+    }
+    if(n) setLastQuery(outIndex);
+  }
 };
 
 class ExtendField : public Field {
@@ -2699,6 +3063,20 @@ public:
       _kdtreeSurfaces->buildIndex();
     }
   }
+  // called before each meshing pass: rebuild both trees from the current
+  // boundary mesh, so that they are never modified while meshing
+  void update()
+  {
+    recomputeCurves();
+    recomputeSurfaces();
+    updateNeeded = false;
+  }
+  bool needsUpdate(int dim) const
+  {
+    return updateNeeded ||
+           (dim == 2 && _tagCurves.size() && _sizeCurves.empty()) ||
+           (dim == 3 && _tagSurfaces.size() && _sizeSurfaces.empty());
+  }
   using Field::operator();
   virtual double operator()(double X, double Y, double Z, GEntity *ge = nullptr)
   {
@@ -2706,24 +3084,16 @@ public:
     if(ge->dim() != 2 && ge->dim() != 3) return MAX_LC;
     if(ge->dim() == 2 && _tagCurves.empty()) return MAX_LC;
     if(ge->dim() == 3 && _tagSurfaces.empty()) return MAX_LC;
+    if(needsUpdate(ge->dim())) {
+      // the field was not initialized after the boundary mesh was generated
 #pragma omp critical
-    if(updateNeeded ||
-       (ge->dim() == 2 && _tagCurves.size() && _sizeCurves.empty())) {
-      // we are meshing our first surface; recompute distance to the elements on
-      // curves, and invalidate the distance to surfaces
-      recomputeCurves();
-      _sizeSurfaces.clear();
-      updateNeeded = false;
-    }
-#pragma omp critical
-    if(updateNeeded ||
-       (ge->dim() == 3 && _tagSurfaces.size() && _sizeSurfaces.empty())) {
-      // we are meshing our first volume; recompute distance to the elements on
-      // surfaces, and invalidate the distance to curves (to be ready for
-      // subsequent surface meshing pass)
-      recomputeSurfaces();
-      _sizeCurves.clear();
-      updateNeeded = false;
+      if(needsUpdate(ge->dim())) {
+        if(ge->dim() == 2)
+          recomputeCurves();
+        else
+          recomputeSurfaces();
+        updateNeeded = false;
+      }
     }
     double pt[3] = {X, Y, Z};
     nanoflann::KNNResultSet<double> res(1);
@@ -2964,6 +3334,27 @@ bool BoundaryLayerField::setupFor2d(int iF)
   return true;
 }
 
+bool BoundaryLayerField::isFaceBL(int iF) const
+{
+  if(std::find(_excludedSurfaceTags.begin(), _excludedSurfaceTags.end(), iF) !=
+     _excludedSurfaceTags.end())
+    return false;
+
+  GFace *gf = GModel::current()->getFaceByTag(iF);
+  if(!gf) return false;
+
+  const std::list<int> &curves =
+    _curveTagsSaved.empty() ? _curveTags : _curveTagsSaved;
+  std::vector<GEdge *> ed = gf->edges();
+  std::vector<GEdge *> const &embedded_edges = gf->embeddedEdges();
+  ed.insert(ed.begin(), embedded_edges.begin(), embedded_edges.end());
+  for(auto it = ed.begin(); it != ed.end(); ++it) {
+    if(std::find(curves.begin(), curves.end(), (*it)->tag()) != curves.end())
+      return true;
+  }
+  return false;
+}
+
 double BoundaryLayerField::operator()(double x, double y, double z, GEntity *ge)
 {
   if(updateNeeded) {
@@ -3198,10 +3589,8 @@ FieldManager::FieldManager()
   mapTypeName["ExternalProcess"] = new FieldFactoryT<ExternalProcessField>();
   mapTypeName["MathEval"] = new FieldFactoryT<MathEvalField>();
   mapTypeName["MathEvalAniso"] = new FieldFactoryT<MathEvalFieldAniso>();
-#if defined(HAVE_ANN)
   mapTypeName["AttractorAnisoCurve"] =
     new FieldFactoryT<AttractorAnisoCurveField>();
-#endif
   mapTypeName["MaxEigenHessian"] = new FieldFactoryT<MaxEigenHessianField>();
   mapTypeName["AutomaticMeshSizeField"] =
     new FieldFactoryT<automaticMeshSizeField>();
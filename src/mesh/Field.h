@@ -10,6 +10,7 @@
 #include <map>
 #include <vector>
 #include <list>
+#include <atomic>
 #include "GmshConfig.h"
 #include "Context.h"
 #include "STensor3.h"
@@ -53,14 +54,15 @@ private:
   bool _deprecated;
 
 protected:
-  bool *status;
+  std::atomic<bool> *status;
   inline void modified()
   {
     if(status) *status = true;
   }
 
 public:
-  FieldOption(const std::string &help, bool *_status, bool deprecated)
+  FieldOption(const std::string &help, std::atomic<bool> *_status,
+              bool deprecated)
     : _help(help), _deprecated(deprecated), status(_status)
   {
   }
@@ -126,7 +128,26 @@ public:
                           GEntity *ge = nullptr)
   {
   }
-  bool updateNeeded;
+  // isotropic, at n points with coordinates xyz[3 * i], xyz[3 * i + 1] and
+  // xyz[3 * i + 2]: fields override this to avoid a virtual call (and the
+  // evaluation of the fields they depend on) per point
+  virtual void evaluate(const double *xyz, std::size_t n, double *values,
+                        GEntity *ge = nullptr);
+  // set when an option is modified; read concurrently during meshing, hence
+  // atomic
+  std::atomic<bool> updateNeeded;
+  // call update() if an option was modified: once the update is done all the
+  // threads see the new data, without locking
+  void updateIfNeeded()
+  {
+    if(updateNeeded.load(std::memory_order_acquire)) {
+#pragma omp critical(FieldUpdate)
+      if(updateNeeded.load(std::memory_order_relaxed)) {
+        update();
+        updateNeeded.store(false, std::memory_order_release);
+      }
+    }
+  }
   virtual const char *getName() = 0;
 #if defined(HAVE_POST)
   void putOnView(PView *view, int comp = -1);
@@ -259,6 +280,9 @@ public:
   void computeFor1dMesh(double x, double y, double z, SMetric3 &metr);
   void setupFor1d(int iE);
   bool setupFor2d(int iF);
+  // does the field create a boundary layer in surface iF? (does not modify
+  // the field, contrary to setupFor2d)
+  bool isFaceBL(int iF) const;
   void removeAttractors();
 };
 
@@ -267,7 +291,8 @@ public:
   std::string &val;
   virtual FieldOptionType getType() { return FIELD_OPTION_STRING; }
   FieldOptionString(std::string &_val, const std::string &help,
-                    bool *status = nullptr, bool deprecated = false)
+                    std::atomic<bool> *status = nullptr,
+                    bool deprecated = false)
     : FieldOption(help, status, deprecated), val(_val)
   {
   }
@@ -290,7 +315,8 @@ public:
   double &val;
   FieldOptionType getType() { return FIELD_OPTION_DOUBLE; }
   FieldOptionDouble(double &_val, const std::string &help,
-                    bool *status = nullptr, bool deprecated = false)
+                    std::atomic<bool> *status = nullptr,
+                    bool deprecated = false)
     : FieldOption(help, status, deprecated), val(_val)
   {
   }
@@ -313,8 +339,8 @@ class FieldOptionInt : public FieldOption {
 public:
   int &val;
   FieldOptionType getType() { return FIELD_OPTION_INT; }
-  FieldOptionInt(int &_val, const std::string &help, bool *status = nullptr,
-                 bool deprecated = false)
+  FieldOptionInt(int &_val, const std::string &help,
+                 std::atomic<bool> *status = nullptr, bool deprecated = false)
     : FieldOption(help, status, deprecated), val(_val)
   {
   }
@@ -337,7 +363,7 @@ public:
   std::list<int> &val;
   FieldOptionType getType() { return FIELD_OPTION_LIST; }
   FieldOptionList(std::list<int> &_val, const std::string &help,
-                  bool *status = nullptr, bool deprecated = false)
+                  std::atomic<bool> *status = nullptr, bool deprecated = false)
     : FieldOption(help, status, deprecated), val(_val)
   {
   }
@@ -365,7 +391,8 @@ public:
   std::list<double> &val;
   FieldOptionType getType() { return FIELD_OPTION_LIST_DOUBLE; }
   FieldOptionListDouble(std::list<double> &_val, const std::string &help,
-                        bool *status = nullptr, bool deprecated = false)
+                        std::atomic<bool> *status = nullptr,
+                        bool deprecated = false)
     : FieldOption(help, status, deprecated), val(_val)
   {
   }
@@ -393,7 +420,7 @@ class FieldOptionPath : public FieldOptionString {
 public:
   virtual FieldOptionType getType() { return FIELD_OPTION_PATH; }
   FieldOptionPath(std::string &val, const std::string &help,
-                  bool *status = nullptr, bool deprecated = false)
+                  std::atomic<bool> *status = nullptr, bool deprecated = false)
     : FieldOptionString(val, help, status, deprecated)
   {
   }
@@ -403,8 +430,8 @@ class FieldOptionBool : public FieldOption {
 public:
   bool &val;
   FieldOptionType getType() { return FIELD_OPTION_BOOL; }
-  FieldOptionBool(bool &_val, const std::string &help, bool *status = nullptr,
-                  bool deprecated = false)
+  FieldOptionBool(bool &_val, const std::string &help,
+                  std::atomic<bool> *status = nullptr, bool deprecated = false)
     : FieldOption(help, status, deprecated), val(_val)
   {
   }
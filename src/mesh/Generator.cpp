@@ -12,6 +12,8 @@
 #include "Numeric.h"
 #include "Context.h"
 #include "OS.h"
+#include "StringUtils.h"
+#include "Profiler.h"
 #include "GModel.h"
 #include "MPoint.h"
 #include "MLine.h"
@@ -36,6 +38,7 @@
 #include "Field.h"
 #include "Options.h"
 #include "Generator.h"
+#include "robustPredicates.h"
 #include "meshQuadQuasiStructured.h"
 #include "meshGFaceBipartiteLabelling.h"
 #include "sizeField.h"
@@ -293,6 +296,47 @@ void GetStatistics(double stat[50], double quality[3][100], bool visibleOnly)
 #endif
 }
 
+void AppendBenchReport(const std::string &fileName)
+{
+  FILE *fp = Fopen(fileName.c_str(), "a");
+  if(!fp) {
+    Msg::Error("Could not open file '%s'", fileName.c_str());
+    return;
+  }
+
+  double stat[50], quality[3][100];
+  GetStatistics(stat, quality);
+  const double *w = CTX::instance()->meshTimer;
+  const double *c = CTX::instance()->meshCpuTimer;
+  int nt = CTX::instance()->numThreads;
+  if(!nt) nt = Msg::GetMaxThreads();
+
+  // one JSON object per line (JSON Lines), so that reports of successive runs
+  // can simply be appended to the same file
+  fprintf(fp, "{\"file\": %s, \"threads\": %d, \"seed\": %d, ",
+          JsonString(GModel::current()->getFileName()).c_str(), nt,
+          CTX::instance()->mesh.randomSeed);
+  fprintf(fp, "\"wall\": {\"1d\": %g, \"2d\": %g, \"3d\": %g, "
+              "\"optimize\": %g, \"io\": %g}, ",
+          w[0], w[1], w[2], w[3], w[4]);
+  fprintf(fp, "\"cpu\": {\"1d\": %g, \"2d\": %g, \"3d\": %g, "
+              "\"optimize\": %g, \"io\": %g}, ",
+          c[0], c[1], c[2], c[3], c[4]);
+  fprintf(fp, "\"peak_rss\": %ld, \"nodes\": %.16g, ", GetMemoryUsage(),
+          stat[4]);
+  fprintf(fp, "\"elements\": {\"points\": %.16g, \"lines\": %.16g, "
+              "\"triangles\": %.16g, \"quadrangles\": %.16g, "
+              "\"tetrahedra\": %.16g, \"hexahedra\": %.16g, "
+              "\"prisms\": %.16g, \"pyramids\": %.16g, \"trihedra\": %.16g}, ",
+          stat[5], stat[6], stat[7], stat[8], stat[9], stat[10], stat[11],
+          stat[12], stat[13]);
+  fprintf(fp, "\"quality\": {\"sicn\": [%g, %g, %g], \"gamma\": [%g, %g, %g], "
+              "\"sige\": [%g, %g, %g]}}\n",
+          stat[19], stat[18], stat[20], stat[22], stat[21], stat[23], stat[25],
+          stat[24], stat[26]);
+  fclose(fp);
+}
+
 static bool TooManyElements(GModel *m, int dim)
 {
   if(CTX::instance()->expertMode || !m->getNumVertices()) return false;
@@ -341,6 +385,7 @@ static void Mesh0D(GModel *m)
 static void Mesh1D(GModel *m)
 {
   if(CTX::instance()->abortOnError && Msg::GetErrorCount()) return;
+  ProfilerScope scope("Mesh1D");
 
   m->getFields()->initialize();
 
@@ -410,6 +455,7 @@ static void Mesh1D(GModel *m)
 
   double t2 = Cpu(), w2 = TimeOfDay();
   CTX::instance()->meshTimer[0] = w2 - w1;
+  CTX::instance()->meshCpuTimer[0] = t2 - t1;
   Msg::StatusBar(true, "Done meshing 1D (Wall %gs, CPU %gs)",
                  CTX::instance()->meshTimer[0], t2 - t1);
 }
@@ -479,9 +525,114 @@ static void PrintMesh2dStatistics(GModel *m)
   fclose(statreport);
 }
 
+// Surfaces that rely on global state while being meshed, and which thus cannot
+// be meshed concurrently with any other surface
+static bool MeshSurfaceSerially(GFace *gf,
+                                std::vector<BoundaryLayerField *> &blFields)
+{
+  // Frontal-Delaunay for quads and co modify static members of MTri3
+  if(gf->getMeshingAlgo() == ALGO_2D_FRONTAL_QUAD ||
+     gf->getMeshingAlgo() == ALGO_2D_PACK_PRLGRMS ||
+     gf->getMeshingAlgo() == ALGO_2D_PACK_PRLGRMS_CSTR)
+    return true;
+
+  // Extruded meshes are not yet fully thread-safe (not sure why!)
+  if(gf->meshAttributes.extrude && gf->meshAttributes.extrude->mesh.ExtrudeMesh)
+    return true;
+
+  // boundary layer fields are set up for each surface they apply to
+  for(auto blf : blFields)
+    if(blf->isFaceBL(gf->tag())) return true;
+
+  return false;
+}
+
+// Sort the surfaces in successive stages, so that the mesh of a surface is only
+// generated after the mesh of the surface it depends on (periodic surfaces and
+// copies of extruded surfaces). Surfaces in each stage are meshed in parallel,
+// except those that must be meshed serially.
+static void ScheduleMesh2D(GModel *m, const std::vector<GFace *> &faces,
+                           std::vector<std::vector<GFace *> > &parallel,
+                           std::vector<std::vector<GFace *> > &serial)
+{
+  std::vector<BoundaryLayerField *> blFields;
+  bool blBackground = false;
+  FieldManager *fields = m->getFields();
+  for(int i = 0; i < fields->getNumBoundaryLayerFields(); i++) {
+    int id = fields->getBoundaryLayerField(i);
+    BoundaryLayerField *blf =
+      dynamic_cast<BoundaryLayerField *>(fields->get(id));
+    if(blf) blFields.push_back(blf);
+    if(id == fields->getBackgroundField()) blBackground = true;
+  }
+
+  std::map<GFace *, GFace *> source;
+  for(auto gf : faces) {
+    GFace *from = nullptr;
+    ExtrudeParams *ep = gf->meshAttributes.extrude;
+    if(ep && ep->mesh.ExtrudeMesh && ep->geo.Mode == COPIED_ENTITY)
+      from = m->getFaceByTag(std::abs(ep->geo.Source));
+    else if(gf->getMeshMaster() != gf)
+      from = dynamic_cast<GFace *>(gf->getMeshMaster());
+    if(from && from != gf) source[gf] = from;
+  }
+
+  for(auto gf : faces) {
+    // follow the chain of dependencies: a surface is meshed one stage after
+    // the surface it depends on; surfaces on a cycle of dependencies (which
+    // should not happen) have no well-defined order, and are meshed serially
+    std::set<GFace *> chain;
+    std::size_t s = 0;
+    GFace *f = gf;
+    bool cycle = false;
+    while(source.count(f)) {
+      if(!chain.insert(f).second) {
+        cycle = true;
+        break;
+      }
+      f = source[f];
+      s++;
+    }
+    if(s >= parallel.size()) {
+      parallel.resize(s + 1);
+      serial.resize(s + 1);
+    }
+    if(cycle || blBackground || MeshSurfaceSerially(gf, blFields))
+      serial[s].push_back(gf);
+    else
+      parallel[s].push_back(gf);
+  }
+}
+
+static void MeshSurfaces(const std::vector<GFace *> &faces, int nthreads,
+                         bool progress, int &nPending, bool &exceptions)
+{
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(size_t K = 0; K < faces.size(); K++) {
+    if(exceptions) continue;
+    int localPending = 0;
+    if(faces[K]->meshStatistics.status == GFace::PENDING) {
+      backgroundMesh::current()->unset();
+      try{ // OpenMP forbids leaving block via exception
+        faces[K]->mesh(true);
+      }
+      catch(...) {
+        exceptions = true;
+      }
+#pragma omp atomic capture
+      {
+        ++nPending;
+        localPending = nPending;
+      }
+    }
+    if(progress) Msg::ProgressMeter(localPending, false, "Meshing 2D...");
+  }
+}
+
 static void Mesh2D(GModel *m)
 {
   if(CTX::instance()->abortOnError && Msg::GetErrorCount()) return;
+  ProfilerScope scope("Mesh2D");
 
   m->getFields()->initialize();
 
@@ -494,25 +645,6 @@ static void Mesh2D(GModel *m)
     nthreads = CTX::instance()->mesh.maxNumThreads2D;
   if(!nthreads) nthreads = Msg::GetMaxThreads();
 
-  // boundary layers are not yet thread-safe
-  if(m->getFields()->getNumBoundaryLayerFields()) nthreads = 1;
-
-  for(auto it = m->firstFace(); it != m->lastFace(); ++it) {
-    // Frontal-Delaunay for quads and co are not yet thread-safe
-    if((*it)->getMeshingAlgo() == ALGO_2D_FRONTAL_QUAD ||
-       (*it)->getMeshingAlgo() == ALGO_2D_PACK_PRLGRMS ||
-       (*it)->getMeshingAlgo() == ALGO_2D_PACK_PRLGRMS_CSTR)
-      nthreads = 1;
-
-    // Periodic meshing is not yet thread-safe
-    if((*it)->getMeshMaster() != *it) nthreads = 1;
-
-    // Extruded meshes are not yet fully thread-safe (not sure why!)
-    if((*it)->meshAttributes.extrude &&
-       (*it)->meshAttributes.extrude->mesh.ExtrudeMesh)
-      nthreads = 1;
-  }
-
   for(auto it = m->firstFace(); it != m->lastFace(); ++it)
     (*it)->meshStatistics.status = GFace::PENDING;
 
@@ -522,6 +654,22 @@ static void Mesh2D(GModel *m)
   if(!Mesh2DWithBoundaryLayers(m)) {
     std::set<GFace *, GEntityPtrLessThan> f;
     for(auto it = m->firstFace(); it != m->lastFace(); ++it) f.insert(*it);
+    std::vector<GFace *> temp(f.begin(), f.end());
+
+    // surfaces that depend on other surfaces or that cannot be meshed
+    // concurrently with others are scheduled separately
+    std::vector<std::vector<GFace *> > parallel, serial;
+    ScheduleMesh2D(m, temp, parallel, serial);
+    if(nthreads > 1) {
+      std::size_t numSerial = 0;
+      for(std::size_t s = 0; s < serial.size(); s++)
+        numSerial += serial[s].size();
+      if(numSerial || parallel.size() > 1)
+        Msg::Info("Meshing %lu surface%s in %lu stage%s (%lu serially)",
+                  (unsigned long)temp.size(), temp.size() > 1 ? "s" : "",
+                  (unsigned long)parallel.size(),
+                  parallel.size() > 1 ? "s" : "", (unsigned long)numSerial);
+    }
 
     int nIter = 0, nTot = m->getNumFaces();
 
@@ -535,27 +683,9 @@ static void Mesh2D(GModel *m)
 
       int nPending = 0;
       bool exceptions = false;
-      std::vector<GFace *> temp;
-      temp.insert(temp.begin(), f.begin(), f.end());
-#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
-      for(size_t K = 0; K < temp.size(); K++) {
-        if(exceptions) continue;
-        int localPending = 0;
-        if(temp[K]->meshStatistics.status == GFace::PENDING) {
-          backgroundMesh::current()->unset();
-          try{ // OpenMP forbids leaving block via exception
-            temp[K]->mesh(true);
-          }
-          catch(...) {
-            exceptions = true;
-          }
-#pragma omp atomic capture
-          {
-            ++nPending;
-            localPending = nPending;
-          }
-        }
-        if(!nIter) Msg::ProgressMeter(localPending, false, "Meshing 2D...");
+      for(std::size_t s = 0; s < parallel.size(); s++) {
+        MeshSurfaces(parallel[s], nthreads, !nIter, nPending, exceptions);
+        MeshSurfaces(serial[s], 1, !nIter, nPending, exceptions);
       }
       if(exceptions) throw std::runtime_error(Msg::GetLastError());
       if(!nPending) break;
@@ -583,6 +713,7 @@ static void Mesh2D(GModel *m)
 
   double t2 = Cpu(), w2 = TimeOfDay();
   CTX::instance()->meshTimer[1] = w2 - w1;
+  CTX::instance()->meshCpuTimer[1] = t2 - t1;
   Msg::StatusBar(true, "Done meshing 2D (Wall %gs, CPU %gs)",
                  CTX::instance()->meshTimer[1], t2 - t1);
 
@@ -627,9 +758,70 @@ FindConnectedRegions(const std::vector<GRegion *> &del,
     connected.push_back(temp2);
     delaunay = temp1;
   }
-  Msg::Info("3D Meshing %d volume%s with %d connected component%s", nbVolumes,
-            nbVolumes > 1 ? "s" : "", connected.size(),
-            connected.size() > 1 ? "s" : "");
+  Msg::Info("3D Meshing %lu volume%s with %lu connected component%s",
+            (unsigned long)nbVolumes, nbVolumes > 1 ? "s" : "",
+            (unsigned long)connected.size(), connected.size() > 1 ? "s" : "");
+}
+
+// Connected components that only touch along a curve or at a point (or share
+// embedded entities) are not independent: the boundary recovery perturbs and
+// restores the coordinates of all their boundary nodes. Such components are
+// gathered in the same task, and are meshed one after the other; tasks can be
+// meshed concurrently.
+static void
+FindIndependentTasks(const std::vector<std::vector<GRegion *> > &connected,
+                     std::vector<std::vector<std::size_t> > &tasks)
+{
+  std::vector<std::size_t> parent(connected.size());
+  for(std::size_t i = 0; i < parent.size(); i++) parent[i] = i;
+  auto root = [&parent](std::size_t i) {
+    while(parent[i] != i) i = parent[i] = parent[parent[i]];
+    return i;
+  };
+
+  std::map<GEntity *, std::size_t> owner;
+  auto mark = [&owner, &parent, &root](GEntity *ge, std::size_t i) {
+    if(!ge) return;
+    auto it = owner.find(ge);
+    if(it == owner.end())
+      owner[ge] = i;
+    else
+      parent[root(it->second)] = root(i);
+  };
+
+  for(std::size_t i = 0; i < connected.size(); i++) {
+    for(std::size_t j = 0; j < connected[i].size(); j++) {
+      GRegion *gr = connected[i][j];
+      // don't use GRegion::edges(), which returns a static container
+      std::vector<GFace *> f = gr->faces();
+      f.insert(f.end(), gr->embeddedFaces().begin(), gr->embeddedFaces().end());
+      for(auto gf : f) {
+        mark(gf, i);
+        mark(gf->compoundSurface, i);
+        for(auto ge : gf->edges()) mark(ge, i);
+        for(auto ge : gf->embeddedEdges()) mark(ge, i);
+        for(auto gv : gf->vertices()) mark(gv, i);
+        for(auto gv : gf->embeddedVertices()) mark(gv, i);
+      }
+      for(auto ge : gr->embeddedEdges()) {
+        mark(ge, i);
+        for(auto gv : ge->vertices()) mark(gv, i);
+      }
+      for(auto gv : gr->embeddedVertices()) mark(gv, i);
+    }
+  }
+
+  std::map<std::size_t, std::size_t> index;
+  for(std::size_t i = 0; i < connected.size(); i++) {
+    std::size_t r = root(i);
+    auto it = index.find(r);
+    if(it == index.end()) {
+      index[r] = tasks.size();
+      tasks.push_back(std::vector<std::size_t>(1, i));
+    }
+    else
+      tasks[it->second].push_back(i);
+  }
 }
 
 // JFR : use hex-splitting to resolve non conformity
@@ -831,6 +1023,7 @@ static void TestConformity(GModel *gm)
 static void Mesh3D(GModel *m)
 {
   if(CTX::instance()->abortOnError && Msg::GetErrorCount()) return;
+  ProfilerScope scope("Mesh3D");
 
   m->getFields()->initialize();
 
@@ -879,64 +1072,157 @@ static void Mesh3D(GModel *m)
   int nb_elements_recombination = 0, nb_hexa_recombination = 0;
 #endif
 
-  for(std::size_t i = 0; i < connected.size(); i++) {
-    if(CTX::instance()->abortOnError && Msg::GetErrorCount()) {
-      Msg::Warning("Aborted 3D meshing");
-      break;
-    }
+  int nthreads = CTX::instance()->numThreads;
+  if(CTX::instance()->mesh.maxNumThreads3D > 0)
+    nthreads = CTX::instance()->mesh.maxNumThreads3D;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+
+  // HXT is multi-threaded internally; MMG and hex recombination are not yet
+  // thread-safe
+  if(CTX::instance()->mesh.algo3d != ALGO_3D_DELAUNAY &&
+     CTX::instance()->mesh.algo3d != ALGO_3D_INITIAL_ONLY)
+    nthreads = 1;
+  if(CTX::instance()->mesh.recombine3DAll) nthreads = 1;
 
-    MeshDelaunayVolume(connected[i]);
+  // boundary layers are not yet thread-safe
+  if(m->getFields()->getNumBoundaryLayerFields()) nthreads = 1;
 
-#if defined(HAVE_DOMHEX)
-    // additional code for experimental hex mesh - will eventually be replaced
-    // by new HXT-based code
+  for(std::size_t i = 0; i < connected.size(); i++) {
     for(std::size_t j = 0; j < connected[i].size(); j++) {
       GRegion *gr = connected[i][j];
-      bool treat_region_ok = false;
-      if(CTX::instance()->mesh.algo3d == ALGO_3D_RTREE) {
-        if(old_algo_hexa()) {
-          Filler f;
-          f.treat_region(gr);
-          treat_region_ok = true;
-        }
-        else {
-          Filler3D f;
-          treat_region_ok = f.treat_region(gr);
-        }
+      if(gr->meshAttributes.recombine3D) nthreads = 1;
+      // hybrid meshes: pyramids are optimized globally on the model
+      std::vector<GFace *> f = gr->faces();
+      for(auto it = f.begin(); it != f.end(); ++it)
+        if((*it)->quadrangles.size()) nthreads = 1;
+    }
+  }
+
+  // independent sets of connected components that can be meshed concurrently
+  std::vector<std::vector<std::size_t> > tasks;
+  if(nthreads > 1 && connected.size() > 1)
+    FindIndependentTasks(connected, tasks);
+  else
+    for(std::size_t i = 0; i < connected.size(); i++)
+      tasks.push_back(std::vector<std::size_t>(1, i));
+  if(tasks.size() < 2) nthreads = 1;
+
+  if(nthreads > 1) {
+    // the robust predicates use a global static filter, which must thus be
+    // set once for all the components before meshing them in parallel
+    double maxx = 0., maxy = 0., maxz = 0.;
+    std::vector<GEntity *> entities;
+    m->getEntities(entities, 2);
+    m->getEntities(entities, 1);
+    m->getEntities(entities, 0);
+    for(auto ge : entities) {
+      for(auto v : ge->mesh_vertices) {
+        maxx = std::max(maxx, std::abs(v->x()));
+        maxy = std::max(maxy, std::abs(v->y()));
+        maxz = std::max(maxz, std::abs(v->z()));
       }
-      if(treat_region_ok && (CTX::instance()->mesh.recombine3DAll ||
-                             gr->meshAttributes.recombine3D)) {
-        if(CTX::instance()->mesh.optimize) {
-          optimizeMeshGRegion opt;
-          opt(gr);
-        }
-        double a = TimeOfDay();
-        // CTX::instance()->mesh.recombine3DLevel = 2;
-        if(CTX::instance()->mesh.recombine3DLevel >= 0) {
-          Recombinator rec;
-          rec.execute(gr);
+    }
+    robustPredicates::exactinit(1, maxx, maxy, maxz);
+    Msg::Info("Meshing %lu independent set%s of connected components with %d "
+              "threads", (unsigned long)tasks.size(),
+              tasks.size() > 1 ? "s" : "", nthreads);
+  }
+
+  std::vector<double> wallTime(connected.size(), 0.);
+  std::vector<int> threadNum(connected.size(), 0);
+  bool exceptions = false, aborted = false;
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t K = 0; K < tasks.size(); K++) {
+    for(std::size_t k = 0; k < tasks[K].size(); k++) {
+      if(exceptions || aborted) continue;
+      if(CTX::instance()->abortOnError && Msg::GetErrorCount()) {
+        aborted = true;
+        continue;
+      }
+      std::size_t i = tasks[K][k];
+      double w = TimeOfDay();
+      try { // OpenMP forbids leaving block via exception
+        MeshDelaunayVolume(connected[i]);
+      }
+      catch(...) {
+        exceptions = true;
+      }
+      wallTime[i] = TimeOfDay() - w;
+      threadNum[i] = Msg::GetThreadNum();
+
+#if defined(HAVE_DOMHEX)
+      // additional code for experimental hex mesh - will eventually be
+      // replaced by new HXT-based code
+      for(std::size_t j = 0; j < connected[i].size(); j++) {
+        GRegion *gr = connected[i][j];
+        bool treat_region_ok = false;
+        if(CTX::instance()->mesh.algo3d == ALGO_3D_RTREE) {
+          if(old_algo_hexa()) {
+            Filler f;
+            f.treat_region(gr);
+            treat_region_ok = true;
+          }
+          else {
+            Filler3D f;
+            treat_region_ok = f.treat_region(gr);
+          }
         }
-        if(CTX::instance()->mesh.recombine3DLevel >= 1) {
-          Supplementary sup;
-          sup.execute(gr);
+        if(treat_region_ok && (CTX::instance()->mesh.recombine3DAll ||
+                               gr->meshAttributes.recombine3D)) {
+          if(CTX::instance()->mesh.optimize) {
+            optimizeMeshGRegion opt;
+            opt(gr);
+          }
+          double a = TimeOfDay();
+          // CTX::instance()->mesh.recombine3DLevel = 2;
+          if(CTX::instance()->mesh.recombine3DLevel >= 0) {
+            Recombinator rec;
+            rec.execute(gr);
+          }
+          if(CTX::instance()->mesh.recombine3DLevel >= 1) {
+            Supplementary sup;
+            sup.execute(gr);
+          }
+          PostOp post;
+          post.execute(gr, CTX::instance()->mesh.recombine3DLevel,
+                       CTX::instance()->mesh.recombine3DConformity);
+          // CTX::instance()->mesh.recombine3DConformity);
+          // 0: no pyramid, 1: single-step, 2: two-steps (conforming),
+          // true: fill non-conformities with trihedra
+          RelocateVertices(gr, CTX::instance()->mesh.nbSmoothing);
+          // while(LaplaceSmoothing (gr)){
+          // }
+          nb_elements_recombination += post.get_nb_elements();
+          nb_hexa_recombination += post.get_nb_hexahedra();
+          vol_element_recombination += post.get_vol_elements();
+          vol_hexa_recombination += post.get_vol_hexahedra();
+          time_recombination += (TimeOfDay() - a);
         }
-        PostOp post;
-        post.execute(gr, CTX::instance()->mesh.recombine3DLevel,
-                     CTX::instance()->mesh.recombine3DConformity);
-        // CTX::instance()->mesh.recombine3DConformity);
-        // 0: no pyramid, 1: single-step, 2: two-steps (conforming),
-        // true: fill non-conformities with trihedra
-        RelocateVertices(gr, CTX::instance()->mesh.nbSmoothing);
-        // while(LaplaceSmoothing (gr)){
-        // }
-        nb_elements_recombination += post.get_nb_elements();
-        nb_hexa_recombination += post.get_nb_hexahedra();
-        vol_element_recombination += post.get_vol_elements();
-        vol_hexa_recombination += post.get_vol_hexahedra();
-        time_recombination += (TimeOfDay() - a);
       }
-    }
 #endif
+    }
+  }
+  if(exceptions) throw std::runtime_error(Msg::GetLastError());
+  if(aborted) Msg::Warning("Aborted 3D meshing");
+
+  if(connected.size() > 1) {
+    double sum = 0., max = 0.;
+    for(std::size_t i = 0; i < connected.size(); i++) {
+      std::size_t numTets = 0;
+      for(std::size_t j = 0; j < connected[i].size(); j++)
+        numTets += connected[i][j]->tetrahedra.size();
+      Msg::Info("Connected component %lu (%lu volume%s, %lu tetrahedra): "
+                "Wall %gs on thread %d", (unsigned long)(i + 1),
+                (unsigned long)connected[i].size(),
+                connected[i].size() > 1 ? "s" : "", (unsigned long)numTets,
+                wallTime[i], threadNum[i]);
+      sum += wallTime[i];
+      max = std::max(max, wallTime[i]);
+    }
+    Msg::Info("Meshed %lu connected components on %d thread%s (cumulative "
+              "Wall %gs, largest component Wall %gs)",
+              (unsigned long)connected.size(), nthreads,
+              nthreads > 1 ? "s" : "", sum, max);
   }
 
 #if defined(HAVE_DOMHEX)
@@ -980,6 +1266,7 @@ static void Mesh3D(GModel *m)
 
   double t2 = Cpu(), w2 = TimeOfDay();
   CTX::instance()->meshTimer[2] = w2 - w1;
+  CTX::instance()->meshCpuTimer[2] = t2 - t1;
 
   if(m->getNumRegions()) {
     Msg::ProgressMeter(1, false, "Meshing 3D...");
@@ -993,6 +1280,7 @@ static void Mesh3D(GModel *m)
 void OptimizeMesh(GModel *m, const std::string &how, bool force, int niter)
 {
   if(CTX::instance()->abortOnError && Msg::GetErrorCount()) return;
+  ProfilerScope scope("OptimizeMesh");
 
   if(how != "" && how != "Gmsh" && how != "Optimize" && how != "Netgen" &&
      how != "HighOrder" && how != "HighOrderElastic" &&
@@ -1159,6 +1447,8 @@ void OptimizeMesh(GModel *m, const std::string &how, bool force, int niter)
                   EmbeddedCompatibilityTest());
 
   double t2 = Cpu(), w2 = TimeOfDay();
+  CTX::instance()->meshTimer[3] += w2 - w1;
+  CTX::instance()->meshCpuTimer[3] += t2 - t1;
   Msg::StatusBar(true, "Done optimizing mesh (Wall %gs, CPU %gs)", w2 - w1,
                  t2 - t1);
 }
@@ -1481,6 +1771,7 @@ void GenerateMesh(GModel *m, int ask)
     Msg::Info("I'm busy! Ask me that later...");
     return;
   }
+  ProfilerScope scope("GenerateMesh");
   CTX::instance()->lock = 1;
 
   Msg::ResetErrorCounter();
@@ -1491,6 +1782,9 @@ void GenerateMesh(GModel *m, int ask)
   // Initialize pseudo random mesh generator with the same seed
   srand(CTX::instance()->mesh.randomSeed);
 
+  // Optimization times are accumulated over all the optimization passes
+  CTX::instance()->meshTimer[3] = CTX::instance()->meshCpuTimer[3] = 0.;
+
   // Change any high order elements back into first order ones (but skip
   // discrete entities)
   SetOrder1(m, false, true);
@@ -17,5 +17,6 @@ void AdaptMesh(GModel *m);
 void FixPeriodicMesh(GModel *m);
 void GetStatistics(double stat[50], double quality[4][100] = 0,
                    bool visibleOnly = false);
+void AppendBenchReport(const std::string &fileName);
 
 #endif
@@ -9,6 +9,10 @@
 
 #include <sstream>
 #include <vector>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <stdint.h>
 #include "GmshConfig.h"
 #include "GModel.h"
 #include "HighOrder.h"
@@ -24,6 +28,7 @@
 #include "fullMatrix.h"
 #include "BasisFactory.h"
 #include "nodalBasis.h"
+#include "ElementType.h"
 #include "InnerVertexPlacement.h"
 #include "Context.h"
 #include "MFace.h"
@@ -434,9 +439,11 @@ static void getEdgeVertices(GEdge *ge, MElement *ele,
   ve.insert(ve.end(), veEdge.begin(), veEdge.end());
 }
 
-// Get new interior vertices for an edge in a 2D element
+// Get new interior vertices for an edge in a 2D element; the vertices of the
+// edges on curves are looked up in curveEdgeVertices, which is not modified
 static void getEdgeVertices(GFace *gf, MElement *ele,
                             std::vector<MVertex *> &ve,
+                            const edgeContainer &curveEdgeVertices,
                             edgeContainer &edgeVertices, bool linear,
                             int nPts = 1)
 {
@@ -450,14 +457,20 @@ static void getEdgeVertices(GFace *gf, MElement *ele,
     std::pair<MVertex *, MVertex *> p(vMin, vMax);
     std::vector<MVertex *> veEdge;
 
-    auto eIter = edgeVertices.find(p);
+    const std::vector<MVertex *> *eVtcs = nullptr;
+    auto cIter = curveEdgeVertices.find(p);
+    if(cIter != curveEdgeVertices.end())
+      eVtcs = &cIter->second;
+    else {
+      auto eIter = edgeVertices.find(p);
+      if(eIter != edgeVertices.end()) eVtcs = &eIter->second;
+    }
 
-    if(eIter != edgeVertices.end()) { // Vertices already exist
-      std::vector<MVertex *> &eVtcs = eIter->second;
+    if(eVtcs) { // Vertices already exist
       if(increasing)
-        veEdge.assign(eVtcs.begin(), eVtcs.end());
+        veEdge.assign(eVtcs->begin(), eVtcs->end());
       else
-        veEdge.assign(eVtcs.rbegin(), eVtcs.rend());
+        veEdge.assign(eVtcs->rbegin(), eVtcs->rend());
     }
     else { // Vertices do not exist, create them
       // Get vertices on geometry if asked
@@ -470,44 +483,12 @@ static void getEdgeVertices(GFace *gf, MElement *ele,
         interpVerticesInExistingEdge(gf, &edgeEl, veEdge, nPts);
       }
 
-      std::vector<MVertex *> &eVtcs = edgeVertices[p];
+      std::vector<MVertex *> &vtcs = edgeVertices[p];
 
       if(increasing) // Add newly created vertices to list
-        eVtcs.insert(eVtcs.end(), veEdge.begin(), veEdge.end());
-      else
-        eVtcs.insert(eVtcs.end(), veEdge.rbegin(), veEdge.rend());
-    }
-    ve.insert(ve.end(), veEdge.begin(), veEdge.end());
-  }
-}
-
-// Get new interior vertices for an edge in a 3D element
-static void getEdgeVertices(GRegion *gr, MElement *ele,
-                            std::vector<MVertex *> &ve,
-                            edgeContainer &edgeVertices, int nPts = 1)
-{
-  for(int i = 0; i < ele->getNumEdges(); i++) {
-    std::vector<MVertex *> veOld;
-    ele->getEdgeVertices(i, veOld);
-    MVertex *vMin, *vMax;
-    const bool increasing = getMinMaxVert(veOld[0], veOld[1], vMin, vMax);
-    std::pair<MVertex *, MVertex *> p(vMin, vMax);
-    std::vector<MVertex *> veEdge;
-    if(edgeVertices.count(p)) { // Vertices already exist
-      if(increasing)
-        veEdge.assign(edgeVertices[p].begin(), edgeVertices[p].end());
-      else
-        veEdge.assign(edgeVertices[p].rbegin(), edgeVertices[p].rend());
-    }
-    else { // Vertices do not exist, create them
-      const MLineN edgeEl(veOld, ele->getPolynomialOrder());
-      interpVerticesInExistingEdge(gr, &edgeEl, veEdge, nPts);
-      if(increasing) // Add newly created vertices to list
-        edgeVertices[p].insert(edgeVertices[p].end(), veEdge.begin(),
-                               veEdge.end());
+        vtcs.insert(vtcs.end(), veEdge.begin(), veEdge.end());
       else
-        edgeVertices[p].insert(edgeVertices[p].end(), veEdge.rbegin(),
-                               veEdge.rend());
+        vtcs.insert(vtcs.end(), veEdge.rbegin(), veEdge.rend());
     }
     ve.insert(ve.end(), veEdge.begin(), veEdge.end());
   }
@@ -855,50 +836,6 @@ static int retrieveFaceBoundaryVertices(int k, int type, int nPts,
   }
 }
 
-// Get new face (excluding edge) vertices for a face of a 3D element
-static void getFaceVertices(GRegion *gr, MElement *ele,
-                            std::vector<MVertex *> &newVertices,
-                            faceContainer &faceVertices, int nPts = 1)
-{
-  std::vector<MVertex *> vCorner;
-  ele->getVertices(vCorner);
-  // NB: We can get more than corner vertices but we use only corners
-
-  for(int i = 0; i < ele->getNumFaces(); i++) {
-    MFace face = ele->getFace(i);
-    std::vector<MVertex *> vFace;
-    auto fIter = faceVertices.find(face);
-    if(fIter != faceVertices.end()) { // Vertices already exist
-      std::vector<MVertex *> vtcs = fIter->second;
-      int orientation;
-      bool swap;
-      if(fIter->first.computeCorrespondence(face, orientation, swap)) {
-        // Check correspondence and apply permutation if needed
-        if(face.getNumVertices() == 3 && nPts > 1)
-          reorientTrianglePoints(vtcs, orientation, swap);
-        else if(face.getNumVertices() == 4)
-          reorientQuadPoints(vtcs, orientation, swap, nPts - 1);
-      }
-      else
-        Msg::Error(
-          "Error in face lookup for retrieval of high order face nodes");
-      vFace.assign(vtcs.begin(), vtcs.end());
-    }
-    else { // Vertices do not exist, create them by interpolation
-      std::vector<MVertex *> faceBoundaryVertices;
-      int type = retrieveFaceBoundaryVertices(
-        i, ele->getType(), nPts, vCorner, newVertices, faceBoundaryVertices);
-      fullMatrix<double> *coefficients =
-        getInnerVertexPlacement(type, nPts + 1);
-      interpVerticesInExistingFace(gr, *coefficients, faceBoundaryVertices,
-                                   vFace);
-      faceVertices[face].insert(faceVertices[face].end(), vFace.begin(),
-                                vFace.end());
-    }
-    newVertices.insert(newVertices.end(), vFace.begin(), vFace.end());
-  }
-}
-
 // Get new interior vertices for a 3D element
 static void getVolumeVertices(GRegion *gr, MElement *ele,
                               std::vector<MVertex *> &newVertices, int nPts = 1)
@@ -931,7 +868,7 @@ static void getVolumeVertices(GRegion *gr, MElement *ele,
 // Creation of high-order elements
 
 static void setHighOrder(GEdge *ge, edgeContainer &edgeVertices, bool linear,
-                         int nbPts = 1)
+                         int nbPts, std::size_t num)
 {
   std::vector<MLine *> lines2;
   for(std::size_t i = 0; i < ge->lines.size(); i++) {
@@ -939,11 +876,11 @@ static void setHighOrder(GEdge *ge, edgeContainer &edgeVertices, bool linear,
     std::vector<MVertex *> ve;
     getEdgeVertices(ge, l, ve, edgeVertices, linear, nbPts);
     if(nbPts == 1)
-      lines2.push_back(
-        new MLine3(l->getVertex(0), l->getVertex(1), ve[0], l->getPartition()));
+      lines2.push_back(new MLine3(l->getVertex(0), l->getVertex(1), ve[0],
+                                  num + i, l->getPartition()));
     else
-      lines2.push_back(
-        new MLineN(l->getVertex(0), l->getVertex(1), ve, l->getPartition()));
+      lines2.push_back(new MLineN(l->getVertex(0), l->getVertex(1), ve,
+                                  num + i, l->getPartition()));
     delete l;
   }
   ge->lines = lines2;
@@ -951,39 +888,41 @@ static void setHighOrder(GEdge *ge, edgeContainer &edgeVertices, bool linear,
 }
 
 static MTriangle *setHighOrder(MTriangle *t, GFace *gf,
+                               const edgeContainer &curveEdgeVertices,
                                edgeContainer &edgeVertices,
                                faceContainer &faceVertices, bool linear,
-                               bool incomplete, int nPts)
+                               bool incomplete, int nPts, std::size_t num)
 {
   std::vector<MVertex *> v;
-  getEdgeVertices(gf, t, v, edgeVertices, linear, nPts);
+  getEdgeVertices(gf, t, v, curveEdgeVertices, edgeVertices, linear, nPts);
   if(nPts == 1) {
     return new MTriangle6(t->getVertex(0), t->getVertex(1), t->getVertex(2),
-                          v[0], v[1], v[2], 0, t->getPartition());
+                          v[0], v[1], v[2], num, t->getPartition());
   }
   else {
     if(!incomplete) getFaceVertices(gf, t, v, faceVertices, linear, nPts);
     return new MTriangleN(t->getVertex(0), t->getVertex(1), t->getVertex(2), v,
-                          nPts + 1, 0, t->getPartition());
+                          nPts + 1, num, t->getPartition());
   }
 }
 
 static MQuadrangle *setHighOrder(MQuadrangle *q, GFace *gf,
+                                 const edgeContainer &curveEdgeVertices,
                                  edgeContainer &edgeVertices,
                                  faceContainer &faceVertices, bool linear,
-                                 bool incomplete, int nPts)
+                                 bool incomplete, int nPts, std::size_t num)
 {
   std::vector<MVertex *> v;
-  getEdgeVertices(gf, q, v, edgeVertices, linear, nPts);
+  getEdgeVertices(gf, q, v, curveEdgeVertices, edgeVertices, linear, nPts);
   if(incomplete) {
     if(nPts == 1) {
       return new MQuadrangle8(q->getVertex(0), q->getVertex(1), q->getVertex(2),
-                              q->getVertex(3), v[0], v[1], v[2], v[3], 0,
+                              q->getVertex(3), v[0], v[1], v[2], v[3], num,
                               q->getPartition());
     }
     else {
       return new MQuadrangleN(q->getVertex(0), q->getVertex(1), q->getVertex(2),
-                              q->getVertex(3), v, nPts + 1, 0,
+                              q->getVertex(3), v, nPts + 1, num,
                               q->getPartition());
     }
   }
@@ -991,26 +930,28 @@ static MQuadrangle *setHighOrder(MQuadrangle *q, GFace *gf,
     getFaceVertices(gf, q, v, faceVertices, linear, nPts);
     if(nPts == 1) {
       return new MQuadrangle9(q->getVertex(0), q->getVertex(1), q->getVertex(2),
-                              q->getVertex(3), v[0], v[1], v[2], v[3], v[4], 0,
-                              q->getPartition());
+                              q->getVertex(3), v[0], v[1], v[2], v[3], v[4],
+                              num, q->getPartition());
     }
     else {
       return new MQuadrangleN(q->getVertex(0), q->getVertex(1), q->getVertex(2),
-                              q->getVertex(3), v, nPts + 1, 0,
+                              q->getVertex(3), v, nPts + 1, num,
                               q->getPartition());
     }
   }
 }
 
-static void setHighOrder(GFace *gf, edgeContainer &edgeVertices,
+static void setHighOrder(GFace *gf, const edgeContainer &curveEdgeVertices,
+                         edgeContainer &edgeVertices,
                          faceContainer &faceVertices, bool linear,
-                         bool incomplete, int nPts = 1)
+                         bool incomplete, int nPts, std::size_t num)
 {
   std::vector<MTriangle *> triangles2;
   for(std::size_t i = 0; i < gf->triangles.size(); i++) {
     MTriangle *t = gf->triangles[i];
     MTriangle *tNew =
-      setHighOrder(t, gf, edgeVertices, faceVertices, linear, incomplete, nPts);
+      setHighOrder(t, gf, curveEdgeVertices, edgeVertices, faceVertices,
+                   linear, incomplete, nPts, num++);
     triangles2.push_back(tNew);
     delete t;
   }
@@ -1020,7 +961,8 @@ static void setHighOrder(GFace *gf, edgeContainer &edgeVertices,
   for(std::size_t i = 0; i < gf->quadrangles.size(); i++) {
     MQuadrangle *q = gf->quadrangles[i];
     MQuadrangle *qNew =
-      setHighOrder(q, gf, edgeVertices, faceVertices, linear, incomplete, nPts);
+      setHighOrder(q, gf, curveEdgeVertices, edgeVertices, faceVertices,
+                   linear, incomplete, nPts, num++);
     quadrangles2.push_back(qNew);
     delete q;
   }
@@ -1028,166 +970,453 @@ static void setHighOrder(GFace *gf, edgeContainer &edgeVertices,
   gf->deleteVertexArrays();
 }
 
+// Replace the nodes of the elements of a surface that duplicate the nodes
+// created on the same mesh edges by another surface, and delete them
+static void replaceDuplicateVertices(GFace *gf,
+                                     std::map<MVertex *, MVertex *> &duplicates)
+{
+  for(std::size_t i = 0; i < gf->getNumMeshElements(); i++) {
+    MElement *e = gf->getMeshElement(i);
+    for(std::size_t j = 0; j < e->getNumVertices(); j++) {
+      auto it = duplicates.find(e->getVertex(j));
+      if(it != duplicates.end()) e->setVertex(j, it->second);
+    }
+  }
+  for(auto it = duplicates.begin(); it != duplicates.end(); it++)
+    delete it->first;
+  gf->deleteVertexArrays();
+}
+
+// In a volume, the new vertices of each element are given by the caller:
+// edge vertices, followed by the face vertices if incomplete is false
+
 static MTetrahedron *setHighOrder(MTetrahedron *t, GRegion *gr,
-                                  edgeContainer &edgeVertices,
-                                  faceContainer &faceVertices, bool incomplete,
-                                  int nPts)
+                                  std::vector<MVertex *> &v, bool incomplete,
+                                  int nPts, std::size_t num)
 {
-  std::vector<MVertex *> v;
-  getEdgeVertices(gr, t, v, edgeVertices, nPts);
   if(nPts == 1) {
     return new MTetrahedron10(t->getVertex(0), t->getVertex(1), t->getVertex(2),
                               t->getVertex(3), v[0], v[1], v[2], v[3], v[4],
-                              v[5], 0, t->getPartition());
+                              v[5], num, t->getPartition());
   }
   else {
-    if(!incomplete) {
-      getFaceVertices(gr, t, v, faceVertices, nPts);
-      getVolumeVertices(gr, t, v, nPts);
-    }
+    if(!incomplete) getVolumeVertices(gr, t, v, nPts);
     return new MTetrahedronN(t->getVertex(0), t->getVertex(1), t->getVertex(2),
-                             t->getVertex(3), v, nPts + 1, 0,
+                             t->getVertex(3), v, nPts + 1, num,
                              t->getPartition());
   }
 }
 
 static MHexahedron *setHighOrder(MHexahedron *h, GRegion *gr,
-                                 edgeContainer &edgeVertices,
-                                 faceContainer &faceVertices, bool incomplete,
-                                 int nPts)
+                                 std::vector<MVertex *> &v, bool incomplete,
+                                 int nPts, std::size_t num)
 {
-  std::vector<MVertex *> v;
-  getEdgeVertices(gr, h, v, edgeVertices, nPts);
   if(incomplete) {
     if(nPts == 1) {
       return new MHexahedron20(
         h->getVertex(0), h->getVertex(1), h->getVertex(2), h->getVertex(3),
         h->getVertex(4), h->getVertex(5), h->getVertex(6), h->getVertex(7),
         v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8], v[9], v[10],
-        v[11], 0, h->getPartition());
+        v[11], num, h->getPartition());
     }
     else {
       return new MHexahedronN(h->getVertex(0), h->getVertex(1), h->getVertex(2),
                               h->getVertex(3), h->getVertex(4), h->getVertex(5),
-                              h->getVertex(6), h->getVertex(7), v, nPts + 1, 0,
-                              h->getPartition());
+                              h->getVertex(6), h->getVertex(7), v, nPts + 1,
+                              num, h->getPartition());
     }
   }
   else {
-    getFaceVertices(gr, h, v, faceVertices, nPts);
     getVolumeVertices(gr, h, v, nPts);
     if(nPts == 1) {
       return new MHexahedron27(
         h->getVertex(0), h->getVertex(1), h->getVertex(2), h->getVertex(3),
         h->getVertex(4), h->getVertex(5), h->getVertex(6), h->getVertex(7),
         v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8], v[9], v[10],
-        v[11], v[12], v[13], v[14], v[15], v[16], v[17], v[18], 0,
+        v[11], v[12], v[13], v[14], v[15], v[16], v[17], v[18], num,
         h->getPartition());
     }
     else {
       return new MHexahedronN(h->getVertex(0), h->getVertex(1), h->getVertex(2),
                               h->getVertex(3), h->getVertex(4), h->getVertex(5),
-                              h->getVertex(6), h->getVertex(7), v, nPts + 1, 0,
-                              h->getPartition());
+                              h->getVertex(6), h->getVertex(7), v, nPts + 1,
+                              num, h->getPartition());
     }
   }
 }
 
-static MPrism *setHighOrder(MPrism *p, GRegion *gr, edgeContainer &edgeVertices,
-                            faceContainer &faceVertices, bool incomplete,
-                            int nPts)
+static MPrism *setHighOrder(MPrism *p, GRegion *gr, std::vector<MVertex *> &v,
+                            bool incomplete, int nPts, std::size_t num)
 {
-  std::vector<MVertex *> v;
-  getEdgeVertices(gr, p, v, edgeVertices, nPts);
   if(incomplete) {
     if(nPts == 1) {
       return new MPrism15(p->getVertex(0), p->getVertex(1), p->getVertex(2),
                           p->getVertex(3), p->getVertex(4), p->getVertex(5),
                           v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8],
-                          0, p->getPartition());
+                          num, p->getPartition());
     }
     else {
       return new MPrismN(p->getVertex(0), p->getVertex(1), p->getVertex(2),
                          p->getVertex(3), p->getVertex(4), p->getVertex(5), v,
-                         nPts + 1, 0, p->getPartition());
+                         nPts + 1, num, p->getPartition());
     }
   }
   else {
-    getFaceVertices(gr, p, v, faceVertices, nPts);
     if(nPts == 1) {
       return new MPrism18(p->getVertex(0), p->getVertex(1), p->getVertex(2),
                           p->getVertex(3), p->getVertex(4), p->getVertex(5),
                           v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8],
-                          v[9], v[10], v[11], 0, p->getPartition());
+                          v[9], v[10], v[11], num, p->getPartition());
     }
     else {
       getVolumeVertices(gr, p, v, nPts);
       return new MPrismN(p->getVertex(0), p->getVertex(1), p->getVertex(2),
                          p->getVertex(3), p->getVertex(4), p->getVertex(5), v,
-                         nPts + 1, 0, p->getPartition());
+                         nPts + 1, num, p->getPartition());
     }
   }
 }
 
 static MPyramid *setHighOrder(MPyramid *p, GRegion *gr,
-                              edgeContainer &edgeVertices,
-                              faceContainer &faceVertices, bool incomplete,
-                              int nPts)
+                              std::vector<MVertex *> &v, bool incomplete,
+                              int nPts, std::size_t num)
 {
-  std::vector<MVertex *> v;
-  getEdgeVertices(gr, p, v, edgeVertices, nPts);
-  if(!incomplete) {
-    getFaceVertices(gr, p, v, faceVertices, nPts);
-    if(nPts > 1) { getVolumeVertices(gr, p, v, nPts); }
-  }
+  if(!incomplete && nPts > 1) getVolumeVertices(gr, p, v, nPts);
   return new MPyramidN(p->getVertex(0), p->getVertex(1), p->getVertex(2),
-                       p->getVertex(3), p->getVertex(4), v, nPts + 1, 0,
+                       p->getVertex(3), p->getVertex(4), v, nPts + 1, num,
                        p->getPartition());
 }
 
+// Key of a mesh edge (N = 2) or face (N = 4) of the elements of a volume:
+// its vertices sorted by address (completed with nullptr for triangles), and
+// its index in the list of the edges or faces of all the elements
+template <int N> struct meshEntityKey {
+  MVertex *v[N];
+  std::size_t entry;
+  bool sameEntity(const meshEntityKey<N> &other) const
+  {
+    for(int i = 0; i < N; i++)
+      if(v[i] != other.v[i]) return false;
+    return true;
+  }
+  bool operator<(const meshEntityKey<N> &other) const
+  {
+    for(int i = 0; i < N; i++)
+      if(v[i] != other.v[i]) return std::less<MVertex *>()(v[i], other.v[i]);
+    return entry < other.entry;
+  }
+};
+
+// Group the identical keys: the keys are distributed in buckets according to
+// their first vertex, and the buckets are sorted in parallel. The owner of
+// each group is its first entry, so that the groups and their owners do not
+// depend on the number of threads. Return the number of groups.
+template <int N>
+static std::size_t groupMeshEntities(const std::vector<meshEntityKey<N> > &keys,
+                                     std::vector<std::size_t> &group,
+                                     std::vector<std::size_t> &owner,
+                                     int nthreads)
+{
+  std::size_t n = keys.size(), nb = n / 4 + 1;
+  auto bucket = [nb](MVertex *v) {
+    return (std::size_t)((((uint64_t)(uintptr_t)v) * 0x9E3779B97F4A7C15ULL) >>
+                         32) % nb;
+  };
+
+  std::vector<std::size_t> start(nb + 1, 0);
+#pragma omp parallel for num_threads(nthreads)
+  for(std::size_t i = 0; i < n; i++) {
+    std::size_t b = bucket(keys[i].v[0]);
+#pragma omp atomic update
+    start[b + 1]++;
+  }
+  for(std::size_t b = 0; b < nb; b++) start[b + 1] += start[b];
+
+  std::vector<std::size_t> pos(start.begin(), start.end() - 1);
+  std::vector<meshEntityKey<N> > sorted(n);
+#pragma omp parallel for num_threads(nthreads)
+  for(std::size_t i = 0; i < n; i++) {
+    std::size_t b = bucket(keys[i].v[0]), p;
+#pragma omp atomic capture
+    p = pos[b]++;
+    sorted[p] = keys[i];
+  }
+
+  std::vector<std::size_t> groups(nb + 1, 0);
+#pragma omp parallel for schedule(dynamic, 1024) num_threads(nthreads)
+  for(std::size_t b = 0; b < nb; b++) {
+    std::sort(sorted.begin() + start[b], sorted.begin() + start[b + 1]);
+    for(std::size_t i = start[b]; i < start[b + 1]; i++)
+      if(i == start[b] || !sorted[i].sameEntity(sorted[i - 1])) groups[b + 1]++;
+  }
+  for(std::size_t b = 0; b < nb; b++) groups[b + 1] += groups[b];
+
+  group.resize(n);
+  owner.resize(groups[nb]);
+#pragma omp parallel for schedule(dynamic, 1024) num_threads(nthreads)
+  for(std::size_t b = 0; b < nb; b++) {
+    std::size_t g = groups[b];
+    for(std::size_t i = start[b]; i < start[b + 1]; i++) {
+      if(i == start[b] || !sorted[i].sameEntity(sorted[i - 1])) {
+        if(i > start[b]) g++;
+        owner[g] = sorted[i].entry;
+      }
+      group[sorted[i].entry] = g;
+    }
+  }
+  return groups[nb];
+}
+
+static int getNumFaceVertices(int nCorner, int nPts)
+{
+  return nCorner == 3 ? (nPts - 1) * nPts / 2 : nPts * nPts;
+}
+
+// The elements of a volume are processed in parallel: the unique mesh edges
+// and faces are identified first, then the vertices of each edge and face are
+// created (or retrieved from the containers) by the first element that uses
+// it, and finally the new elements are created. The new vertices (and the
+// order in which they are stored in the elements) are thus the same as if
+// the elements were processed one after the other.
 static void setHighOrder(GRegion *gr, edgeContainer &edgeVertices,
                          faceContainer &faceVertices, bool incomplete,
-                         int nPts = 1)
+                         int nPts, std::size_t num, int nthreads)
 {
-  std::vector<MTetrahedron *> tetrahedra2;
-  for(std::size_t i = 0; i < gr->tetrahedra.size(); i++) {
-    MTetrahedron *t = gr->tetrahedra[i];
-    MTetrahedron *tNew =
-      setHighOrder(t, gr, edgeVertices, faceVertices, incomplete, nPts);
-    tetrahedra2.push_back(tNew);
-    delete t;
+  std::vector<MElement *> elements;
+  elements.insert(elements.end(), gr->tetrahedra.begin(),
+                  gr->tetrahedra.end());
+  elements.insert(elements.end(), gr->hexahedra.begin(), gr->hexahedra.end());
+  elements.insert(elements.end(), gr->prisms.begin(), gr->prisms.end());
+  elements.insert(elements.end(), gr->pyramids.begin(), gr->pyramids.end());
+  std::size_t ne = elements.size();
+  if(!ne) return;
+
+  // face vertices are only needed for complete elements with quadrangular
+  // faces or above order 2
+  bool faces = !incomplete && (nPts > 1 || gr->hexahedra.size() ||
+                               gr->prisms.size() || gr->pyramids.size());
+
+  // list the edges and faces of all the elements
+  std::vector<std::size_t> edgeStart(ne + 1, 0), faceStart(ne + 1, 0);
+  for(std::size_t i = 0; i < ne; i++) {
+    edgeStart[i + 1] = edgeStart[i] + elements[i]->getNumEdges();
+    faceStart[i + 1] = faceStart[i] + (faces ? elements[i]->getNumFaces() : 0);
   }
-  gr->tetrahedra = tetrahedra2;
-
-  std::vector<MHexahedron *> hexahedra2;
-  for(std::size_t i = 0; i < gr->hexahedra.size(); i++) {
-    MHexahedron *h = gr->hexahedra[i];
-    MHexahedron *hNew =
-      setHighOrder(h, gr, edgeVertices, faceVertices, incomplete, nPts);
-    hexahedra2.push_back(hNew);
-    delete h;
+  std::vector<meshEntityKey<2> > edgeKeys(edgeStart[ne]);
+  std::vector<meshEntityKey<4> > faceKeys(faceStart[ne]);
+#pragma omp parallel for num_threads(nthreads)
+  for(std::size_t i = 0; i < ne; i++) {
+    MElement *ele = elements[i];
+    for(int j = 0; j < ele->getNumEdges(); j++) {
+      meshEntityKey<2> &k = edgeKeys[edgeStart[i] + j];
+      MEdge e = ele->getEdge(j);
+      k.v[0] = e.getVertex(0);
+      k.v[1] = e.getVertex(1);
+      if(std::less<MVertex *>()(k.v[1], k.v[0])) std::swap(k.v[0], k.v[1]);
+      k.entry = edgeStart[i] + j;
+    }
+    for(std::size_t j = 0; j < faceStart[i + 1] - faceStart[i]; j++) {
+      meshEntityKey<4> &k = faceKeys[faceStart[i] + j];
+      MFace f = ele->getFace(j);
+      std::size_t nv = f.getNumVertices();
+      for(std::size_t l = 0; l < 4; l++)
+        k.v[l] = l < nv ? f.getVertex(l) : nullptr;
+      std::sort(k.v, k.v + nv, std::less<MVertex *>());
+      k.entry = faceStart[i] + j;
+    }
   }
-  gr->hexahedra = hexahedra2;
 
-  std::vector<MPrism *> prisms2;
-  for(std::size_t i = 0; i < gr->prisms.size(); i++) {
-    MPrism *p = gr->prisms[i];
-    MPrism *pNew =
-      setHighOrder(p, gr, edgeVertices, faceVertices, incomplete, nPts);
-    prisms2.push_back(pNew);
-    delete p;
+  // element and local index of an edge or face entry
+  auto locate = [](const std::vector<std::size_t> &start, std::size_t entry,
+                   std::size_t &i, int &j) {
+    i = std::upper_bound(start.begin(), start.end(), entry) - start.begin() - 1;
+    j = entry - start[i];
+  };
+
+  // vertices of the unique edges, ordered from the vertex with the smallest
+  // tag to the vertex with the largest tag (as in edgeContainer)
+  std::vector<std::size_t> edgeGroup, edgeOwner;
+  std::size_t nEdges =
+    groupMeshEntities(edgeKeys, edgeGroup, edgeOwner, nthreads);
+  std::vector<MVertex *> edgeNodes(nEdges * nPts);
+  std::vector<char> newEdge(nEdges, 0);
+#pragma omp parallel for num_threads(nthreads)
+  for(std::size_t g = 0; g < nEdges; g++) {
+    std::size_t i;
+    int j;
+    locate(edgeStart, edgeOwner[g], i, j);
+    std::vector<MVertex *> veOld, veEdge;
+    elements[i]->getEdgeVertices(j, veOld);
+    MVertex *vMin, *vMax;
+    const bool increasing = getMinMaxVert(veOld[0], veOld[1], vMin, vMax);
+    auto it = edgeVertices.find(std::make_pair(vMin, vMax));
+    if(it != edgeVertices.end() && (int)it->second.size() == nPts) {
+      std::copy(it->second.begin(), it->second.end(),
+                edgeNodes.begin() + g * nPts);
+      continue;
+    }
+    const MLineN edgeEl(veOld, elements[i]->getPolynomialOrder());
+    interpVerticesInExistingEdge(gr, &edgeEl, veEdge, nPts);
+    if(!increasing) std::reverse(veEdge.begin(), veEdge.end());
+    std::copy(veEdge.begin(), veEdge.end(), edgeNodes.begin() + g * nPts);
+    newEdge[g] = 1;
+  }
+  std::vector<meshEntityKey<2> >().swap(edgeKeys);
+
+  // edge vertices of an element, in the orientation of its edges
+  auto getElementEdgeVertices = [&](std::size_t i, std::vector<MVertex *> &v) {
+    MElement *ele = elements[i];
+    for(int j = 0; j < ele->getNumEdges(); j++) {
+      MEdge e = ele->getEdge(j);
+      auto first = edgeNodes.begin() + edgeGroup[edgeStart[i] + j] * nPts;
+      if(e.getVertex(0)->getNum() < e.getVertex(1)->getNum())
+        v.insert(v.end(), first, first + nPts);
+      else
+        v.insert(v.end(), std::reverse_iterator<decltype(first)>(first + nPts),
+                 std::reverse_iterator<decltype(first)>(first));
+    }
+  };
+
+  // vertices of the unique faces, ordered according to the face of their
+  // owner element, or to the face stored in faceContainer
+  std::vector<std::size_t> faceGroup, faceOwner;
+  std::size_t nFaces =
+    groupMeshEntities(faceKeys, faceGroup, faceOwner, nthreads);
+  std::vector<std::size_t> faceNodeStart(nFaces + 1, 0);
+  for(std::size_t g = 0; g < nFaces; g++)
+    faceNodeStart[g + 1] =
+      faceNodeStart[g] +
+      getNumFaceVertices(faceKeys[faceOwner[g]].v[3] ? 4 : 3, nPts);
+  std::vector<meshEntityKey<4> >().swap(faceKeys);
+  std::vector<MVertex *> faceNodes(faceNodeStart[nFaces]);
+  std::vector<const MFace *> faceRef(nFaces, nullptr);
+#pragma omp parallel for num_threads(nthreads)
+  for(std::size_t g = 0; g < nFaces; g++) {
+    std::size_t i;
+    int j;
+    locate(faceStart, faceOwner[g], i, j);
+    MElement *ele = elements[i];
+    MFace face = ele->getFace(j);
+    std::size_t nf = faceNodeStart[g + 1] - faceNodeStart[g];
+    auto it = faceVertices.find(face);
+    if(it != faceVertices.end() && it->second.size() == nf) {
+      std::copy(it->second.begin(), it->second.end(),
+                faceNodes.begin() + faceNodeStart[g]);
+      faceRef[g] = &it->first;
+      continue;
+    }
+    if(!nf) continue;
+    std::vector<MVertex *> vCorner, vEdges, faceBoundaryVertices, vFace;
+    ele->getVertices(vCorner);
+    getElementEdgeVertices(i, vEdges);
+    int type = retrieveFaceBoundaryVertices(j, ele->getType(), nPts, vCorner,
+                                            vEdges, faceBoundaryVertices);
+    fullMatrix<double> *coefficients = getInnerVertexPlacement(type, nPts + 1);
+    interpVerticesInExistingFace(gr, *coefficients, faceBoundaryVertices,
+                                 vFace);
+    std::copy(vFace.begin(), vFace.end(),
+              faceNodes.begin() + faceNodeStart[g]);
   }
-  gr->prisms = prisms2;
 
-  std::vector<MPyramid *> pyramids2;
-  for(std::size_t i = 0; i < gr->pyramids.size(); i++) {
-    MPyramid *p = gr->pyramids[i];
-    MPyramid *pNew =
-      setHighOrder(p, gr, edgeVertices, faceVertices, incomplete, nPts);
-    pyramids2.push_back(pNew);
-    delete p;
+  // create the new elements
+  std::vector<MElement *> elements2(ne);
+  bool exceptions = false;
+#pragma omp parallel for schedule(dynamic, 1024) num_threads(nthreads)
+  for(std::size_t i = 0; i < ne; i++) {
+    if(exceptions) continue;
+    try { // OpenMP forbids leaving block via exception
+      MElement *ele = elements[i];
+      std::vector<MVertex *> v;
+      getElementEdgeVertices(i, v);
+      for(std::size_t j = 0; j < faceStart[i + 1] - faceStart[i]; j++) {
+        std::size_t entry = faceStart[i] + j, g = faceGroup[entry];
+        std::vector<MVertex *> vtcs(faceNodes.begin() + faceNodeStart[g],
+                                    faceNodes.begin() + faceNodeStart[g + 1]);
+        if(faceRef[g] || faceOwner[g] != entry) {
+          MFace face = ele->getFace(j), ownerFace;
+          if(!faceRef[g]) {
+            std::size_t k;
+            int l;
+            locate(faceStart, faceOwner[g], k, l);
+            ownerFace = elements[k]->getFace(l);
+          }
+          const MFace &ref = faceRef[g] ? *faceRef[g] : ownerFace;
+          int orientation;
+          bool swap;
+          if(ref.computeCorrespondence(face, orientation, swap)) {
+            // Check correspondence and apply permutation if needed
+            if(face.getNumVertices() == 3 && nPts > 1)
+              reorientTrianglePoints(vtcs, orientation, swap);
+            else if(face.getNumVertices() == 4)
+              reorientQuadPoints(vtcs, orientation, swap, nPts - 1);
+          }
+          else
+            Msg::Error(
+              "Error in face lookup for retrieval of high order face nodes");
+        }
+        v.insert(v.end(), vtcs.begin(), vtcs.end());
+      }
+      switch(ele->getType()) {
+      case TYPE_TET:
+        elements2[i] = setHighOrder((MTetrahedron *)ele, gr, v, incomplete,
+                                    nPts, num + i);
+        break;
+      case TYPE_HEX:
+        elements2[i] = setHighOrder((MHexahedron *)ele, gr, v, incomplete,
+                                    nPts, num + i);
+        break;
+      case TYPE_PRI:
+        elements2[i] =
+          setHighOrder((MPrism *)ele, gr, v, incomplete, nPts, num + i);
+        break;
+      case TYPE_PYR:
+        elements2[i] =
+          setHighOrder((MPyramid *)ele, gr, v, incomplete, nPts, num + i);
+        break;
+      }
+    } catch(...) {
+      exceptions = true;
+    }
   }
-  gr->pyramids = pyramids2;
+  if(exceptions) throw std::runtime_error(Msg::GetLastError());
+
+  // make the edges and faces on the boundary of the volume available to the
+  // other volumes
+  for(std::size_t g = 0; g < nEdges; g++) {
+    if(!newEdge[g]) continue;
+    std::size_t i;
+    int j;
+    locate(edgeStart, edgeOwner[g], i, j);
+    MEdge e = elements[i]->getEdge(j);
+    if(e.getVertex(0)->onWhat() == gr || e.getVertex(1)->onWhat() == gr)
+      continue;
+    MVertex *vMin, *vMax;
+    getMinMaxVert(e.getVertex(0), e.getVertex(1), vMin, vMax);
+    edgeVertices[std::make_pair(vMin, vMax)].assign(
+      edgeNodes.begin() + g * nPts, edgeNodes.begin() + (g + 1) * nPts);
+  }
+  for(std::size_t g = 0; g < nFaces; g++) {
+    if(faceRef[g]) continue;
+    std::size_t i;
+    int j;
+    locate(faceStart, faceOwner[g], i, j);
+    MFace face = elements[i]->getFace(j);
+    bool boundary = true;
+    for(std::size_t k = 0; k < face.getNumVertices(); k++)
+      if(face.getVertex(k)->onWhat() == gr) boundary = false;
+    if(boundary)
+      faceVertices[face].assign(faceNodes.begin() + faceNodeStart[g],
+                                faceNodes.begin() + faceNodeStart[g + 1]);
+  }
+
+#pragma omp parallel for num_threads(nthreads)
+  for(std::size_t i = 0; i < ne; i++) delete elements[i];
+
+  std::size_t k = 0;
+  for(auto &t : gr->tetrahedra) t = (MTetrahedron *)elements2[k++];
+  for(auto &h : gr->hexahedra) h = (MHexahedron *)elements2[k++];
+  for(auto &p : gr->prisms) p = (MPrism *)elements2[k++];
+  for(auto &p : gr->pyramids) p = (MPyramid *)elements2[k++];
 
   gr->deleteVertexArrays();
 }
@@ -1427,46 +1656,185 @@ void SetOrderN(GModel *m, int order, bool linear, bool incomplete,
 
   m->destroyMeshCaches();
 
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+
+  // Curves (and then surfaces) are processed in parallel, each one with its
+  // own containers, which are then merged in order; the elements of each
+  // volume are processed in parallel. The new elements are numbered and the
+  // new vertices are renumbered at the end so that the mesh is the same as
+  // if all the entities were processed one after the other.
+  std::size_t maxVertexNum = m->getMaxVertexNumber();
+  std::size_t num = m->getMaxElementNumber() + 1;
+
+  // fill the caches of nodal bases and interpolation matrices, which are not
+  // thread-safe, before the parallel loops
+  std::vector<GEntity *> entities;
+  m->getEntities(entities);
+  int maxOrder = order;
+  for(std::size_t i = 0; i < entities.size(); i++)
+    maxOrder = std::max(maxOrder, getOrder(entities[i]));
+  for(int o = 1; o <= maxOrder; o++) {
+    int tag = ElementType::getType(TYPE_LIN, o);
+    if(tag) BasisFactory::getNodalBasis(tag);
+  }
+  for(int type = TYPE_TRI; type <= TYPE_HEX; type++)
+    getInnerVertexPlacement(type, order);
+
   // Keep track of vertex/entities created
   edgeContainer edgeVertices;
   faceContainer faceVertices;
 
+  std::vector<GEdge *> edges;
+  std::vector<GFace *> faces;
+  std::vector<GRegion *> regions;
+  for(auto it = m->firstEdge(); it != m->lastEdge(); ++it)
+    if(!onlyVisible || (*it)->getVisibility()) edges.push_back(*it);
+  for(auto it = m->firstFace(); it != m->lastFace(); ++it)
+    if(!onlyVisible || (*it)->getVisibility()) faces.push_back(*it);
+  for(auto it = m->firstRegion(); it != m->lastRegion(); ++it)
+    if(!onlyVisible || (*it)->getVisibility()) regions.push_back(*it);
+
   int counter = 0;
-  int nTot = m->getNumEdges() + m->getNumFaces() + m->getNumRegions();
+  int nTot = edges.size() + faces.size() + regions.size();
   Msg::StartProgressMeter(nTot);
 
   // TODO: we can leak nodes of discrete entities with existing high-order
   // nodes, if we ask a mesh with a different order
 
-  for(auto it = m->firstEdge(); it != m->lastEdge(); ++it) {
-    Msg::Info("Meshing curve %d order %d", (*it)->tag(), order);
-    Msg::ProgressMeter(++counter, false, msg);
-    if(onlyVisible && !(*it)->getVisibility()) continue;
-    if(getOrder(*it) != order)
-      setHighOrder(*it, edgeVertices, linear, nPts);
-    else
-      setHighOrderFromExistingMesh(*it, edgeVertices);
+  std::vector<bool> existing(edges.size());
+  std::vector<std::size_t> first(edges.size());
+  for(std::size_t i = 0; i < edges.size(); i++) {
+    existing[i] = (getOrder(edges[i]) == order);
+    first[i] = num;
+    if(!existing[i]) num += edges[i]->lines.size();
   }
+  std::vector<edgeContainer> curveEdgeVertices(edges.size());
+  bool exceptions = false;
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t i = 0; i < edges.size(); i++) {
+    if(exceptions) continue;
+    int localCounter;
+#pragma omp atomic capture
+    localCounter = ++counter;
+    Msg::Info("Meshing curve %d order %d", edges[i]->tag(), order);
+    Msg::ProgressMeter(localCounter, false, msg);
+    try { // OpenMP forbids leaving block via exception
+      if(!existing[i])
+        setHighOrder(edges[i], curveEdgeVertices[i], linear, nPts, first[i]);
+      else
+        setHighOrderFromExistingMesh(edges[i], curveEdgeVertices[i]);
+    } catch(...) {
+      exceptions = true;
+    }
+  }
+  if(exceptions) throw std::runtime_error(Msg::GetLastError());
+  for(std::size_t i = 0; i < edges.size(); i++) {
+    for(auto it = curveEdgeVertices[i].begin();
+        it != curveEdgeVertices[i].end(); it++) {
+      if(!edgeVertices.insert(*it).second && !existing[i] &&
+         it->first.first != it->first.second) {
+        // Vertices already exist and edge is not a degenerated edge
+        Msg::Error(
+          "Mesh edges from different curves share nodes: create a finer mesh "
+          "(curve involved: %d)",
+          edges[i]->tag());
+      }
+    }
+  }
+  std::vector<edgeContainer>().swap(curveEdgeVertices);
+
+  existing.resize(faces.size());
+  first.resize(faces.size());
+  for(std::size_t i = 0; i < faces.size(); i++) {
+    existing[i] = (getOrder(faces[i]) == order);
+    first[i] = num;
+    if(!existing[i])
+      num += faces[i]->triangles.size() + faces[i]->quadrangles.size();
+  }
+  std::vector<edgeContainer> surfaceEdgeVertices(faces.size());
+  std::vector<faceContainer> surfaceFaceVertices(faces.size());
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+  for(std::size_t i = 0; i < faces.size(); i++) {
+    if(exceptions) continue;
+    int localCounter;
+#pragma omp atomic capture
+    localCounter = ++counter;
+    Msg::Info("Meshing surface %d order %d", faces[i]->tag(), order);
+    Msg::ProgressMeter(localCounter, false, msg);
+    try { // OpenMP forbids leaving block via exception
+      if(!existing[i])
+        setHighOrder(faces[i], edgeVertices, surfaceEdgeVertices[i],
+                     surfaceFaceVertices[i], linear, incomplete, nPts,
+                     first[i]);
+      else
+        setHighOrderFromExistingMesh(faces[i], surfaceEdgeVertices[i],
+                                     surfaceFaceVertices[i]);
+    } catch(...) {
+      exceptions = true;
+    }
+  }
+  if(exceptions) throw std::runtime_error(Msg::GetLastError());
+  for(std::size_t i = 0; i < faces.size(); i++) {
+    // mesh edges shared by surfaces but not on a curve get the vertices
+    // created by the first surface
+    std::map<MVertex *, MVertex *> duplicates;
+    for(auto it = surfaceEdgeVertices[i].begin();
+        it != surfaceEdgeVertices[i].end(); it++) {
+      auto ins = edgeVertices.insert(*it);
+      if(ins.second || existing[i]) continue;
+      const std::vector<MVertex *> &vtcs = ins.first->second;
+      for(std::size_t j = 0; j < vtcs.size() && j < it->second.size(); j++)
+        if(it->second[j] != vtcs[j]) duplicates[it->second[j]] = vtcs[j];
+    }
+    faceVertices.insert(surfaceFaceVertices[i].begin(),
+                        surfaceFaceVertices[i].end());
+    if(duplicates.size()) replaceDuplicateVertices(faces[i], duplicates);
+    if(faces[i]->getColumns() != nullptr)
+      faces[i]->getColumns()->clearElementData();
+  }
+  std::vector<edgeContainer>().swap(surfaceEdgeVertices);
+  std::vector<faceContainer>().swap(surfaceFaceVertices);
 
-  for(auto it = m->firstFace(); it != m->lastFace(); ++it) {
-    Msg::Info("Meshing surface %d order %d", (*it)->tag(), order);
+  for(std::size_t i = 0; i < regions.size(); i++) {
+    GRegion *gr = regions[i];
+    Msg::Info("Meshing volume %d order %d", gr->tag(), order);
     Msg::ProgressMeter(++counter, false, msg);
-    if(onlyVisible && !(*it)->getVisibility()) continue;
-    if(getOrder(*it) != order)
-      setHighOrder(*it, edgeVertices, faceVertices, linear, incomplete, nPts);
-    else
-      setHighOrderFromExistingMesh(*it, edgeVertices, faceVertices);
-    if((*it)->getColumns() != nullptr) (*it)->getColumns()->clearElementData();
+    if(getOrder(gr) != order) {
+      setHighOrder(gr, edgeVertices, faceVertices, incomplete, nPts, num,
+                   nthreads);
+      num += gr->tetrahedra.size() + gr->hexahedra.size() +
+             gr->prisms.size() + gr->pyramids.size();
+    }
+    if(gr->getColumns() != nullptr) gr->getColumns()->clearElementData();
   }
 
-  for(auto it = m->firstRegion(); it != m->lastRegion(); ++it) {
-    Msg::Info("Meshing volume %d order %d", (*it)->tag(), order);
-    Msg::ProgressMeter(++counter, false, msg);
-    if(onlyVisible && !(*it)->getVisibility()) continue;
-    if(getOrder(*it) != order)
-      setHighOrder(*it, edgeVertices, faceVertices, incomplete, nPts);
-    if((*it)->getColumns() != nullptr) (*it)->getColumns()->clearElementData();
+  // elements numbered in parallel might have missed the update of the maximum
+  // element number
+  m->setMaxElementNumber(num - 1);
+
+  // number the new vertices in the order in which they appear in the
+  // elements, i.e. in the order in which they would have been created
+  // sequentially
+  std::vector<MVertex *> newVertices;
+  {
+    std::vector<char> found(m->getMaxVertexNumber() - maxVertexNum, 0);
+    for(std::size_t i = 0; i < entities.size(); i++) {
+      for(std::size_t j = 0; j < entities[i]->getNumMeshElements(); j++) {
+        MElement *e = entities[i]->getMeshElement(j);
+        for(std::size_t k = e->getNumPrimaryVertices(); k < e->getNumVertices();
+            k++) {
+          MVertex *v = e->getVertex(k);
+          if(v->getNum() <= maxVertexNum) continue;
+          if(found[v->getNum() - maxVertexNum - 1]) continue;
+          found[v->getNum() - maxVertexNum - 1] = 1;
+          newVertices.push_back(v);
+        }
+      }
+    }
   }
+  for(std::size_t i = 0; i < newVertices.size(); i++)
+    newVertices[i]->forceNum(maxVertexNum + i + 1);
 
   // store nodes in entities
   m->pruneMeshVertexAssociations();
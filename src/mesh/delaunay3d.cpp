@@ -1262,7 +1262,11 @@ void delaunayTriangulation(const int numThreads, const int nptsatonce,
     _temp[v->getNum()] = mv;
   }
 
-  robustPredicates::exactinit(1, maxx, maxy, maxz);
+  // when called from a parallel region (e.g. when meshing independent volumes
+  // concurrently), the static filter of the predicates is shared between
+  // threads and must be set beforehand by the caller
+  if(Msg::GetNumThreads() == 1)
+    robustPredicates::exactinit(1, maxx, maxy, maxz);
 
   Vert *box[8];
   delaunayTriangulation(numThreads, nptsatonce, _vertices, box, allocator);
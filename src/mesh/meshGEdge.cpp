@@ -13,6 +13,7 @@
 #include "boundaryLayersData.h"
 #include "Numeric.h"
 #include "GmshMessage.h"
+#include "Profiler.h"
 #include "Context.h"
 #include "STensor3.h"
 #include "Field.h"
@@ -720,6 +721,8 @@ int meshGEdgeProcessing(GEdge *ge, const double t_begin, double t_end, int &N,
 
 void meshGEdge::operator()(GEdge *ge)
 {
+  ProfilerScope scope("Curve", ge->tag());
+
   // debug stuff
   if(CTX::instance()->debugSurface > 0) {
     std::vector<GFace *> f = ge->faces();
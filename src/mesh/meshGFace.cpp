@@ -8,6 +8,7 @@
 #include <stdlib.h>
 #include <map>
 #include "GmshMessage.h"
+#include "Profiler.h"
 #include "GModel.h"
 #include "GFace.h"
 #include "GEdge.h"
@@ -2894,6 +2895,7 @@ int debugSurface = -1; //-100;
 
 void meshGFace::operator()(GFace *gf, bool print)
 {
+  ProfilerScope scope("Surface", gf->tag());
   gf->model()->setCurrentMeshEntity(gf);
 
   if(gf->meshAttributes.method == MESH_NONE) return;
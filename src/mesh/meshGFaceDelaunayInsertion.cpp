@@ -11,6 +11,7 @@
 #include "GmshConfig.h"
 #include "GmshMessage.h"
 #include "OS.h"
+#include "Profiler.h"
 #include "robustPredicates.h"
 #include "BackgroundMesh.h"
 #include "meshGFaceDelaunayInsertion.h"
@@ -410,7 +411,7 @@ static void fourthPoint(double *p1, double *p2, double *p3, double *p4)
 
 MTri3::MTri3(MTriangle *t, double lc, SMetric3 *metric, bidimMeshData *data,
              GFace *gf)
-  : deleted(false), base(t)
+  : deleted(false), base(t), index(-1)
 {
   neigh[0] = neigh[1] = neigh[2] = nullptr;
   double center[3];
@@ -552,12 +553,6 @@ void connectTriangles(std::vector<MTri3 *> &l)
   connectTris(l.begin(), l.end(), conn);
 }
 
-void connectTriangles(std::set<MTri3 *, compareTri3Ptr> &l)
-{
-  std::vector<edgeXface> conn;
-  connectTris(l.begin(), l.end(), conn);
-}
-
 static int inCircumCircleXY(MTriangle *t, MVertex *v)
 {
   MVertex *v1 = t->getVertex(0);
@@ -594,8 +589,8 @@ static void recurFindCavity(std::vector<edgeXface> &shell,
   }
 }
 
-static void recurFindCavityAniso(GFace *gf, std::list<edgeXface> &shell,
-                                 std::list<MTri3 *> &cavity, double *metric,
+static void recurFindCavityAniso(GFace *gf, std::vector<edgeXface> &shell,
+                                 std::vector<MTri3 *> &cavity, double *metric,
                                  double *param, MTri3 *t, bidimMeshData &data)
 {
   t->setDeleted(true);
@@ -681,15 +676,22 @@ inline double getSurfUV(MTriangle *t, bidimMeshData &data)
   return 0.5 * (vv1[0] * vv2[1] - vv1[1] * vv2[0]);
 }
 
-static int insertVertexB(std::list<edgeXface> &shell,
-                         std::list<MTri3 *> &cavity, bool force, GFace *gf,
-                         MVertex *v, double *param, MTri3 *t,
-                         std::set<MTri3 *, compareTri3Ptr> &allTets,
-                         std::set<MTri3 *, compareTri3Ptr> *activeTets,
+// scratch buffers for the insertion of a point, reused from one point to the
+// next to avoid memory allocations
+struct cavityBuffers {
+  std::vector<edgeXface> shell, conn;
+  std::vector<MTri3 *> cavity, newTris, newCavity;
+};
+
+static int insertVertexB(cavityBuffers &buf, bool force, GFace *gf,
+                         MVertex *v, double *param, MTri3 *t, MTri3Pool &pool,
+                         MTri3Heap &allTets, MTri3Heap *activeTets,
                          bidimMeshData &data, double *metric,
                          MTri3 **oneNewTriangle,
                          bool verifyStarShapeness = true)
 {
+  std::vector<edgeXface> &shell = buf.shell;
+  std::vector<MTri3 *> &cavity = buf.cavity;
   if(cavity.size() == 1) return -1;
 
   if(shell.size() != cavity.size() + 2) return -2;
@@ -705,11 +707,10 @@ static int insertVertexB(std::list<edgeXface> &shell,
       return volume + std::abs(getSurfUV(triangle->tri(), data));
     });
 
-  MTri3 **newTris = new MTri3 *[shell.size()];
-
-  std::vector<MTri3 *> new_cavity;
-
-  int k = 0;
+  std::vector<MTri3 *> &newTris = buf.newTris;
+  std::vector<MTri3 *> &new_cavity = buf.newCavity;
+  newTris.clear();
+  new_cavity.clear();
 
   auto it = shell.begin();
 
@@ -737,8 +738,8 @@ static int insertVertexB(std::list<edgeXface> &shell,
                    data.vSizesBGM[index2]);
     double LL = std::min(lc, lcBGM);
 
-    MTri3 *t4 = new MTri3(t, Extend1dMeshIn2dSurfaces(gf) ? LL : lcBGM, nullptr,
-                          &data, gf);
+    MTri3 *t4 = pool.create(t, Extend1dMeshIn2dSurfaces(gf) ? LL : lcBGM,
+                            nullptr, &data, gf);
 
     if(oneNewTriangle) {
       force = true;
@@ -764,7 +765,7 @@ static int insertVertexB(std::list<edgeXface> &shell,
       onePointIsTooClose = true;
     }
 
-    newTris[k++] = t4;
+    newTris.push_back(t4);
     // all new triangles are pushed front in order to be able to destroy them if
     // the cavity is not star shaped around the new vertex.
     new_cavity.push_back(t4);
@@ -781,24 +782,18 @@ static int insertVertexB(std::list<edgeXface> &shell,
     ++it;
   }
 
-  std::vector<edgeXface> conn;
-
   // for adding a point we require that the area remains the same after addition
   // of the point, and that the point is not too close to an edge
   if(std::abs(oldVolume - newVolume) < EPS * oldVolume && !onePointIsTooClose) {
-    connectTris(new_cavity.begin(), new_cavity.end(), conn);
-    // 30 % of the time is spent here!
-    allTets.insert(newTris, newTris + shell.size());
+    connectTris(new_cavity.begin(), new_cavity.end(), buf.conn);
+    for(std::size_t i = 0; i < newTris.size(); i++) allTets.insert(newTris[i]);
     if(activeTets) {
       for(auto i = new_cavity.begin(); i != new_cavity.end(); ++i) {
         int active_edge;
-        if(isActive(*i, LIMIT_, active_edge) && (*i)->getRadius() > LIMIT_) {
-          if((*activeTets).find(*i) == (*activeTets).end())
-            (*activeTets).insert(*i);
-        }
+        if(isActive(*i, LIMIT_, active_edge) && (*i)->getRadius() > LIMIT_)
+          activeTets->insert(*i);
       }
     }
-    delete[] newTris;
     return 1;
   }
   else {
@@ -810,11 +805,10 @@ static int insertVertexB(std::list<edgeXface> &shell,
     // Vs, false); _printTris("newTris.pos", &newTris[0], newTris+shell.size(),
     // Us, Vs, false); _printTris("allTris.pos", allTets.begin(),allTets.end(),
     // Us, Vs, false);
-    for(std::size_t i = 0; i < shell.size(); i++) {
+    for(std::size_t i = 0; i < newTris.size(); i++) {
       delete newTris[i]->tri();
-      delete newTris[i];
+      pool.free(newTris[i]);
     }
-    delete[] newTris;
 
     if(std::abs(oldVolume - newVolume) > EPS * oldVolume) return -3;
     if(onePointIsTooClose) return -4;
@@ -872,8 +866,8 @@ static MTri3 *search4Triangle(MTri3 *t, MVertex *v, int maxx, int &ITER)
 }
 
 static MTri3 *search4Triangle(MTri3 *t, double pt[2], bidimMeshData &data,
-                              std::set<MTri3 *, compareTri3Ptr> &AllTris,
-                              double uv[2], bool force = false)
+                              MTri3Heap &AllTris, double uv[2],
+                              bool force = false)
 {
   // bool inside = t->inCircumCircle(pt);
   bool inside = invMapUV(t->tri(), pt, data, uv, 1.e-8);
@@ -919,27 +913,30 @@ static MTri3 *search4Triangle(MTri3 *t, double pt[2], bidimMeshData &data,
   return nullptr;
 }
 
-static bool
-insertAPoint(GFace *gf, std::set<MTri3 *, compareTri3Ptr>::iterator it,
-             double center[2], double metric[3], bidimMeshData &data,
-             std::set<MTri3 *, compareTri3Ptr> &AllTris,
-             std::set<MTri3 *, compareTri3Ptr> *ActiveTris = nullptr,
-             MTri3 *worst = nullptr, MTri3 **oneNewTriangle = nullptr,
-             bool testStarShapeness = false)
+// insert a point to break the triangle "worst" (by default the one with the
+// largest radius)
+static bool insertAPoint(GFace *gf, double center[2], double metric[3],
+                         bidimMeshData &data, MTri3Pool &pool,
+                         MTri3Heap &AllTris, cavityBuffers &buf,
+                         MTri3Heap *ActiveTris = nullptr,
+                         MTri3 *worst = nullptr,
+                         MTri3 **oneNewTriangle = nullptr,
+                         bool testStarShapeness = false)
 {
   if(worst) {
-    it = AllTris.find(worst);
-    if(worst != *it) {
+    if(!AllTris.contains(worst)) {
       Msg::Error("Could not insert point");
       return false;
     }
   }
   else
-    worst = *it;
+    worst = AllTris.top();
 
   MTri3 *ptin = nullptr;
-  std::list<edgeXface> shell;
-  std::list<MTri3 *> cavity;
+  std::vector<edgeXface> &shell = buf.shell;
+  std::vector<MTri3 *> &cavity = buf.cavity;
+  shell.clear();
+  cavity.clear();
   double uv[2];
 
   // if the point is able to break the bad triangle "worst"
@@ -982,7 +979,7 @@ insertAPoint(GFace *gf, std::set<MTri3 *, compareTri3Ptr>::iterator it,
 
     int result = -9;
     if(p.succeeded()) {
-      result = insertVertexB(shell, cavity, false, gf, v, center, ptin, AllTris,
+      result = insertVertexB(buf, false, gf, v, center, ptin, pool, AllTris,
                              ActiveTris, data, metric, oneNewTriangle,
                              testStarShapeness);
     }
@@ -1007,54 +1004,43 @@ insertAPoint(GFace *gf, std::set<MTri3 *, compareTri3Ptr>::iterator it,
                    "parametric domain)",
                    center[0], center[1]);
 
-      AllTris.erase(it);
       worst->forceRadius(-1);
-      AllTris.insert(worst);
+      AllTris.update(worst);
       delete v;
       for(auto itc = cavity.begin(); itc != cavity.end(); ++itc)
         (*itc)->setDeleted(false);
       return false;
     }
     else {
-      gf->mesh_vertices.push_back(v);
+      if(data.meshVertices)
+        data.meshVertices->push_back(v);
+      else
+        gf->mesh_vertices.push_back(v);
+      static const int counter = Profiler::counter("Delaunay insertions");
+      Profiler::count(counter);
       return true;
     }
   }
   else {
     for(auto itc = cavity.begin(); itc != cavity.end(); ++itc)
       (*itc)->setDeleted(false);
-    AllTris.erase(it);
     worst->forceRadius(0);
-    AllTris.insert(worst);
+    AllTris.update(worst);
     return false;
   }
 }
 
-void bowyerWatson(GFace *gf, int MAXPNT,
-                  std::map<MVertex *, MVertex *> *equivalence,
-                  std::map<MVertex *, SPoint2> *parametricCoordinates)
+static void refineDelaunay(GFace *gf, MTri3Pool &pool, MTri3Heap &AllTris,
+                           cavityBuffers &buf, bidimMeshData &DATA, int MAXPNT)
 {
-  std::set<MTri3 *, compareTri3Ptr> AllTris;
-  bidimMeshData DATA(equivalence, parametricCoordinates);
-
-  if(!buildMeshGenerationDataStructures(gf, AllTris, DATA)) {
-    Msg::Error("Invalid meshing data structure");
-    return;
-  }
-
-  if(AllTris.empty()) {
-    Msg::Error("No triangles in initial mesh");
-    return;
-  }
-
   int ITER = 0;
   int NBDELETED = 0;
-  while(1) {
-    MTri3 *worst = *AllTris.begin();
+  while(!AllTris.empty()) {
+    MTri3 *worst = AllTris.top();
     if(worst->isDeleted()) {
+      AllTris.pop();
       delete worst->tri();
-      delete worst;
-      AllTris.erase(AllTris.begin());
+      pool.free(worst);
       NBDELETED++;
     }
     else {
@@ -1080,9 +1066,39 @@ void bowyerWatson(GFace *gf, int MAXPNT,
 
       buildMetric(gf, pa, metric);
       circumCenterMetric(worst->tri(), metric, DATA, center, r2);
-      insertAPoint(gf, AllTris.begin(), center, metric, DATA, AllTris);
+      insertAPoint(gf, center, metric, DATA, pool, AllTris, buf);
     }
   }
+}
+
+static bool refineInSubdomains(GFace *gf, MTri3Pool &pool, MTri3Heap &AllTris,
+                               cavityBuffers &buf, bidimMeshData &DATA,
+                               int MAXPNT, bool frontal,
+                               std::vector<SPoint2> *true_boundary);
+
+void bowyerWatson(GFace *gf, int MAXPNT,
+                  std::map<MVertex *, MVertex *> *equivalence,
+                  std::map<MVertex *, SPoint2> *parametricCoordinates)
+{
+  MTri3Pool pool(gf->triangles.size());
+  MTri3Heap AllTris;
+  cavityBuffers buf;
+  bidimMeshData DATA(equivalence, parametricCoordinates);
+
+  if(!buildMeshGenerationDataStructures(gf, pool, AllTris, DATA)) {
+    Msg::Error("Invalid meshing data structure");
+    return;
+  }
+
+  if(AllTris.empty()) {
+    Msg::Error("No triangles in initial mesh");
+    return;
+  }
+
+  if(refineInSubdomains(gf, pool, AllTris, buf, DATA, MAXPNT, false, nullptr))
+    return;
+
+  refineDelaunay(gf, pool, AllTris, buf, DATA, MAXPNT);
   splitElementsInBoundaryLayerIfNeeded(gf);
   transferDataStructure(gf, AllTris, DATA);
 }
@@ -1286,27 +1302,18 @@ static bool optimalPointFrontalB(GFace *gf, MTri3 *worst, int active_edge,
   return true;
 }
 
-void bowyerWatsonFrontal(GFace *gf, std::map<MVertex *, MVertex *> *equivalence,
-                         std::map<MVertex *, SPoint2> *parametricCoordinates,
-                         std::vector<SPoint2> *true_boundary)
+static void refineFrontal(GFace *gf, MTri3Pool &pool, MTri3Heap &AllTris,
+                          cavityBuffers &buf, bidimMeshData &DATA,
+                          std::vector<SPoint2> *true_boundary)
 {
-  std::set<MTri3 *, compareTri3Ptr> AllTris;
-  std::set<MTri3 *, compareTri3Ptr> ActiveTris;
-  bidimMeshData DATA(equivalence, parametricCoordinates);
+  MTri3Heap ActiveTris;
   bool testStarShapeness = true;
-  SPoint3 c;
-  std::set<GEntity *> degenerated;
-  getDegeneratedVertices(gf, degenerated);
-
-  if(!buildMeshGenerationDataStructures(gf, AllTris, DATA)) {
-    Msg::Error("Invalid meshing data structure");
-    return;
-  }
 
   int ITER = 0, active_edge;
   // compute active triangle
-  auto it = AllTris.begin();
-  for(; it != AllTris.end(); ++it) {
+  std::vector<MTri3 *> tris;
+  AllTris.getAll(tris);
+  for(auto it = tris.begin(); it != tris.end(); ++it) {
     if(isActive(*it, LIMIT_, active_edge))
       ActiveTris.insert(*it);
     else if((*it)->getRadius() < LIMIT_)
@@ -1317,7 +1324,6 @@ void bowyerWatsonFrontal(GFace *gf, std::map<MVertex *, MVertex *> *equivalence,
   Range<double> RV = gf->parBounds(1);
   SPoint2 FAR(2 * RU.high(), 2 * RV.high());
 
-
   // insert points
   int ITERATION = 0;
   while(1) {
@@ -1334,21 +1340,21 @@ void bowyerWatsonFrontal(GFace *gf, std::map<MVertex *, MVertex *> *equivalence,
 
     //    printf("%d active tris \n",ActiveTris.size());
     if(!ActiveTris.size()) break;
-    MTri3 *worst = (*ActiveTris.begin());
-    ActiveTris.erase(ActiveTris.begin());
+    MTri3 *worst = ActiveTris.top();
+    ActiveTris.pop();
 
     if(!worst->isDeleted() && isActive(worst, LIMIT_, active_edge) &&
        worst->getRadius() > LIMIT_) {
       if(ITER++ % 5000 == 0)
         Msg::Debug("%7d points created -- Worst tri radius is %8.3f",
-                   gf->mesh_vertices.size(), worst->getRadius());
+                   DATA.vSizes.size(), worst->getRadius());
       double newPoint[2], metric[3];
       if(optimalPointFrontalB(gf, worst, active_edge, DATA, newPoint, metric)) {
         SPoint2 NP(newPoint[0], newPoint[1]);
         int nnnn;
         if(!true_boundary ||
            pointInsideParametricDomain(*true_boundary, NP, FAR, nnnn))
-          insertAPoint(gf, AllTris.end(), newPoint, metric, DATA, AllTris,
+          insertAPoint(gf, newPoint, metric, DATA, pool, AllTris, buf,
                        &ActiveTris, worst, nullptr, testStarShapeness);
       }
     }
@@ -1357,10 +1363,309 @@ void bowyerWatsonFrontal(GFace *gf, std::map<MVertex *, MVertex *> *equivalence,
   //  char name[245];
   //  sprintf(name,"delFrontal_GFace_%d_Layer_%d_Active.pos",gf->tag(),ITERATION);
   //  _printTris (name, AllTris.begin(), AllTris.end(), &DATA);
+}
+
+// Recursive coordinate bisection of the triangles tris[beg, end) (weighted by
+// w) into the parts [p0, p0 + np), using the centroids c in parameter space
+static void bisectTriangles(std::vector<std::size_t> &tris, std::size_t beg,
+                            std::size_t end, const std::vector<SPoint2> &c,
+                            const std::vector<double> &w, int p0, int np,
+                            std::vector<int> &part)
+{
+  if(np == 1 || end - beg < 2) {
+    for(std::size_t i = beg; i < end; i++) part[tris[i]] = p0;
+    return;
+  }
+  SBoundingBox3d bb;
+  double total = 0.;
+  for(std::size_t i = beg; i < end; i++) {
+    bb += SPoint3(c[tris[i]].x(), c[tris[i]].y(), 0.);
+    total += w[tris[i]];
+  }
+  int dir = (bb.max().x() - bb.min().x() > bb.max().y() - bb.min().y()) ? 0 : 1;
+  std::sort(tris.begin() + beg, tris.begin() + end,
+            [&](std::size_t a, std::size_t b) {
+              if(c[a][dir] != c[b][dir]) return c[a][dir] < c[b][dir];
+              return a < b;
+            });
+  int n1 = np / 2;
+  double target = total * n1 / np, sum = 0.;
+  std::size_t mid = beg + 1;
+  for(std::size_t i = beg; i < end - 1; i++) {
+    sum += w[tris[i]];
+    mid = i + 1;
+    if(sum >= target) break;
+  }
+  bisectTriangles(tris, beg, mid, c, w, p0, n1, part);
+  bisectTriangles(tris, mid, end, c, w, p0 + n1, np - n1, part);
+}
+
+// Mesh large surfaces by splitting them into subdomains that are refined
+// concurrently: a coarse mesh is first generated, partitioned by recursive
+// bisection, and the edges between the subdomains are refined to the target
+// size and frozen, so that each subdomain can then be meshed independently.
+// The result only depends on Mesh.MaxNumSubdomains2D, not on the number of
+// threads. Returns false if the surface is not split.
+static bool refineInSubdomains(GFace *gf, MTri3Pool &pool, MTri3Heap &AllTris,
+                               cavityBuffers &buf, bidimMeshData &DATA,
+                               int MAXPNT, bool frontal,
+                               std::vector<SPoint2> *true_boundary)
+{
+  int maxSub = CTX::instance()->mesh.maxNumSubdomains2D;
+  if(maxSub < 2 || gf->geomType() == GEntity::DiscreteSurface) return false;
+
+  // estimate the number of nodes of the final mesh
+  std::vector<MTri3 *> tris;
+  AllTris.getAll(tris);
+  double estimate = 0.;
+  for(std::size_t i = 0; i < tris.size(); i++) {
+    MTriangle *t = tris[i]->tri();
+    double u = 0., v = 0., lc = 0., lcBGM = 0.;
+    for(int j = 0; j < 3; j++) {
+      int index = DATA.getIndex(t->getVertex(j));
+      u += DATA.Us[index] / 3.;
+      v += DATA.Vs[index] / 3.;
+      lc += DATA.vSizes[index] / 3.;
+      lcBGM += DATA.vSizesBGM[index] / 3.;
+    }
+    GPoint p = gf->point(u, v);
+    if(p.succeeded())
+      lcBGM = std::min(lcBGM, BGM_MeshSize(gf, u, v, p.x(), p.y(), p.z()));
+    double h = std::min(lc, lcBGM);
+    if(h > 0.) estimate += 0.5 * t->getVolume() / (0.433 * h * h);
+  }
+  int nsub = std::min(maxSub, (int)std::min(estimate / 20000., 1.e6));
+  if(nsub < 2 || estimate > MAXPNT) return false;
+
+  // coarse mesh
+  int maxCoarse = std::min(MAXPNT, (int)DATA.vSizes.size() + 100 * nsub);
+  refineDelaunay(gf, pool, AllTris, buf, DATA, maxCoarse);
+  AllTris.getAll(tris);
+  if(tris.empty() || tris[0]->getRadius() < 0.5 * std::sqrt(2.0)) return false;
+
+  Msg::Info("Meshing surface %d in %d subdomains (about %g nodes)", gf->tag(),
+            nsub, estimate);
+
+  // partition the live triangles
+  std::size_t nslots = 0;
+  for(std::size_t i = 0; i < tris.size(); i++)
+    nslots = std::max(nslots, (std::size_t)tris[i]->getIndex() + 1);
+  std::vector<int> part(nslots, -1);
+  std::vector<SPoint2> c(nslots);
+  std::vector<double> w(nslots, 0.);
+  std::vector<std::size_t> live;
+  for(std::size_t i = 0; i < tris.size(); i++) {
+    if(tris[i]->isDeleted()) continue;
+    std::size_t k = tris[i]->getIndex();
+    double u = 0., v = 0.;
+    for(int j = 0; j < 3; j++) {
+      int index = DATA.getIndex(tris[i]->tri()->getVertex(j));
+      u += DATA.Us[index] / 3.;
+      v += DATA.Vs[index] / 3.;
+    }
+    c[k] = SPoint2(u, v);
+    double r = std::max(tris[i]->getRadius(), 0.);
+    w[k] = 1. + r * r;
+    live.push_back(k);
+  }
+  bisectTriangles(live, 0, live.size(), c, w, 0, nsub, part);
+
+  // refine the edges between subdomains, and freeze them
+  std::set<MEdge, MEdgeLessThan> interfaces;
+  for(std::size_t i = 0; i < tris.size(); i++) {
+    if(tris[i]->isDeleted()) continue;
+    for(int j = 0; j < 3; j++) {
+      MTri3 *n = tris[i]->getNeigh(j);
+      if(!n || part[n->getIndex()] == part[tris[i]->getIndex()]) continue;
+      edgeXface e(tris[i], j);
+      MEdge me(e._v(0), e._v(1));
+      if(DATA.internalEdges.find(me) == DATA.internalEdges.end())
+        interfaces.insert(me);
+    }
+  }
+  DATA.internalEdges.insert(interfaces.begin(), interfaces.end());
+  for(int iter = 0; iter < 30; iter++) {
+    std::vector<std::pair<MTri3 *, int> > toSplit;
+    AllTris.getAll(tris);
+    for(std::size_t i = 0; i < tris.size(); i++) {
+      if(tris[i]->isDeleted()) continue;
+      for(int j = 0; j < 3; j++) {
+        MTri3 *n = tris[i]->getNeigh(j);
+        if(!n || part[n->getIndex()] <= part[tris[i]->getIndex()]) continue;
+        edgeXface e(tris[i], j);
+        if(interfaces.find(MEdge(e._v(0), e._v(1))) == interfaces.end())
+          continue;
+        int i0 = DATA.getIndex(e._v(0)), i1 = DATA.getIndex(e._v(1));
+        double lc = std::min(0.5 * (DATA.vSizes[i0] + DATA.vSizes[i1]),
+                             0.5 * (DATA.vSizesBGM[i0] + DATA.vSizesBGM[i1]));
+        if(e._v(0)->distance(e._v(1)) > 1.3 * lc)
+          toSplit.push_back(std::make_pair(tris[i], j));
+      }
+    }
+    if(toSplit.empty()) break;
+    for(std::size_t i = 0; i < toSplit.size(); i++) {
+      MTri3 *t = toSplit[i].first;
+      if(t->isDeleted()) continue;
+      edgeXface e(t, toSplit[i].second);
+      MEdge me(e._v(0), e._v(1));
+      int i0 = DATA.getIndex(e._v(0)), i1 = DATA.getIndex(e._v(1));
+      double mid[2] = {0.5 * (DATA.Us[i0] + DATA.Us[i1]),
+                       0.5 * (DATA.Vs[i0] + DATA.Vs[i1])};
+      double metric[3];
+      buildMetric(gf, mid, metric);
+      double r = t->getRadius();
+      interfaces.erase(me);
+      DATA.internalEdges.erase(me);
+      if(insertAPoint(gf, mid, metric, DATA, pool, AllTris, buf, nullptr, t)) {
+        // the new triangles belong to the subdomain of the cavity triangle
+        // (now deleted) that was adjacent to their shell edge
+        for(std::size_t k = 0; k < buf.newTris.size(); k++) {
+          std::size_t index = buf.newTris[k]->getIndex();
+          if(index >= part.size()) part.resize(index + 1, -1);
+          part[index] = part[buf.shell[k].t1->getIndex()];
+        }
+        MVertex *p = gf->mesh_vertices.back();
+        MEdge e1(e._v(0), p), e2(p, e._v(1));
+        interfaces.insert(e1);
+        interfaces.insert(e2);
+        DATA.internalEdges.insert(e1);
+        DATA.internalEdges.insert(e2);
+      }
+      else {
+        if(!t->isDeleted()) {
+          t->forceRadius(r);
+          AllTris.update(t);
+        }
+        interfaces.insert(me);
+        DATA.internalEdges.insert(me);
+      }
+    }
+  }
+
+  // copy the subdomains
+  AllTris.getAll(tris);
+  struct subdomain {
+    MTri3Pool pool;
+    MTri3Heap tris;
+    cavityBuffers buf;
+    bidimMeshData data;
+    std::vector<MVertex *> vertices;
+  };
+  std::vector<subdomain> subs(nsub);
+  std::vector<MTri3 *> copies(part.size(), nullptr);
+  for(int k = 0; k < nsub; k++) {
+    subs[k].data = DATA;
+    subs[k].data.meshVertices = &subs[k].vertices;
+  }
+  for(std::size_t i = 0; i < tris.size(); i++) {
+    if(tris[i]->isDeleted()) continue;
+    std::size_t index = tris[i]->getIndex();
+    copies[index] = subs[part[index]].pool.copy(*tris[i]);
+  }
+  for(std::size_t i = 0; i < tris.size(); i++) {
+    if(tris[i]->isDeleted()) continue;
+    std::size_t index = tris[i]->getIndex();
+    MTri3 *t = copies[index];
+    for(int j = 0; j < 3; j++) {
+      MTri3 *n = tris[i]->getNeigh(j);
+      t->setNeigh(j, (n && part[n->getIndex()] == part[index]) ?
+                       copies[n->getIndex()] : nullptr);
+    }
+    subs[part[index]].tris.insert(t);
+  }
+
+  // the coarse triangles are now owned by the subdomains
+  for(std::size_t i = 0; i < tris.size(); i++)
+    if(tris[i]->isDeleted()) delete tris[i]->tri();
+  AllTris.clear();
+
+  int nthreads = CTX::instance()->numThreads;
+  if(CTX::instance()->mesh.maxNumThreads2D > 0)
+    nthreads = CTX::instance()->mesh.maxNumThreads2D;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+  // surfaces are already being meshed concurrently
+  if(Msg::GetNumThreads() > 1) nthreads = 1;
+
+  bool exceptions = false;
+  auto refine = [&](int k) {
+    try { // OpenMP forbids leaving block via exception
+      if(frontal)
+        refineFrontal(gf, subs[k].pool, subs[k].tris, subs[k].buf,
+                      subs[k].data, true_boundary);
+      else
+        refineDelaunay(gf, subs[k].pool, subs[k].tris, subs[k].buf,
+                       subs[k].data, MAXPNT);
+    }
+    catch(...) {
+      exceptions = true;
+    }
+  };
+  if(nthreads > 1) {
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+    for(int k = 0; k < nsub; k++) refine(k);
+  }
+  else {
+    for(int k = 0; k < nsub; k++) refine(k);
+  }
+
+  // merge the subdomains
+  for(auto it = interfaces.begin(); it != interfaces.end(); ++it)
+    DATA.internalEdges.erase(*it);
+  tris.clear();
+  for(int k = 0; k < nsub; k++) {
+    bidimMeshData &data = subs[k].data;
+    for(std::size_t i = 0; i < subs[k].vertices.size(); i++) {
+      MVertex *v = subs[k].vertices[i];
+      int index = data.getIndex(v);
+      DATA.addVertex(v, data.Us[index], data.Vs[index], data.vSizes[index],
+                     data.vSizesBGM[index]);
+      gf->mesh_vertices.push_back(v);
+    }
+    std::vector<MTri3 *> t;
+    subs[k].tris.getAll(t);
+    tris.insert(tris.end(), t.begin(), t.end());
+  }
+  if(exceptions) {
+    for(std::size_t i = 0; i < tris.size(); i++) delete tris[i]->tri();
+    throw std::runtime_error(Msg::GetLastError());
+  }
+
+  if(frontal) {
+    transferDataStructure(gf, tris, DATA);
+    splitElementsInBoundaryLayerIfNeeded(gf);
+  }
+  else {
+    splitElementsInBoundaryLayerIfNeeded(gf);
+    transferDataStructure(gf, tris, DATA);
+  }
+  return true;
+}
+
+void bowyerWatsonFrontal(GFace *gf, std::map<MVertex *, MVertex *> *equivalence,
+                         std::map<MVertex *, SPoint2> *parametricCoordinates,
+                         std::vector<SPoint2> *true_boundary)
+{
+  MTri3Pool pool(gf->triangles.size());
+  MTri3Heap AllTris;
+  cavityBuffers buf;
+  bidimMeshData DATA(equivalence, parametricCoordinates);
+  SPoint3 c;
+  std::set<GEntity *> degenerated;
+  getDegeneratedVertices(gf, degenerated);
+
+  if(!buildMeshGenerationDataStructures(gf, pool, AllTris, DATA)) {
+    Msg::Error("Invalid meshing data structure");
+    return;
+  }
+
+  if(refineInSubdomains(gf, pool, AllTris, buf, DATA, 1000000000, true,
+                        true_boundary))
+    return;
+
+  refineFrontal(gf, pool, AllTris, buf, DATA, true_boundary);
   transferDataStructure(gf, AllTris, DATA);
 
   splitElementsInBoundaryLayerIfNeeded(gf);
-
 }
 
 static void optimalPointFrontalQuad(GFace *gf, MTri3 *worst, int active_edge,
@@ -1498,8 +1803,10 @@ void bowyerWatsonFrontalLayers(
   GFace *gf, bool quad, std::map<MVertex *, MVertex *> *equivalence,
   std::map<MVertex *, SPoint2> *parametricCoordinates)
 {
-  std::set<MTri3 *, compareTri3Ptr> AllTris;
-  std::set<MTri3 *, compareTri3Ptr> ActiveTris;
+  MTri3Pool pool(gf->triangles.size());
+  MTri3Heap AllTris;
+  MTri3Heap ActiveTris;
+  cavityBuffers buf;
   bidimMeshData DATA(equivalence, parametricCoordinates);
 
   if(quad) {
@@ -1508,16 +1815,17 @@ void bowyerWatsonFrontalLayers(
     MTri3::radiusNorm = -1;
   }
 
-  if(!buildMeshGenerationDataStructures(gf, AllTris, DATA)) {
+  if(!buildMeshGenerationDataStructures(gf, pool, AllTris, DATA)) {
     Msg::Error("Invalid meshing data structure");
     return;
   }
 
   int ITER = 0, active_edge;
   // compute active triangle
-  auto it = AllTris.begin();
+  std::vector<MTri3 *> tris;
+  AllTris.getAll(tris);
   std::set<MEdge, MEdgeLessThan> _front;
-  for(; it != AllTris.end(); ++it) {
+  for(auto it = tris.begin(); it != tris.end(); ++it) {
     if(isActive(*it, LIMIT_, active_edge)) {
       ActiveTris.insert(*it);
       updateActiveEdges(*it, LIMIT_, _front);
@@ -1539,7 +1847,7 @@ void bowyerWatsonFrontalLayers(
     //   _printTris (name, ActiveTris.begin(),  ActiveTris.end(),DATA,true);
     // }
 
-    std::set<MTri3 *, compareTri3Ptr> ActiveTrisNotInFront;
+    MTri3Heap ActiveTrisNotInFront;
 
     // printf("%d active triangles\n",ActiveTris.size());
 
@@ -1552,10 +1860,8 @@ void bowyerWatsonFrontalLayers(
            _printTris (name, AllTris, Us,Vs,true);
          }
       */
-      auto WORST_ITER = ActiveTris.begin();
-
-      MTri3 *worst = (*WORST_ITER);
-      ActiveTris.erase(WORST_ITER);
+      MTri3 *worst = ActiveTris.top();
+      ActiveTris.pop();
       if(!worst->isDeleted() &&
          (ITERATION > max_layers ?
             isActive(worst, LIMIT_, active_edge) :
@@ -1578,7 +1884,7 @@ void bowyerWatsonFrontalLayers(
         else
           optimalPointFrontalB(gf, worst, active_edge, DATA, newPoint, metric);
 
-        insertAPoint(gf, AllTris.end(), newPoint, nullptr, DATA, AllTris,
+        insertAPoint(gf, newPoint, nullptr, DATA, pool, AllTris, buf,
                      &ActiveTris, worst);
         // else if (!worst->isDeleted() && worst->getRadius() > LIMIT_){
         //   ActiveTrisNotInFront.insert(worst);
@@ -1597,8 +1903,8 @@ void bowyerWatsonFrontalLayers(
       }
     }
     _front.clear();
-    it = ActiveTrisNotInFront.begin();
-    for(; it != ActiveTrisNotInFront.end(); ++it) {
+    for(auto it = ActiveTrisNotInFront.begin();
+        it != ActiveTrisNotInFront.end(); ++it) {
       if((*it)->getRadius() > LIMIT_ && isActive(*it, LIMIT_, active_edge)) {
         ActiveTris.insert(*it);
         updateActiveEdges(*it, LIMIT_, _front);
@@ -1622,7 +1928,9 @@ void bowyerWatsonParallelograms(
   GFace *gf, std::map<MVertex *, MVertex *> *equivalence,
   std::map<MVertex *, SPoint2> *parametricCoordinates)
 {
-  std::set<MTri3 *, compareTri3Ptr> AllTris;
+  MTri3Pool pool(gf->triangles.size());
+  MTri3Heap AllTris;
+  cavityBuffers buf;
   bidimMeshData DATA(equivalence, parametricCoordinates);
   std::vector<MVertex *> packed;
   std::vector<SMetric3> metrics;
@@ -1651,7 +1959,7 @@ void bowyerWatsonParallelograms(
 
   Msg::Info("%lu Nodes created --> now staring insertion", packed.size());
 
-  if(!buildMeshGenerationDataStructures(gf, AllTris, DATA)) {
+  if(!buildMeshGenerationDataStructures(gf, pool, AllTris, DATA)) {
     Msg::Error("Invalid meshing data structure");
     return;
   }
@@ -1664,11 +1972,11 @@ void bowyerWatsonParallelograms(
 
   MTri3 *oneNewTriangle = nullptr;
   for(std::size_t i = 0; i < packed.size();) {
-    MTri3 *worst = *AllTris.begin();
+    MTri3 *worst = AllTris.top();
     if(worst->isDeleted()) {
+      AllTris.pop();
       delete worst->tri();
-      delete worst;
-      AllTris.erase(AllTris.begin());
+      pool.free(worst);
     }
     else {
       double newPoint[2];
@@ -1679,23 +1987,14 @@ void bowyerWatsonParallelograms(
       buildMetric(gf, newPoint, metric);
 
       bool success =
-        insertAPoint(gf, AllTris.begin(), newPoint, metric, DATA, AllTris,
-                     nullptr, oneNewTriangle, &oneNewTriangle);
+        insertAPoint(gf, newPoint, metric, DATA, pool, AllTris, buf, nullptr,
+                     oneNewTriangle, &oneNewTriangle);
       if(!success) oneNewTriangle = nullptr;
       i++;
     }
 
-    if(1.0 * AllTris.size() > 2.5 * DATA.vSizes.size()) {
-      auto itd = AllTris.begin();
-      while(itd != AllTris.end()) {
-        if((*itd)->isDeleted()) {
-          delete *itd;
-          AllTris.erase(itd++);
-        }
-        else
-          itd++;
-      }
-    }
+    if(1.0 * AllTris.size() > 2.5 * DATA.vSizes.size())
+      AllTris.removeDeleted(pool);
   }
 
   transferDataStructure(gf, AllTris, DATA);
@@ -1716,7 +2015,9 @@ void bowyerWatsonParallelogramsConstrained(
   Msg::Error("bowyerWatsonParallelogramsConstrained deprecated");
   return;
 
-  std::set<MTri3 *, compareTri3Ptr> AllTris;
+  MTri3Pool pool(gf->triangles.size());
+  MTri3Heap AllTris;
+  cavityBuffers buf;
   bidimMeshData DATA(equivalence, parametricCoordinates);
   std::vector<MVertex *> packed;
   std::vector<SMetric3> metrics;
@@ -1728,7 +2029,7 @@ void bowyerWatsonParallelogramsConstrained(
   Msg::Error("Packing of parallelograms algorithm requires DOMHEX");
 #endif
 
-  if(!buildMeshGenerationDataStructures(gf, AllTris, DATA)) {
+  if(!buildMeshGenerationDataStructures(gf, pool, AllTris, DATA)) {
     Msg::Error("Invalid meshing data structure");
     return;
   }
@@ -1737,11 +2038,11 @@ void bowyerWatsonParallelogramsConstrained(
 
   MTri3 *oneNewTriangle = nullptr;
   for(std::size_t i = 0; i < packed.size();) {
-    MTri3 *worst = *AllTris.begin();
+    MTri3 *worst = AllTris.top();
     if(worst->isDeleted()) {
+      AllTris.pop();
       delete worst->tri();
-      delete worst;
-      AllTris.erase(AllTris.begin());
+      pool.free(worst);
     }
     else {
       double newPoint[2];
@@ -1752,23 +2053,14 @@ void bowyerWatsonParallelogramsConstrained(
       buildMetric(gf, newPoint, metric);
 
       bool success =
-        insertAPoint(gf, AllTris.begin(), newPoint, metric, DATA, AllTris,
-                     nullptr, oneNewTriangle, &oneNewTriangle);
+        insertAPoint(gf, newPoint, metric, DATA, pool, AllTris, buf, nullptr,
+                     oneNewTriangle, &oneNewTriangle);
       if(!success) oneNewTriangle = nullptr;
       i++;
     }
 
-    if(1.0 * AllTris.size() > 2.5 * DATA.vSizes.size()) {
-      auto itd = AllTris.begin();
-      while(itd != AllTris.end()) {
-        if((*itd)->isDeleted()) {
-          delete *itd;
-          AllTris.erase(itd++);
-        }
-        else
-          itd++;
-      }
-    }
+    if(1.0 * AllTris.size() > 2.5 * DATA.vSizes.size())
+      AllTris.removeDeleted(pool);
   }
 
   transferDataStructure(gf, AllTris, DATA);
@@ -14,6 +14,8 @@
 #include <list>
 #include <set>
 #include <map>
+#include <vector>
+#include <algorithm>
 
 class GModel;
 class GFace;
@@ -27,6 +29,8 @@ struct bidimMeshData {
   std::map<MVertex *, MVertex *> *equivalence;
   std::map<MVertex *, SPoint2> *parametricCoordinates;
   std::set<MEdge, MEdgeLessThan> internalEdges; // embedded edges
+  // where the new nodes are stored (the mesh vertices of the face if null)
+  std::vector<MVertex *> *meshVertices;
   //  std::set<MVertex*> internalVertices; // embedded vertices
   inline void addVertex(MVertex *mv, double u, double v, double size,
                         double sizeBGM)
@@ -64,7 +68,7 @@ struct bidimMeshData {
   }
   bidimMeshData(std::map<MVertex *, MVertex *> *e = nullptr,
                 std::map<MVertex *, SPoint2> *p = nullptr)
-    : equivalence(e), parametricCoordinates(p)
+    : equivalence(e), parametricCoordinates(p), meshVertices(nullptr)
   {
   }
 };
@@ -76,11 +80,14 @@ int inCircumCircleAniso(GFace *gf, MTriangle *base, const double *uv,
                         const double *metric, bidimMeshData &data);
 
 class MTri3 {
+  friend class MTri3Pool;
+
 protected:
   bool deleted;
   double circum_radius;
   MTriangle *base;
   MTri3 *neigh[3];
+  int index; // slot in the MTri3Pool, or -1
 
 public:
   /// 2 is euclidian norm, -1 is infinite norm  , 3 quality
@@ -99,8 +106,13 @@ public:
         return n->tri()->getVertex(j);
     return nullptr;
   }
+  MTri3() : deleted(false), circum_radius(0.), base(nullptr), index(-1)
+  {
+    neigh[0] = neigh[1] = neigh[2] = nullptr;
+  }
   MTri3(MTriangle *t, double lc, SMetric3 *m = nullptr,
         bidimMeshData *data = nullptr, GFace *gf = nullptr);
+  inline int getIndex() const { return index; }
   inline void setTri(MTriangle *t) { base = t; }
   inline MTriangle *tri() const { return base; }
   inline void setNeigh(int iN, MTri3 *n) { neigh[iN] = n; }
@@ -143,9 +155,175 @@ public:
   }
 };
 
+// Allocates MTri3s by blocks, and reuses the freed ones; the index of an MTri3
+// identifies its slot, and is used by MTri3Heap
+class MTri3Pool {
+private:
+  std::vector<MTri3 *> _blocks;
+  std::vector<MTri3 *> _free;
+  // size of the last block, number of slots used in it, and total number of
+  // slots
+  std::size_t _blockSize, _blockUsed, _size;
+  // store a copy of t in a free slot, keeping the index of the slot
+  MTri3 *_store(const MTri3 &t)
+  {
+    MTri3 *t3;
+    if(!_free.empty()) {
+      t3 = _free.back();
+      _free.pop_back();
+    }
+    else {
+      if(_blocks.empty() || _blockUsed == _blockSize) {
+        // the blocks grow geometrically, up to 65536 MTri3s
+        if(!_blocks.empty() && _blockSize < 65536)
+          _blockSize = std::min(2 * _blockSize, (std::size_t)65536);
+        _blocks.push_back(new MTri3[_blockSize]);
+        _blockUsed = 0;
+      }
+      t3 = &_blocks.back()[_blockUsed++];
+      t3->index = (int)_size++;
+    }
+    int index = t3->index;
+    *t3 = t;
+    t3->index = index;
+    return t3;
+  }
+
+public:
+  // the first block holds size MTri3s (e.g. the number of triangles in the
+  // initial mesh of the surface)
+  MTri3Pool(std::size_t size = 0)
+    : _blockSize(std::max(size, (std::size_t)256)), _blockUsed(0), _size(0)
+  {
+  }
+  ~MTri3Pool()
+  {
+    for(std::size_t i = 0; i < _blocks.size(); i++) delete[] _blocks[i];
+  }
+  MTri3 *create(MTriangle *t, double lc, SMetric3 *m = nullptr,
+                bidimMeshData *data = nullptr, GFace *gf = nullptr)
+  {
+    return _store(MTri3(t, lc, m, data, gf));
+  }
+  // create a copy of t (with the same triangle and neighbors) in this pool
+  MTri3 *copy(const MTri3 &t) { return _store(t); }
+  // release the slot of t (its triangle is not deleted); t should not be in
+  // any MTri3Heap anymore
+  void free(MTri3 *t) { _free.push_back(t); }
+};
+
+// Priority queue of pooled MTri3s, in the order defined by compareTri3Ptr
+// (largest radius first). The binary heap is indexed by the MTri3 indices, so
+// that checking if an MTri3 is in the queue is done in constant time, and
+// removing it or updating it after a change of its radius in logarithmic time.
+class MTri3Heap {
+private:
+  std::vector<MTri3 *> _heap;
+  std::vector<int> _pos; // position in _heap of each MTri3 index, or -1
+  compareTri3Ptr _less;
+  void _set(std::size_t i, MTri3 *t)
+  {
+    _heap[i] = t;
+    _pos[t->getIndex()] = (int)i;
+  }
+  void _up(std::size_t i)
+  {
+    MTri3 *t = _heap[i];
+    while(i > 0) {
+      std::size_t p = (i - 1) / 2;
+      if(!_less(t, _heap[p])) break;
+      _set(i, _heap[p]);
+      i = p;
+    }
+    _set(i, t);
+  }
+  void _down(std::size_t i)
+  {
+    MTri3 *t = _heap[i];
+    std::size_t n = _heap.size();
+    while(2 * i + 1 < n) {
+      std::size_t c = 2 * i + 1;
+      if(c + 1 < n && _less(_heap[c + 1], _heap[c])) c++;
+      if(!_less(_heap[c], t)) break;
+      _set(i, _heap[c]);
+      i = c;
+    }
+    _set(i, t);
+  }
+
+public:
+  typedef std::vector<MTri3 *>::const_iterator iterator;
+  std::size_t size() const { return _heap.size(); }
+  bool empty() const { return _heap.empty(); }
+  // iterators over the MTri3s, in no particular order
+  iterator begin() const { return _heap.begin(); }
+  iterator end() const { return _heap.end(); }
+  bool contains(const MTri3 *t) const
+  {
+    int i = t->getIndex();
+    return i >= 0 && i < (int)_pos.size() && _pos[i] >= 0;
+  }
+  // insert t if it is not already in the queue
+  bool insert(MTri3 *t)
+  {
+    if(contains(t)) return false;
+    std::size_t i = t->getIndex();
+    if(i >= _pos.size()) _pos.resize(std::max(i + 1, 2 * _pos.size()), -1);
+    _heap.push_back(t);
+    _up(_heap.size() - 1);
+    return true;
+  }
+  // the MTri3 with the largest radius
+  MTri3 *top() const { return _heap.front(); }
+  void pop() { erase(_heap.front()); }
+  void erase(MTri3 *t)
+  {
+    std::size_t i = _pos[t->getIndex()];
+    _pos[t->getIndex()] = -1;
+    MTri3 *last = _heap.back();
+    _heap.pop_back();
+    if(last == t) return;
+    _set(i, last);
+    update(last);
+  }
+  // restore the order after a change of the radius of t
+  void update(MTri3 *t)
+  {
+    _up(_pos[t->getIndex()]);
+    _down(_pos[t->getIndex()]);
+  }
+  // remove the deleted MTri3s, and free them with their triangle
+  void removeDeleted(MTri3Pool &pool)
+  {
+    std::size_t n = 0;
+    for(std::size_t i = 0; i < _heap.size(); i++) {
+      MTri3 *t = _heap[i];
+      if(t->isDeleted()) {
+        _pos[t->getIndex()] = -1;
+        delete t->tri();
+        pool.free(t);
+      }
+      else
+        _set(n++, t);
+    }
+    _heap.resize(n);
+    for(std::size_t i = n / 2; i-- > 0;) _down(i);
+  }
+  // all the MTri3s, in the order of the queue
+  void getAll(std::vector<MTri3 *> &tris) const
+  {
+    tris = _heap;
+    std::sort(tris.begin(), tris.end(), _less);
+  }
+  void clear()
+  {
+    std::vector<MTri3 *>().swap(_heap);
+    std::vector<int>().swap(_pos);
+  }
+};
+
 void connectTriangles(std::list<MTri3 *> &);
 void connectTriangles(std::vector<MTri3 *> &);
-void connectTriangles(std::set<MTri3 *, compareTri3Ptr> &AllTris);
 void bowyerWatson(
   GFace *gf, int MAXPNT = 1000000000,
   std::map<MVertex *, MVertex *> *equivalence = nullptr,
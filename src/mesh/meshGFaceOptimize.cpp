@@ -171,8 +171,8 @@ static void setLcs(MTriangle *t, std::map<MVertex *, double> &vSizes,
   }
 }
 
-bool buildMeshGenerationDataStructures(
-  GFace *gf, std::set<MTri3 *, compareTri3Ptr> &AllTris, bidimMeshData &data)
+bool buildMeshGenerationDataStructures(GFace *gf, MTri3Pool &pool,
+                                       MTri3Heap &AllTris, bidimMeshData &data)
 {
   std::map<MVertex *, double> vSizesMap;
 
@@ -248,6 +248,7 @@ bool buildMeshGenerationDataStructures(
                            it->second;
     data.addVertex(it->first, param[0], param[1], it->second, lcBGM);
   }
+  std::vector<MTri3 *> tris(gf->triangles.size());
   for(std::size_t i = 0; i < gf->triangles.size(); i++) {
     double lc = 0.3333333333 *
                 (data.vSizes[data.getIndex(gf->triangles[i]->getVertex(0))] +
@@ -260,10 +261,11 @@ bool buildMeshGenerationDataStructures(
        data.vSizesBGM[data.getIndex(gf->triangles[i]->getVertex(2))]);
 
     double LL = Extend1dMeshIn2dSurfaces(gf) ? std::min(lc, lcBGM) : lcBGM;
-    AllTris.insert(new MTri3(gf->triangles[i], LL, nullptr, &data, gf));
+    tris[i] = pool.create(gf->triangles[i], LL, nullptr, &data, gf);
   }
   gf->triangles.clear();
-  connectTriangles(AllTris);
+  connectTriangles(tris);
+  for(std::size_t i = 0; i < tris.size(); i++) AllTris.insert(tris[i]);
 
   return true;
 }
@@ -345,19 +347,23 @@ void splitEquivalentTriangles(GFace *gf, bidimMeshData &data)
   computeEquivalentTriangles(gf, data.equivalence);
 }
 
-void transferDataStructure(GFace *gf,
-                           std::set<MTri3 *, compareTri3Ptr> &AllTris,
+void transferDataStructure(GFace *gf, MTri3Heap &AllTris, bidimMeshData &data)
+{
+  // the MTri3s themselves are freed with their pool
+  std::vector<MTri3 *> tris;
+  AllTris.getAll(tris);
+  AllTris.clear();
+  transferDataStructure(gf, tris, data);
+}
+
+void transferDataStructure(GFace *gf, const std::vector<MTri3 *> &tris,
                            bidimMeshData &data)
 {
-  while(1) {
-    if(AllTris.begin() == AllTris.end()) break;
-    MTri3 *worst = *AllTris.begin();
-    if(worst->isDeleted())
-      delete worst->tri();
+  for(std::size_t i = 0; i < tris.size(); i++) {
+    if(tris[i]->isDeleted())
+      delete tris[i]->tri();
     else
-      gf->triangles.push_back(worst->tri());
-    delete worst;
-    AllTris.erase(AllTris.begin());
+      gf->triangles.push_back(tris[i]->tri());
   }
 
   // make sure all the triangles are oriented in the same way in
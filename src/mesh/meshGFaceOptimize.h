@@ -58,10 +58,11 @@ void buildEdgeToElements(std::vector<MElement *> &tris, e2t_cont &adj);
 
 void laplaceSmoothing(GFace *gf, int niter = 1, bool infinity_norm = false);
 
-bool buildMeshGenerationDataStructures(
-  GFace *gf, std::set<MTri3 *, compareTri3Ptr> &AllTris, bidimMeshData &data);
-void transferDataStructure(GFace *gf,
-                           std::set<MTri3 *, compareTri3Ptr> &AllTris,
+bool buildMeshGenerationDataStructures(GFace *gf, MTri3Pool &pool,
+                                       MTri3Heap &AllTris,
+                                       bidimMeshData &data);
+void transferDataStructure(GFace *gf, MTri3Heap &AllTris, bidimMeshData &DATA);
+void transferDataStructure(GFace *gf, const std::vector<MTri3 *> &tris,
                            bidimMeshData &DATA);
 void computeEquivalences(GFace *gf, bidimMeshData &DATA);
 void recombineIntoQuads(GFace *gf, bool blossom, int topologicalOptiPasses,
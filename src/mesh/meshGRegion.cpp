@@ -7,6 +7,7 @@
 #include <vector>
 #include "GmshConfig.h"
 #include "GmshMessage.h"
+#include "Profiler.h"
 #include "meshGRegion.h"
 #include "meshGRegionHxt.h"
 #include "meshGRegionNetgen.h"
@@ -87,6 +88,7 @@ int splitQuadRecovery::buildPyramids(GModel *gm)
 void MeshDelaunayVolume(std::vector<GRegion *> &regions)
 {
   if(regions.empty()) return;
+  ProfilerScope scope("MeshDelaunayVolume");
 
   if(CTX::instance()->mesh.algo3d == ALGO_3D_HXT) {
     if(meshGRegionHxt(regions) != 0) { Msg::Error("HXT 3D mesh failed"); }
@@ -210,6 +212,7 @@ void deMeshGRegion::operator()(GRegion *gr)
 
 void meshGRegion::operator()(GRegion *gr)
 {
+  ProfilerScope scope("Volume", gr->tag());
   gr->model()->setCurrentMeshEntity(gr);
 
   if(gr->isFullyDiscrete()) return;
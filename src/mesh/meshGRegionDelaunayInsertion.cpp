@@ -7,9 +7,11 @@
 #include <map>
 #include <algorithm>
 #include <queue>
+#include <unordered_map>
 #include "GmshMessage.h"
 #include "robustPredicates.h"
 #include "OS.h"
+#include "Profiler.h"
 #include "meshGRegion.h"
 #include "meshGRegionLocalMeshMod.h"
 #include "meshGRegionDelaunayInsertion.h"
@@ -22,6 +24,7 @@
 #include "MEdge.h"
 #include "MLine.h"
 #include "ExtrudeParams.h"
+#include "HilbertCurve.h"
 
 int MTet4::radiusNorm = 2;
 
@@ -459,8 +462,7 @@ static void printTets(const char *fn, std::list<MTet4 *> &cavity,
 bool insertVertexB(std::vector<faceXtet> &shell, std::vector<MTet4 *> &cavity,
                    MVertex *v, double lc1, double lc2,
                    std::vector<double> &vSizes, std::vector<double> &vSizesBGM,
-                   MTet4 *t, MTet4Factory &myFactory,
-                   std::set<MTet4 *, compareTet4Ptr> &allTets,
+                   MTet4 *t, MTet4Factory &myFactory, MTet4Queue &allTets,
                    const std::set<MFace, MFaceLessThan> &allEmbeddedFaces)
 {
   std::vector<MTet4 *> new_cavity;
@@ -873,6 +875,94 @@ void adaptMeshGRegion::operator()(GRegion *gr)
   }
 }
 
+// Partition of the nodes used to apply local mesh modifications concurrently:
+// the value associated to a node is 2 * part + 1 if the node is interior to its
+// part (if all the tets touching it have all their nodes in the same part), and
+// 2 * part otherwise. All the tets read or modified by an edge swap (the tets
+// around the edge and their neighbors) or by the relocation of a node (the tets
+// around the node) then belong to the part, provided that the nodes of the edge
+// (or the relocated node) are interior.
+typedef std::unordered_map<MVertex *, int> nodePartition;
+
+static void partitionNodes(const std::vector<MTet4 *> &allTets, int nparts,
+                           nodePartition &part)
+{
+  part.clear();
+  std::vector<MVertex *> nodes;
+  for(std::size_t i = 0; i < allTets.size(); i++) {
+    if(allTets[i]->isDeleted()) continue;
+    for(int j = 0; j < 4; j++) {
+      MVertex *v = allTets[i]->tet()->getVertex(j);
+      if(part.insert(std::make_pair(v, 0)).second) nodes.push_back(v);
+    }
+  }
+  if(nparts < 2) return;
+  // contiguous chunks along a Hilbert curve
+  std::vector<SPoint3> points(nodes.size());
+  for(std::size_t i = 0; i < nodes.size(); i++) points[i] = nodes[i]->point();
+  std::vector<std::size_t> ordering;
+  SortHilbert(points, ordering);
+  for(std::size_t i = 0; i < ordering.size(); i++)
+    part[nodes[ordering[i]]] = 2 * (int)(i * nparts / ordering.size());
+}
+
+// Mark the interior nodes, and sort the tets by part: the tets with nodes in
+// several parts are stored in "others"
+static void classifyTets(const std::vector<MTet4 *> &allTets, int nparts,
+                         nodePartition &part,
+                         std::vector<std::vector<MTet4 *> > &tets,
+                         std::vector<MTet4 *> &others)
+{
+  tets.assign(nparts, std::vector<MTet4 *>());
+  others.clear();
+  for(auto it = part.begin(); it != part.end(); ++it) it->second |= 1;
+  for(std::size_t i = 0; i < allTets.size(); i++) {
+    if(allTets[i]->isDeleted()) continue;
+    MTetrahedron *t = allTets[i]->tet();
+    int p = part[t->getVertex(0)] / 2;
+    bool same = true;
+    for(int j = 1; j < 4; j++)
+      if(part[t->getVertex(j)] / 2 != p) same = false;
+    if(same) {
+      tets[p].push_back(allTets[i]);
+    }
+    else {
+      for(int j = 0; j < 4; j++) part[t->getVertex(j)] &= ~1;
+      others.push_back(allTets[i]);
+    }
+  }
+}
+
+static bool isInterior(const nodePartition &part, MVertex *v)
+{
+  auto it = part.find(v);
+  return it != part.end() && (it->second & 1);
+}
+
+// Swap the first edge of t that can be swapped, considering only the edges with
+// interior nodes if "interior" is set, and only the other ones if not. Returns
+// 1 if an edge was swapped, -1 if no edge was swapped but some were skipped
+static int swapEdgeOfTet(std::vector<MTet4 *> &newTets, MTet4 *t,
+                         bool interior, const nodePartition &part,
+                         const qmTetrahedron::Measures &qm,
+                         const std::set<MFace, MFaceLessThan> &embeddedFaces,
+                         const std::set<MEdge, MEdgeLessThan> &embeddedEdges)
+{
+  int ret = 0;
+  for(int i = 0; i < 6; i++) {
+    MEdge ed = t->tet()->getEdge(i);
+    if(embeddedEdges.find(ed) != embeddedEdges.end()) continue;
+    bool in = isInterior(part, ed.getVertex(0)) &&
+              isInterior(part, ed.getVertex(1));
+    if(in != interior) {
+      ret = -1;
+      continue;
+    }
+    if(edgeSwap(newTets, t, i, qm, embeddedFaces)) return 1;
+  }
+  return ret;
+}
+
 void optimizeMesh(GRegion *gr, const qmTetrahedron::Measures &qm)
 {
   double qMin = CTX::instance()->mesh.optimizeThreshold;
@@ -945,33 +1035,71 @@ void optimizeMesh(GRegion *gr, const qmTetrahedron::Measures &qm)
   int nbESwap = 0, nbReloc = 0;
   double worstA = 0.0;
 
+  // large meshes are split into parts along a Hilbert curve, in which edge
+  // swaps and node relocations are performed concurrently; the operations
+  // involving several parts are then performed sequentially. The number of
+  // parts does not depend on the number of threads, so that the optimized
+  // mesh does not either
+  const int numParts = 8;
+  int nthreads = CTX::instance()->numThreads;
+  if(CTX::instance()->mesh.maxNumThreads3D > 0)
+    nthreads = CTX::instance()->mesh.maxNumThreads3D;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+  // volumes are already being optimized concurrently
+  if(Msg::GetNumThreads() > 1) nthreads = 1;
+  int nparts = (allTets.size() > 10000) ? numParts : 1;
+  nodePartition part;
+  partitionNodes(allTets, nparts, part);
+  std::vector<std::vector<MTet4 *> > tets;
+  std::vector<MTet4 *> others;
+  if(nparts > 1)
+    Msg::Info("Optimizing %lu tetrahedra in %d parts",
+              (unsigned long)allTets.size(), nparts);
+
   while(1) {
     std::vector<MTet4 *> newTets;
 
+    classifyTets(allTets, nparts, part, tets, others);
+    std::vector<std::vector<MTet4 *> > newTetsPart(nparts);
+    std::vector<int> nbESwapPart(nparts, 0);
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+    for(int k = 0; k < nparts; k++) {
+      std::vector<MTet4 *> skipped;
+      for(std::size_t i = 0; i < tets[k].size(); i++) {
+        MTet4 *t = tets[k][i];
+        if(t->isDeleted() || t->getQuality() >= qMin) continue;
+        int ret = swapEdgeOfTet(newTetsPart[k], t, true, part, qm,
+                                allEmbeddedFaces, allEmbeddedEdges);
+        if(ret == 1) nbESwapPart[k]++;
+        if(ret == -1) skipped.push_back(t);
+      }
+      tets[k].swap(skipped);
+    }
+    for(int k = 0; k < nparts; k++) {
+      newTets.insert(newTets.end(), newTetsPart[k].begin(),
+                     newTetsPart[k].end());
+      nbESwap += nbESwapPart[k];
+      others.insert(others.end(), tets[k].begin(), tets[k].end());
+    }
+    for(std::size_t i = 0; i < others.size(); i++) {
+      MTet4 *t = others[i];
+      if(t->isDeleted() || t->getQuality() >= qMin) continue;
+      if(swapEdgeOfTet(newTets, t, false, part, qm, allEmbeddedFaces,
+                       allEmbeddedEdges) == 1)
+        nbESwap++;
+    }
+
     illegals.clear();
     for(int i = 0; i < nbRanges; i++) quality_ranges[i] = 0;
 
     for(auto it = allTets.begin(); it != allTets.end(); ++it) {
       if(!(*it)->isDeleted()) {
         double qq = (*it)->getQuality();
-        if(qq < qMin) {
-          for(int i = 0; i < 6; i++) {
-            MEdge ed = (*it)->tet()->getEdge(i);
-            if(allEmbeddedEdges.find(ed) == allEmbeddedEdges.end()) {
-              if(edgeSwap(newTets, *it, i, qm, allEmbeddedFaces)) {
-                nbESwap++;
-                break;
-              }
-            }
-          }
-        }
-        if(!(*it)->isDeleted()) {
-          if(qq < sliverLimit) illegals.push_back(*it);
-          for(int i = 0; i < nbRanges; i++) {
-            double low = (double)i / nbRanges;
-            double high = (double)(i + 1) / nbRanges;
-            if(qq >= low && qq < high) quality_ranges[i]++;
-          }
+        if(qq < sliverLimit) illegals.push_back(*it);
+        for(int i = 0; i < nbRanges; i++) {
+          double low = (double)i / nbRanges;
+          double high = (double)(i + 1) / nbRanges;
+          if(qq >= low && qq < high) quality_ranges[i]++;
         }
       }
     }
@@ -989,16 +1117,34 @@ void optimizeMesh(GRegion *gr, const qmTetrahedron::Measures &qm)
 
     // relocate vertices
     if(gr->hexahedra.empty() && gr->prisms.empty() && gr->pyramids.empty()) {
-      for(auto it = allTets.begin(); it != allTets.end(); ++it) {
-        if(!(*it)->isDeleted()) {
-          double qq = (*it)->getQuality();
-          if(qq < qMin) {
-            for(int i = 0; i < 4; i++) {
-              if(smoothVertex(*it, i, qm)) nbReloc++;
-            }
+      classifyTets(allTets, nparts, part, tets, others);
+      std::vector<int> nbRelocPart(nparts, 0);
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+      for(int k = 0; k < nparts; k++) {
+        for(std::size_t i = 0; i < tets[k].size(); i++) {
+          MTet4 *t = tets[k][i];
+          if(t->isDeleted() || t->getQuality() >= qMin) continue;
+          for(int j = 0; j < 4; j++) {
+            if(isInterior(part, t->tet()->getVertex(j)) &&
+               smoothVertex(t, j, qm))
+              nbRelocPart[k]++;
           }
         }
       }
+      for(int k = 0; k < nparts; k++) {
+        nbReloc += nbRelocPart[k];
+        for(std::size_t i = 0; i < tets[k].size(); i++)
+          others.push_back(tets[k][i]);
+      }
+      for(std::size_t i = 0; i < others.size(); i++) {
+        MTet4 *t = others[i];
+        if(t->isDeleted() || t->getQuality() >= qMin) continue;
+        for(int j = 0; j < 4; j++) {
+          if(!isInterior(part, t->tet()->getVertex(j)) &&
+             smoothVertex(t, j, qm))
+            nbReloc++;
+        }
+      }
     }
 
     double totalVolumeb = 0.0;
@@ -1122,22 +1268,6 @@ double tetcircumcenter(double a[3], double b[3], double c[3], double d[3],
   return xxx;
 }
 
-static void memoryCleanup(MTet4Factory &myFactory,
-                          std::set<MTet4 *, compareTet4Ptr> &allTets)
-{
-  // int n1 = allTets.size();
-  auto itd = allTets.begin();
-  while(itd != allTets.end()) {
-    if((*itd)->isDeleted()) {
-      myFactory.Free((*itd));
-      allTets.erase(itd++);
-    }
-    else
-      itd++;
-  }
-  // Msg::Info("Cleaning up memory %d -> %d", n1, allTets.size());
-}
-
 static int isCavityCompatibleWithEmbeddedEdges(std::vector<MTet4 *> &cavity,
                                                std::vector<faceXtet> &shell,
                                                edgeContainerB &allEmbeddedEdges)
@@ -1219,8 +1349,8 @@ void insertVerticesInRegion(GRegion *gr, int maxIter,
 #endif
 
   std::vector<double> vSizes, vSizesBGM;
-  MTet4Factory myFactory(1600000);
-  std::set<MTet4 *, compareTet4Ptr> &allTets = myFactory.getAllTets();
+  MTet4Factory myFactory;
+  MTet4Queue allTets(worstTetRadiusTarget);
   int NUM = 0;
 
   // leave this in a block so the map gets deallocated directly
@@ -1278,15 +1408,19 @@ void insertVerticesInRegion(GRegion *gr, int maxIter,
     }
   }
 
+  std::vector<MTet4 *> tets(gr->tetrahedra.size());
   for(std::size_t i = 0; i < gr->tetrahedra.size(); i++) {
     gr->tetrahedra[i]->setVolumePositive();
-    allTets.insert(myFactory.Create(gr->tetrahedra[i], vSizes, vSizesBGM));
+    tets[i] = myFactory.Create(gr->tetrahedra[i], vSizes, vSizesBGM);
   }
 
   gr->tetrahedra.clear();
 
+  // process the tets by decreasing radius, i.e. in the order of the queue
+  std::sort(tets.begin(), tets.end(), compareTet4Ptr());
+
   // SLOW
-  connectTets(allTets.begin(), allTets.end());
+  connectTets(tets.begin(), tets.end());
 
   // classify the tets on the right region
 
@@ -1295,7 +1429,7 @@ void insertVerticesInRegion(GRegion *gr, int maxIter,
     buildFaceSearchStructure(gr->model(), search, true); // only triangles
     if(sqr) search.insert(sqr->getTri().begin(), sqr->getTri().end());
 
-    for(auto it = allTets.begin(); it != allTets.end(); ++it) {
+    for(auto it = tets.begin(); it != tets.end(); ++it) {
       if(!(*it)->onWhat()) {
         std::list<MTet4 *> theRegion;
         std::set<GFace *> faces_bound;
@@ -1340,11 +1474,11 @@ void insertVerticesInRegion(GRegion *gr, int maxIter,
   }
   else {
     // FIXME ... too simple
-    for(auto it = allTets.begin(); it != allTets.end(); ++it)
+    for(auto it = tets.begin(); it != tets.end(); ++it)
       (*it)->setOnWhat(gr);
   }
 
-  for(auto it = allTets.begin(); it != allTets.end(); ++it) {
+  for(auto it = tets.begin(); it != tets.end(); ++it) {
     (*it)->setNeigh(0, nullptr);
     (*it)->setNeigh(1, nullptr);
     (*it)->setNeigh(2, nullptr);
@@ -1358,8 +1492,11 @@ void insertVerticesInRegion(GRegion *gr, int maxIter,
     createAllEmbeddedFaces((*it), allEmbeddedFaces);
     createAllEmbeddedEdges((*it), allEmbeddedEdges);
   }
-  connectTets(allTets.begin(), allTets.end(), &allEmbeddedFaces);
-  Msg::Debug("All %d tets were connected", allTets.size());
+  connectTets(tets.begin(), tets.end(), &allEmbeddedFaces);
+  Msg::Debug("All %d tets were connected", tets.size());
+
+  allTets.insert(tets.begin(), tets.end());
+  std::vector<MTet4 *>().swap(tets);
 
   // here the classification should be done
 
@@ -1379,11 +1516,11 @@ void insertVerticesInRegion(GRegion *gr, int maxIter,
       break;
     }
 
-    MTet4 *worst = *allTets.begin();
+    MTet4 *worst = allTets.top();
 
     if(worst->isDeleted()) {
+      allTets.pop();
       myFactory.Free(worst);
-      allTets.erase(allTets.begin());
     }
     else {
       if(ITER++ % 500 == 0)
@@ -1475,7 +1612,7 @@ void insertVerticesInRegion(GRegion *gr, int maxIter,
            !insertVertexB(shell, cavity, v, lc1, lc2, vSizes, vSizesBGM, worst,
                           myFactory, allTets, allEmbeddedFaces)) {
           COUNT_MISS_1++;
-          myFactory.changeTetRadius(allTets.begin(), 0.);
+          allTets.changeTopRadius(0.);
           for(auto itc = cavity.begin(); itc != cavity.end(); ++itc)
             (*itc)->setDeleted(false);
           delete v;
@@ -1490,7 +1627,7 @@ void insertVerticesInRegion(GRegion *gr, int maxIter,
       }
 
       else {
-        myFactory.changeTetRadius(allTets.begin(), 0.0);
+        allTets.changeTopRadius(0.0);
         COUNT_MISS_2++;
         for(auto itc = cavity.begin(); itc != cavity.end(); ++itc)
           (*itc)->setDeleted(false);
@@ -1501,11 +1638,11 @@ void insertVerticesInRegion(GRegion *gr, int maxIter,
     // allows to clean up the set of tets when lots of deleted ones are present
     // in the mesh
     if(allTets.size() > 7 * vSizes.size() && ITER > 1000) {
-      memoryCleanup(myFactory, allTets);
+      allTets.removeDeleted(myFactory);
     }
   }
 
-  memoryCleanup(myFactory, allTets);
+  allTets.removeDeleted(myFactory);
   double t2 = TimeOfDay();
   double dt = (t2 - t1);
   int COUNT_MISS = COUNT_MISS_1 + COUNT_MISS_2;
@@ -1515,11 +1652,16 @@ void insertVerticesInRegion(GRegion *gr, int maxIter,
   Msg::Info(" - %d nodes could not be inserted", COUNT_MISS);
   Msg::Info(" - %d tetrahedra created in %g sec. (%d tets/s)", allTets.size(),
             dt, (int)(allTets.size() / dt));
+  static const int counter = Profiler::counter("Delaunay insertions");
+  Profiler::count(counter, REALCOUNT);
+
+  allTets.getAll(tets);
+  allTets.clear();
 
   // relocate vertices
   int nbReloc = 0;
   for(int SM = 0; SM < CTX::instance()->mesh.nbSmoothing; SM++) {
-    for(auto it = allTets.begin(); it != allTets.end(); ++it) {
+    for(auto it = tets.begin(); it != tets.end(); ++it) {
       if(!(*it)->isDeleted()) {
         double qq = (*it)->getQuality();
         if(qq < .4)
@@ -1530,15 +1672,12 @@ void insertVerticesInRegion(GRegion *gr, int maxIter,
     }
   }
 
-  while(1) {
-    if(allTets.begin() == allTets.end()) break;
-    MTet4 *worst = *allTets.begin();
-    if(!worst->isDeleted()) {
-      worst->onWhat()->tetrahedra.push_back(worst->tet());
-      worst->tet() = nullptr;
-    }
-    myFactory.Free(worst);
-    allTets.erase(allTets.begin());
+  for(auto it = tets.begin(); it != tets.end(); ++it) {
+    if(!(*it)->isDeleted()) {
+      (*it)->onWhat()->tetrahedra.push_back((*it)->tet());
+      (*it)->tet() = nullptr;
+    }
+    myFactory.Free(*it);
   }
 
   _deleteUnusedVertices(gr);
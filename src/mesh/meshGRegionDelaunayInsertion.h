@@ -10,13 +10,15 @@
 #include <set>
 #include <map>
 #include <stack>
+#include <vector>
+#include <algorithm>
+#include <cmath>
 #include "MTetrahedron.h"
 #include "Numeric.h"
 #include "BackgroundMeshTools.h"
 #include "qualityMeasures.h"
 #include "robustPredicates.h"
 
-//#define GMSH_PRE_ALLOCATE_STRATEGY 1
 class GRegion;
 class GFace;
 class GModel;
@@ -30,11 +32,10 @@ class MTet4Factory;
 
 // Memory usage for 1 million tets:
 //
-// * sizeof(MTet4) = 36 Bytes and sizeof(MTetrahedron) = 28 Bytes
-//   -> 64 MB
-// * rb tree containing all pointers sorted with respect to tet
-//   radius: each bucket of the tree contains 4 pointers (16 Bytes)
-//   plus the data -> 20 MB
+// * sizeof(MTet4) = 64 Bytes (allocated by blocks) and sizeof(MTetrahedron)
+//   = 56 Bytes -> 120 MB
+// * priority queue of pointers sorted with respect to tet radius (8 Bytes
+//   per tet) -> 8 MB
 // * sizeof(MVertex) = 44 Bytes and there are about 200000 verts per
 //   million tet -> 9MB
 // * vector of char lengths per vertex -> 1.6Mb
@@ -227,91 +228,171 @@ struct compareTet4Ptr {
   }
 };
 
+// Allocates MTet4s by blocks, and reuses the freed ones
 class MTet4Factory {
-public:
-  typedef std::set<MTet4 *, compareTet4Ptr> container;
-  typedef container::iterator iterator;
-
 private:
-  container allTets;
-#ifdef GMSH_PRE_ALLOCATE_STRATEGY
-  MTet4 *allSlots;
-  int s_last, s_alloc;
-  std::stack<MTet4 *> emptySlots;
-  inline MTet4 *getANewSlot()
-  {
-    if(s_last >= s_alloc) return 0;
-    MTet4 *t = &(allSlots[s_last]);
-    s_last++;
-    return t;
-  }
-  inline MTet4 *getAnEmptySlot()
+  std::vector<MTet4 *> _blocks;
+  std::vector<MTet4 *> _free;
+  std::size_t _blockSize, _last; // number of slots used in the last block
+  MTet4 *_newSlot()
   {
-    if(!emptySlots.empty()) {
-      MTet4 *t = emptySlots.top();
-      emptySlots.pop();
-      return t;
+    MTet4 *t4;
+    if(!_free.empty()) {
+      t4 = _free.back();
+      _free.pop_back();
+      t4->setOnWhat(nullptr);
+      return t4;
     }
-    return getANewSlot();
-  };
-#endif
+    if(_blocks.empty() || _last == _blockSize) {
+      _blocks.push_back(new MTet4[_blockSize]);
+      _last = 0;
+    }
+    return &_blocks.back()[_last++];
+  }
+
 public:
-  MTet4Factory(int _size = 1000000)
+  MTet4Factory(std::size_t blockSize = 65536)
+    : _blockSize(blockSize), _last(0)
   {
-#ifdef GMSH_PRE_ALLOCATE_STRATEGY
-    s_last = 0;
-    s_alloc = _size;
-    allSlots = new MTet4[s_alloc];
-#endif
   }
   ~MTet4Factory()
   {
-#ifdef GMSH_PRE_ALLOCATE_STRATEGY
-    delete[] allSlots;
-#endif
+    for(std::size_t i = 0; i < _blocks.size(); i++) delete[] _blocks[i];
   }
   MTet4 *Create(MTetrahedron *t, std::vector<double> &sizes,
                 std::vector<double> &sizesBGM)
   {
-#ifdef GMSH_PRE_ALLOCATE_STRATEGY
-    MTet4 *t4 = getAnEmptySlot();
-#else
-    MTet4 *t4 = new MTet4;
-#endif
+    MTet4 *t4 = _newSlot();
     t4->setup(t, sizes, sizesBGM);
     return t4;
   }
   MTet4 *Create(MTetrahedron *t, std::vector<double> &sizes,
                 std::vector<double> &sizesBGM, double lc1, double lc2)
   {
-#ifdef GMSH_PRE_ALLOCATE_STRATEGY
-    MTet4 *t4 = getAnEmptySlot();
-#else
-    MTet4 *t4 = new MTet4;
-#endif
+    MTet4 *t4 = _newSlot();
     t4->setup(t, sizes, sizesBGM, lc1, lc2);
     return t4;
   }
-
   void Free(MTet4 *t)
   {
     if(t->tet()) delete t->tet();
     t->tet() = nullptr;
-#ifdef GMSH_PRE_ALLOCATE_STRATEGY
-    emptySlots.push(t);
     t->setDeleted(true);
-#else
-    delete t;
-#endif
+    _free.push_back(t);
+  }
+};
+
+// Priority queue of tets, in the order defined by compareTet4Ptr (largest
+// radius first). Tets are stored in buckets of radii (8 per octave above the
+// threshold), each bucket being a binary heap; tets with a radius below the
+// threshold, which are usually not refined anymore, are kept unordered until
+// they are needed. Deleted tets stay in the queue until they are popped or
+// until removeDeleted() is called.
+class MTet4Queue {
+private:
+  // comparison for std heaps, which have their largest element first
+  struct heapLess {
+    bool operator()(MTet4 const *const a, MTet4 const *const b) const
+    {
+      return compareTet4Ptr()(b, a);
+    }
+  };
+  std::vector<std::vector<MTet4 *> > _buckets;
+  double _threshold;
+  std::size_t _size, _top;
+  bool _heap0; // is bucket 0 (below the threshold) a heap?
+  std::size_t _bucket(double r) const
+  {
+    if(!(r >= _threshold)) return 0;
+    if(!(_threshold > 0.)) return 1;
+    double b = 8. * std::log2(r / _threshold);
+    return 1 + (std::size_t)std::min(b, (double)_buckets.size() - 2.);
   }
-  void changeTetRadius(iterator it, double r)
+  std::vector<MTet4 *> &_topBucket()
   {
-    MTet4 *t = *it;
-    allTets.erase(it);
+    while(_top > 0 && _buckets[_top].empty()) _top--;
+    if(!_top && !_heap0) {
+      std::make_heap(_buckets[0].begin(), _buckets[0].end(), heapLess());
+      _heap0 = true;
+    }
+    return _buckets[_top];
+  }
+
+public:
+  MTet4Queue(double threshold)
+    : _buckets(128), _threshold(threshold), _size(0), _top(0), _heap0(false)
+  {
+  }
+  std::size_t size() const { return _size; }
+  bool empty() const { return !_size; }
+  void insert(MTet4 *t)
+  {
+    std::size_t b = _bucket(t->getRadius());
+    _buckets[b].push_back(t);
+    if(b || _heap0)
+      std::push_heap(_buckets[b].begin(), _buckets[b].end(), heapLess());
+    if(b > _top) _top = b;
+    _size++;
+  }
+  template <class ITER> void insert(ITER beg, ITER end)
+  {
+    for(ITER it = beg; it != end; ++it) insert(*it);
+  }
+  // the tet with the largest radius
+  MTet4 *top() { return _topBucket().front(); }
+  void pop()
+  {
+    std::vector<MTet4 *> &b = _topBucket();
+    std::pop_heap(b.begin(), b.end(), heapLess());
+    b.pop_back();
+    _size--;
+  }
+  void changeTopRadius(double r)
+  {
+    MTet4 *t = top();
+    pop();
     t->forceRadius(r);
-    allTets.insert(t);
+    insert(t);
+  }
+  // free the deleted tets
+  void removeDeleted(MTet4Factory &factory)
+  {
+    for(std::size_t i = 0; i < _buckets.size(); i++) {
+      std::vector<MTet4 *> &b = _buckets[i];
+      std::size_t n = 0;
+      for(std::size_t j = 0; j < b.size(); j++) {
+        if(b[j]->isDeleted())
+          factory.Free(b[j]);
+        else
+          b[n++] = b[j];
+      }
+      _size -= b.size() - n;
+      b.resize(n);
+      if(i || _heap0) std::make_heap(b.begin(), b.end(), heapLess());
+    }
+  }
+  // all the tets, in the order of the queue
+  void getAll(std::vector<MTet4 *> &tets) const
+  {
+    tets.clear();
+    tets.reserve(_size);
+    for(std::size_t i = 0; i < _buckets.size(); i++)
+      tets.insert(tets.end(), _buckets[i].begin(), _buckets[i].end());
+    std::sort(tets.begin(), tets.end(), compareTet4Ptr());
+  }
+  // call f(t) for all the tets, in no particular order
+  template <class F> void forEach(F f) const
+  {
+    for(std::size_t i = 0; i < _buckets.size(); i++)
+      for(std::size_t j = 0; j < _buckets[i].size(); j++) f(_buckets[i][j]);
+  }
+  void clear()
+  {
+    for(std::size_t i = 0; i < _buckets.size(); i++)
+      std::vector<MTet4 *>().swap(_buckets[i]);
+    _size = _top = 0;
+    _heap0 = false;
   }
-  container &getAllTets() { return allTets; }
 };
 
 void optimizeMesh(GRegion *gr, const qmTetrahedron::Measures &qm);
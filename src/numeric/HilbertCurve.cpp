@@ -3,8 +3,11 @@
 // See the LICENSE.txt file in the Gmsh root directory for license information.
 // Please report all issues on https://gitlab.onelab.info/gmsh/gmsh/issues.
 
+#include <algorithm>
+#include <stdint.h>
 #include "SBoundingBox3d.h"
 #include "MVertex.h"
+#include "HilbertCurve.h"
 
 struct HilbertSort {
   // The code for generating table transgc
@@ -269,3 +272,56 @@ void SortHilbert(std::vector<MVertex *> &v)
   // HilbertSort h;
   h.Apply(v);
 }
+
+// index along the Hilbert curve of the point with integer coordinates X[3] of
+// b bits each (J. Skilling, "Programming the Hilbert curve", 2004)
+static uint64_t HilbertIndex(unsigned int X[3], int b)
+{
+  const int n = 3;
+  unsigned int M = 1u << (b - 1), P, Q, t;
+  // inverse undo
+  for(Q = M; Q > 1; Q >>= 1) {
+    P = Q - 1;
+    for(int i = 0; i < n; i++) {
+      if(X[i] & Q)
+        X[0] ^= P;
+      else {
+        t = (X[0] ^ X[i]) & P;
+        X[0] ^= t;
+        X[i] ^= t;
+      }
+    }
+  }
+  // Gray encode
+  for(int i = 1; i < n; i++) X[i] ^= X[i - 1];
+  t = 0;
+  for(Q = M; Q > 1; Q >>= 1)
+    if(X[n - 1] & Q) t ^= Q - 1;
+  for(int i = 0; i < n; i++) X[i] ^= t;
+  // interleave the bits of the transposed index
+  uint64_t index = 0;
+  for(int j = b - 1; j >= 0; j--)
+    for(int i = 0; i < n; i++) index = (index << 1) | ((X[i] >> j) & 1);
+  return index;
+}
+
+void SortHilbert(const std::vector<SPoint3> &points,
+                 std::vector<std::size_t> &ordering)
+{
+  const int b = 21; // 63-bit indices
+  SBoundingBox3d bbox;
+  for(std::size_t i = 0; i < points.size(); i++) bbox += points[i];
+  std::vector<std::pair<uint64_t, std::size_t> > index(points.size());
+  for(std::size_t i = 0; i < points.size(); i++) {
+    unsigned int X[3];
+    for(int d = 0; d < 3; d++) {
+      double size = bbox.max()[d] - bbox.min()[d];
+      double u = size > 0. ? (points[i][d] - bbox.min()[d]) / size : 0.;
+      X[d] = (unsigned int)(u * ((1u << b) - 1));
+    }
+    index[i] = std::make_pair(HilbertIndex(X, b), i);
+  }
+  std::sort(index.begin(), index.end());
+  ordering.resize(points.size());
+  for(std::size_t i = 0; i < index.size(); i++) ordering[i] = index[i].second;
+}
@@ -6,6 +6,18 @@
 #ifndef HILBERT_CURVE
 #define HILBERT_CURVE
 
+#include <vector>
+#include "SPoint3.h"
+
+class MVertex;
+
+// sort the vertices in a multiscale Hilbert order (biased randomized insertion
+// order), suited for Delaunay insertion
 void SortHilbert(std::vector<MVertex *> &);
 
+// compute the ordering of the points along a Hilbert curve, for a numbering
+// with good spatial locality
+void SortHilbert(const std::vector<SPoint3> &points,
+                 std::vector<std::size_t> &ordering);
+
 #endif
@@ -14,6 +14,7 @@
 #include "shapeFunctions.h"
 #include "GModel.h"
 #include "MElement.h"
+#include "MElementOctree.h"
 #include "Context.h"
 #include "SBoundingBox3d.h"
 
@@ -261,6 +262,8 @@ OctreePost::~OctreePost()
   Octree_Delete(_sy);
   Octree_Delete(_vy);
   Octree_Delete(_ty);
+  for(std::size_t i = 0; i < _elementIndices.size(); i++)
+    delete _elementIndices[i];
 }
 
 OctreePost::OctreePost(PView *v)
@@ -476,6 +479,83 @@ static MElement *getElement(double P[3], GModel *m, int qn, double *qx,
   return nullptr;
 }
 
+void OctreePost::buildElementIndex()
+{
+  if(!_theViewDataGModel || _elementIndices.size()) return;
+  for(int step = 0; step < _theViewDataGModel->getNumTimeSteps(); step++) {
+    GModel *m = _theViewDataGModel->getModel(step);
+    ElementIndex *index = nullptr;
+    for(std::size_t i = 0; i < _elementIndices.size(); i++)
+      if(_elementIndices[i]->model == m) index = _elementIndices[i];
+    if(!index && m) {
+      index = new ElementIndex;
+      index->model = m;
+      std::vector<GEntity *> entities;
+      m->getEntities(entities);
+      for(std::size_t i = 0; i < entities.size(); i++) {
+        // as in MElementOctree, skip points not connected to any curve
+        GVertex *gv = dynamic_cast<GVertex *>(entities[i]);
+        if(gv && gv->edges().empty()) continue;
+        for(std::size_t j = 0; j < entities[i]->getNumMeshElements(); j++)
+          index->elements.push_back(entities[i]->getMeshElement(j));
+      }
+      std::vector<SBoundingBox3d> boxes(index->elements.size());
+      for(std::size_t i = 0; i < index->elements.size(); i++) {
+        double min[3], max[3];
+        MElementBB(index->elements[i], min, max);
+        boxes[i] = SBoundingBox3d(min[0], min[1], min[2], max[0], max[1],
+                                  max[2]);
+      }
+      index->bvh.build(boxes);
+      _elementIndices.push_back(index);
+    }
+    _stepIndex.push_back(index);
+  }
+}
+
+MElement *OctreePost::_getElement(double P[3], int step, int qn, double *qx,
+                                  double *qy, double *qz, int dim) const
+{
+  std::size_t s = (step < 0) ? 0 : step;
+  if(_elementIndices.empty()) {
+    GModel *m = _theViewDataGModel->getModel(s);
+    return m ? getElement(P, m, qn, qx, qy, qz, dim) : nullptr;
+  }
+  if(s >= _stepIndex.size() || !_stepIndex[s]) return nullptr;
+  const ElementIndex *index = _stepIndex[s];
+  std::vector<MElement *> elements;
+  MElement *found = nullptr;
+  bool all = (qn && qx && qy && qz);
+  index->bvh.containing(P, [&](std::size_t i) -> bool {
+    MElement *e = index->elements[i];
+    if((dim >= 0 && e->getDim() != dim) || !MElementInEle(e, P)) return false;
+    if(!all) {
+      found = e;
+      return true;
+    }
+    elements.push_back(e);
+    return false;
+  });
+  if(!all) return found;
+  // try to use the value from the same geometrical element as the one provided
+  // in qx/y/z
+  double eps = CTX::instance()->geom.tolerance;
+  for(std::size_t i = 0; i < elements.size(); i++) {
+    if(qn == static_cast<int>(elements[i]->getNumVertices())) {
+      bool ok = true;
+      for(int j = 0; j < qn; j++) {
+        MVertex *v = elements[i]->getVertex(j);
+        ok &=
+          (std::abs(v->x() - qx[j]) < eps && std::abs(v->y() - qy[j]) < eps &&
+           std::abs(v->z() - qz[j]) < eps);
+      }
+      if(ok) return elements[i];
+    }
+  }
+  if(elements.size()) return elements[0];
+  return nullptr;
+}
+
 bool OctreePost::_getValue(void *in, int dim, int nbNod, int nbComp,
                            double P[3], int step, double *values,
                            double *elementSize, bool grad)
@@ -621,11 +701,8 @@ bool OctreePost::searchScalar(double x, double y, double z, double *values,
       return true;
   }
   else if(_theViewDataGModel) {
-    GModel *m = _theViewDataGModel->getModel((step < 0) ? 0 : step);
-    if(m) {
-      MElement *e = getElement(P, m, qn, qx, qy, qz, dim);
-      if(_getValue(e, 1, P, step, values, size, grad)) { return true; }
-    }
+    MElement *e = _getElement(P, step, qn, qx, qy, qz, dim);
+    if(_getValue(e, 1, P, step, values, size, grad)) { return true; }
   }
 
   return false;
@@ -677,11 +754,8 @@ bool OctreePost::searchVector(double x, double y, double z, double *values,
       return true;
   }
   else if(_theViewDataGModel) {
-    GModel *m = _theViewDataGModel->getModel((step < 0) ? 0 : step);
-    if(m) {
-      MElement *e = getElement(P, m, qn, qx, qy, qz, dim);
-      if(_getValue(e, 3, P, step, values, size, grad)) { return true; }
-    }
+    MElement *e = _getElement(P, step, qn, qx, qy, qz, dim);
+    if(_getValue(e, 3, P, step, values, size, grad)) { return true; }
   }
 
   return false;
@@ -733,11 +807,8 @@ bool OctreePost::searchTensor(double x, double y, double z, double *values,
       return true;
   }
   else if(_theViewDataGModel) {
-    GModel *m = _theViewDataGModel->getModel((step < 0) ? 0 : step);
-    if(m) {
-      MElement *e = getElement(P, m, qn, qx, qy, qz, dim);
-      if(_getValue(e, 9, P, step, values, size, grad)) { return true; }
-    }
+    MElement *e = _getElement(P, step, qn, qx, qy, qz, dim);
+    if(_getValue(e, 9, P, step, values, size, grad)) { return true; }
   }
 
   return false;
@@ -6,12 +6,16 @@
 #ifndef OCTREE_POST_H
 #define OCTREE_POST_H
 
+#include <vector>
 #include "Octree.h"
+#include "SBoundingBox3dBVH.h"
 
 class PView;
 class PViewData;
 class PViewDataList;
 class PViewDataGModel;
+class GModel;
+class MElement;
 
 class OctreePost {
 private:
@@ -25,7 +29,17 @@ private:
   Octree *_sy, *_vy, *_ty;
   PViewDataList *_theViewDataList;
   PViewDataGModel *_theViewDataGModel;
+  // model-based views: bounding volume hierarchy of the mesh elements of the
+  // model of each time step (steps on the same model share it)
+  struct ElementIndex {
+    GModel *model;
+    std::vector<MElement *> elements;
+    SBoundingBox3dBVH bvh;
+  };
+  std::vector<ElementIndex *> _elementIndices, _stepIndex;
   void _create(PViewData *data);
+  MElement *_getElement(double P[3], int step, int qn, double *qx, double *qy,
+                        double *qz, int dim) const;
   bool _getValue(void *in, int dim, int nbNod, int nbComp, double P[3],
                  int step, double *values, double *elementSize, bool grad);
   bool _getValue(void *in, int nbComp, double P[3], int step, double *values,
@@ -35,6 +49,11 @@ public:
   OctreePost(PView *v);
   OctreePost(PViewData *data);
   ~OctreePost();
+  // model-based views: index the mesh elements of each time step in bounding
+  // volume hierarchies, which are only read by the searches (that can thus be
+  // performed concurrently without locking); otherwise the searches use the
+  // element octree of the model. The mesh must not be modified afterwards
+  void buildElementIndex();
   // search for the value of the View at point x, y, z. Values are interpolated
   // using standard first order shape functions in the post element. If several
   // time steps are present, they are all interpolated unless time step is set
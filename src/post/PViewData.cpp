@@ -7,6 +7,7 @@
 #include "adaptiveData.h"
 #include "Numeric.h"
 #include "GmshMessage.h"
+#include "Context.h"
 #include "OctreePost.h"
 #include "fullMatrix.h"
 
@@ -245,6 +246,73 @@ bool PViewData::combineSpace(nameData &nd)
   return false;
 }
 
+// The search structures are built once, in a critical section, and only
+// published when complete: queries then proceed concurrently without locking
+
+OctreePost *PViewData::_getOctree()
+{
+  OctreePost *octree;
+#pragma omp atomic read
+  octree = _octree;
+  if(octree) return octree;
+#pragma omp critical(PViewDataSearch)
+  {
+    if(!_octree) {
+      Msg::Debug("Rebuilding octree for view data '%s'", _name.c_str());
+      OctreePost *o = new OctreePost(this);
+      // for model-based views, index the elements of each step instead of
+      // sharing the element octree of the model
+      o->buildElementIndex();
+#pragma omp flush
+#pragma omp atomic write
+      _octree = o;
+    }
+    octree = _octree;
+  }
+  return octree;
+}
+
+SPoint3KDTree *PViewData::_getKDTree(int step)
+{
+  SPoint3KDTree *kdtree;
+#pragma omp atomic read
+  kdtree = _kdtree;
+  if(kdtree) return kdtree;
+#pragma omp critical(PViewDataSearch)
+  {
+    if(!_kdtree) {
+      Msg::Debug("Rebuilding kdtree for view data '%s'", _name.c_str());
+      _pc.pts.clear();
+      // FIXME: should directly iterate on mesh nodes for model-based views
+      if(step < 0) step = getFirstNonEmptyTimeStep();
+      for(int ent = 0; ent < getNumEntities(step); ent++) {
+        for(int ele = 0; ele < getNumElements(step, ent); ele++) {
+          int numNodes = getNumNodes(step, ent, ele);
+          for(int nod = 0; nod < numNodes; nod++) {
+            double xx, yy, zz;
+            getNode(step, ent, ele, nod, xx, yy, zz);
+            _pc.pts.push_back(SPoint3(xx, yy, zz));
+          }
+        }
+      }
+      SPoint3KDTree *t = new SPoint3KDTree(
+        3, _pc2kdtree, nanoflann::KDTreeSingleIndexAdaptorParams(10));
+      t->buildIndex();
+#pragma omp flush
+#pragma omp atomic write
+      _kdtree = t;
+    }
+    kdtree = _kdtree;
+  }
+  return kdtree;
+}
+
+void PViewData::buildSearchIndex(int step, bool closest)
+{
+  _getOctree();
+  if(closest) _getKDTree(step);
+}
+
 double PViewData::findClosestNode(double &xn, double &yn, double &zn, int step)
 {
   double x = xn, y = yn, z = zn;
@@ -279,33 +347,13 @@ double PViewData::findClosestNode(double &xn, double &yn, double &zn, int step)
 
 #else
 
-#pragma omp critical
-  if(!_kdtree) {
-    Msg::Debug("Rebuilding kdtree for view data '%s'", _name.c_str());
-    _pc.pts.clear();
-    // FIXME: should directly iterate on mesh nodes for model-based views
-    if(step < 0) step = getFirstNonEmptyTimeStep();
-    for(int ent = 0; ent < getNumEntities(step); ent++) {
-      for(int ele = 0; ele < getNumElements(step, ent); ele++) {
-        int numNodes = getNumNodes(step, ent, ele);
-        for(int nod = 0; nod < numNodes; nod++) {
-          double xx, yy, zz;
-          getNode(step, ent, ele, nod, xx, yy, zz);
-          _pc.pts.push_back(SPoint3(xx, yy, zz));
-        }
-      }
-    }
-    _kdtree = new SPoint3KDTree(3, _pc2kdtree,
-                                nanoflann::KDTreeSingleIndexAdaptorParams(10));
-    _kdtree->buildIndex();
-  }
-
+  SPoint3KDTree *kdtree = _getKDTree(step);
   double query_pt[3] = {x, y, z};
   std::size_t idx;
   double squ_dist = 0.;
   nanoflann::KNNResultSet<double> resultSet(1);
   resultSet.init(&idx, &squ_dist);
-  _kdtree->findNeighbors(resultSet, &query_pt[0], nanoflann::SearchParams(10));
+  kdtree->findNeighbors(resultSet, &query_pt[0], nanoflann::SearchParams(10));
   if(idx < _pc.pts.size()) {
     xn = _pc.pts[idx].x();
     yn = _pc.pts[idx].y();
@@ -323,16 +371,8 @@ bool PViewData::searchScalar(double x, double y, double z, double *values,
                              int step, double *size, int qn, double *qx,
                              double *qy, double *qz, bool grad, int dim)
 {
-  if(!_octree) {
-#pragma omp barrier
-#pragma omp single
-    {
-      Msg::Debug("Rebuilding octree for view data '%s'", _name.c_str());
-      _octree = new OctreePost(this);
-    }
-  }
-  return _octree->searchScalar(x, y, z, values, step, size, qn, qx, qy, qz,
-                               grad, dim);
+  return _getOctree()->searchScalar(x, y, z, values, step, size, qn, qx, qy,
+                                    qz, grad, dim);
 }
 
 bool PViewData::searchScalarClosest(double x, double y, double z,
@@ -363,16 +403,8 @@ bool PViewData::searchVector(double x, double y, double z, double *values,
                              int step, double *size, int qn, double *qx,
                              double *qy, double *qz, bool grad, int dim)
 {
-  if(!_octree) {
-#pragma omp barrier
-#pragma omp single
-    {
-      Msg::Debug("Rebuilding octree for view data '%s'", _name.c_str());
-      _octree = new OctreePost(this);
-    }
-  }
-  return _octree->searchVector(x, y, z, values, step, size, qn, qx, qy, qz,
-                               grad, dim);
+  return _getOctree()->searchVector(x, y, z, values, step, size, qn, qx, qy,
+                                    qz, grad, dim);
 }
 
 bool PViewData::searchVectorClosest(double x, double y, double z,
@@ -403,16 +435,8 @@ bool PViewData::searchTensor(double x, double y, double z, double *values,
                              int step, double *size, int qn, double *qx,
                              double *qy, double *qz, bool grad, int dim)
 {
-  if(!_octree) {
-#pragma omp barrier
-#pragma omp single
-    {
-      Msg::Debug("Rebuilding octree for view data '%s'", _name.c_str());
-      _octree = new OctreePost(this);
-    }
-  }
-  return _octree->searchTensor(x, y, z, values, step, size, qn, qx, qy, qz,
-                               grad, dim);
+  return _getOctree()->searchTensor(x, y, z, values, step, size, qn, qx, qy,
+                                    qz, grad, dim);
 }
 
 bool PViewData::searchTensorClosest(double x, double y, double z,
@@ -438,3 +462,56 @@ bool PViewData::searchTensorClosest(double x, double y, double z,
   }
   return ret;
 }
+
+std::size_t PViewData::searchClosest(int numComp, std::size_t n,
+                                     const double *xyz, double *values,
+                                     double *distances, double distance,
+                                     int step, bool grad, int dim)
+{
+  int numSteps = (step < 0) ? getNumTimeSteps() : 1;
+  int numVal = numComp * (grad ? 3 : 1) * numSteps;
+  if(numComp != 1 && numComp != 3 && numComp != 9) {
+    Msg::Error("Invalid number of components (%d) for search", numComp);
+    return 0;
+  }
+
+  // build the search structures beforehand, so that the parallel queries
+  // below never wait on each other
+  buildSearchIndex(step, distance != 0.);
+
+  // probe in parallel only if the data can be read concurrently, with the
+  // probed steps kept in memory
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+  if(!isThreadSafe()) nthreads = 1;
+  int firstStep = (step < 0) ? 0 : step;
+  for(int s = firstStep; s < firstStep + numSteps; s++) pinTimeStep(s);
+
+  std::size_t found = 0;
+#pragma omp parallel for schedule(dynamic, 256) num_threads(nthreads) \
+  reduction(+ : found)
+  for(std::size_t i = 0; i < n; i++) {
+    const double *p = &xyz[3 * i];
+    double *val = &values[numVal * i];
+    double d = distance;
+    bool ok = false;
+    if(numComp == 1)
+      ok = searchScalarClosest(p[0], p[1], p[2], d, val, step, nullptr, 0,
+                               nullptr, nullptr, nullptr, grad, dim);
+    else if(numComp == 3)
+      ok = searchVectorClosest(p[0], p[1], p[2], d, val, step, nullptr, 0,
+                               nullptr, nullptr, nullptr, grad, dim);
+    else
+      ok = searchTensorClosest(p[0], p[1], p[2], d, val, step, nullptr, 0,
+                               nullptr, nullptr, nullptr, grad, dim);
+    if(ok) { found++; }
+    else {
+      for(int j = 0; j < numVal; j++) val[j] = 0.;
+      d = -1.;
+    }
+    distances[i] = d;
+  }
+
+  for(int s = firstStep; s < firstStep + numSteps; s++) unpinTimeStep(s);
+  return found;
+}
@@ -43,6 +43,9 @@ private:
   SPoint3Cloud _pc;
   SPoint3CloudAdaptor<SPoint3Cloud> _pc2kdtree;
   SPoint3KDTree *_kdtree;
+  // get the search structures, building them on first use (thread-safe)
+  OctreePost *_getOctree();
+  SPoint3KDTree *_getKDTree(int step);
 
 protected:
   // adaptive visualization data
@@ -284,6 +287,16 @@ public:
   // is the view a list-based dataset
   virtual bool isListBased() { return false; }
 
+  // can the data be accessed (getNode, getValue, ...) concurrently by several
+  // threads, as long as it is not modified and the time steps that are
+  // accessed are pinned?
+  virtual bool isThreadSafe() { return false; }
+
+  // make sure that the data of a time step is in memory and stays there until
+  // unpinTimeStep() is called (for data read on demand)
+  virtual void pinTimeStep(int step) {}
+  virtual void unpinTimeStep(int step) {}
+
   // get (approx) memry used by data in Mb
   virtual double getMemoryInMb() { return 0; }
 
@@ -296,8 +309,12 @@ public:
   // get MElement (if view supports it)
   virtual MElement *getElement(int step, int entity, int element);
 
-  // find coordinates of closest node to point (xn, yn, zn); currently performs
-  // a simple linear search - we might want to use a kdtree instead
+  // build the search structures used by the search*() functions and by
+  // findClosestNode(); they are otherwise built on first use. Once built they
+  // are never modified, so that queries can be performed concurrently
+  void buildSearchIndex(int step = -1, bool closest = false);
+
+  // find coordinates of closest node to point (xn, yn, zn), using a kdtree
   double findClosestNode(double &xn, double &yn, double &zn, int step);
 
   // search for the value of the View at point x, y, z. Values are interpolated
@@ -338,6 +355,16 @@ public:
                            double *qy = nullptr, double *qz = nullptr,
                            bool grad = false, int dim = -1);
 
+  // batched version of the search*Closest() functions for the n points with
+  // coordinates xyz (x1, y1, z1, x2, ...), performed in parallel: values
+  // contains numComp * (grad ? 3 : 1) * numSteps values per point (zero if the
+  // point is not found) and distances the distance of each match (or -1);
+  // return the number of points found
+  std::size_t searchClosest(int numComp, std::size_t n, const double *xyz,
+                            double *values, double *distances,
+                            double distance = 0., int step = -1,
+                            bool grad = false, int dim = -1);
+
   // I/O routines
   virtual bool writeSTL(const std::string &fileName);
   virtual bool writeTXT(const std::string &fileName);
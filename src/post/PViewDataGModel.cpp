@@ -254,11 +254,7 @@ bool PViewDataGModel::finalize(bool computeMinMax,
 
 MElement *PViewDataGModel::_getElement(int step, int ent, int ele)
 {
-  static int lastStep = -1, lastEnt = -1, lastEle = -1;
-  static MElement *curr = nullptr;
-  if(step != lastStep || ent != lastEnt || ele != lastEle)
-    curr = _steps[step]->getEntity(ent)->getMeshElement(ele);
-  return curr;
+  return _steps[step]->getEntity(ent)->getMeshElement(ele);
 }
 
 std::string PViewDataGModel::getFileName(int step)
@@ -272,7 +268,7 @@ int PViewDataGModel::getNumTimeSteps() { return _steps.size(); }
 int PViewDataGModel::getFirstNonEmptyTimeStep(int start)
 {
   for(std::size_t i = start; i < _steps.size(); i++)
-    if(_steps[i]->getNumData()) return i;
+    if(_steps[i]->hasData()) return i;
   return start;
 }
 
@@ -667,6 +663,7 @@ void PViewDataGModel::getValue(int step, int ent, int ele, int nod, int comp,
 void PViewDataGModel::setValue(int step, int ent, int ele, int nod, int comp,
                                double val)
 {
+  _steps[step]->keepInMemory(); // modified values must not be evicted
   MElement *e = _getElement(step, ent, ele);
   switch(_type) {
   case NodeData: {
@@ -814,7 +811,7 @@ bool PViewDataGModel::skipElement(int step, int ent, int ele,
 {
   if(step >= getNumTimeSteps()) return true;
   stepData<double> *sd = _steps[step];
-  if(!_steps[step]->getNumData()) return true;
+  if(!_steps[step]->hasData()) return true;
   MElement *e = _getElement(step, ent, ele);
   if(checkVisibility && !e->getVisibility()) return true;
   if(_type == NodeData) {
@@ -829,7 +826,7 @@ bool PViewDataGModel::skipElement(int step, int ent, int ele,
 
 bool PViewDataGModel::hasTimeStep(int step)
 {
-  if(step >= 0 && step < getNumTimeSteps() && _steps[step]->getNumData())
+  if(step >= 0 && step < getNumTimeSteps() && _steps[step]->hasData())
     return true;
   return false;
 }
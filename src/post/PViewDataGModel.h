@@ -6,6 +6,8 @@
 #ifndef PVIEW_DATA_GMODEL_H
 #define PVIEW_DATA_GMODEL_H
 
+#include <list>
+#include <atomic>
 #include "PViewData.h"
 #include "GModel.h"
 #include "SBoundingBox3d.h"
@@ -35,8 +37,27 @@ private:
   // MElement)
   //
   // FIXME: we should change this design and store a vector<int> of tags, and do
-  // indirect addressing, even if it's a bit slower...
+  // indirect addressing, even if it's a bit slower... (only the storage of the
+  // values has been made contiguous, see _blocks: this index is still dense)
   std::vector<Real *> *_data;
+  // the storage of the values pointed to by _data: large contiguous blocks,
+  // filled sequentially (a single block if the total number of values is
+  // reserved in advance), so that the pointers stay valid when values are
+  // added
+  std::vector<Real *> _blocks;
+  std::size_t _blockUsed, _blockSize;
+  Real *_allocate(std::size_t n)
+  {
+    if(_blocks.empty() || _blockUsed + n > _blockSize) {
+      _blockSize = std::max(n, (std::size_t)65536);
+      _blocks.push_back(new Real[_blockSize]);
+      _blockUsed = 0;
+    }
+    Real *d = _blocks.back() + _blockUsed;
+    _blockUsed += n;
+    for(std::size_t i = 0; i < n; i++) d[i] = 0.;
+    return d;
+  }
   // a vector containing the multiplying factor allowing to compute
   // the number of values stored in _data for each index (number of
   // values = getMult() * getNumComponents()). If _mult is empty, a
@@ -47,16 +68,67 @@ private:
   std::vector<std::vector<double> > _gaussPoints;
   // a set of all "partitions" encountered in the data
   std::set<int> _partitions;
+  // if the values are read on demand (see PostProcessing.StepMemoryBudget),
+  // the location of the blocks of values in the file(s), the step is then
+  // loaded when its values are first accessed, and can be evicted when the
+  // memory budget is exceeded (unless it is pinned, or if values are read by
+  // several threads)
+  struct fileBlock {
+    std::string fileName;
+    long offset;
+    int numEnt;
+    // total number of values in the block
+    std::size_t numValues;
+    bool binary, swap, mult;
+  };
+  std::vector<fileBlock> _fileBlocks;
+  std::size_t _lastUse;
+  // set (with release semantics) once the values read on demand are complete
+  std::atomic<bool> _loaded;
+  std::atomic<int> _pinned;
+  // the steps read on demand, and a counter incremented at each load
+  static std::list<stepData<Real> *> &_onDemandSteps();
+  static std::atomic<std::size_t> &_loadCounter();
+  // read the values (with the stepDataOnDemand lock held)
+  void _load();
+  void _unload()
+  {
+    _loaded.store(false, std::memory_order_relaxed);
+    if(_data) {
+      delete _data;
+      _data = 0;
+    }
+    for(std::size_t i = 0; i < _blocks.size(); i++) delete[] _blocks[i];
+    _blocks.clear();
+    _blockUsed = _blockSize = 0;
+    _mult.clear();
+  }
+  void _loadIfNeeded()
+  {
+    if(_fileBlocks.empty()) return;
+    if(!_loaded.load(std::memory_order_acquire)) {
+#pragma omp critical(stepDataOnDemand)
+      if(!_loaded.load(std::memory_order_relaxed)) _load();
+    }
+    else {
+      std::size_t counter = _loadCounter().load(std::memory_order_relaxed);
+#pragma omp atomic write
+      _lastUse = counter;
+    }
+  }
 
 public:
   stepData(GModel *model, int numComp, const std::string &fileName = "",
            int fileIndex = -1, double time = 0., double min = VAL_INF,
            double max = -VAL_INF)
     : _model(model), _fileName(fileName), _fileIndex(fileIndex), _time(time),
-      _min(min), _max(max), _numComp(numComp), _data(0)
+      _min(min), _max(max), _numComp(numComp), _data(0), _blockUsed(0),
+      _blockSize(0), _lastUse(0), _loaded(false), _pinned(0)
   {
   }
-  stepData(stepData<Real> &other) : _data(0)
+  stepData(stepData<Real> &other)
+    : _data(0), _blockUsed(0), _blockSize(0), _lastUse(0), _loaded(false),
+      _pinned(0)
   {
     _model = other._model;
     _entities = other._entities;
@@ -68,13 +140,16 @@ public:
     _max = other._max;
     _numComp = other._numComp;
     if(other._data) {
-      std::size_t n = other.getNumData();
+      std::size_t n = other.getNumData(), total = 0;
       _data = new std::vector<Real *>(n, (Real *)0);
+      for(std::size_t i = 0; i < n; i++)
+        if(other.getData(i)) total += other.getMult(i) * _numComp;
+      reserveValues(total);
       for(std::size_t i = 0; i < n; i++) {
         Real *d = other.getData(i);
         if(d) {
           int m = other.getMult(i) * _numComp;
-          (*_data)[i] = new Real[m];
+          (*_data)[i] = _allocate(m);
           for(int j = 0; j < m; j++) (*_data)[i][j] = d[j];
         }
       }
@@ -84,6 +159,24 @@ public:
     _partitions = other._partitions;
   }
   ~stepData() { destroyData(); }
+  // register a block of values stored in a file, to be read on demand, with
+  // the range of its values
+  void addFileBlock(const std::string &fileName, long offset, int numEnt,
+                    std::size_t numValues, bool binary, bool swap, bool mult,
+                    double min, double max);
+  // read the values if they are read on demand, and never evict them (e.g.
+  // before modifying them)
+  void keepInMemory();
+  // read the values if they are read on demand, and do not evict them until
+  // unpin() is called (e.g. while they are accessed by several threads)
+  void pin();
+  void unpin()
+  {
+    if(!_fileBlocks.empty()) _pinned--;
+  }
+  // does the step contain data (without reading it if read on demand)?
+  bool hasData() { return (_data && _data->size()) || !_fileBlocks.empty(); }
+  bool isOnDemand() { return !_fileBlocks.empty(); }
   void fillEntities() { _model->getEntities(_entities); }
   void computeBoundingBox() { _bbox = _model->bounds(); }
   GModel *getModel() { return _model; }
@@ -93,6 +186,7 @@ public:
   int getNumComponents() { return _numComp; }
   int getMult(int index)
   {
+    _loadIfNeeded();
     if(index < 0 || index >= (int)_mult.size()) return 1;
     return _mult[index];
   }
@@ -108,6 +202,7 @@ public:
   void setMax(double max) { _max = max; }
   std::size_t getNumData()
   {
+    _loadIfNeeded();
     if(!_data) return 0;
     return _data->size();
   }
@@ -116,15 +211,26 @@ public:
     if(!_data) _data = new std::vector<Real *>(n, (Real *)0);
     if(n > (int)_data->size()) _data->resize(n, (Real *)0);
   }
+  // make sure that the next n values will be stored contiguously
+  void reserveValues(std::size_t n)
+  {
+    if(n && (_blocks.empty() || _blockUsed + n > _blockSize)) {
+      _blockSize = n;
+      _blocks.push_back(new Real[_blockSize]);
+      _blockUsed = 0;
+    }
+  }
+  // get the values for the given index; for a step read on demand, the pointer
+  // stays valid until two other steps have been read, unless the step is
+  // pinned (see pin())
   Real *getData(int index, bool allocIfNeeded = false, int mult = 1)
   {
     if(index < 0) return 0;
+    _loadIfNeeded();
     if(allocIfNeeded) {
+      if(!_fileBlocks.empty()) keepInMemory();
       if(index >= (int)getNumData()) resizeData(index + 100); // optimize this
-      if(!(*_data)[index]) {
-        (*_data)[index] = new Real[_numComp * mult];
-        for(int i = 0; i < _numComp * mult; i++) (*_data)[index][i] = 0.;
-      }
+      if(!(*_data)[index]) (*_data)[index] = _allocate(_numComp * mult);
       if(mult > 1) {
         if(index >= (int)_mult.size())
           _mult.resize(index + 100, 1); // optimize this
@@ -136,17 +242,10 @@ public:
     }
     return (*_data)[index];
   }
-  void destroyData()
-  {
-    if(_data) {
-      for(unsigned int i = 0; i < _data->size(); i++)
-        if((*_data)[i]) delete[](*_data)[i];
-      delete _data;
-      _data = 0;
-    }
-  }
+  void destroyData();
   void renumberData(const std::map<int, int> &mapping)
   {
+    keepInMemory();
     if(!_data) return;
     int imax = 0, imin = 0;
     for(auto m : mapping) {
@@ -181,8 +280,11 @@ public:
   std::set<int> &getPartitions() { return _partitions; }
   double getMemoryInMb()
   {
+    // only count the values in memory (do not read them if read on demand)
+    if(!_data) return 0.;
     double b = 0.;
-    for(std::size_t i = 0; i < getNumData(); i++) b += getMult(i);
+    for(std::size_t i = 0; i < _data->size(); i++)
+      b += (i < _mult.size()) ? _mult[i] : 1;
     return b * getNumComponents() * sizeof(Real) / 1024. / 1024.;
   }
 };
@@ -268,6 +370,15 @@ public:
   bool hasMultipleMeshes();
   bool hasModel(GModel *model, int step = -1);
   bool isNodeData() { return _type == NodeData; }
+  bool isThreadSafe() { return true; }
+  void pinTimeStep(int step)
+  {
+    if(step >= 0 && step < (int)_steps.size()) _steps[step]->pin();
+  }
+  void unpinTimeStep(int step)
+  {
+    if(step >= 0 && step < (int)_steps.size()) _steps[step]->unpin();
+  }
   bool useGaussPoints() { return _type == GaussPointData; }
   GModel *getModel(int step) { return _steps[step]->getModel(); }
   GEntity *getEntity(int step, int ent);
@@ -16,6 +16,168 @@
 #include "CGNSCommon.h"
 #include "CGNSConventions.h"
 
+template <class Real>
+std::list<stepData<Real> *> &stepData<Real>::_onDemandSteps()
+{
+  static std::list<stepData<Real> *> steps;
+  return steps;
+}
+
+template <class Real>
+std::atomic<std::size_t> &stepData<Real>::_loadCounter()
+{
+  static std::atomic<std::size_t> counter(0);
+  return counter;
+}
+
+template <class Real>
+void stepData<Real>::addFileBlock(const std::string &fileName, long offset,
+                                  int numEnt, std::size_t numValues,
+                                  bool binary, bool swap, bool mult,
+                                  double min, double max)
+{
+  fileBlock b = {fileName, offset, numEnt, numValues, binary, swap, mult};
+#pragma omp critical(stepDataOnDemand)
+  {
+    if(_fileBlocks.empty()) _onDemandSteps().push_back(this);
+    _fileBlocks.push_back(b);
+    // all the blocks (e.g. partitions) of the step are read at once
+    _unload();
+    _min = std::min(_min, min);
+    _max = std::max(_max, max);
+  }
+}
+
+template <class Real> void stepData<Real>::pin()
+{
+  if(_fileBlocks.empty()) return;
+#pragma omp critical(stepDataOnDemand)
+  {
+    _pinned++;
+    if(!_loaded.load(std::memory_order_relaxed)) _load();
+  }
+}
+
+template <class Real> void stepData<Real>::keepInMemory()
+{
+  if(_fileBlocks.empty()) return;
+#pragma omp critical(stepDataOnDemand)
+  {
+    if(!_loaded.load(std::memory_order_relaxed)) _load();
+    _onDemandSteps().remove(this);
+    _fileBlocks.clear();
+  }
+}
+
+template <class Real> void stepData<Real>::destroyData()
+{
+  if(!_fileBlocks.empty()) {
+#pragma omp critical(stepDataOnDemand)
+    {
+      _onDemandSteps().remove(this);
+      _fileBlocks.clear();
+    }
+  }
+  _unload();
+}
+
+template <class Real> void stepData<Real>::_load()
+{
+  double t1 = Cpu(), w1 = TimeOfDay();
+  int numEnt = 0;
+  std::size_t numValues = 0;
+  for(std::size_t i = 0; i < _fileBlocks.size(); i++) {
+    numEnt += _fileBlocks[i].numEnt;
+    numValues += _fileBlocks[i].numValues;
+  }
+  reserveValues(numValues);
+  std::vector<Real *> *data = new std::vector<Real *>();
+  data->reserve(numEnt);
+  std::vector<int> mult;
+  std::vector<double> values;
+  bool ok = true;
+  for(std::size_t b = 0; b < _fileBlocks.size() && ok; b++) {
+    const fileBlock &fb = _fileBlocks[b];
+    FILE *fp = Fopen(fb.fileName.c_str(), "rb");
+    if(!fp || fseek(fp, fb.offset, SEEK_SET)) {
+      Msg::Error("Unable to read data from file '%s'", fb.fileName.c_str());
+      if(fp) fclose(fp);
+      ok = false;
+      break;
+    }
+    for(int i = 0; i < fb.numEnt && ok; i++) {
+      int num = -1, m = 1;
+      if(fb.binary) {
+        ok = (fread(&num, sizeof(int), 1, fp) == 1);
+        if(ok && fb.mult) ok = (fread(&m, sizeof(int), 1, fp) == 1);
+        if(fb.swap) {
+          SwapBytes((char *)&num, sizeof(int), 1);
+          SwapBytes((char *)&m, sizeof(int), 1);
+        }
+      }
+      else {
+        ok = (fscanf(fp, "%d", &num) == 1);
+        if(ok && fb.mult) ok = (fscanf(fp, "%d", &m) == 1);
+      }
+      if(!ok || num < 0 || m < 1) {
+        ok = false;
+        break;
+      }
+      std::size_t n = _numComp * m;
+      values.resize(n);
+      if(fb.binary) {
+        ok = (fread(&values[0], sizeof(double), n, fp) == n);
+        if(fb.swap) SwapBytes((char *)&values[0], sizeof(double), n);
+      }
+      else {
+        for(std::size_t j = 0; j < n && ok; j++)
+          ok = (fscanf(fp, "%lf", &values[j]) == 1);
+      }
+      if(!ok) break;
+      if(num >= (int)data->size()) data->resize(num + 1, (Real *)0);
+      if(m > 1) {
+        if(num >= (int)mult.size()) mult.resize(num + 1, 1);
+        mult[num] = m;
+      }
+      Real *d = (*data)[num];
+      if(!d) d = (*data)[num] = _allocate(n);
+      for(std::size_t j = 0; j < n; j++) d[j] = values[j];
+    }
+    fclose(fp);
+  }
+  if(!ok) Msg::Error("Could not read data for time step %g", _time);
+  _mult = mult;
+  _data = data;
+  _lastUse = ++_loadCounter();
+  // the values are only made visible once complete, as other threads check
+  // _loaded without locking
+  _loaded.store(true, std::memory_order_release);
+  Msg::Debug("Read time step %g on demand (%g Mb) in %g s (Wall %gs)", _time,
+             getMemoryInMb(), Cpu() - t1, TimeOfDay() - w1);
+
+  // evict the least recently used steps if the memory budget is exceeded; the
+  // steps accessed since the previous read are kept, as their values could
+  // still be in use, as well as the pinned steps; nothing is evicted while
+  // several threads are running, as they access the values without locking
+  if(Msg::GetNumThreads() > 1) return;
+  double mem = 0.;
+  for(auto s : _onDemandSteps()) mem += s->getMemoryInMb();
+  while(mem > CTX::instance()->post.stepMemoryBudget) {
+    stepData<Real> *lru = nullptr;
+    for(auto s : _onDemandSteps()) {
+      if(s->_loaded && !s->_pinned && s->_lastUse + 1 < _lastUse &&
+         (!lru || s->_lastUse < lru->_lastUse))
+        lru = s;
+    }
+    if(!lru) break;
+    Msg::Debug("Evicting time step %g from memory", lru->_time);
+    mem -= lru->getMemoryInMb();
+    lru->_unload();
+  }
+}
+
+template class stepData<double>;
+
 bool PViewDataGModel::addData(GModel *model,
                               const std::map<int, std::vector<double> > &data,
                               int step, double time, int partition, int numComp)
@@ -39,6 +201,11 @@ bool PViewDataGModel::addData(GModel *model,
                                      model->getNumMeshElements();
   _steps[step]->resizeData(numEnt);
 
+  std::size_t numValues = 0;
+  for(auto it = data.begin(); it != data.end(); it++)
+    numValues += (it->second.size() / numComp) * numComp;
+  _steps[step]->reserveValues(numValues);
+
   for(auto it = data.begin(); it != data.end(); it++) {
     int mult = it->second.size() / numComp;
     double *d = _steps[step]->getData(it->first, true, mult);
@@ -77,6 +244,11 @@ bool PViewDataGModel::addData(GModel *model,
                                      model->getNumMeshElements();
   _steps[step]->resizeData(numEnt);
 
+  std::size_t numValues = 0;
+  for(std::size_t i = 0; i < data.size(); i++)
+    numValues += (data[i].size() / numComp) * numComp;
+  _steps[step]->reserveValues(numValues);
+
   for(std::size_t i = 0; i < data.size(); i++) {
     int mult = data[i].size() / numComp;
     double *d = _steps[step]->getData(tags[i], true, mult);
@@ -117,6 +289,7 @@ bool PViewDataGModel::addData(GModel *model,
   _steps[step]->resizeData(numEnt);
 
   int mult = stride / numComp;
+  _steps[step]->reserveValues(tags.size() * mult * numComp);
   for(std::size_t i = 0; i < tags.size(); i++) {
     double *d = _steps[step]->getData(tags[i], true, mult);
     int k = i * stride;
@@ -158,6 +331,54 @@ bool PViewDataGModel::readMSH(const std::string &viewName,
   if(numSteps > maxSteps) return true;
   */
 
+  // if a memory budget is set for time steps, only record where the values are
+  // in the file: they will be read when first accessed
+  if(CTX::instance()->post.stepMemoryBudget > 0 && _type != BeamData &&
+     (!_steps[step]->hasData() || _steps[step]->isOnDemand())) {
+    bool mult = (_type == ElementNodeData || _type == GaussPointData);
+    long offset = ftell(fp);
+    // read through the values to get their range, without storing them
+    double vmin = VAL_INF, vmax = -VAL_INF;
+    std::vector<double> values;
+    std::size_t numValues = 0;
+    int n = mult ? 2 : 1;
+    for(int i = 0; i < numEnt; i++) {
+      int data[2] = {0, 1};
+      if(binary) {
+        if((int)fread(data, sizeof(int), n, fp) != n) return false;
+        if(swap) SwapBytes((char *)data, sizeof(int), n);
+      }
+      else {
+        for(int j = 0; j < n; j++)
+          if(fscanf(fp, "%d", &data[j]) != 1) return false;
+      }
+      if(data[1] < 1) return false;
+      std::size_t nv = (std::size_t)numComp * data[1];
+      numValues += nv;
+      values.resize(nv);
+      if(binary) {
+        if(fread(&values[0], sizeof(double), nv, fp) != nv) return false;
+        if(swap) SwapBytes((char *)&values[0], sizeof(double), nv);
+      }
+      else {
+        for(std::size_t j = 0; j < nv; j++)
+          if(fscanf(fp, "%lf", &values[j]) != 1) return false;
+      }
+      for(int j = 0; j < data[1]; j++) {
+        double val = ComputeScalarRep(numComp, &values[numComp * j]);
+        vmin = std::min(vmin, val);
+        vmax = std::max(vmax, val);
+      }
+    }
+    _steps[step]->addFileBlock(fileName, offset, numEnt, numValues, binary,
+                               swap, mult, vmin, vmax);
+    if(partition >= 0) _steps[step]->getPartitions().insert(partition);
+    finalize(false, interpolationScheme);
+    _min = std::min(_min, vmin);
+    _max = std::max(_max, vmax);
+    return true;
+  }
+
   _steps[step]->resizeData(numEnt);
 
   Msg::StartProgressMeter(numEnt);
@@ -181,6 +402,9 @@ bool PViewDataGModel::readMSH(const std::string &viewName,
         if(fscanf(fp, "%d", &mult) != 1) return false;
       }
     }
+    // store the values of the step contiguously, assuming that all the
+    // entities have the same multiplicity as the first one
+    if(!i) _steps[step]->reserveValues((std::size_t)numEnt * mult * numComp);
     double *d = _steps[step]->getData(num, true, mult);
     if(binary) {
       if((int)fread(d, sizeof(double), numComp * mult, fp) != numComp * mult)
@@ -25,6 +25,63 @@
 #include "StringUtils.h"
 #include "fullMatrix.h"
 
+// The vertex arrays, normals and options used to add the elements of a view:
+// those of the view itself or, when the elements are processed in parallel,
+// thread-local arrays and a thread-local copy of the options (some of which,
+// like "boundary" or "tmpMin", are modified while the elements are added)
+class PViewArrays {
+private:
+  PView *_view;
+  PViewOptions *_opt, _localOpt;
+  bool _local;
+
+public:
+  VertexArray *va_points, *va_lines, *va_triangles, *va_vectors, *va_ellipses;
+  smooth_normals *normals;
+  PViewArrays(PView *view, bool local = false)
+    : _view(view), _opt(view->getOptions()), _local(local),
+      va_points(view->va_points), va_lines(view->va_lines),
+      va_triangles(view->va_triangles), va_vectors(view->va_vectors),
+      va_ellipses(view->va_ellipses), normals(view->normals)
+  {
+    if(!_local) return;
+    _localOpt = *_opt;
+    _localOpt.genRaiseEvaluator = nullptr; // owned by the view options
+    _localOpt.tmpBBox.reset();
+    _opt = &_localOpt;
+    va_points = new VertexArray(1, 0);
+    va_lines = new VertexArray(2, 0);
+    va_triangles = new VertexArray(3, 0);
+    va_vectors = new VertexArray(2, 0);
+    va_ellipses = new VertexArray(4, 0);
+  }
+  ~PViewArrays()
+  {
+    if(!_local) return;
+    delete va_points;
+    delete va_lines;
+    delete va_triangles;
+    delete va_vectors;
+    delete va_ellipses;
+  }
+  PViewData *getData(bool useAdaptiveIfAvailable = false)
+  {
+    return _view->getData(useAdaptiveIfAvailable);
+  }
+  PViewOptions *getOptions() { return _opt; }
+  // merge thread-local arrays into the arrays of the view
+  void merge()
+  {
+    if(!_local) return;
+    _view->va_points->merge(va_points);
+    _view->va_lines->merge(va_lines);
+    _view->va_triangles->merge(va_triangles);
+    _view->va_vectors->merge(va_vectors);
+    _view->va_ellipses->merge(va_ellipses);
+    _view->getOptions()->tmpBBox += _localOpt.tmpBBox;
+  }
+};
+
 static void saturate(int nb, double **val, double vmin, double vmax, int i0 = 0,
                      int i1 = 1, int i2 = 2, int i3 = 3, int i4 = 4, int i5 = 5,
                      int i6 = 6, int i7 = 7)
@@ -72,7 +129,7 @@ static SVector3 normal3(double **xyz, int i0 = 0, int i1 = 1, int i2 = 2)
   return n;
 }
 
-static SVector3 getPointNormal(PView *p, double v)
+static SVector3 getPointNormal(PViewArrays *p, double v)
 {
   PViewOptions *opt = p->getOptions();
   SVector3 n(0., 0., 0.);
@@ -86,7 +143,7 @@ static SVector3 getPointNormal(PView *p, double v)
   return n;
 }
 
-static void getLineNormal(PView *p, double x[2], double y[2], double z[2],
+static void getLineNormal(PViewArrays *p, double x[2], double y[2], double z[2],
                           double *v, SVector3 n[2], bool computeNormal)
 {
   PViewOptions *opt = p->getOptions();
@@ -130,7 +187,7 @@ static void getLineNormal(PView *p, double x[2], double y[2], double z[2],
   }
 }
 
-static bool getExternalValues(PView *p, int index, int ient, int iele,
+static bool getExternalValues(PViewArrays *p, int index, int ient, int iele,
                               int numNodes, int numComp, double **val,
                               int &numComp2, double **val2)
 {
@@ -173,7 +230,7 @@ static bool getExternalValues(PView *p, int index, int ient, int iele,
   return false;
 }
 
-static void applyGeneralRaise(PView *p, int numNodes, int numComp,
+static void applyGeneralRaise(PViewArrays *p, int numNodes, int numComp,
                               double **vals, double **xyz)
 {
   PViewOptions *opt = p->getOptions();
@@ -190,8 +247,8 @@ static void applyGeneralRaise(PView *p, int numNodes, int numComp,
   }
 }
 
-void changeCoordinates(PView *p, int ient, int iele, int numNodes, int type,
-                       int numComp, double **xyz, double **val)
+static void changeCoordinates(PViewArrays *p, int ient, int iele, int numNodes,
+                              int type, int numComp, double **xyz, double **val)
 {
   PViewOptions *opt = p->getOptions();
 
@@ -312,7 +369,7 @@ bool isElementVisible(PViewOptions *opt, int dim, int numNodes, double **xyz)
   return !hidden;
 }
 
-static void addOutlinePoint(PView *p, double **xyz, unsigned int color,
+static void addOutlinePoint(PViewArrays *p, double **xyz, unsigned int color,
                             bool pre, int i0 = 0)
 {
   if(pre) return;
@@ -321,7 +378,7 @@ static void addOutlinePoint(PView *p, double **xyz, unsigned int color,
                     true);
 }
 
-static void addScalarPoint(PView *p, double **xyz, double **val, bool pre,
+static void addScalarPoint(PViewArrays *p, double **xyz, double **val, bool pre,
                            int i0 = 0, bool unique = false)
 {
   if(pre) return;
@@ -341,8 +398,8 @@ static void addScalarPoint(PView *p, double **xyz, double **val, bool pre,
   }
 }
 
-static void addOutlineLine(PView *p, double **xyz, unsigned int color, bool pre,
-                           int i0 = 0, int i1 = 1)
+static void addOutlineLine(PViewArrays *p, double **xyz, unsigned int color,
+                           bool pre, int i0 = 0, int i1 = 1)
 {
   if(pre) return;
 
@@ -360,7 +417,7 @@ static void addOutlineLine(PView *p, double **xyz, unsigned int color, bool pre,
   p->va_lines->add(x, y, z, n, col, nullptr, true);
 }
 
-static void addScalarLine(PView *p, double **xyz, double **val, bool pre,
+static void addScalarLine(PViewArrays *p, double **xyz, double **val, bool pre,
                           int i0 = 0, int i1 = 1, bool unique = false)
 {
   if(pre) return;
@@ -437,7 +494,7 @@ static void addScalarLine(PView *p, double **xyz, double **val, bool pre,
   }
 }
 
-static void addOutlineTriangle(PView *p, double **xyz, unsigned int color,
+static void addOutlineTriangle(PViewArrays *p, double **xyz, unsigned int color,
                                bool pre, int i0 = 0, int i1 = 1, int i2 = 2)
 {
   PViewOptions *opt = p->getOptions();
@@ -465,8 +522,8 @@ static void addOutlineTriangle(PView *p, double **xyz, unsigned int color,
   }
 }
 
-static void addScalarTriangle(PView *p, double **xyz, double **val, bool pre,
-                              int i0 = 0, int i1 = 1, int i2 = 2,
+static void addScalarTriangle(PViewArrays *p, double **xyz, double **val,
+                              bool pre, int i0 = 0, int i1 = 1, int i2 = 2,
                               bool unique = false, bool skin = false)
 {
   PViewOptions *opt = p->getOptions();
@@ -592,9 +649,9 @@ static void addScalarTriangle(PView *p, double **xyz, double **val, bool pre,
   }
 }
 
-static void addOutlineQuadrangle(PView *p, double **xyz, unsigned int color,
-                                 bool pre, int i0 = 0, int i1 = 1, int i2 = 2,
-                                 int i3 = 3)
+static void addOutlineQuadrangle(PViewArrays *p, double **xyz,
+                                 unsigned int color, bool pre, int i0 = 0,
+                                 int i1 = 1, int i2 = 2, int i3 = 3)
 {
   PViewOptions *opt = p->getOptions();
 
@@ -621,9 +678,9 @@ static void addOutlineQuadrangle(PView *p, double **xyz, unsigned int color,
   }
 }
 
-static void addScalarQuadrangle(PView *p, double **xyz, double **val, bool pre,
-                                int i0 = 0, int i1 = 1, int i2 = 2, int i3 = 3,
-                                bool unique = false)
+static void addScalarQuadrangle(PViewArrays *p, double **xyz, double **val,
+                                bool pre, int i0 = 0, int i1 = 1, int i2 = 2,
+                                int i3 = 3, bool unique = false)
 {
   PViewOptions *opt = p->getOptions();
 
@@ -642,15 +699,15 @@ static void addScalarQuadrangle(PView *p, double **xyz, double **val, bool pre,
     addScalarTriangle(p, xyz, val, pre, it[i][0], it[i][1], it[i][2], unique);
 }
 
-static void addOutlinePolygon(PView *p, double **xyz, unsigned int color,
+static void addOutlinePolygon(PViewArrays *p, double **xyz, unsigned int color,
                               bool pre, int numNodes)
 {
   for(int i = 0; i < numNodes / 3; i++)
     addOutlineTriangle(p, xyz, color, pre, 3 * i, 3 * i + 1, 3 * i + 2);
 }
 
-static void addScalarPolygon(PView *p, double **xyz, double **val, bool pre,
-                             int numNodes)
+static void addScalarPolygon(PViewArrays *p, double **xyz, double **val,
+                             bool pre, int numNodes)
 {
   PViewOptions *opt = p->getOptions();
 
@@ -692,16 +749,17 @@ static void addScalarPolygon(PView *p, double **xyz, double **val, bool pre,
     addScalarTriangle(p, xyz, val, pre, 3 * i, 3 * i + 1, 3 * i + 2);
 }
 
-static void addOutlineTetrahedron(PView *p, double **xyz, unsigned int color,
-                                  bool pre)
+static void addOutlineTetrahedron(PViewArrays *p, double **xyz,
+                                  unsigned int color, bool pre)
 {
   const int it[4][3] = {{0, 2, 1}, {0, 1, 3}, {0, 3, 2}, {3, 1, 2}};
   for(int i = 0; i < 4; i++)
     addOutlineTriangle(p, xyz, color, pre, it[i][0], it[i][1], it[i][2]);
 }
 
-static void addScalarTetrahedron(PView *p, double **xyz, double **val, bool pre,
-                                 int i0 = 0, int i1 = 1, int i2 = 2, int i3 = 3)
+static void addScalarTetrahedron(PViewArrays *p, double **xyz, double **val,
+                                 bool pre, int i0 = 0, int i1 = 1, int i2 = 2,
+                                 int i3 = 3)
 {
   PViewOptions *opt = p->getOptions();
 
@@ -760,8 +818,8 @@ static void addScalarTetrahedron(PView *p, double **xyz, double **val, bool pre,
   }
 }
 
-static void addOutlineHexahedron(PView *p, double **xyz, unsigned int color,
-                                 bool pre)
+static void addOutlineHexahedron(PViewArrays *p, double **xyz,
+                                 unsigned int color, bool pre)
 {
   const int iq[6][4] = {{0, 3, 2, 1}, {0, 1, 5, 4}, {0, 4, 7, 3},
                         {1, 2, 6, 5}, {2, 3, 7, 6}, {4, 5, 6, 7}};
@@ -771,7 +829,8 @@ static void addOutlineHexahedron(PView *p, double **xyz, unsigned int color,
                          iq[i][3]);
 }
 
-static void addScalarHexahedron(PView *p, double **xyz, double **val, bool pre)
+static void addScalarHexahedron(PViewArrays *p, double **xyz, double **val,
+                                bool pre)
 {
   PViewOptions *opt = p->getOptions();
 
@@ -794,7 +853,7 @@ static void addScalarHexahedron(PView *p, double **xyz, double **val, bool pre)
                          is[i][3]);
 }
 
-static void addOutlinePrism(PView *p, double **xyz, unsigned int color,
+static void addOutlinePrism(PViewArrays *p, double **xyz, unsigned int color,
                             bool pre)
 {
   const int iq[3][4] = {{0, 1, 4, 3}, {0, 3, 5, 2}, {1, 2, 5, 4}};
@@ -807,7 +866,7 @@ static void addOutlinePrism(PView *p, double **xyz, unsigned int color,
     addOutlineTriangle(p, xyz, color, pre, it[i][0], it[i][1], it[i][2]);
 }
 
-static void addScalarPrism(PView *p, double **xyz, double **val, bool pre)
+static void addScalarPrism(PViewArrays *p, double **xyz, double **val, bool pre)
 {
   PViewOptions *opt = p->getOptions();
   const int iq[3][4] = {{0, 1, 4, 3}, {0, 3, 5, 2}, {1, 2, 5, 4}};
@@ -830,7 +889,7 @@ static void addScalarPrism(PView *p, double **xyz, double **val, bool pre)
                          is[i][3]);
 }
 
-static void addOutlinePyramid(PView *p, double **xyz, unsigned int color,
+static void addOutlinePyramid(PViewArrays *p, double **xyz, unsigned int color,
                               bool pre)
 {
   const int it[4][3] = {{0, 1, 4}, {3, 0, 4}, {1, 2, 4}, {2, 3, 4}};
@@ -840,7 +899,8 @@ static void addOutlinePyramid(PView *p, double **xyz, unsigned int color,
     addOutlineTriangle(p, xyz, color, pre, it[i][0], it[i][1], it[i][2]);
 }
 
-static void addScalarPyramid(PView *p, double **xyz, double **val, bool pre)
+static void addScalarPyramid(PViewArrays *p, double **xyz, double **val,
+                             bool pre)
 {
   PViewOptions *opt = p->getOptions();
 
@@ -861,21 +921,21 @@ static void addScalarPyramid(PView *p, double **xyz, double **val, bool pre)
                          is[i][3]);
 }
 
-static void addOutlineTrihedron(PView *p, double **xyz, unsigned int color,
-                                bool pre)
+static void addOutlineTrihedron(PViewArrays *p, double **xyz,
+                                unsigned int color, bool pre)
 {
   addOutlineQuadrangle(p, xyz, color, pre, 0, 1, 2, 3);
 }
 
-static void addScalarTrihedron(PView *p, double **xyz, double **val, bool pre,
-                               int i0 = 0, int i1 = 1, int i2 = 2, int i3 = 3,
-                               bool unique = false)
+static void addScalarTrihedron(PViewArrays *p, double **xyz, double **val,
+                               bool pre, int i0 = 0, int i1 = 1, int i2 = 2,
+                               int i3 = 3, bool unique = false)
 {
   addScalarQuadrangle(p, xyz, val, pre, i0, i1, i2, i3, unique);
 }
 
-static void addOutlinePolyhedron(PView *p, double **xyz, unsigned int color,
-                                 bool pre, int numNodes)
+static void addOutlinePolyhedron(PViewArrays *p, double **xyz,
+                                 unsigned int color, bool pre, int numNodes)
 {
   // FIXME: this code is horribly slow
   const int it[4][3] = {{0, 2, 1}, {0, 1, 3}, {0, 3, 2}, {3, 1, 2}};
@@ -907,8 +967,8 @@ static void addOutlinePolyhedron(PView *p, double **xyz, unsigned int color,
   for(int i = 0; i < numNodes; i++) delete verts[i];
 }
 
-static void addScalarPolyhedron(PView *p, double **xyz, double **val, bool pre,
-                                int numNodes)
+static void addScalarPolyhedron(PViewArrays *p, double **xyz, double **val,
+                                bool pre, int numNodes)
 {
   PViewOptions *opt = p->getOptions();
 
@@ -919,7 +979,7 @@ static void addScalarPolyhedron(PView *p, double **xyz, double **val, bool pre,
                          4 * i + 3);
 }
 
-static void addOutlineElement(PView *p, int type, double **xyz, bool pre,
+static void addOutlineElement(PViewArrays *p, int type, double **xyz, bool pre,
                               int numNodes)
 {
   PViewOptions *opt = p->getOptions();
@@ -948,8 +1008,8 @@ static void addOutlineElement(PView *p, int type, double **xyz, bool pre,
   }
 }
 
-static void addScalarElement(PView *p, int type, double **xyz, double **val,
-                             bool pre, int numNodes)
+static void addScalarElement(PViewArrays *p, int type, double **xyz,
+                             double **val, bool pre, int numNodes)
 {
   switch(type) {
   case TYPE_PNT: addScalarPoint(p, xyz, val, pre); break;
@@ -966,7 +1026,7 @@ static void addScalarElement(PView *p, int type, double **xyz, double **val,
   }
 }
 
-static void addVectorElement(PView *p, int ient, int iele, int numNodes,
+static void addVectorElement(PViewArrays *p, int ient, int iele, int numNodes,
                              int type, double **xyz, double **val, bool pre)
 {
   // use adaptive data if available
@@ -1095,8 +1155,8 @@ static void addVectorElement(PView *p, int ient, int iele, int numNodes,
   delete[] val2;
 }
 
-static void addTriangle(PView *p, PViewOptions *opt, double *x0, double *x1,
-                        double *x2, SPoint3 &xx, double val)
+static void addTriangle(PViewArrays *p, PViewOptions *opt, double *x0,
+                        double *x1, double *x2, SPoint3 &xx, double val)
 {
   unsigned int color = opt->getColor(
     val, opt->tmpMin, opt->tmpMax, false,
@@ -1124,7 +1184,7 @@ static void addTriangle(PView *p, PViewOptions *opt, double *x0, double *x1,
   }
 }
 
-static void addTensorElement(PView *p, int iEnt, int iEle, int numNodes,
+static void addTensorElement(PViewArrays *p, int iEnt, int iEle, int numNodes,
                              int type, double **xyz, double **val, bool pre)
 {
   PViewOptions *opt = p->getOptions();
@@ -1280,7 +1340,33 @@ static void addTensorElement(PView *p, int iEnt, int iEle, int numNodes,
   }
 }
 
-static void addElementsInArrays(PView *p, bool preprocessNormalsOnly)
+// coordinates and values of the nodes of an element
+class elementNodes {
+public:
+  int nmax;
+  double **xyz, **val;
+  elementNodes() : nmax(0), xyz(nullptr), val(nullptr) { resize(PVIEW_NMAX); }
+  ~elementNodes() { resize(0); }
+  void resize(int n)
+  {
+    for(int j = 0; j < nmax; j++) {
+      delete[] xyz[j];
+      delete[] val[j];
+    }
+    delete[] xyz;
+    delete[] val;
+    nmax = n;
+    xyz = n ? new double *[n] : nullptr;
+    val = n ? new double *[n] : nullptr;
+    for(int j = 0; j < n; j++) {
+      xyz[j] = new double[3];
+      val[j] = new double[9];
+    }
+  }
+};
+
+static void addElementInArrays(PViewArrays *p, int ent, int i,
+                               bool preprocessNormalsOnly, elementNodes &nodes)
 {
   static int numNodesError = 0, numCompError = 0;
 
@@ -1288,135 +1374,178 @@ static void addElementsInArrays(PView *p, bool preprocessNormalsOnly)
   PViewData *data = p->getData(true);
   PViewOptions *opt = p->getOptions();
 
-  opt->tmpBBox.reset();
-
-  int NMAX = PVIEW_NMAX;
-  double **xyz = new double *[NMAX];
-  double **val = new double *[NMAX];
-  for(int i = 0; i < NMAX; i++) {
-    xyz[i] = new double[3];
-    val[i] = new double[9];
-  }
-  for(int ent = 0; ent < data->getNumEntities(opt->timeStep); ent++) {
-    if(data->skipEntity(opt->timeStep, ent)) continue;
-    for(int i = 0; i < data->getNumElements(opt->timeStep, ent); i++) {
-      if(data->skipElement(opt->timeStep, ent, i, true, opt->sampling))
-        continue;
-      int type = data->getType(opt->timeStep, ent, i);
-      if(opt->skipElement(type)) continue;
-      int numComp = data->getNumComponents(opt->timeStep, ent, i);
-      int numNodes = data->getNumNodes(opt->timeStep, ent, i);
-      if(numNodes > PVIEW_NMAX) {
-        if(type == TYPE_POLYG || type == TYPE_POLYH) {
-          if(numNodes > NMAX) {
-            for(int j = 0; j < NMAX; j++) {
-              delete[] xyz[j];
-              delete[] val[j];
-            }
-            delete[] xyz;
-            delete[] val;
-            NMAX = numNodes;
-            xyz = new double *[NMAX];
-            val = new double *[NMAX];
-            for(int j = 0; j < NMAX; j++) {
-              xyz[j] = new double[3];
-              val[j] = new double[9];
-            }
-          }
-        }
-        else {
-          if(numNodesError != numNodes) {
-            numNodesError = numNodes;
-            Msg::Warning(
-              "Fields with %d nodes per element cannot be displayed: "
-              "either force the field type or select 'Adapt visualization "
-              "grid' if the field is high-order",
-              numNodes);
-          }
-          continue;
-        }
-      }
-      if((numComp > 9 && !opt->forceNumComponents) ||
-         opt->forceNumComponents > 9) {
-        if(numCompError != numComp) {
-          numCompError = numComp;
-          Msg::Warning(
-            "Fields with %d components cannot be displayed: "
-            "either force the field type or select 'Adapt visualization "
-            "grid' if the field is high-order",
-            numComp);
-        }
-        continue;
+  if(data->skipElement(opt->timeStep, ent, i, true, opt->sampling)) return;
+  int type = data->getType(opt->timeStep, ent, i);
+  if(opt->skipElement(type)) return;
+  int numComp = data->getNumComponents(opt->timeStep, ent, i);
+  int numNodes = data->getNumNodes(opt->timeStep, ent, i);
+  if(numNodes > PVIEW_NMAX) {
+    if(type == TYPE_POLYG || type == TYPE_POLYH) {
+      if(numNodes > nodes.nmax) nodes.resize(numNodes);
+    }
+    else {
+#pragma omp critical(PViewVertexArraysWarning)
+      if(numNodesError != numNodes) {
+        numNodesError = numNodes;
+        Msg::Warning("Fields with %d nodes per element cannot be displayed: "
+                     "either force the field type or select 'Adapt "
+                     "visualization grid' if the field is high-order",
+                     numNodes);
       }
-      for(int j = 0; j < numNodes; j++) {
-        data->getNode(opt->timeStep, ent, i, j, xyz[j][0], xyz[j][1],
-                      xyz[j][2]);
-        if(opt->forceNumComponents) {
-          for(int k = 0; k < opt->forceNumComponents; k++) {
-            int comp = opt->componentMap[k];
-            if(comp >= 0 && comp < numComp)
-              data->getValue(opt->timeStep, ent, i, j, comp, val[j][k]);
-            else
-              val[j][k] = 0.;
-          }
-        }
+      return;
+    }
+  }
+  if((numComp > 9 && !opt->forceNumComponents) ||
+     opt->forceNumComponents > 9) {
+#pragma omp critical(PViewVertexArraysWarning)
+    if(numCompError != numComp) {
+      numCompError = numComp;
+      Msg::Warning("Fields with %d components cannot be displayed: "
+                   "either force the field type or select 'Adapt "
+                   "visualization grid' if the field is high-order",
+                   numComp);
+    }
+    return;
+  }
+  double **xyz = nodes.xyz, **val = nodes.val;
+  for(int j = 0; j < numNodes; j++) {
+    data->getNode(opt->timeStep, ent, i, j, xyz[j][0], xyz[j][1], xyz[j][2]);
+    if(opt->forceNumComponents) {
+      for(int k = 0; k < opt->forceNumComponents; k++) {
+        int comp = opt->componentMap[k];
+        if(comp >= 0 && comp < numComp)
+          data->getValue(opt->timeStep, ent, i, j, comp, val[j][k]);
         else
-          for(int k = 0; k < numComp; k++)
-            data->getValue(opt->timeStep, ent, i, j, k, val[j][k]);
+          val[j][k] = 0.;
       }
-      if(opt->forceNumComponents) numComp = opt->forceNumComponents;
-
-      changeCoordinates(p, ent, i, numNodes, type, numComp, xyz, val);
-      int dim = data->getDimension(opt->timeStep, ent, i);
-      if(!isElementVisible(opt, dim, numNodes, xyz)) continue;
-
-      for(int j = 0; j < numNodes; j++)
-        opt->tmpBBox += SPoint3(xyz[j][0], xyz[j][1], xyz[j][2]);
-
-      if(opt->showElement && !data->useGaussPoints())
-        addOutlineElement(p, type, xyz, preprocessNormalsOnly, numNodes);
-
-      if(opt->intervalsType != PViewOptions::Numeric) {
-        if(data->useGaussPoints()) {
-          for(int j = 0; j < numNodes; j++) {
-            double *x2 = new double[3];
-            double **xyz2 = &x2;
-            double *v2 = new double[9];
-            double **val2 = &v2;
-            xyz2[0][0] = xyz[j][0];
-            xyz2[0][1] = xyz[j][1];
-            xyz2[0][2] = xyz[j][2];
-            for(int k = 0; k < numComp; k++) val2[0][k] = val[j][k];
-            if(numComp == 1 && opt->drawScalars)
-              addScalarElement(p, TYPE_PNT, xyz2, val2, preprocessNormalsOnly,
-                               numNodes);
-            else if(numComp == 3 && opt->drawVectors)
-              addVectorElement(p, ent, i, 1, TYPE_PNT, xyz2, val2,
-                               preprocessNormalsOnly);
-            else if(numComp == 9 && opt->drawTensors)
-              addTensorElement(p, ent, i, 1, TYPE_PNT, xyz2, val2,
-                               preprocessNormalsOnly);
-            delete[] x2;
-            delete[] v2;
-          }
-        }
-        else if(numComp == 1 && opt->drawScalars)
-          addScalarElement(p, type, xyz, val, preprocessNormalsOnly, numNodes);
+    }
+    else
+      for(int k = 0; k < numComp; k++)
+        data->getValue(opt->timeStep, ent, i, j, k, val[j][k]);
+  }
+  if(opt->forceNumComponents) numComp = opt->forceNumComponents;
+
+  changeCoordinates(p, ent, i, numNodes, type, numComp, xyz, val);
+  int dim = data->getDimension(opt->timeStep, ent, i);
+  if(!isElementVisible(opt, dim, numNodes, xyz)) return;
+
+  for(int j = 0; j < numNodes; j++)
+    opt->tmpBBox += SPoint3(xyz[j][0], xyz[j][1], xyz[j][2]);
+
+  if(opt->showElement && !data->useGaussPoints())
+    addOutlineElement(p, type, xyz, preprocessNormalsOnly, numNodes);
+
+  if(opt->intervalsType != PViewOptions::Numeric) {
+    if(data->useGaussPoints()) {
+      for(int j = 0; j < numNodes; j++) {
+        double *x2 = new double[3];
+        double **xyz2 = &x2;
+        double *v2 = new double[9];
+        double **val2 = &v2;
+        xyz2[0][0] = xyz[j][0];
+        xyz2[0][1] = xyz[j][1];
+        xyz2[0][2] = xyz[j][2];
+        for(int k = 0; k < numComp; k++) val2[0][k] = val[j][k];
+        if(numComp == 1 && opt->drawScalars)
+          addScalarElement(p, TYPE_PNT, xyz2, val2, preprocessNormalsOnly,
+                           numNodes);
         else if(numComp == 3 && opt->drawVectors)
-          addVectorElement(p, ent, i, numNodes, type, xyz, val,
+          addVectorElement(p, ent, i, 1, TYPE_PNT, xyz2, val2,
                            preprocessNormalsOnly);
         else if(numComp == 9 && opt->drawTensors)
-          addTensorElement(p, ent, i, numNodes, type, xyz, val,
+          addTensorElement(p, ent, i, 1, TYPE_PNT, xyz2, val2,
                            preprocessNormalsOnly);
+        delete[] x2;
+        delete[] v2;
       }
     }
+    else if(numComp == 1 && opt->drawScalars)
+      addScalarElement(p, type, xyz, val, preprocessNormalsOnly, numNodes);
+    else if(numComp == 3 && opt->drawVectors)
+      addVectorElement(p, ent, i, numNodes, type, xyz, val,
+                       preprocessNormalsOnly);
+    else if(numComp == 9 && opt->drawTensors)
+      addTensorElement(p, ent, i, numNodes, type, xyz, val,
+                       preprocessNormalsOnly);
   }
-  for(int j = 0; j < NMAX; j++) {
-    delete[] xyz[j];
-    delete[] val[j];
+}
+
+static bool isThreadSafe(PView *p)
+{
+  PViewData *data = p->getData(true);
+  PViewOptions *opt = p->getOptions();
+  if(!data->isThreadSafe() || opt->useGenRaise) return false;
+  // vectors can be colored by the values of another view
+  int index = opt->externalViewIndex;
+  if(index >= 0 && index < (int)PView::list.size() &&
+     !PView::list[index]->getData(true)->isThreadSafe())
+    return false;
+  return true;
+}
+
+static void addElementsInArrays(PView *p, bool preprocessNormalsOnly)
+{
+  // use adaptive data if available
+  PViewData *data = p->getData(true);
+  PViewOptions *opt = p->getOptions();
+
+  opt->tmpBBox.reset();
+
+  int step = opt->timeStep;
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+
+  // smoothed normals are accumulated in a shared structure: only the final
+  // pass, which just reads them, can be performed in parallel
+  if(preprocessNormalsOnly || nthreads < 2 || !isThreadSafe(p)) {
+    PViewArrays arrays(p);
+    elementNodes nodes;
+    for(int ent = 0; ent < data->getNumEntities(step); ent++) {
+      if(data->skipEntity(step, ent)) continue;
+      for(int i = 0; i < data->getNumElements(step, ent); i++)
+        addElementInArrays(&arrays, ent, i, preprocessNormalsOnly, nodes);
+    }
+    return;
+  }
+
+  // split the elements in chunks, each filling its own vertex arrays; the
+  // arrays are merged in the order of the chunks, so that the result does not
+  // depend on the number of threads
+  std::vector<std::pair<int, int> > chunks; // entity, first element
+  const int chunkSize = 10000;
+  for(int ent = 0; ent < data->getNumEntities(step); ent++) {
+    if(data->skipEntity(step, ent)) continue;
+    for(int i = 0; i < data->getNumElements(step, ent); i += chunkSize)
+      chunks.push_back(std::make_pair(ent, i));
+  }
+  std::vector<PViewArrays *> arrays(chunks.size(), nullptr);
+  // steps read on demand must be loaded beforehand, and must not be evicted
+  // while the threads read them
+  PViewData *external = nullptr;
+  int index = opt->externalViewIndex;
+  if(index >= 0 && index < (int)PView::list.size())
+    external = PView::list[index]->getData(true);
+  data->pinTimeStep(step);
+  if(external) external->pinTimeStep(step);
+#pragma omp parallel num_threads(nthreads)
+  {
+    elementNodes nodes;
+#pragma omp for schedule(dynamic)
+    for(std::size_t c = 0; c < chunks.size(); c++) {
+      int ent = chunks[c].first;
+      int last = std::min(chunks[c].second + chunkSize,
+                          data->getNumElements(step, ent));
+      arrays[c] = new PViewArrays(p, true);
+      for(int i = chunks[c].second; i < last; i++)
+        addElementInArrays(arrays[c], ent, i, false, nodes);
+    }
+  }
+  data->unpinTimeStep(step);
+  if(external) external->unpinTimeStep(step);
+  for(std::size_t c = 0; c < chunks.size(); c++) {
+    arrays[c]->merge();
+    delete arrays[c];
   }
-  delete[] xyz;
-  delete[] val;
 }
 
 class initPView {
@@ -1565,6 +1694,13 @@ public:
   }
 };
 
+void changeCoordinates(PView *p, int ient, int iele, int numNodes, int type,
+                       int numComp, double **xyz, double **val)
+{
+  PViewArrays arrays(p);
+  changeCoordinates(&arrays, ient, iele, numNodes, type, numComp, xyz, val);
+}
+
 bool PView::fillVertexArrays()
 {
   initPView init;
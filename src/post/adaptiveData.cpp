@@ -5,6 +5,7 @@
 
 #include <math.h>
 #include <list>
+#include <map>
 #include <set>
 #include <algorithm>
 #include "adaptiveData.h"
@@ -12,6 +13,7 @@
 #include "Plugin.h"
 #include "OS.h"
 #include "GmshDefines.h"
+#include "Context.h"
 
 //#define TIMER
 
@@ -1352,6 +1354,39 @@ bool adaptiveElements<T>::adapt(double tol, int numComp,
   return true;
 }
 
+// Copy of the refinement pattern of T-type elements created by T::create(),
+// with the vertices in the order of T::allVertices (i.e. of the rows of the
+// interpolation matrices) and the root element first: each thread refines the
+// elements in its own copy, so that the global pattern is only read
+template <class T> class adaptiveTree {
+public:
+  std::vector<adaptiveVertex> vertices;
+  std::vector<T> elements;
+
+public:
+  adaptiveTree()
+  {
+    std::map<const adaptiveVertex *, std::size_t> vmap;
+    vertices.assign(T::allVertices.begin(), T::allVertices.end());
+    std::size_t i = 0;
+    for(auto it = T::allVertices.begin(); it != T::allVertices.end(); ++it)
+      vmap[&(*it)] = i++;
+    std::map<const T *, std::size_t> emap;
+    elements.reserve(T::all.size());
+    for(auto it = T::all.begin(); it != T::all.end(); ++it) {
+      emap[*it] = elements.size();
+      elements.push_back(**it);
+    }
+    const int numChildren = sizeof(T::e) / sizeof(T::e[0]);
+    for(i = 0; i < elements.size(); i++) {
+      T &t = elements[i];
+      for(int j = 0; j < T::numNodes; j++) t.p[j] = &vertices[vmap[t.p[j]]];
+      for(int j = 0; j < numChildren; j++)
+        if(t.e[j]) t.e[j] = &elements[emap[t.e[j]]];
+    }
+  }
+};
+
 template <class T>
 void adaptiveElements<T>::addInView(double tol, int step, PViewData *in,
                                     PViewDataList *out, GMSH_PostPlugin *plug)
@@ -1424,56 +1459,69 @@ void adaptiveElements<T>::addInView(double tol, int step, PViewData *in,
   outList->clear();
   *outNb = 0;
 
+  int numVertices = T::allVertices.size();
+  if(!numVertices) {
+    Msg::Warning("No adapted vertices to interpolate");
+    return;
+  }
+  int numVals = _coeffsVal ? _coeffsVal->size1() : T::numNodes;
+  int numNodes = _coeffsGeom ? _coeffsGeom->size1() : T::numNodes;
+
+  // gather the node coordinates and the values of the elements (reading the
+  // input data is not thread-safe)
+  std::vector<double> xyz, val;
+  std::size_t n = 0;
   for(int ent = 0; ent < in->getNumEntities(step); ent++) {
     for(int ele = 0; ele < in->getNumElements(step, ent); ele++) {
       if(in->skipElement(step, ent, ele) ||
          in->getNumEdges(step, ent, ele) != T::numEdges)
         continue;
-      int numNodes = in->getNumNodes(step, ent, ele);
-      std::vector<PCoords> coords;
+      int numVal = in->getNumValues(step, ent, ele);
+      if(numVals != numVal / numComp) {
+        Msg::Warning("Wrong number of values in adaptation %d != %i", numVals,
+                     numVal / numComp);
+        continue;
+      }
+      if(numNodes != in->getNumNodes(step, ent, ele)) {
+        Msg::Error("Wrong number of nodes in adaptation %d != %i", numNodes,
+                   in->getNumNodes(step, ent, ele));
+        continue;
+      }
       for(int i = 0; i < numNodes; i++) {
         double x, y, z;
         in->getNode(step, ent, ele, i, x, y, z);
-        coords.push_back(PCoords(x, y, z));
+        xyz.push_back(x);
+        xyz.push_back(y);
+        xyz.push_back(z);
       }
-      int numVal = in->getNumValues(step, ent, ele);
-      std::vector<PValues> values;
+      for(int i = 0; i < numVals * numComp; i++) {
+        double v;
+        in->getValue(step, ent, ele, i, v);
+        val.push_back(v);
+      }
+      n++;
+    }
+  }
 
-      switch(numComp) {
-      case 1:
-        for(int i = 0; i < numVal; i++) {
-          double val;
-          in->getValue(step, ent, ele, i, val);
-          values.push_back(PValues(val));
-        }
-        break;
-      case 3: {
-        for(int i = 0; i < numVal / 3; i++) {
-          double vx, vy, vz;
-          in->getValue(step, ent, ele, 3 * i + 0, vx);
-          in->getValue(step, ent, ele, 3 * i + 1, vy);
-          in->getValue(step, ent, ele, 3 * i + 2, vz);
-          values.push_back(PValues(vx, vy, vz));
-        }
-        break;
+  if(plug) {
+    // plugins set the visibility through the global refinement pattern
+    for(std::size_t ele = 0; ele < n; ele++) {
+      std::vector<PCoords> coords;
+      for(int i = 0; i < numNodes; i++) {
+        double *x = &xyz[3 * (numNodes * ele + i)];
+        coords.push_back(PCoords(x[0], x[1], x[2]));
       }
-      case 9: {
-        for(int i = 0; i < numVal / 9; i++) {
-          double vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz;
-          in->getValue(step, ent, ele, 9 * i + 0, vxx);
-          in->getValue(step, ent, ele, 9 * i + 1, vxy);
-          in->getValue(step, ent, ele, 9 * i + 2, vxz);
-          in->getValue(step, ent, ele, 9 * i + 3, vyx);
-          in->getValue(step, ent, ele, 9 * i + 4, vyy);
-          in->getValue(step, ent, ele, 9 * i + 5, vyz);
-          in->getValue(step, ent, ele, 9 * i + 6, vzx);
-          in->getValue(step, ent, ele, 9 * i + 7, vzy);
-          in->getValue(step, ent, ele, 9 * i + 8, vzz);
+      std::vector<PValues> values;
+      for(int i = 0; i < numVals; i++) {
+        double *v = &val[numComp * (numVals * ele + i)];
+        switch(numComp) {
+        case 1: values.push_back(PValues(v[0])); break;
+        case 3: values.push_back(PValues(v[0], v[1], v[2])); break;
+        case 9:
           values.push_back(
-            PValues(vxx, vxy, vxz, vyx, vyy, vyz, vzx, vzy, vzz));
+            PValues(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7], v[8]));
+          break;
         }
-        break;
-      }
       }
       if(adapt(tol, numComp, coords, values, out->Min, out->Max, plug)) {
         *outNb += coords.size() / T::numNodes;
@@ -1490,6 +1538,140 @@ void adaptiveElements<T>::addInView(double tol, int step, PViewData *in,
         }
       }
     }
+    return;
+  }
+
+  int nthreads = CTX::instance()->numThreads;
+  if(!nthreads) nthreads = Msg::GetMaxThreads();
+
+  // the elements are processed by blocks: the values and the coordinates at
+  // the vertices of the refinement pattern are computed with one
+  // matrix-matrix product per block
+  const std::size_t blockSize = 64;
+  std::size_t numBlocks = (n + blockSize - 1) / blockSize;
+  auto interpolate = [&](std::size_t b, fullMatrix<double> &s,
+                         fullMatrix<double> &res) {
+    std::size_t start = b * blockSize, nb = std::min(blockSize, n - start);
+    s.resize(numVals, nb, false);
+    res.resize(numVertices, nb, false);
+    for(std::size_t e = 0; e < nb; e++) {
+      for(int i = 0; i < numVals; i++) {
+        double *v = &val[numComp * (numVals * (start + e) + i)];
+        double sv = v[0];
+        if(numComp > 1) {
+          sv = 0.;
+          for(int k = 0; k < numComp; k++) sv += v[k] * v[k];
+        }
+        s(i, e) = sv;
+      }
+    }
+    _interpolVal->mult(s, res);
+  };
+
+  // 1st pass: range of the (squared norm of the) values, used to scale the
+  // error estimate
+  std::vector<double> blockMin(numBlocks, out->Min);
+  std::vector<double> blockMax(numBlocks, out->Max);
+#pragma omp parallel num_threads(nthreads)
+  {
+    fullMatrix<double> s, res;
+#pragma omp for schedule(dynamic)
+    for(std::size_t b = 0; b < numBlocks; b++) {
+      interpolate(b, s, res);
+      for(int i = 0; i < res.size1(); i++) {
+        for(int j = 0; j < res.size2(); j++) {
+          blockMin[b] = std::min(blockMin[b], res(i, j));
+          blockMax[b] = std::max(blockMax[b], res(i, j));
+        }
+      }
+    }
+  }
+  for(std::size_t b = 0; b < numBlocks; b++) {
+    out->Min = std::min(out->Min, blockMin[b]);
+    out->Max = std::max(out->Max, blockMax[b]);
+  }
+  double avg = fabs(out->Max - out->Min);
+  if(tol < 0) avg = 1.; // force visibility to the smallest subdivision
+
+  // 2nd pass: refine each element in a thread-local copy of the refinement
+  // pattern; the refined elements of each block are merged in order
+  std::vector<std::vector<double> > blockList(numBlocks);
+  std::vector<int> blockNb(numBlocks, 0);
+#pragma omp parallel num_threads(nthreads)
+  {
+    adaptiveTree<T> tree;
+    fullMatrix<double> s, res, c, resc, g, resg;
+#pragma omp for schedule(dynamic)
+    for(std::size_t b = 0; b < numBlocks; b++) {
+      std::size_t start = b * blockSize, nb = std::min(blockSize, n - start);
+      if(numComp == 1) { interpolate(b, s, res); }
+      else {
+        c.resize(numVals, nb * numComp, false);
+        resc.resize(numVertices, nb * numComp, false);
+        for(std::size_t e = 0; e < nb; e++)
+          for(int i = 0; i < numVals; i++)
+            for(int k = 0; k < numComp; k++)
+              c(i, numComp * e + k) =
+                val[numComp * (numVals * (start + e) + i) + k];
+        _interpolVal->mult(c, resc);
+      }
+      g.resize(numNodes, 3 * nb, false);
+      resg.resize(numVertices, 3 * nb, false);
+      for(std::size_t e = 0; e < nb; e++)
+        for(int i = 0; i < numNodes; i++)
+          for(int k = 0; k < 3; k++)
+            g(i, 3 * e + k) = xyz[3 * (numNodes * (start + e) + i) + k];
+      _interpolGeom->mult(g, resg);
+
+      std::vector<double> &list = blockList[b];
+      for(std::size_t e = 0; e < nb; e++) {
+        for(int i = 0; i < numVertices; i++) {
+          adaptiveVertex &p = tree.vertices[i];
+          if(numComp == 1) { p.val = res(i, e); }
+          else {
+            int j = numComp * e;
+            p.val = resc(i, j);
+            p.valy = resc(i, j + 1);
+            p.valz = resc(i, j + 2);
+            if(numComp == 9) {
+              p.valyx = resc(i, j + 3);
+              p.valyy = resc(i, j + 4);
+              p.valyz = resc(i, j + 5);
+              p.valzx = resc(i, j + 6);
+              p.valzy = resc(i, j + 7);
+              p.valzz = resc(i, j + 8);
+            }
+          }
+          p.X = resg(i, 3 * e);
+          p.Y = resg(i, 3 * e + 1);
+          p.Z = resg(i, 3 * e + 2);
+        }
+        for(std::size_t i = 0; i < tree.elements.size(); i++)
+          tree.elements[i].visible = false;
+        T::recurError(&tree.elements[0], avg, tol);
+        for(std::size_t i = 0; i < tree.elements.size(); i++) {
+          if(!tree.elements[i].visible) continue;
+          adaptiveVertex **p = tree.elements[i].p;
+          for(int k = 0; k < T::numNodes; k++) list.push_back(p[k]->X);
+          for(int k = 0; k < T::numNodes; k++) list.push_back(p[k]->Y);
+          for(int k = 0; k < T::numNodes; k++) list.push_back(p[k]->Z);
+          for(int k = 0; k < T::numNodes; k++) {
+            const double v[9] = {p[k]->val,   p[k]->valy,  p[k]->valz,
+                                 p[k]->valyx, p[k]->valyy, p[k]->valyz,
+                                 p[k]->valzx, p[k]->valzy, p[k]->valzz};
+            list.insert(list.end(), v, v + numComp);
+          }
+          blockNb[b]++;
+        }
+      }
+    }
+  }
+  std::size_t size = 0;
+  for(std::size_t b = 0; b < numBlocks; b++) size += blockList[b].size();
+  outList->reserve(size);
+  for(std::size_t b = 0; b < numBlocks; b++) {
+    outList->insert(outList->end(), blockList[b].begin(), blockList[b].end());
+    *outNb += blockNb[b];
   }
 }
 
@@ -611,7 +611,8 @@ public:
              GMSH_PostPlugin *plug = nullptr, bool onlyComputeMinMax = false);
   // adapt all the T-type elements in the input view and add the
   // refined elements in the output view (we will remove this when we
-  // switch to true on-the-fly local refinement in drawPost())
+  // switch to true on-the-fly local refinement in drawPost()); without a
+  // plugin, the elements are refined in parallel by blocks
   void addInView(double tol, int step, PViewData *in, PViewDataList *out,
                  GMSH_PostPlugin *plug = nullptr);
 